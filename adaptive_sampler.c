@@ -0,0 +1,59 @@
+/**
+ * @file adaptive_sampler.c
+ * @brief Implementação da amostragem adaptativa
+ */
+#include "adaptive_sampler.h"
+
+void adaptive_sampler_init(adaptive_sampler_t *sampler, const adaptive_sampler_config_t *config, uint32_t now_ms) {
+    *sampler = (adaptive_sampler_t){
+        .config = *config,
+        .period_ms = config->min_period_ms,
+        .next_ms = now_ms,
+        .stable_since_ms = now_ms,
+    };
+}
+
+uint32_t adaptive_sampler_update(adaptive_sampler_t *sampler, uint16_t value, uint32_t now_ms) {
+    const adaptive_sampler_config_t *cfg = &sampler->config;
+    bool trigger = false;
+
+    if (sampler->primed) {
+        uint32_t dt = now_ms - sampler->last_ms;
+        uint32_t delta = value > sampler->last_value ? value - sampler->last_value : sampler->last_value - value;
+        uint32_t allowed = cfg->noise_band + (uint32_t)((uint64_t)cfg->slope_per_s * dt / 1000);
+        trigger = delta > allowed;
+
+        // Média e variância móveis com peso 1/8 (desvio em 1/16 de código)
+        int32_t d = ((int32_t)value << 4) - sampler->mean_q4;
+        sampler->mean_q4 += d / 8;
+        uint32_t d2 = (uint32_t)(((int64_t)d * d) >> 8);
+        sampler->variance = sampler->variance - sampler->variance / 8 + d2 / 8;
+        trigger = trigger || sampler->variance > cfg->variance;
+    } else {
+        sampler->mean_q4 = (int32_t)value << 4;
+        sampler->primed = true;
+    }
+
+    if (trigger) {
+        sampler->period_ms = cfg->min_period_ms;
+        sampler->stable_since_ms = now_ms;
+        sampler->triggers++;
+    } else if (now_ms - sampler->stable_since_ms >= cfg->relax_after_ms && sampler->period_ms < cfg->max_period_ms) {
+        sampler->period_ms *= 2;
+        if (sampler->period_ms > cfg->max_period_ms) sampler->period_ms = cfg->max_period_ms;
+        sampler->stable_since_ms = now_ms;
+    }
+
+    sampler->last_value = value;
+    sampler->last_ms = now_ms;
+    sampler->next_ms = now_ms + sampler->period_ms;
+    sampler->samples++;
+    return sampler->period_ms;
+}
+
+void adaptive_sampler_boost(adaptive_sampler_t *sampler, uint32_t now_ms) {
+    sampler->period_ms = sampler->config.min_period_ms;
+    sampler->stable_since_ms = now_ms;
+    sampler->next_ms = now_ms;
+    sampler->triggers++;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file adaptive_sampler.h
+ * @brief Período de amostragem adaptativo por canal, guiado pela dinâmica do sinal
+ *
+ * O ADC converte continuamente (adc_capture.h) e o alarme de gás avalia
+ * todos os blocos na interrupção; o que varia aqui é com que frequência
+ * o laço principal toma o último valor de um canal para decidir
+ * atuadores e gerar telemetria. Cada canal tem seu período entre
+ * min_period_ms e max_period_ms:
+ *
+ * - Disparo: se a variação desde a amostra anterior passar da faixa de
+ *   ruído mais a inclinação permitida no intervalo, ou se a variância
+ *   (média móvel exponencial, peso 1/8) passar do limite, o período vai
+ *   direto ao mínimo.
+ * - Relaxamento: a cada relax_after_ms sem disparo, o período dobra, até
+ *   o máximo.
+ * - Reforço: adaptive_sampler_boost() força o período mínimo a partir de
+ *   agora, para sinais externos (p.ex. o alarme de gás, que a interrupção
+ *   detecta antes do laço).
+ *
+ * O cálculo é todo inteiro (o Cortex-M0+ não tem FPU). As ferramentas de
+ * host reproduzem séries gravadas com o mesmo código (sampling_replay).
+ */
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Limites e limiares de um canal (códigos brutos do ADC)
+ */
+typedef struct {
+    uint32_t min_period_ms;
+    uint32_t max_period_ms;
+    uint16_t noise_band;        // Variação nunca considerada mudança
+    uint16_t slope_per_s;       // Inclinação tolerada além da faixa de ruído
+    uint32_t variance;          // Variância (códigos²) que dispara
+    uint32_t relax_after_ms;    // Tempo estável antes de dobrar o período
+} adaptive_sampler_config_t;
+
+/**
+ * @brief Configurações padrão, compartilhadas pelo firmware e pelas ferramentas de host
+ *
+ * O máximo do LDR fica em 2 s, o período fixo anterior, para não piorar
+ * a latência do LED; o do MQ2 pode ir além, porque o relé não depende
+ * do laço.
+ */
+#define ADAPTIVE_SAMPLER_LDR_DEFAULT {250, 2000, 40, 200, 2500, 10000}
+#define ADAPTIVE_SAMPLER_MQ2_DEFAULT {100, 8000, 40, 100, 2500, 10000}
+
+/**
+ * @brief Estado de um canal
+ */
+typedef struct {
+    adaptive_sampler_config_t config;
+    uint32_t period_ms;         // Período atual
+    uint32_t next_ms;           // Instante da próxima amostra
+    uint32_t last_ms;           // Instante da última amostra
+    uint32_t stable_since_ms;   // Último disparo, reforço ou relaxamento
+    uint16_t last_value;
+    int32_t mean_q4;            // Média móvel em 1/16 de código
+    uint32_t variance;          // Variância móvel em códigos²
+    uint32_t samples;           // Amostras tomadas
+    uint32_t triggers;          // Disparos e reforços
+    bool primed;                // Já há uma amostra anterior
+} adaptive_sampler_t;
+
+/**
+ * @brief Inicializa um canal no período mínimo, com a primeira amostra devida em now_ms
+ */
+void adaptive_sampler_init(adaptive_sampler_t *sampler, const adaptive_sampler_config_t *config, uint32_t now_ms);
+
+/**
+ * @brief Indica se a próxima amostra já é devida (tolera o wrap de 32 bits)
+ */
+static inline bool adaptive_sampler_due(const adaptive_sampler_t *sampler, uint32_t now_ms) {
+    return (int32_t)(now_ms - sampler->next_ms) >= 0;
+}
+
+/**
+ * @brief Registra uma amostra e agenda a próxima
+ *
+ * @return Novo período em ms
+ */
+uint32_t adaptive_sampler_update(adaptive_sampler_t *sampler, uint16_t value, uint32_t now_ms);
+
+/**
+ * @brief Força o período mínimo, com a próxima amostra devida em now_ms
+ */
+void adaptive_sampler_boost(adaptive_sampler_t *sampler, uint32_t now_ms);
+
+#endif // ADAPTIVE_SAMPLER_H
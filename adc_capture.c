@@ -0,0 +1,179 @@
+/**
+ * @file adc_capture.c
+ * @brief Implementação da captura do ADC via DMA em ping-pong
+ */
+#include "adc_capture.h"
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "adc_dnl.h"
+#include "board.h"
+#include "exec_trace.h"
+#include "running_median.h"
+#include "sensor_registry.h"
+
+#define ADC_CAPTURE_ADC_CLOCK_HZ 48000000   // Relógio do ADC (clk_adc)
+
+#if ADC_CAPTURE_SAMPLE_VSYS
+#define ADC_CAPTURE_VSYS_CHANNEL BOARD_VSYS_ADC_CHANNEL
+#else
+#define ADC_CAPTURE_VSYS_CHANNEL 2          // ADC2 (GPIO 28) ocupa a posição de VSYS e é descartado
+#endif
+
+static_assert(BOARD_MQ2_ADC_CHANNEL < ADC_CAPTURE_VSYS_CHANNEL && ADC_CAPTURE_FILTERED == ADC_CAPTURE_VSYS,
+              "as posições do bloco seguem a ordem dos canais no round-robin");
+static_assert(ADC_CAPTURE_SAMPLE_RATE_HZ <= 500000, "o ADC converte no máximo 500 mil amostras por segundo");
+
+/**
+ * @brief Estado da captura
+ */
+typedef struct {
+    int dma_channel[2];                     // Canais de DMA do ping-pong
+    adc_capture_block_fn on_block;          // Callback de bloco
+    volatile uint32_t blocks;               // Blocos convertidos até a última interrupção
+    uint32_t next_block_us;                 // Fim previsto do próximo bloco a contar
+    running_median_t median[ADC_CAPTURE_FILTERED];
+} adc_capture_state_t;
+
+static adc_capture_state_t adc_capture_state;
+
+// Blocos de destino do DMA, um por canal
+static uint16_t adc_capture_buffer[2][ADC_CAPTURE_BLOCK_SAMPLES];
+
+/**
+ * @brief Trata o fim de um bloco de DMA
+ *
+ * Rearma o canal que terminou (o outro já está em andamento por
+ * encadeamento), corrige a DNL do bloco inteiro (adc_dnl.h), filtra o
+ * LDR e o MQ2 no lugar pela mediana móvel de
+ * cada um, soma VSYS e temperatura, entrega o bloco ao callback e
+ * publica os últimos valores no canal SENSOR_REGISTRY_ADC e as médias
+ * no SENSOR_REGISTRY_ADC_AUX do registro (sensor_registry.h). O canal
+ * rearmado só volta a escrever no bloco depois que o outro terminar.
+ * Fica em RAM para não depender do cache de XIP.
+ */
+static void __not_in_flash_func(adc_capture_dma_irq)(void) {
+    uint32_t now = time_us_32();
+    EXEC_TRACE_BEGIN(EXEC_TRACE_IRQ_DMA);
+
+    // Conta pelo tempo, não pelas entradas aqui: blocos sobrescritos por uma
+    // interrupção atrasada além do ping-pong também foram convertidos
+    while ((int32_t)(now + ADC_CAPTURE_BLOCK_US / 2 - adc_capture_state.next_block_us) >= 0) {
+        adc_capture_state.next_block_us += ADC_CAPTURE_BLOCK_US;
+        adc_capture_state.blocks++;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        int ch = adc_capture_state.dma_channel[i];
+        if (!dma_channel_get_irq0_status(ch)) continue;
+        dma_channel_acknowledge_irq0(ch);
+
+        uint16_t *block = adc_capture_buffer[i];
+        dma_channel_set_write_addr(ch, adc_capture_buffer[i], false);
+        adc_dnl_correct_block(block, ADC_CAPTURE_BLOCK_SAMPLES);
+
+        uint32_t vsys_sum = 0, temp_sum = 0;
+        for (int s = 0; s < ADC_CAPTURE_BLOCK_SAMPLES; s += ADC_CAPTURE_CHANNELS) {
+            for (int c = 0; c < ADC_CAPTURE_FILTERED; c++) {
+                block[s + c] = (uint16_t)running_median_push(&adc_capture_state.median[c], block[s + c]);
+            }
+            vsys_sum += block[s + ADC_CAPTURE_VSYS];
+            temp_sum += block[s + ADC_CAPTURE_TEMP];
+        }
+
+        if (adc_capture_state.on_block) {
+            adc_capture_state.on_block(block, now);
+        }
+        sensor_reading_t latest = {
+            .value = {block[ADC_CAPTURE_BLOCK_SAMPLES - ADC_CAPTURE_CHANNELS + ADC_CAPTURE_LDR],
+                      block[ADC_CAPTURE_BLOCK_SAMPLES - ADC_CAPTURE_CHANNELS + ADC_CAPTURE_MQ2]},
+            .time_us = now,
+        };
+        sensor_registry_publish(SENSOR_REGISTRY_ADC, &latest);
+        sensor_reading_t aux = {
+            .value = {(int32_t)(temp_sum * 16 / ADC_CAPTURE_PER_CHANNEL),
+                      ADC_CAPTURE_SAMPLE_VSYS ? (int32_t)(vsys_sum * 16 / ADC_CAPTURE_PER_CHANNEL) : 0},
+            .time_us = now,
+        };
+        sensor_registry_publish(SENSOR_REGISTRY_ADC_AUX, &aux);
+    }
+    EXEC_TRACE_END(EXEC_TRACE_IRQ_DMA);
+}
+
+int adc_capture_init(adc_capture_block_fn on_block) {
+    adc_capture_state.on_block = on_block;
+    adc_dnl_init();
+    for (int c = 0; c < ADC_CAPTURE_FILTERED; c++) {
+        running_median_init(&adc_capture_state.median[c], ADC_CAPTURE_MEDIAN_WINDOW);
+    }
+
+    adc_init();
+    adc_gpio_init(BOARD_LDR_PIN);
+    adc_gpio_init(BOARD_MQ2_PIN);
+#if ADC_CAPTURE_SAMPLE_VSYS
+    adc_gpio_init(BOARD_VSYS_PIN);
+    gpio_init(BOARD_VSYS_ENABLE_PIN);
+    gpio_set_dir(BOARD_VSYS_ENABLE_PIN, GPIO_OUT);
+    gpio_put(BOARD_VSYS_ENABLE_PIN, 1);
+#endif
+    adc_set_temp_sensor_enabled(true);
+
+    // O round-robin segue a ordem dos canais a partir do LDR: LDR, MQ2, VSYS (3) ou ADC2, temperatura (4)
+    adc_select_input(BOARD_LDR_ADC_CHANNEL);
+    adc_set_round_robin((1u << BOARD_LDR_ADC_CHANNEL) | (1u << BOARD_MQ2_ADC_CHANNEL) |
+                        (1u << ADC_CAPTURE_VSYS_CHANNEL) | (1u << BOARD_TEMP_ADC_CHANNEL));
+    adc_fifo_setup(true,    // Amostras vão para o FIFO
+                   true,    // DREQ habilitado para o DMA
+                   1,       // DREQ a cada amostra
+                   false,   // Sem bit de erro nas amostras
+                   false);  // Amostras de 12 bits em 16 bits
+    adc_set_clkdiv((float)ADC_CAPTURE_ADC_CLOCK_HZ / ADC_CAPTURE_SAMPLE_RATE_HZ - 1.0f);
+
+    for (int i = 0; i < 2; i++) {
+        int ch = dma_claim_unused_channel(false);
+        if (ch < 0) return ADC_CAPTURE_ERROR_NO_DMA;
+        adc_capture_state.dma_channel[i] = ch;
+    }
+
+    // Cada canal encadeia o outro: a captura nunca para entre blocos
+    for (int i = 0; i < 2; i++) {
+        int ch = adc_capture_state.dma_channel[i];
+        dma_channel_config cfg = dma_channel_get_default_config(ch);
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+        channel_config_set_read_increment(&cfg, false);
+        channel_config_set_write_increment(&cfg, true);
+        channel_config_set_dreq(&cfg, DREQ_ADC);
+        channel_config_set_chain_to(&cfg, adc_capture_state.dma_channel[i ^ 1]);
+        dma_channel_configure(ch, &cfg, adc_capture_buffer[i], &adc_hw->fifo,
+                              ADC_CAPTURE_BLOCK_SAMPLES, false);
+        dma_channel_set_irq0_enabled(ch, true);
+    }
+
+    irq_set_exclusive_handler(DMA_IRQ_0, adc_capture_dma_irq);
+    irq_set_priority(DMA_IRQ_0, PICO_HIGHEST_IRQ_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    adc_capture_state.next_block_us = time_us_32() + ADC_CAPTURE_BLOCK_US;
+    dma_channel_start(adc_capture_state.dma_channel[0]);
+    adc_run(true);
+
+    return ADC_CAPTURE_OK;
+}
+
+uint16_t adc_capture_latest(uint32_t channel) {
+    sensor_reading_t latest;
+    sensor_registry_read(SENSOR_REGISTRY_ADC, &latest);
+    return (uint16_t)latest.value[channel];
+}
+
+uint32_t adc_capture_latest_us(void) {
+    sensor_reading_t latest;
+    sensor_registry_read(SENSOR_REGISTRY_ADC, &latest);
+    return latest.time_us;
+}
+
+uint32_t adc_capture_block_count(void) {
+    return adc_capture_state.blocks;
+}
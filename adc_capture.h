@@ -0,0 +1,142 @@
+/**
+ * @file adc_capture.h
+ * @brief Captura contínua do ADC em round-robin via DMA
+ *
+ * O ADC converte continuamente, em round-robin a partir do LDR, as
+ * entradas do LDR e do MQ2 (canais do ADC resolvidos em compilação por
+ * board.h, ADC0 e ADC1 na placa atual), VSYS / 3 (ADC3) e o sensor de
+ * temperatura interno (ADC4). Dois canais de DMA encadeados (ping-pong)
+ * copiam o FIFO do ADC para dois blocos em RAM; ao completar cada bloco,
+ * a interrupção DMA_IRQ_0 (prioridade máxima) entrega o bloco ao
+ * callback registrado e atualiza o último valor de cada canal. A CPU não
+ * participa da aquisição.
+ *
+ * Cada bloco contém ADC_CAPTURE_BLOCK_SAMPLES amostras intercaladas:
+ * @code
+ * [LDR, MQ2, VSYS, TEMP, LDR, MQ2, VSYS, TEMP, ...]
+ * @endcode
+ *
+ * A taxa total e o bloco dobraram com as duas entradas novas, então cada
+ * sensor segue com 10 mil amostras por segundo, o bloco dura os mesmos
+ * 800 μs e a interrupção vem na mesma frequência. VSYS e temperatura
+ * variam devagar: entram só na média do bloco, publicada em Q4 no canal
+ * SENSOR_REGISTRY_ADC_AUX para a compensação (adc_compensation.h).
+ *
+ * Antes de qualquer outro uso, o bloco inteiro passa pela tabela de
+ * correção da DNL do ADC (adc_dnl.h): os códigos entregues, publicados
+ * e comparados pelo alarme de gás já estão na escala de um ADC ideal.
+ *
+ * Antes de chegar ao callback, o LDR e o MQ2 passam por uma mediana
+ * móvel de ADC_CAPTURE_MEDIAN_WINDOW amostras (running_median.h), que
+ * remove picos isolados do ADC antes de qualquer limiar. O atraso de um
+ * degrau é de (janela - 1) / 2 amostras do canal: 100 μs com a janela
+ * padrão, que somados ao bloco ainda cabem no orçamento de 1 ms do
+ * alarme de gás.
+ *
+ * Na Pico W, o GPIO 29 (ADC3) também é o relógio do SPI do chip sem fio,
+ * e VSYS / 3 só chega a ele com o GPIO 25 (CS do rádio) em nível alto:
+ * a captura mantém o GPIO 25 alto e não convive com o driver do rádio.
+ * Com a rede (net.h), ADC_CAPTURE_SAMPLE_VSYS em 0 deixa os GPIOs 25 e
+ * 29 com o rádio: a posição de VSYS no bloco passa a converter o ADC2
+ * (GPIO 28, livre na placa), que é descartado, e a média publicada de
+ * VSYS fica em zero, que a compensação trata como VSYS nominal.
+ */
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Códigos de retorno das operações da captura
+ */
+#define ADC_CAPTURE_OK 0                    // Operação realizada com sucesso
+#define ADC_CAPTURE_ERROR_NO_DMA -1         // Não há canais de DMA livres
+
+#define ADC_CAPTURE_CHANNELS 4              // Entradas no round-robin
+#define ADC_CAPTURE_LDR 0                   // Posição do LDR no bloco
+#define ADC_CAPTURE_MQ2 1                   // Posição do MQ2 no bloco
+#define ADC_CAPTURE_VSYS 2                  // Posição de VSYS / 3 (ADC3) no bloco
+#define ADC_CAPTURE_TEMP 3                  // Posição do sensor de temperatura (ADC4) no bloco
+#define ADC_CAPTURE_FILTERED 2              // Entradas com mediana: as duas primeiras posições
+
+#ifndef ADC_CAPTURE_SAMPLE_VSYS
+#define ADC_CAPTURE_SAMPLE_VSYS 1           // 0: não mede VSYS (GPIOs 25 e 29 com o rádio)
+#endif
+
+#ifndef ADC_CAPTURE_SAMPLE_RATE_HZ
+#define ADC_CAPTURE_SAMPLE_RATE_HZ 40000    // Conversões por segundo (todas as entradas)
+#endif
+#ifndef ADC_CAPTURE_BLOCK_SAMPLES
+#define ADC_CAPTURE_BLOCK_SAMPLES 32        // Amostras por bloco de DMA (8 por canal)
+#endif
+#define ADC_CAPTURE_PER_CHANNEL (ADC_CAPTURE_BLOCK_SAMPLES / ADC_CAPTURE_CHANNELS)
+
+#ifndef ADC_CAPTURE_MEDIAN_WINDOW
+#define ADC_CAPTURE_MEDIAN_WINDOW 3         // Janela da mediana por canal (1: sem filtro)
+#endif
+
+// Duração de um bloco: limite superior do atraso entre conversão e interrupção
+#define ADC_CAPTURE_BLOCK_US (ADC_CAPTURE_BLOCK_SAMPLES * 1000000 / ADC_CAPTURE_SAMPLE_RATE_HZ)
+
+static_assert(ADC_CAPTURE_BLOCK_SAMPLES % ADC_CAPTURE_CHANNELS == 0,
+              "o bloco deve conter o mesmo número de amostras de cada canal");
+static_assert((ADC_CAPTURE_BLOCK_SAMPLES & (ADC_CAPTURE_BLOCK_SAMPLES - 1)) == 0,
+              "bloco em potência de dois: a interrupção divide por ele com um deslocamento, sem rotina da flash");
+static_assert(ADC_CAPTURE_BLOCK_US < 1000,
+              "o bloco de DMA deve ser menor que o orçamento de latência de 1 ms");
+static_assert(ADC_CAPTURE_BLOCK_US + (ADC_CAPTURE_MEDIAN_WINDOW - 1) / 2 * ADC_CAPTURE_CHANNELS * 1000000 /
+                      ADC_CAPTURE_SAMPLE_RATE_HZ < 1000,
+              "o bloco mais o atraso da mediana devem caber no orçamento de latência de 1 ms");
+
+/**
+ * @brief Callback chamado dentro da interrupção a cada bloco completo
+ *
+ * @param samples Amostras intercaladas (ADC_CAPTURE_BLOCK_SAMPLES)
+ * @param end_us Instante (time_us_32) em que a interrupção começou,
+ *               aproximadamente a conversão da última amostra
+ *
+ * @note Roda em contexto de interrupção: deve ser curto, não bloquear e
+ * não chamar printf.
+ */
+typedef void (*adc_capture_block_fn)(const uint16_t *samples, uint32_t end_us);
+
+/**
+ * @brief Inicia a captura contínua
+ *
+ * Configura o ADC, os pinos analógicos (BOARD_LDR_PIN, BOARD_MQ2_PIN e,
+ * com ADC_CAPTURE_SAMPLE_VSYS, BOARD_VSYS_PIN), o sensor de temperatura,
+ * os dois canais de DMA e a interrupção DMA_IRQ_0 com prioridade máxima.
+ * A partir deste ponto o ADC pertence à captura: adc_select_input()/
+ * adc_read() não devem mais ser usados pela aplicação.
+ *
+ * @param on_block Callback de bloco (pode ser NULL)
+ *
+ * @return ADC_CAPTURE_OK ou ADC_CAPTURE_ERROR_NO_DMA
+ */
+int adc_capture_init(adc_capture_block_fn on_block);
+
+/**
+ * @brief Última amostra de um canal (ADC_CAPTURE_LDR ou ADC_CAPTURE_MQ2)
+ *
+ * Para obter a amostra junto com o seu instante, leia o canal
+ * SENSOR_REGISTRY_ADC de sensor_registry.h numa única chamada: duas
+ * chamadas separadas podem cruzar uma interrupção.
+ */
+uint16_t adc_capture_latest(uint32_t channel);
+
+/**
+ * @brief Instante (time_us_32) da interrupção que entregou as últimas amostras
+ */
+uint32_t adc_capture_latest_us(void);
+
+/**
+ * @brief Número de blocos convertidos desde o início da captura, até a última interrupção
+ *
+ * Contados pelo tempo da interrupção: os blocos que uma interrupção
+ * atrasada deixou o DMA sobrescrever também entram.
+ */
+uint32_t adc_capture_block_count(void);
+
+#endif // ADC_CAPTURE_H
@@ -0,0 +1,81 @@
+/**
+ * @file adc_compensation.c
+ * @brief Implementação da compensação das leituras do ADC em ponto fixo
+ */
+#include "adc_compensation.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define Q4_FULL_SCALE (ADC_COMPENSATION_FULL_SCALE * 16u)
+#define VREF_UV (ADC_COMPENSATION_VREF_MV * 1000ull)
+
+// Temperatura em que o ADC4 leria 0 V (m°C): a reta do datasheet estendida
+#define TEMP_ZERO_MC                                                                                                 \
+    ((int32_t)(27000 + (ADC_COMPENSATION_TEMP_27C_UV * 1000 + ADC_COMPENSATION_TEMP_SLOPE_UV / 2) /                  \
+                               ADC_COMPENSATION_TEMP_SLOPE_UV))
+// m°C por unidade Q4 do ADC4, em Q8
+#define TEMP_MC_PER_Q4_Q8                                                                                            \
+    ((uint32_t)((VREF_UV * 1000 * 256 + (uint64_t)Q4_FULL_SCALE * ADC_COMPENSATION_TEMP_SLOPE_UV / 2) /             \
+                ((uint64_t)Q4_FULL_SCALE * ADC_COMPENSATION_TEMP_SLOPE_UV)))
+
+// VSYS nominal / VSYS = SUPPLY_NUM_Q16 / média do ADC3 em Q4, com o ganho em Q16
+#define SUPPLY_NUM_Q16                                                                                               \
+    ((uint64_t)ADC_COMPENSATION_VSYS_NOMINAL_MV * Q4_FULL_SCALE * 65536 /                                            \
+     (ADC_COMPENSATION_VSYS_DIVIDER * ADC_COMPENSATION_VREF_MV))
+#define VSYS_Q4(mv) ((uint32_t)((uint64_t)(mv) * Q4_FULL_SCALE / (ADC_COMPENSATION_VSYS_DIVIDER * ADC_COMPENSATION_VREF_MV)))
+
+// Com |ppm| <= 5000 e a referência na faixa, o fator de temperatura fica entre 0,175 e 1,825,
+// o ganho total abaixo de 12 e o código vezes o ganho em 32 bits
+static_assert((ADC_COMPENSATION_MAX_MC - ADC_COMPENSATION_MIN_MC) / 1000 * 5000 < 1000000,
+              "faixa de temperatura larga demais para os ganhos em 32 bits");
+static_assert(SUPPLY_NUM_Q16 <= UINT32_MAX, "VSYS nominal alto demais para o ganho em 32 bits");
+
+static const struct {
+    int32_t ppm_per_c;
+    bool vsys;
+} sensors[ADC_COMPENSATION_SENSORS] = {
+    [ADC_COMPENSATION_LDR] = {ADC_COMPENSATION_LDR_PPM_PER_C,
+                              ADC_COMPENSATION_LDR_SUPPLY == ADC_COMPENSATION_SUPPLY_VSYS},
+    [ADC_COMPENSATION_MQ2] = {ADC_COMPENSATION_MQ2_PPM_PER_C,
+                              ADC_COMPENSATION_MQ2_SUPPLY == ADC_COMPENSATION_SUPPLY_VSYS},
+};
+
+int32_t adc_compensation_die_mc(uint32_t temp_q4) {
+    // A tensão cai com a temperatura; o produto vai até 65520 * 7492, dentro de 32 bits
+    return TEMP_ZERO_MC - (int32_t)((temp_q4 * TEMP_MC_PER_Q4_Q8 + 128) / 256);
+}
+
+uint32_t adc_compensation_vsys_mv(uint32_t vsys_q4) {
+    return (vsys_q4 * (ADC_COMPENSATION_VSYS_DIVIDER * ADC_COMPENSATION_VREF_MV) + Q4_FULL_SCALE / 2) / Q4_FULL_SCALE;
+}
+
+void adc_compensation_update(adc_compensation_t *comp, uint32_t temp_q4, uint32_t vsys_q4) {
+    comp->die_mc = temp_q4 ? adc_compensation_die_mc(temp_q4) : ADC_COMPENSATION_REF_MC;
+    comp->vsys_mv = vsys_q4 ? adc_compensation_vsys_mv(vsys_q4) : ADC_COMPENSATION_VSYS_NOMINAL_MV;
+
+    int32_t die_mc = comp->die_mc;
+    if (die_mc < ADC_COMPENSATION_MIN_MC) die_mc = ADC_COMPENSATION_MIN_MC;
+    if (die_mc > ADC_COMPENSATION_MAX_MC) die_mc = ADC_COMPENSATION_MAX_MC;
+    int32_t delta_mc = die_mc - ADC_COMPENSATION_REF_MC;
+
+    // Direto da média em Q4, sem o arredondamento a mV; fora de metade a dobro do
+    // nominal, VSYS não alimenta nada direito e a correção para aí
+    if (!vsys_q4) vsys_q4 = VSYS_Q4(ADC_COMPENSATION_VSYS_NOMINAL_MV);
+    if (vsys_q4 < VSYS_Q4(ADC_COMPENSATION_VSYS_NOMINAL_MV / 2)) vsys_q4 = VSYS_Q4(ADC_COMPENSATION_VSYS_NOMINAL_MV / 2);
+    if (vsys_q4 > VSYS_Q4(ADC_COMPENSATION_VSYS_NOMINAL_MV * 2)) vsys_q4 = VSYS_Q4(ADC_COMPENSATION_VSYS_NOMINAL_MV * 2);
+    uint32_t supply_q16 = (uint32_t)SUPPLY_NUM_Q16 / vsys_q4;
+
+    for (int s = 0; s < ADC_COMPENSATION_SENSORS; s++) {
+        // Fator da saída em ppm; o ganho é o inverso: 2^16 * 10^6 / fator = (10^6 << 12) / (fator >> 4)
+        uint32_t factor_ppm = (uint32_t)(1000000 + sensors[s].ppm_per_c * delta_mc / 1000);
+        uint32_t temp_q16 = (1000000u << 12) / (factor_ppm >> 4);
+        uint32_t vsys_q16 = sensors[s].vsys ? supply_q16 : 1u << 16;
+        comp->gain_q16[s] = (uint32_t)(((uint64_t)temp_q16 * vsys_q16 + (1u << 15)) >> 16);
+    }
+}
+
+uint16_t adc_compensation_apply(const adc_compensation_t *comp, adc_compensation_sensor_t sensor, uint32_t code) {
+    uint32_t out = (code * comp->gain_q16[sensor] + (1u << 15)) >> 16;
+    return (uint16_t)(out > ADC_COMPENSATION_FULL_SCALE ? ADC_COMPENSATION_FULL_SCALE : out);
+}
@@ -0,0 +1,118 @@
+/**
+ * @file adc_compensation.h
+ * @brief Compensação de temperatura e de alimentação das leituras do ADC, em ponto fixo
+ *
+ * O LDR e o MQ2 derivam com a temperatura da placa e, se alimentados por
+ * VSYS, com a tensão de alimentação. A captura do ADC (adc_capture.h)
+ * mede junto com eles o sensor de temperatura interno do RP2040 (ADC4)
+ * e VSYS / 3 (ADC3) e publica a média de cada bloco no canal
+ * SENSOR_REGISTRY_ADC_AUX, em dezesseis avos de código (Q4). Este módulo
+ * converte essas médias e refere os códigos do LDR e do MQ2 às condições
+ * nominais (ADC_COMPENSATION_REF_MC e ADC_COMPENSATION_VSYS_NOMINAL_MV):
+ *
+ * - temperatura: a saída de cada sensor sobe ppm_per_c partes por milhão
+ *   por °C acima da referência, e o código é dividido por esse fator. A
+ *   temperatura usada é a do chip, que acompanha a da placa; os
+ *   coeficientes são aproximações das curvas dos datasheets e devem ser
+ *   calibrados por montagem;
+ * - alimentação: um sensor alimentado pelos 3,3 V, a mesma referência
+ *   do ADC, já é radiométrico e não é corrigido; um alimentado por VSYS
+ *   tem o código multiplicado por VSYS nominal / VSYS medido.
+ *
+ * Os códigos chegam aqui já corrigidos da DNL (adc_dnl.h). O alarme de
+ * gás (gas_alarm.h) compara os códigos sem compensação na interrupção
+ * do DMA e não passa por aqui.
+ *
+ * Tudo em inteiros, sem float nem divisão de 64 bits: o ganho de cada
+ * sensor é calculado uma vez por adc_compensation_update() em Q16 (com
+ * um único produto de 64 bits) e aplicado com uma multiplicação de 32. O erro contra o cálculo em
+ * ponto flutuante é conferido por host/adc_compensation_check.c.
+ */
+#ifndef ADC_COMPENSATION_H
+#define ADC_COMPENSATION_H
+
+#include <assert.h>
+#include <stdint.h>
+
+#define ADC_COMPENSATION_VREF_MV 3300           // Referência do ADC (o próprio 3,3 V da placa)
+#define ADC_COMPENSATION_FULL_SCALE 4095        // Maior código de 12 bits
+#define ADC_COMPENSATION_VSYS_DIVIDER 3         // ADC3 mede VSYS / 3
+
+// Sensor de temperatura do RP2040 (datasheet, 4.9.5): 0,706 V a 27 °C, -1,721 mV/°C
+#define ADC_COMPENSATION_TEMP_27C_UV 706000
+#define ADC_COMPENSATION_TEMP_SLOPE_UV 1721
+
+#define ADC_COMPENSATION_SUPPLY_VREF 0          // Sensor alimentado pelos 3,3 V (radiométrico)
+#define ADC_COMPENSATION_SUPPLY_VSYS 1          // Sensor alimentado por VSYS
+
+#ifndef ADC_COMPENSATION_REF_MC
+#define ADC_COMPENSATION_REF_MC 25000           // Temperatura de referência dos coeficientes (m°C)
+#endif
+#ifndef ADC_COMPENSATION_VSYS_NOMINAL_MV
+#define ADC_COMPENSATION_VSYS_NOMINAL_MV 5000   // VSYS com alimentação USB
+#endif
+#ifndef ADC_COMPENSATION_LDR_PPM_PER_C
+#define ADC_COMPENSATION_LDR_PPM_PER_C 0        // Depende da luz e do lado do divisor: calibrar
+#endif
+#ifndef ADC_COMPENSATION_MQ2_PPM_PER_C
+#define ADC_COMPENSATION_MQ2_PPM_PER_C 2000     // Rs cai com a temperatura: a saída sobe
+#endif
+#ifndef ADC_COMPENSATION_LDR_SUPPLY
+#define ADC_COMPENSATION_LDR_SUPPLY ADC_COMPENSATION_SUPPLY_VREF    // Como em diagram.json
+#endif
+#ifndef ADC_COMPENSATION_MQ2_SUPPLY
+#define ADC_COMPENSATION_MQ2_SUPPLY ADC_COMPENSATION_SUPPLY_VREF
+#endif
+
+#define ADC_COMPENSATION_MIN_MC -40000          // Faixa de operação do RP2040: limita a correção
+#define ADC_COMPENSATION_MAX_MC 125000
+
+// Mantém o fator de temperatura positivo e os ganhos em 32 bits (ver adc_compensation.c)
+static_assert(ADC_COMPENSATION_LDR_PPM_PER_C >= -5000 && ADC_COMPENSATION_LDR_PPM_PER_C <= 5000 &&
+                      ADC_COMPENSATION_MQ2_PPM_PER_C >= -5000 && ADC_COMPENSATION_MQ2_PPM_PER_C <= 5000,
+              "coeficiente de temperatura fora de ±5000 ppm/°C");
+static_assert(ADC_COMPENSATION_REF_MC >= ADC_COMPENSATION_MIN_MC && ADC_COMPENSATION_REF_MC <= ADC_COMPENSATION_MAX_MC,
+              "temperatura de referência fora da faixa do RP2040");
+
+/**
+ * @brief Sensores compensados (mesma ordem de ADC_CAPTURE_LDR e ADC_CAPTURE_MQ2)
+ */
+typedef enum {
+    ADC_COMPENSATION_LDR,
+    ADC_COMPENSATION_MQ2,
+    ADC_COMPENSATION_SENSORS,
+} adc_compensation_sensor_t;
+
+/**
+ * @brief Condições medidas e o ganho resultante de cada sensor
+ */
+typedef struct {
+    int32_t die_mc;                                 // Temperatura do chip (m°C)
+    uint32_t vsys_mv;                               // VSYS (mV)
+    uint32_t gain_q16[ADC_COMPENSATION_SENSORS];    // Código compensado = código * ganho / 65536
+} adc_compensation_t;
+
+/**
+ * @brief Temperatura do chip (m°C) a partir da média do ADC4 em Q4
+ */
+int32_t adc_compensation_die_mc(uint32_t temp_q4);
+
+/**
+ * @brief VSYS (mV) a partir da média do ADC3 em Q4
+ */
+uint32_t adc_compensation_vsys_mv(uint32_t vsys_q4);
+
+/**
+ * @brief Recalcula as condições e os ganhos a partir das médias publicadas pela captura
+ *
+ * Com temp_q4 e vsys_q4 em zero (captura ainda sem blocos), assume as
+ * condições nominais: ganho unitário.
+ */
+void adc_compensation_update(adc_compensation_t *comp, uint32_t temp_q4, uint32_t vsys_q4);
+
+/**
+ * @brief Código do sensor referido às condições nominais (0 a 4095)
+ */
+uint16_t adc_compensation_apply(const adc_compensation_t *comp, adc_compensation_sensor_t sensor, uint32_t code);
+
+#endif // ADC_COMPENSATION_H
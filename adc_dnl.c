@@ -0,0 +1,90 @@
+/**
+ * @file adc_dnl.c
+ * @brief Implementação da tabela de correção da DNL do ADC
+ */
+#include "adc_dnl.h"
+
+#include <stddef.h>
+
+#if PICO_ON_DEVICE
+#include "pico.h"
+#define ADC_DNL_FUNC(f) __not_in_flash_func(f)
+#else
+#define ADC_DNL_FUNC(f) f
+#endif
+
+#define INTERIOR_LSB (ADC_DNL_CODES - 2)    // Largura somada dos códigos 1 a 4094
+
+#ifdef ADC_DNL_TABLE_FILE
+// Define adc_dnl_calibrated[ADC_DNL_CODES], impresso por adc_dnl_calibrate
+#include ADC_DNL_TABLE_FILE
+#endif
+
+static int8_t offsets[ADC_DNL_CODES];
+
+// Ocorrências do código no histograma, ou a largura no modelo nominal (LSB)
+static uint32_t count_of(const uint32_t *histogram, uint32_t code) {
+    if (histogram) return histogram[code];
+    return adc_dnl_is_spike(code) ? 1 + ADC_DNL_SPIKE_LSB : 1;
+}
+
+/**
+ * @brief Preenche a tabela a partir das larguras dos códigos (histograma ou modelo)
+ *
+ * Com os códigos 1 a 4094 normalizados para 4094 LSB, o código k começa
+ * em 1 + 4094 * acumulado / total, e o centro menos 1/2, arredondado, é
+ * 1 + (2 * acumulado + h_k) * 2047 / total. A primeira passada só
+ * confere a faixa dos deslocamentos, para não deixar a tabela pela
+ * metade nem precisar de outra de 4 kB na pilha.
+ */
+static int build(const uint32_t *histogram) {
+    uint64_t total = 0;
+    for (uint32_t k = 1; k < ADC_DNL_CODES - 1; k++) total += count_of(histogram, k);
+    if (total < (histogram ? (uint64_t)ADC_DNL_MIN_PER_CODE * INTERIOR_LSB : 1)) {
+        return ADC_DNL_ERROR_FEW_SAMPLES;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        uint64_t acc = 0;
+        for (uint32_t k = 1; k < ADC_DNL_CODES - 1; k++) {
+            uint32_t h = count_of(histogram, k);
+            int32_t corrected = 1 + (int32_t)((2 * acc + h) * (INTERIOR_LSB / 2) / total);
+            int32_t offset = corrected - (int32_t)k;
+            if (pass == 0 && (offset < INT8_MIN || offset > INT8_MAX)) return ADC_DNL_ERROR_RANGE;
+            if (pass == 1) offsets[k] = (int8_t)offset;
+            acc += h;
+        }
+    }
+    offsets[0] = 0;
+    offsets[ADC_DNL_CODES - 1] = 0;
+    return ADC_DNL_OK;
+}
+
+void adc_dnl_init(void) {
+#ifdef ADC_DNL_TABLE_FILE
+    for (uint32_t k = 0; k < ADC_DNL_CODES; k++) offsets[k] = adc_dnl_calibrated[k];
+#else
+    build(NULL);
+#endif
+}
+
+int adc_dnl_build(const uint32_t *histogram) {
+    return build(histogram);
+}
+
+int8_t adc_dnl_offset(uint16_t code) {
+    return offsets[code & (ADC_DNL_CODES - 1)];
+}
+
+uint16_t adc_dnl_correct(uint16_t code) {
+    code &= ADC_DNL_CODES - 1;
+    return (uint16_t)(code + offsets[code]);
+}
+
+// Chamada da interrupção do DMA: fica em RAM, como a tabela
+void ADC_DNL_FUNC(adc_dnl_correct_block)(uint16_t *samples, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t code = samples[i] & (ADC_DNL_CODES - 1);
+        samples[i] = (uint16_t)(code + offsets[code]);
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ * @file adc_dnl.h
+ * @brief Correção da não linearidade diferencial (DNL) do ADC do RP2040 por tabela
+ *
+ * O ADC do RP2040 tem códigos muito mais largos que 1 LSB em 512, 1536,
+ * 2560 e 3584 (documentados no datasheet): uma faixa de entradas de
+ * vários LSB sai toda com o mesmo código, e os códigos acima de cada um
+ * ficam deslocados para baixo. Perto dessas regiões, a leitura bruta erra por
+ * alguns códigos e desloca os limiares comparados com ela (LDR_THRESHOLD,
+ * o limiar do alarme de gás).
+ *
+ * A correção é uma tabela de 4096 deslocamentos (int8_t, 4 kB de RAM):
+ * cada código bruto vira o centro da faixa de entrada que o produz, na
+ * escala de um ADC ideal. A tabela sai da largura de cada código, que
+ * vem de um de dois lugares:
+ *
+ * - o modelo nominal (padrão): todos os códigos com 1 LSB, menos os
+ *   quatro acima, com 1 + ADC_DNL_SPIKE_LSB;
+ * - um histograma medido com uma rampa lenta na entrada (o teste de
+ *   histograma usual: com a rampa uniforme, as ocorrências de cada
+ *   código são proporcionais à sua largura). O firmware à parte
+ *   adc_dnl_calibrate.c mede o histograma na placa e imprime a tabela,
+ *   que o firmware usa em vez do modelo quando compilado com
+ *   ADC_DNL_TABLE_FILE (opção ADC_DNL_TABLE do CMake).
+ *
+ * Os códigos 0 e 4095 também recebem as entradas fora da faixa e ficam
+ * de fora do histograma; as larguras dos demais são normalizadas para
+ * os 4094 LSB entre eles.
+ *
+ * A captura (adc_capture.h) corrige cada bloco de DMA inteiro com
+ * adc_dnl_correct_block(), antes da mediana e do alarme de gás: uma
+ * leitura e uma soma por amostra. O custo por bloco é medido por
+ * host/adc_dnl_bench.cpp, que também compara o erro antes e depois da
+ * correção em curvas de transferência simuladas: na curva nominal, o
+ * erro RMS cai de 2,3 para 0,5 LSB; numa placa com códigos largos de
+ * outras larguras, a tabela nominal ajuda pouco e só a calibrada leva o
+ * RMS a 0,5 LSB. O erro máximo fica em metade da largura do maior
+ * código largo, cujas entradas são indistinguíveis, e num ADC sem esses
+ * códigos a tabela nominal piora a leitura.
+ */
+#ifndef ADC_DNL_H
+#define ADC_DNL_H
+
+#include <stdint.h>
+
+/**
+ * @brief Códigos de retorno da construção da tabela
+ */
+#define ADC_DNL_OK 0                        // Tabela construída
+#define ADC_DNL_ERROR_FEW_SAMPLES -1        // Histograma com menos de ADC_DNL_MIN_PER_CODE por código
+#define ADC_DNL_ERROR_RANGE -2              // Algum código corrigido a mais de 127 LSB do bruto
+
+#define ADC_DNL_CODES 4096                  // Códigos de 12 bits
+#define ADC_DNL_SPIKE_FIRST 512             // Primeiro código largo
+#define ADC_DNL_SPIKE_PERIOD 1024           // Distância entre os códigos largos
+#define ADC_DNL_MIN_PER_CODE 16             // Média mínima de amostras por código no histograma
+
+#ifndef ADC_DNL_SPIKE_LSB
+#define ADC_DNL_SPIKE_LSB 8                 // Largura extra de cada código largo no modelo nominal (0: ADC ideal)
+#endif
+
+/**
+ * @brief Indica se o código é um dos quatro códigos largos do modelo nominal
+ */
+static inline int adc_dnl_is_spike(uint32_t code) {
+    return code % ADC_DNL_SPIKE_PERIOD == ADC_DNL_SPIKE_FIRST;
+}
+
+/**
+ * @brief Carrega a tabela padrão: a calibrada (ADC_DNL_TABLE_FILE) ou a do modelo nominal
+ */
+void adc_dnl_init(void);
+
+/**
+ * @brief Constrói a tabela a partir de um histograma de rampa
+ *
+ * @param histogram Ocorrências de cada um dos ADC_DNL_CODES códigos
+ * @return ADC_DNL_OK ou um código de erro; com erro, a tabela não muda
+ */
+int adc_dnl_build(const uint32_t *histogram);
+
+/**
+ * @brief Deslocamento do código bruto na tabela em uso (corrigido = bruto + deslocamento)
+ */
+int8_t adc_dnl_offset(uint16_t code);
+
+/**
+ * @brief Corrige um código bruto
+ */
+uint16_t adc_dnl_correct(uint16_t code);
+
+/**
+ * @brief Corrige no lugar um bloco de amostras brutas de 12 bits
+ */
+void adc_dnl_correct_block(uint16_t *samples, uint32_t count);
+
+#endif // ADC_DNL_H
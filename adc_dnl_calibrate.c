@@ -0,0 +1,157 @@
+/**
+ * @file adc_dnl_calibrate.c
+ * @brief Calibração da tabela de DNL do ADC no RP2040 por histograma de rampa
+ *
+ * Firmware à parte (alvo adc_dnl_calibrate): com uma rampa lenta e
+ * linear cobrindo toda a faixa de 0 a 3,3 V na entrada
+ * ADC_DNL_CALIBRATE_PIN (p.ex. a onda triangular de um gerador, com
+ * alguns períodos inteiros nos ~8 s da captura), o ADC converte a 500
+ * mil amostras por segundo e cada
+ * código é contado num histograma. Com a rampa uniforme, as ocorrências
+ * de cada código são proporcionais à sua largura; adc_dnl_build() faz
+ * disso a tabela de correção.
+ *
+ * A cada passada, a serial recebe a largura medida dos quatro códigos
+ * largos, a maior e a menor largura dos demais, os ciclos de
+ * adc_dnl_correct_block() por bloco de captura e a tabela, como um
+ * arquivo C. Gravada em um arquivo, ela entra no firmware pela opção
+ * ADC_DNL_TABLE do CMake:
+ * @code
+ * cmake -DADC_DNL_TABLE=/caminho/adc_dnl_table.h ...
+ * @endcode
+ *
+ * Uma rampa que não chega aos extremos deixa vazios os primeiros ou os
+ * últimos códigos e é recusada; ruído na entrada alarga os códigos
+ * largos de forma simétrica e não desloca seus centros.
+ */
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#include "adc_capture.h"
+#include "adc_dnl.h"
+
+#ifndef ADC_DNL_CALIBRATE_PIN
+#define ADC_DNL_CALIBRATE_PIN 28            // ADC2, livre na placa
+#endif
+#ifndef ADC_DNL_CALIBRATE_SAMPLES
+#define ADC_DNL_CALIBRATE_SAMPLES (4096u * 1024u)   // ~8 s a 500 mil amostras por segundo
+#endif
+
+#define SYSTICK_MAX 0x00FFFFFFu             // Contador decrescente de 24 bits
+#define BENCH_BLOCKS 256
+
+static_assert(ADC_DNL_CALIBRATE_SAMPLES / (ADC_DNL_CODES - 2) >= 4 * ADC_DNL_MIN_PER_CODE,
+              "poucas amostras para a média mínima por código com uma rampa imperfeita");
+
+static uint32_t histogram[ADC_DNL_CODES];
+static uint16_t block[ADC_CAPTURE_BLOCK_SAMPLES];
+
+/**
+ * @brief Conta ADC_DNL_CALIBRATE_SAMPLES conversões da entrada de calibração
+ *
+ * @return Se o FIFO do ADC transbordou (amostras perdidas)
+ */
+static bool capture_histogram(void) {
+    for (int k = 0; k < ADC_DNL_CODES; k++) histogram[k] = 0;
+
+    adc_fifo_drain();
+    adc_hw->fcs |= ADC_FCS_OVER_BITS;
+    adc_run(true);
+    for (uint32_t i = 0; i < ADC_DNL_CALIBRATE_SAMPLES; i++) {
+        histogram[adc_fifo_get_blocking() & (ADC_DNL_CODES - 1)]++;
+    }
+    adc_run(false);
+    bool overflow = adc_hw->fcs & ADC_FCS_OVER_BITS;
+    adc_fifo_drain();
+    return overflow;
+}
+
+/**
+ * @brief Ciclos de adc_dnl_correct_block() por bloco de captura
+ */
+static uint32_t measure_block_cycles(void) {
+    for (int i = 0; i < ADC_CAPTURE_BLOCK_SAMPLES; i++) block[i] = (uint16_t)(i * 127 & (ADC_DNL_CODES - 1));
+    uint32_t c0 = systick_hw->cvr;
+    for (int b = 0; b < BENCH_BLOCKS; b++) adc_dnl_correct_block(block, ADC_CAPTURE_BLOCK_SAMPLES);
+    uint32_t c1 = systick_hw->cvr;
+    return ((c0 - c1) & SYSTICK_MAX) / BENCH_BLOCKS;
+}
+
+// Largura do código em milésimos de LSB, com os códigos 1 a 4094 somando 4094 LSB
+static uint32_t width_mlsb(uint32_t code, uint64_t total) {
+    return (uint32_t)((uint64_t)histogram[code] * (ADC_DNL_CODES - 2) * 1000 / total);
+}
+
+static void print_summary(bool overflow) {
+    uint64_t total = 0;
+    uint32_t empty = 0;
+    for (uint32_t k = 1; k < ADC_DNL_CODES - 1; k++) {
+        total += histogram[k];
+        empty += histogram[k] == 0;
+    }
+    printf("calibração da DNL: %lu amostras na entrada ADC%d, %lu nos extremos, %lu códigos vazios%s\n",
+           (unsigned long)ADC_DNL_CALIBRATE_SAMPLES, ADC_DNL_CALIBRATE_PIN - 26,
+           (unsigned long)(histogram[0] + histogram[ADC_DNL_CODES - 1]), (unsigned long)empty,
+           overflow ? ", FIFO transbordou" : "");
+    if (!total) return;
+
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (uint32_t k = 1; k < ADC_DNL_CODES - 1; k++) {
+        uint32_t w = width_mlsb(k, total);
+        if (adc_dnl_is_spike(k)) {
+            printf("  código %4lu: %lu.%03lu LSB\n", (unsigned long)k, (unsigned long)(w / 1000),
+                   (unsigned long)(w % 1000));
+            continue;
+        }
+        if (w < lo) lo = w;
+        if (w > hi) hi = w;
+    }
+    printf("  demais códigos: de %lu.%03lu a %lu.%03lu LSB\n", (unsigned long)(lo / 1000), (unsigned long)(lo % 1000),
+           (unsigned long)(hi / 1000), (unsigned long)(hi % 1000));
+}
+
+static void print_table(void) {
+    printf("// Gerado por adc_dnl_calibrate: deslocamento de cada código bruto do ADC\n");
+    printf("static const int8_t adc_dnl_calibrated[%d] = {\n", ADC_DNL_CODES);
+    for (int k = 0; k < ADC_DNL_CODES; k++) {
+        printf("%s%d,%s", k % 16 ? " " : "    ", adc_dnl_offset((uint16_t)k), k % 16 == 15 ? "\n" : "");
+    }
+    printf("};\n");
+}
+
+int main() {
+    stdio_init_all();
+
+    adc_init();
+    adc_gpio_init(ADC_DNL_CALIBRATE_PIN);
+    adc_select_input(ADC_DNL_CALIBRATE_PIN - 26);
+    adc_fifo_setup(true, false, 1, false, false);
+    adc_set_clkdiv(0);                      // Conversões seguidas: 96 ciclos de 48 MHz
+
+    systick_hw->rvr = SYSTICK_MAX;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    while (true) {
+        bool overflow = capture_histogram();
+        print_summary(overflow);
+
+        // Os códigos 0 e 4095 recebem o que passa dos extremos: os vizinhos dizem se a rampa os alcançou
+        bool covered = histogram[1] && histogram[ADC_DNL_CODES - 2];
+        int status = covered ? adc_dnl_build(histogram) : ADC_DNL_ERROR_FEW_SAMPLES;
+        uint32_t mhz = clock_get_hz(clk_sys) / 1000000u;
+        uint32_t cycles = measure_block_cycles();
+        printf("correção de um bloco de %d amostras: %lu ciclos (%lu ns a %lu MHz)\n", ADC_CAPTURE_BLOCK_SAMPLES,
+               (unsigned long)cycles, (unsigned long)(cycles * 1000u / mhz), (unsigned long)mhz);
+        if (status == ADC_DNL_OK) {
+            print_table();
+        } else {
+            printf("histograma recusado (%d): a rampa deve cobrir toda a faixa\n", status);
+        }
+        sleep_ms(5000);
+    }
+}
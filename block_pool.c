@@ -0,0 +1,141 @@
+/**
+ * @file block_pool.c
+ * @brief Implementação dos pools de blocos de tamanho fixo
+ */
+#include "block_pool.h"
+
+#if PICO_ON_DEVICE
+#include "pico.h"
+#include "hardware/sync.h"
+#define BLOCK_POOL_FUNC(f) __not_in_flash_func(f)
+#else
+#define BLOCK_POOL_FUNC(f) f
+#endif
+
+#define BLOCK_POOL_NONE 0xFFFFu
+#define BLOCK_POOL_IN_USE_ONE 0x10000u
+
+#define TOP_INDEX(top) ((uint32_t)(top) & 0xFFFFu)
+#define TOP_IN_USE(top) (((uint32_t)(top) >> 16) & 0xFFFFu)
+
+bool block_pool_init(block_pool_t *pool, const char *name, void *storage,
+                     _Atomic uint16_t *next, size_t block_size, size_t count) {
+    if (count == 0 || count > BLOCK_POOL_MAX_BLOCKS) return false;
+
+    pool->name = name;
+    pool->storage = storage;
+    pool->next = next;
+    pool->block_size = (uint32_t)block_size;
+    pool->count = (uint16_t)count;
+    for (size_t i = 0; i < count; i++) {
+        atomic_init(&next[i], (uint16_t)(i + 1 < count ? i + 1 : BLOCK_POOL_NONE));
+    }
+    atomic_init(&pool->top, 0);
+    atomic_init(&pool->high_water, 0);
+    atomic_init(&pool->exhausted, 0);
+#if PICO_ON_DEVICE
+    if (!pool->lock) pool->lock = spin_lock_instance((uint)spin_lock_claim_unused(true));
+#endif
+    return true;
+}
+
+#if PICO_ON_DEVICE
+
+/*
+ * Sem ldrex/strex no Cortex-M0+, o compare-and-swap do C11 viraria uma
+ * chamada de biblioteca; o spinlock deixa a troca explícita e curta.
+ * Dentro dele, os acessos atômicos relaxados são ldr/str comuns, e o topo
+ * dispensa a etiqueta.
+ */
+void *BLOCK_POOL_FUNC(block_pool_alloc)(block_pool_t *pool) {
+    uint32_t irq = spin_lock_blocking((spin_lock_t *)pool->lock);
+    uint32_t top = atomic_load_explicit(&pool->top, memory_order_relaxed);
+    uint32_t index = TOP_INDEX(top);
+    if (index == BLOCK_POOL_NONE) {
+        atomic_store_explicit(&pool->exhausted, atomic_load_explicit(&pool->exhausted, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        spin_unlock((spin_lock_t *)pool->lock, irq);
+        return NULL;
+    }
+    uint32_t below = atomic_load_explicit(&pool->next[index], memory_order_relaxed);
+    uint32_t used = TOP_IN_USE(top) + 1;
+    atomic_store_explicit(&pool->top, used << 16 | below, memory_order_relaxed);
+    if (used > atomic_load_explicit(&pool->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&pool->high_water, used, memory_order_relaxed);
+    }
+    spin_unlock((spin_lock_t *)pool->lock, irq);
+    return pool->storage + index * pool->block_size;
+}
+
+void BLOCK_POOL_FUNC(block_pool_free)(block_pool_t *pool, void *block) {
+    uint32_t index = (uint32_t)((uint8_t *)block - pool->storage) / pool->block_size;
+    uint32_t irq = spin_lock_blocking((spin_lock_t *)pool->lock);
+    uint32_t top = atomic_load_explicit(&pool->top, memory_order_relaxed);
+    atomic_store_explicit(&pool->next[index], (uint16_t)TOP_INDEX(top), memory_order_relaxed);
+    atomic_store_explicit(&pool->top, (TOP_IN_USE(top) - 1) << 16 | index, memory_order_relaxed);
+    spin_unlock((spin_lock_t *)pool->lock, irq);
+}
+
+#else
+
+/*
+ * Pilha de Treiber. O next[] do bloco do topo pode ser lido depois que
+ * outro contexto já o retirou; nesse caso a etiqueta do topo mudou e a
+ * troca falha. A etiqueta de 32 bits só engana uma troca adiada por
+ * exatamente um múltiplo de 2^32 outras trocas no mesmo pool.
+ */
+#define BLOCK_POOL_TAG_ONE (UINT64_C(1) << 32)
+
+static inline uint64_t next_top(uint64_t top, uint32_t in_use, uint32_t index) {
+    return ((top + BLOCK_POOL_TAG_ONE) & ~UINT64_C(0xFFFFFFFF)) | (uint64_t)(in_use << 16 | index);
+}
+
+void *block_pool_alloc(block_pool_t *pool) {
+    uint64_t top = atomic_load_explicit(&pool->top, memory_order_acquire);
+    uint32_t index, used;
+    do {
+        index = TOP_INDEX(top);
+        if (index == BLOCK_POOL_NONE) {
+            atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+            return NULL;
+        }
+        used = TOP_IN_USE(top) + 1;
+        uint32_t below = atomic_load_explicit(&pool->next[index], memory_order_relaxed);
+        // Sucesso com acquire: o que foi escrito no bloco antes do block_pool_free() fica visível
+        if (atomic_compare_exchange_weak_explicit(&pool->top, &top, next_top(top, used, below),
+                                                  memory_order_acquire, memory_order_acquire)) {
+            break;
+        }
+    } while (true);
+
+    uint32_t high = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    while (used > high && !atomic_compare_exchange_weak_explicit(&pool->high_water, &high, used,
+                                                                 memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return pool->storage + index * pool->block_size;
+}
+
+void block_pool_free(block_pool_t *pool, void *block) {
+    uint32_t index = (uint32_t)((uint8_t *)block - pool->storage) / pool->block_size;
+    uint64_t top = atomic_load_explicit(&pool->top, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&pool->next[index], (uint16_t)TOP_INDEX(top), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->top, &top, next_top(top, TOP_IN_USE(top) - 1, index),
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+#endif
+
+bool block_pool_owns(const block_pool_t *pool, const void *p) {
+    const uint8_t *b = p;
+    if (b < pool->storage || b >= pool->storage + (size_t)pool->count * pool->block_size) return false;
+    return (size_t)(b - pool->storage) % pool->block_size == 0;
+}
+
+void block_pool_stats(const block_pool_t *pool, block_pool_stats_t *stats) {
+    stats->block_size = pool->block_size;
+    stats->count = pool->count;
+    stats->in_use = TOP_IN_USE(atomic_load_explicit(&pool->top, memory_order_relaxed));
+    stats->high_water = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    stats->exhausted = atomic_load_explicit(&pool->exhausted, memory_order_relaxed);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file block_pool.h
+ * @brief Pools estáticos de blocos de tamanho fixo, com alocação O(1)
+ *
+ * Alternativa ao malloc para mensagens e lotes de amostras: cada pool é
+ * um vetor estático de blocos do mesmo tamanho e uma pilha de blocos
+ * livres. Alocar e liberar custam sempre o mesmo (tirar ou pôr o bloco
+ * do topo da pilha), não fragmentam e não dependem do heap da newlib,
+ * cuja latência varia com o histórico de alocações.
+ *
+ * A pilha guarda índices, e o topo é uma só palavra com o índice do
+ * bloco do topo e o número de blocos em uso (16 bits cada). No host, o
+ * topo é trocado por compare-and-swap (C11), sem travas, uma vez por
+ * alocação ou liberação; a palavra tem 64 bits e os 32 de cima são uma
+ * etiqueta que muda a cada troca, para que uma troca baseada num topo
+ * antigo falhe mesmo que o mesmo bloco tenha voltado ao topo (problema
+ * ABA). O Cortex-M0+ não tem instruções de acesso exclusivo, então no
+ * dispositivo a troca é feita sob um spinlock de hardware, que também
+ * desabilita as interrupções: a seção crítica tem poucas instruções e
+ * tamanho fixo. Nos dois casos, alocar e liberar podem ser chamados dos
+ * dois cores e de interrupções, e ficam em RAM no dispositivo, como
+ * sensor_registry.h.
+ *
+ * Cada pool conta os blocos em uso, o maior número já em uso ao mesmo
+ * tempo (high-water) e as alocações que falharam por falta de bloco.
+ */
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#ifndef __cplusplus
+#include <stdatomic.h>
+#endif
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLOCK_POOL_MAX_BLOCKS 0xFFFE        // O índice 0xFFFF marca a pilha vazia
+
+// Só block_pool.c acessa os campos; em C++ (ferramentas do host) eles têm o mesmo leiaute sem _Atomic
+#ifdef __cplusplus
+#define BLOCK_POOL_ATOMIC(type) type
+#else
+#define BLOCK_POOL_ATOMIC(type) _Atomic type
+#endif
+
+/**
+ * @brief Um pool; os campos são internos, use block_pool_stats()
+ */
+typedef struct {
+    const char *name;
+    uint8_t *storage;
+    BLOCK_POOL_ATOMIC(uint16_t) *next;  // Próximo bloco livre abaixo de cada bloco na pilha
+    uint32_t block_size;
+    uint16_t count;
+#if PICO_ON_DEVICE
+    BLOCK_POOL_ATOMIC(uint32_t) top;    // Em uso << 16 | índice do bloco do topo
+#else
+    BLOCK_POOL_ATOMIC(uint64_t) top;    // Etiqueta << 32 | em uso << 16 | índice do bloco do topo
+#endif
+    BLOCK_POOL_ATOMIC(uint32_t) high_water;
+    BLOCK_POOL_ATOMIC(uint32_t) exhausted;
+#if PICO_ON_DEVICE
+    volatile uint32_t *lock;            // spin_lock_t do SDK
+#endif
+} block_pool_t;
+
+/**
+ * @brief Retrato dos contadores de um pool
+ */
+typedef struct {
+    uint32_t block_size;
+    uint32_t count;
+    uint32_t in_use;
+    uint32_t high_water;            // Maior in_use desde block_pool_init()
+    uint32_t exhausted;             // Alocações que devolveram NULL
+} block_pool_stats_t;
+
+/**
+ * @brief Define o armazenamento estático de um pool de count blocos do tipo type
+ *
+ * Declara name##_blocks e name##_next; o pool em si (block_pool_t name)
+ * deve ser preparado com BLOCK_POOL_SETUP(name) antes do primeiro uso.
+ */
+#define BLOCK_POOL_STORAGE(name, type, count)                                                                         \
+    static type name##_blocks[count];                                                                                 \
+    static BLOCK_POOL_ATOMIC(uint16_t) name##_next[count]
+
+#define BLOCK_POOL_SETUP(name)                                                                                        \
+    block_pool_init(&(name), #name, name##_blocks, name##_next, sizeof(name##_blocks[0]),                             \
+                    sizeof(name##_blocks) / sizeof(name##_blocks[0]))
+
+/**
+ * @brief Prepara o pool com todos os blocos livres e zera os contadores
+ *
+ * Não pode ser chamada com o pool em uso. No dispositivo, reserva um
+ * spinlock de hardware livre (na primeira chamada para o pool).
+ *
+ * @param storage count blocos de block_size bytes, alinhados para o tipo guardado
+ * @param next count entradas para a pilha de livres
+ *
+ * @return false se count é 0 ou maior que BLOCK_POOL_MAX_BLOCKS
+ */
+bool block_pool_init(block_pool_t *pool, const char *name, void *storage,
+                     BLOCK_POOL_ATOMIC(uint16_t) *next, size_t block_size, size_t count);
+
+/**
+ * @brief Retira um bloco livre
+ *
+ * O conteúdo do bloco é o que ficou da última vez que foi usado.
+ *
+ * @return O bloco, ou NULL se o pool está esgotado (contado em exhausted)
+ */
+void *block_pool_alloc(block_pool_t *pool);
+
+/**
+ * @brief Devolve um bloco retirado deste pool
+ */
+void block_pool_free(block_pool_t *pool, void *block);
+
+/**
+ * @brief Indica se p aponta para o início de um bloco deste pool
+ */
+bool block_pool_owns(const block_pool_t *pool, const void *p);
+
+void block_pool_stats(const block_pool_t *pool, block_pool_stats_t *stats);
+
+#endif // BLOCK_POOL_H
@@ -0,0 +1,121 @@
+/**
+ * @file block_pool_bench.c
+ * @brief Benchmark no RP2040 dos pools de blocos fixos contra o malloc da newlib
+ *
+ * Firmware à parte (alvo block_pool_bench): roda a mesma carga de
+ * mensagens de host/block_pool_bench.cpp (buffers vivos, um sorteado
+ * liberado e outro alocado a cada passo, tamanhos de 16 a 256 bytes e
+ * 1/8 dos buffers retidos por mais tempo) com block_pool.h e com
+ * malloc/free, e conta com o SysTick os ciclos de cada par
+ * liberar/alocar, descontado o custo da própria medição. Mostra a média
+ * e o máximo, pois o máximo do malloc cresce com a fragmentação do heap
+ * e o do pool não. O resultado sai na serial a cada 5 s.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#include "block_pool.h"
+
+#define BENCH_LIVE 16
+#define BENCH_RETAINED 48
+#define BENCH_MAX_BYTES 256
+#define BENCH_PAIRS 20000
+#define SYSTICK_MAX 0x00FFFFFFu     // Contador decrescente de 24 bits
+
+typedef struct {
+    uint8_t bytes[BENCH_MAX_BYTES];
+} bench_block_t;
+
+BLOCK_POOL_STORAGE(bench_pool, bench_block_t, BENCH_LIVE + BENCH_RETAINED);
+static block_pool_t bench_pool;
+
+static void *live[BENCH_LIVE];
+static void *retained[BENCH_RETAINED];
+static uint32_t rng;
+
+static uint32_t next_random(void) {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static void *pool_alloc(size_t bytes) {
+    (void)bytes;
+    return block_pool_alloc(&bench_pool);
+}
+
+static void pool_free(void *p) {
+    block_pool_free(&bench_pool, p);
+}
+
+static void *null_alloc(size_t bytes) {
+    (void)bytes;
+    return live[0];
+}
+
+static void null_free(void *p) {
+    (void)p;
+}
+
+typedef struct {
+    uint32_t mean;
+    uint32_t max;
+} bench_result_t;
+
+/**
+ * @brief Ciclos por par liberar/alocar na carga de mensagens
+ */
+static bench_result_t measure(void *(*alloc)(size_t), void (*release)(void *), uint32_t overhead) {
+    BLOCK_POOL_SETUP(bench_pool);
+    rng = 12345;
+    for (int i = 0; i < BENCH_LIVE; i++) live[i] = alloc(16 + next_random() % (BENCH_MAX_BYTES - 15));
+    for (int i = 0; i < BENCH_RETAINED; i++) retained[i] = alloc(16 + next_random() % (BENCH_MAX_BYTES - 15));
+
+    uint64_t total = 0;
+    uint32_t max = 0;
+    for (int i = 0; i < BENCH_PAIRS; i++) {
+        uint32_t r = next_random();
+        size_t bytes = 16 + r % (BENCH_MAX_BYTES - 15);
+        void **slot = (r >> 12) % 8 == 0 ? &retained[(r >> 4) % BENCH_RETAINED] : &live[(r >> 4) % BENCH_LIVE];
+        uint32_t c0 = systick_hw->cvr;
+        release(*slot);
+        *slot = alloc(bytes);
+        uint32_t c1 = systick_hw->cvr;
+        uint32_t cycles = (c0 - c1) & SYSTICK_MAX;
+        cycles = cycles > overhead ? cycles - overhead : 0;
+        total += cycles;
+        if (cycles > max) max = cycles;
+        memset(*slot, i, 16);
+    }
+    if (release != null_free) {
+        for (int i = 0; i < BENCH_LIVE; i++) release(live[i]);
+        for (int i = 0; i < BENCH_RETAINED; i++) release(retained[i]);
+    }
+    return (bench_result_t){(uint32_t)(total / BENCH_PAIRS), max};
+}
+
+int main() {
+    stdio_init_all();
+
+    systick_hw->rvr = SYSTICK_MAX;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    static bench_block_t scratch;
+    while (true) {
+        uint32_t mhz = clock_get_hz(clk_sys) / 1000000u;
+        live[0] = &scratch;     // Devolvido por null_alloc()
+        uint32_t overhead = measure(null_alloc, null_free, 0).mean;
+
+        bench_result_t pool = measure(pool_alloc, pool_free, overhead);
+        bench_result_t heap = measure(malloc, free, overhead);
+        printf("block_pool: %lu ciclos/par, máximo %lu | malloc: %lu ciclos/par, máximo %lu (%lu MHz)\n",
+               (unsigned long)pool.mean, (unsigned long)pool.max, (unsigned long)heap.mean, (unsigned long)heap.max,
+               (unsigned long)mhz);
+        sleep_ms(5000);
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * @file board.h
+ * @brief Pinos e periféricos da placa, gerados de diagram.json e conferidos na compilação
+ *
+ * Os GPIOs de cada periférico vêm de board_config.h, que o CMake gera a
+ * partir das ligações de diagram.json (board_config.cmake): o diagrama
+ * do Wokwi é a única fonte da fiação. Aqui ficam o que deriva dos pinos
+ * (canal do ADC, fatia e canal do PWM), calculado pelo pré-processador,
+ * e as conferências que a fiação precisa passar para compilar:
+ * - todo pino usado existe na Pico W (GPIO 0 a 22 e 26 a 28; os demais
+ *   são internos, do chip sem fio e da medição de VSYS);
+ * - nenhum GPIO é usado por dois periféricos, inclusive a UART da serial;
+ * - LDR e MQ2 estão em entradas do ADC, o LDR no canal mais baixo (a
+ *   ordem do round-robin de adc_capture.h);
+ * - a serial do diagrama está nos pinos da UART que o SDK usa no stdio.
+ *
+ * O servo é a única saída em PWM. O período é por fatia, então uma
+ * segunda saída em PWM precisaria de uma fatia diferente da do servo,
+ * que é reprogramada para 20 ms; o GPIO 2 (DHT22) divide a fatia com o
+ * servo, mas como GPIO comum.
+ */
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <assert.h>
+
+#include "board_config.h"
+
+#define BOARD_ADC_FIRST_PIN 26              // ADC0
+
+#define BOARD_PIN_EXISTS(pin) (((pin) >= 0 && (pin) <= 22) || ((pin) >= 26 && (pin) <= 28))
+#define BOARD_PIN_IS_ADC(pin) ((pin) >= BOARD_ADC_FIRST_PIN && (pin) <= 28)
+#define BOARD_ADC_CHANNEL(pin) ((pin) - BOARD_ADC_FIRST_PIN)
+#define BOARD_PWM_SLICE(pin) (((pin) >> 1) & 7)
+#define BOARD_PWM_CHANNEL(pin) ((pin) & 1)  // 0: A, 1: B
+
+#define BOARD_LDR_ADC_CHANNEL BOARD_ADC_CHANNEL(BOARD_LDR_PIN)
+#define BOARD_MQ2_ADC_CHANNEL BOARD_ADC_CHANNEL(BOARD_MQ2_PIN)
+
+// Entradas internas do ADC, fora de diagram.json
+#define BOARD_VSYS_PIN 29                   // VSYS / 3 (ADC3)
+#define BOARD_VSYS_ADC_CHANNEL 3
+#define BOARD_VSYS_ENABLE_PIN 25            // Pico W: CS do rádio, em nível alto liga VSYS / 3 ao GPIO 29
+#define BOARD_TEMP_ADC_CHANNEL 4            // Sensor de temperatura do RP2040
+#define BOARD_SERVO_PWM_SLICE BOARD_PWM_SLICE(BOARD_SERVO_PIN)
+#define BOARD_SERVO_PWM_CHANNEL BOARD_PWM_CHANNEL(BOARD_SERVO_PIN)
+
+#define BOARD_BIT(pin) (1ull << (pin))
+
+// A soma só é igual ao OU se nenhum bit se repete
+#define BOARD_USED_PINS_SUM                                                                                           \
+    (BOARD_BIT(BOARD_UART_TX_PIN) + BOARD_BIT(BOARD_UART_RX_PIN) + BOARD_BIT(BOARD_DHT22_PIN) +                       \
+     BOARD_BIT(BOARD_SERVO_PIN) + BOARD_BIT(BOARD_LDR_PIN) + BOARD_BIT(BOARD_MQ2_PIN) + BOARD_BIT(BOARD_RELE_PIN) +   \
+     BOARD_BIT(BOARD_RED_LED_PIN) + BOARD_BIT(BOARD_MQ2_HEATER_PIN))
+#define BOARD_USED_PINS                                                                                               \
+    (BOARD_BIT(BOARD_UART_TX_PIN) | BOARD_BIT(BOARD_UART_RX_PIN) | BOARD_BIT(BOARD_DHT22_PIN) |                       \
+     BOARD_BIT(BOARD_SERVO_PIN) | BOARD_BIT(BOARD_LDR_PIN) | BOARD_BIT(BOARD_MQ2_PIN) | BOARD_BIT(BOARD_RELE_PIN) |   \
+     BOARD_BIT(BOARD_RED_LED_PIN) | BOARD_BIT(BOARD_MQ2_HEATER_PIN))
+
+static_assert(BOARD_PIN_EXISTS(BOARD_UART_TX_PIN) && BOARD_PIN_EXISTS(BOARD_UART_RX_PIN) &&
+                      BOARD_PIN_EXISTS(BOARD_DHT22_PIN) && BOARD_PIN_EXISTS(BOARD_SERVO_PIN) &&
+                      BOARD_PIN_EXISTS(BOARD_LDR_PIN) && BOARD_PIN_EXISTS(BOARD_MQ2_PIN) &&
+                      BOARD_PIN_EXISTS(BOARD_RELE_PIN) && BOARD_PIN_EXISTS(BOARD_RED_LED_PIN) &&
+                      BOARD_PIN_EXISTS(BOARD_MQ2_HEATER_PIN),
+              "diagram.json liga um periférico a um GPIO que a Pico W não expõe");
+static_assert(BOARD_USED_PINS_SUM == BOARD_USED_PINS, "diagram.json liga dois periféricos ao mesmo GPIO");
+static_assert(BOARD_PIN_IS_ADC(BOARD_LDR_PIN) && BOARD_PIN_IS_ADC(BOARD_MQ2_PIN),
+              "LDR e MQ2 precisam estar em entradas do ADC (GPIO 26 a 28)");
+static_assert(BOARD_LDR_ADC_CHANNEL < BOARD_MQ2_ADC_CHANNEL,
+              "o round-robin do ADC (adc_capture.h) espera o LDR num canal abaixo do MQ2");
+#if defined(PICO_DEFAULT_UART_TX_PIN) && defined(PICO_DEFAULT_UART_RX_PIN)
+static_assert(BOARD_UART_TX_PIN == PICO_DEFAULT_UART_TX_PIN && BOARD_UART_RX_PIN == PICO_DEFAULT_UART_RX_PIN,
+              "a serial de diagram.json não está nos pinos da UART do stdio");
+#endif
+
+#endif // BOARD_H
@@ -0,0 +1,106 @@
+# Generates board_config.h (the GPIO of each peripheral) from the Wokwi diagram.json.
+#
+#   include(board_config.cmake)
+#   board_config_generate(${CMAKE_CURRENT_LIST_DIR}/diagram.json ${CMAKE_CURRENT_BINARY_DIR}/generated)
+#   target_include_directories(<target> PRIVATE ${CMAKE_CURRENT_BINARY_DIR}/generated)
+#
+# Every connection between a "pico:GPn" pin and a known part pin becomes a
+# BOARD_<ROLE>_PIN define. Validity and conflict checks on those pins live in
+# board.h, as static assertions, so that they also cover hand-edited values.
+# Editing diagram.json re-runs the configure step; the header is only rewritten
+# when its contents change.
+
+if(CMAKE_VERSION VERSION_LESS 3.19)
+    message(FATAL_ERROR "board_config.cmake needs CMake 3.19 or newer (string(JSON))")
+endif()
+
+# Role of "<part type>:<pin>"; LEDs are named after their color, and a relay
+# module whose id starts with "heater" switches the MQ2 heater
+function(_board_config_role part_id part_type part_pin color out_var)
+    set(role "")
+    if(part_type STREQUAL "wokwi-dht22" AND part_pin STREQUAL "SDA")
+        set(role DHT22)
+    elseif(part_type STREQUAL "wokwi-servo" AND part_pin STREQUAL "PWM")
+        set(role SERVO)
+    elseif(part_type STREQUAL "wokwi-photoresistor-sensor" AND part_pin STREQUAL "AO")
+        set(role LDR)
+    elseif(part_type STREQUAL "wokwi-gas-sensor" AND part_pin STREQUAL "AOUT")
+        set(role MQ2)
+    elseif(part_type STREQUAL "wokwi-relay-module" AND part_pin STREQUAL "IN" AND part_id MATCHES "^heater")
+        set(role MQ2_HEATER)
+    elseif(part_type STREQUAL "wokwi-relay-module" AND part_pin STREQUAL "IN")
+        set(role RELE)
+    elseif(part_type STREQUAL "wokwi-led" AND part_pin STREQUAL "A")
+        string(TOUPPER "${color}" upper)
+        set(role ${upper}_LED)
+    elseif(part_type STREQUAL "serial-monitor" AND part_pin STREQUAL "RX")
+        set(role UART_TX)
+    elseif(part_type STREQUAL "serial-monitor" AND part_pin STREQUAL "TX")
+        set(role UART_RX)
+    endif()
+    set(${out_var} ${role} PARENT_SCOPE)
+endfunction()
+
+function(board_config_generate diagram output_dir)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${diagram})
+    file(READ ${diagram} json)
+
+    # Part id -> type and LED color
+    string(JSON part_count LENGTH "${json}" parts)
+    math(EXPR last "${part_count} - 1")
+    foreach(i RANGE ${last})
+        string(JSON id GET "${json}" parts ${i} id)
+        string(JSON type GET "${json}" parts ${i} type)
+        string(JSON color ERROR_VARIABLE no_color GET "${json}" parts ${i} attrs color)
+        set(part_type_${id} ${type})
+        set(part_color_${id} ${color})
+    endforeach()
+    set(part_type_$serialMonitor serial-monitor)
+
+    set(defines "")
+    set(roles "")
+    string(JSON connection_count LENGTH "${json}" connections)
+    math(EXPR last "${connection_count} - 1")
+    foreach(i RANGE ${last})
+        string(JSON a GET "${json}" connections ${i} 0)
+        string(JSON b GET "${json}" connections ${i} 1)
+        if(a MATCHES "^pico:GP([0-9]+)$")
+            set(other ${b})
+        elseif(b MATCHES "^pico:GP([0-9]+)$")
+            set(other ${a})
+        else()
+            continue()
+        endif()
+        set(gpio ${CMAKE_MATCH_1})
+        string(REPLACE ":" ";" other_parts ${other})
+        list(GET other_parts 0 part)
+        list(GET other_parts 1 part_pin)
+        if(NOT DEFINED part_type_${part})
+            message(FATAL_ERROR "${diagram}: GP${gpio} is wired to unknown part \"${part}\"")
+        endif()
+
+        _board_config_role(${part} ${part_type_${part}} ${part_pin} "${part_color_${part}}" role)
+        if(role STREQUAL "")
+            message(FATAL_ERROR "${diagram}: no role for GP${gpio} -> ${other} (${part_type_${part}}); "
+                    "add it to board_config.cmake")
+        endif()
+        if(role IN_LIST roles)
+            message(FATAL_ERROR "${diagram}: ${role} is wired to more than one GPIO")
+        endif()
+        list(APPEND roles ${role})
+        string(APPEND defines "#define BOARD_${role}_PIN ${gpio}\n")
+    endforeach()
+
+    foreach(required UART_TX UART_RX DHT22 SERVO LDR MQ2 MQ2_HEATER RELE RED_LED)
+        if(NOT required IN_LIST roles)
+            message(FATAL_ERROR "${diagram}: no GPIO wired to the ${required}")
+        endif()
+    endforeach()
+
+    string(CONCAT header
+            "/* Gerado por board_config.cmake a partir de diagram.json: não edite. */\n"
+            "#ifndef BOARD_CONFIG_H\n#define BOARD_CONFIG_H\n\n"
+            "#define BOARD_TYPE \"${part_type_pico}\"\n\n${defines}\n#endif /* BOARD_CONFIG_H */\n")
+    file(WRITE ${output_dir}/board_config.h.tmp "${header}")
+    configure_file(${output_dir}/board_config.h.tmp ${output_dir}/board_config.h COPYONLY)
+endfunction()
@@ -7,13 +7,14 @@
  */
 
  #include "dht22.h"
+ #include "dht22_frame.h"
+ #include "exec_trace.h"
  #include "pico/stdlib.h"
  #include "hardware/gpio.h"
  
  // Constantes de temporização para o protocolo do DHT22
  #define DHT22_START_SIGNAL_DELAY 18000  // Duração do sinal de início (18ms)
  #define DHT22_RESPONSE_WAIT_TIMEOUT 200 // Timeout para aguardar resposta (200μs)
- #define DHT22_BIT_THRESHOLD 50         // Limite para diferenciação entre bit 0 e 1 (50μs)
  #define DHT22_MIN_INTERVAL_MS 2000     // Intervalo mínimo entre leituras (2s)
  
  /**
@@ -21,12 +22,14 @@
   */
  typedef struct {
      uint32_t last_read_time_ms;  // Momento da última leitura realizada
+     uint32_t data_us;            // Fim da fase de dados da última leitura
      uint32_t pin;                // Pino GPIO utilizado para comunicação
      bool initialized;            // Flag de inicialização do driver
+     dht22_decoder_t decoder;     // Decodificador do quadro (NULL: dht22_frame_decode)
  } dht22_state_t;
  
  // Estado global do driver
- static dht22_state_t dht22_state = {0, 0, false};
+ static dht22_state_t dht22_state = {0, 0, 0, false, NULL};
  
  /**
   * @brief Aguarda até que o pino mude para o estado desejado ou ocorra timeout
@@ -112,7 +115,7 @@
  }
  
  /**
-  * @brief Lê os 40 bits de dados do sensor
+  * @brief Mede os 40 pulsos de dados do sensor
   * 
   * O sensor envia 40 bits (5 bytes) no total:
   * - 16 bits para umidade
@@ -123,12 +126,16 @@
   * - ~28μs para bit 0
   * - ~70μs para bit 1
   * 
+  * Aqui só as larguras são registradas (saturadas em DHT22_FRAME_WIDTH_MAX);
+  * a conversão em bits fica com o decodificador (dht22_frame.h), fora do
+  * laço com tempo crítico.
+  * 
   * @param pin Número do pino GPIO
-  * @param data Buffer para armazenar os dados lidos
+  * @param widths Buffer para as larguras dos pulsos em μs
   * @return DHT22_OK se sucesso, DHT22_ERROR_TIMEOUT se falha
   */
- static int dht22_read_data(uint32_t pin, uint8_t *data) {
-     for (int i = 0; i < 40; i++) {
+ static int dht22_read_data(uint32_t pin, uint8_t *widths) {
+     for (int i = 0; i < DHT22_FRAME_BITS; i++) {
          // Aguarda início do bit (transição para alto)
          if (wait_for_pin_state(pin, 1, DHT22_RESPONSE_WAIT_TIMEOUT) != 0) return DHT22_ERROR_TIMEOUT;
          
@@ -137,56 +144,7 @@
          if (wait_for_pin_state(pin, 0, DHT22_RESPONSE_WAIT_TIMEOUT) != 0) return DHT22_ERROR_TIMEOUT;
          uint32_t pulse_length = time_us_32() - pulse_start;
          
-         // Interpreta duração como bit 0 ou 1
-         if (pulse_length > DHT22_BIT_THRESHOLD) {
-             data[i / 8] |= (1 << (7 - (i % 8))); // Define como bit 1
-         }
-     }
-     
-     return DHT22_OK;
- }
- 
- /**
-  * @brief Verifica o checksum dos dados recebidos
-  * 
-  * O último byte recebido é um checksum que deve ser igual à soma
-  * dos 4 bytes anteriores.
-  * 
-  * @param data Buffer com os dados recebidos
-  * @return DHT22_OK se checksum válido, DHT22_ERROR_CHECKSUM se inválido
-  */
- static int dht22_verify_checksum(const uint8_t *data) {
-     uint8_t checksum = data[0] + data[1] + data[2] + data[3];
-     if (checksum != data[4]) {
-         return DHT22_ERROR_CHECKSUM;
-     }
-     return DHT22_OK;
- }
- 
- /**
-  * @brief Converte os dados brutos em valores de temperatura e umidade
-  * 
-  * Formato dos dados:
-  * - Bytes 0-1: Umidade * 10 (%)
-  * - Bytes 2-3: Temperatura * 10 (°C)
-  *   - Bit mais significativo do byte 2 indica sinal negativo
-  * 
-  * @param data Buffer com os dados brutos
-  * @param temperature Ponteiro para armazenar temperatura
-  * @param humidity Ponteiro para armazenar umidade
-  * @return DHT22_OK se sucesso, DHT22_ERROR_INVALID_DATA se valores inválidos
-  */
- static int dht22_convert_data(const uint8_t *data, float *temperature, float *humidity) {
-     *humidity = ((data[0] << 8) | data[1]) * 0.1;
-     
-     *temperature = ((data[2] & 0x7F) << 8 | data[3]) * 0.1;
-     if (data[2] & 0x80) {
-         *temperature *= -1;
-     }
-     
-     // Verifica se os valores estão dentro dos limites especificados
-     if (*humidity < 0.0 || *humidity > 100.0 || *temperature < -40.0 || *temperature > 80.0) {
-         return DHT22_ERROR_INVALID_DATA;
+         widths[i] = pulse_length > DHT22_FRAME_WIDTH_MAX ? DHT22_FRAME_WIDTH_MAX : (uint8_t)pulse_length;
      }
      
      return DHT22_OK;
@@ -200,9 +158,8 @@
   * 2. Respeita intervalo mínimo entre leituras
   * 3. Envia sinal de início
   * 4. Aguarda resposta
-  * 5. Lê dados
-  * 6. Verifica checksum
-  * 7. Converte valores
+  * 5. Mede os pulsos de dados
+  * 6. Decodifica o quadro (checksum, faixa e conversão)
   * 
   * @param temperature Ponteiro para armazenar temperatura
   * @param humidity Ponteiro para armazenar umidade
@@ -210,7 +167,7 @@
   */
  int dht22_read(float *temperature, float *humidity) {
      int result;
-     uint8_t data[5] = {0};
+     uint8_t widths[DHT22_FRAME_BITS];
      
      // Verifica inicialização do driver
      if (!dht22_state.initialized) {
@@ -224,22 +181,38 @@
          sleep_ms(DHT22_MIN_INTERVAL_MS - (current_time - dht22_state.last_read_time_ms));
      }
      
-     // Executa sequência de leitura
+     // Executa sequência de leitura, com cada fase na linha do tempo (exec_trace.h)
+     EXEC_TRACE_BEGIN(EXEC_TRACE_DHT22_START);
      result = dht22_send_start_signal(dht22_state.pin);
+     EXEC_TRACE_END(EXEC_TRACE_DHT22_START);
      if (result != DHT22_OK) return result;
      
+     EXEC_TRACE_BEGIN(EXEC_TRACE_DHT22_RESPONSE);
      result = dht22_wait_for_response(dht22_state.pin);
+     EXEC_TRACE_END(EXEC_TRACE_DHT22_RESPONSE);
      if (result != DHT22_OK) return result;
      
-     result = dht22_read_data(dht22_state.pin, data);
+     EXEC_TRACE_BEGIN(EXEC_TRACE_DHT22_DATA);
+     result = dht22_read_data(dht22_state.pin, widths);
+     EXEC_TRACE_END(EXEC_TRACE_DHT22_DATA);
      if (result != DHT22_OK) return result;
+     dht22_state.data_us = time_us_32();
      
      // Atualiza timestamp da última leitura
      dht22_state.last_read_time_ms = to_ms_since_boot(get_absolute_time());
      
      // Verifica e converte dados
-     result = dht22_verify_checksum(data);
-     if (result != DHT22_OK) return result;
-     
-     return dht22_convert_data(data, temperature, humidity);
+     dht22_decoder_t decode = dht22_state.decoder ? dht22_state.decoder : dht22_frame_decode;
+     EXEC_TRACE_BEGIN(EXEC_TRACE_DHT22_DECODE);
+     result = decode(widths, temperature, humidity);
+     EXEC_TRACE_END(EXEC_TRACE_DHT22_DECODE);
+     return result;
+ }
+ 
+ void dht22_set_decoder(dht22_decoder_t decoder) {
+     dht22_state.decoder = decoder;
+ }
+ 
+ uint32_t dht22_data_us(void) {
+     return dht22_state.data_us;
  }
\ No newline at end of file
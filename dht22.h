@@ -3,6 +3,8 @@
  
  #include <stdint.h>
  
+ #include "dht22_frame.h"
+ 
  /**
   * @brief Códigos de retorno das operações do driver
   * 
@@ -77,4 +79,20 @@
   */
  int dht22_read(float *temperature, float *humidity);
  
+ /**
+  * @brief Seleciona o decodificador do quadro usado por dht22_read()
+  * 
+  * @param decoder Um dos decodificadores de dht22_frame.h, ou NULL para o
+  *                padrão (dht22_frame_decode)
+  */
+ void dht22_set_decoder(dht22_decoder_t decoder);
+ 
+ /**
+  * @brief Instante (time_us_32) em que terminou a fase de dados da última leitura
+  * 
+  * É o momento em que a amostra chegou ao microcontrolador: o carimbo de
+  * aquisição para latency_trace.h. Só muda quando os 40 bits são recebidos.
+  */
+ uint32_t dht22_data_us(void);
+ 
  #endif // DHT22_H
\ No newline at end of file
@@ -0,0 +1,100 @@
+/**
+ * @file dht22_decode_bench.c
+ * @brief Benchmark no RP2040 dos decodificadores de quadro do DHT22
+ *
+ * Firmware à parte (alvo dht22_decode_bench): gera os mesmos tipos de
+ * quadro que host/dht22_decode_bench.cpp, confere que os dois
+ * decodificadores de dht22_frame.h concordam e conta os ciclos de cada
+ * decodificação com o SysTick no clock do processador, descontando o
+ * custo da própria medição. O resultado sai na serial a cada 5 s.
+ *
+ * Os decodificadores rodam da flash pelo cache XIP, como no firmware;
+ * a primeira passada aquece o cache e não entra na conta.
+ */
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/structs/systick.h"
+
+#include "dht22.h"
+#include "dht22_frame.h"
+
+#define BENCH_FRAMES 256
+#define BENCH_PASSES 16
+#define SYSTICK_MAX 0x00FFFFFFu     // Contador decrescente de 24 bits
+
+static uint8_t frames[BENCH_FRAMES][DHT22_FRAME_BITS];
+static uint32_t rng = 12345;
+
+static uint32_t next_random(void) {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// Quadros variados: 1/16 com checksum errado, 1/16 fora de faixa
+static void build_frames(void) {
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        uint16_t h10 = (uint16_t)(next_random() % 1001);
+        int t10 = (int)(next_random() % 1201) - 400;
+        if (f % 16 == 5) h10 = 1200;
+        uint16_t raw = (uint16_t)(t10 < 0 ? (0x8000 | -t10) : t10);
+        uint8_t data[5] = {h10 >> 8, h10 & 0xFF, raw >> 8, raw & 0xFF, 0};
+        data[4] = data[0] + data[1] + data[2] + data[3] + (f % 16 == 9);
+        for (int i = 0; i < DHT22_FRAME_BITS; i++) {
+            bool bit = data[i / 8] & (1 << (7 - i % 8));
+            frames[f][i] = (uint8_t)((bit ? 70 : 26) + (int)(next_random() % 13) - 6);
+        }
+    }
+}
+
+static int null_decoder(const uint8_t widths[DHT22_FRAME_BITS], float *temperature, float *humidity) {
+    (void)widths;
+    (void)temperature;
+    (void)humidity;
+    return 0;
+}
+
+/**
+ * @brief Ciclos médios por quadro de um decodificador
+ */
+static uint32_t measure(dht22_decoder_t decode) {
+    float t, h;
+    uint64_t total = 0;
+    for (int pass = 0; pass <= BENCH_PASSES; pass++) {
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            uint32_t c0 = systick_hw->cvr;
+            decode(frames[f], &t, &h);
+            uint32_t c1 = systick_hw->cvr;
+            if (pass) total += (c0 - c1) & SYSTICK_MAX;
+        }
+    }
+    return (uint32_t)(total / (BENCH_PASSES * BENCH_FRAMES));
+}
+
+int main() {
+    stdio_init_all();
+    build_frames();
+
+    systick_hw->rvr = SYSTICK_MAX;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    int mismatches = 0;
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        float t1 = 0, h1 = 0, t2 = 0, h2 = 0;
+        int r1 = dht22_frame_decode_bitwise(frames[f], &t1, &h1);
+        int r2 = dht22_frame_decode(frames[f], &t2, &h2);
+        mismatches += r1 != r2 || t1 != t2 || h1 != h2;
+    }
+
+    while (true) {
+        uint32_t overhead = measure(null_decoder);
+        uint32_t bitwise = measure(dht22_frame_decode_bitwise) - overhead;
+        uint32_t table = measure(dht22_frame_decode) - overhead;
+        printf("DHT22: %d quadros, %d divergências; bit a bit %lu ciclos/quadro, tabela %lu ciclos/quadro "
+               "(%lu.%02lux)\n",
+               BENCH_FRAMES, mismatches, (unsigned long)bitwise, (unsigned long)table,
+               (unsigned long)(bitwise / table), (unsigned long)(bitwise * 100 / table % 100));
+        sleep_ms(5000);
+    }
+}
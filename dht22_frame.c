@@ -0,0 +1,76 @@
+/**
+ * @file dht22_frame.c
+ * @brief Implementação dos decodificadores de quadro do DHT22
+ */
+#include "dht22_frame.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "dht22.h"
+
+#define FRAME_LANES 0x01010101u
+// Somado a cada largura (≤ 127), leva ao bit 7 as que passam do limiar
+#define FRAME_BIAS (FRAME_LANES * (127 - DHT22_FRAME_THRESHOLD_US))
+// Leva o bit 0 do byte j ao bit 31 - j: os 4 bits saem em ordem, MSB primeiro
+#define FRAME_GATHER 0x80402010u
+
+/**
+ * @brief 4 larguras consecutivas para um nibble, sem desvios
+ */
+static inline uint32_t frame_nibble(const uint8_t *widths) {
+    uint32_t lanes;
+    memcpy(&lanes, widths, sizeof(lanes));  // Little-endian: widths[0] no byte 0
+    uint32_t mask = ((lanes + FRAME_BIAS) >> 7) & FRAME_LANES;
+    return (mask * FRAME_GATHER) >> 28;
+}
+
+int dht22_frame_decode(const uint8_t widths[DHT22_FRAME_BITS], float *temperature, float *humidity) {
+    uint32_t d[5];
+    for (int i = 0; i < 5; i++) {
+        d[i] = frame_nibble(&widths[8 * i]) << 4 | frame_nibble(&widths[8 * i + 4]);
+    }
+
+    uint32_t h10 = d[0] << 8 | d[1];
+    uint32_t raw = d[2] << 8 | d[3];
+    int32_t neg = -(int32_t)(raw >> 15);                   // 0 ou -1
+    int32_t t10 = ((int32_t)(raw & 0x7FFF) ^ neg) - neg;   // Sinal-magnitude para complemento de 2
+
+    bool bad_sum = ((d[0] + d[1] + d[2] + d[3]) & 0xFF) != d[4];
+    bool bad_range = (h10 > 1000) | ((uint32_t)(t10 + 400) > 1200);
+    int result = bad_range ? DHT22_ERROR_INVALID_DATA : DHT22_OK;
+    result = bad_sum ? DHT22_ERROR_CHECKSUM : result;
+
+    if (result == DHT22_OK) {
+        *temperature = (float)t10 * 0.1f;
+        *humidity = (float)h10 * 0.1f;
+    }
+    return result;
+}
+
+int dht22_frame_decode_bitwise(const uint8_t widths[DHT22_FRAME_BITS], float *temperature, float *humidity) {
+    uint8_t data[5] = {0};
+    for (int i = 0; i < DHT22_FRAME_BITS; i++) {
+        if (widths[i] > DHT22_FRAME_THRESHOLD_US) {
+            data[i / 8] |= (1 << (7 - (i % 8)));
+        }
+    }
+
+    uint8_t checksum = data[0] + data[1] + data[2] + data[3];
+    if (checksum != data[4]) {
+        return DHT22_ERROR_CHECKSUM;
+    }
+
+    float h = ((data[0] << 8) | data[1]) * 0.1f;
+    float t = ((data[2] & 0x7F) << 8 | data[3]) * 0.1f;
+    if (data[2] & 0x80) {
+        t *= -1;
+    }
+    if (h < 0.0f || h > 100.0f || t < -40.0f || t > 80.0f) {
+        return DHT22_ERROR_INVALID_DATA;
+    }
+
+    *temperature = t;
+    *humidity = h;
+    return DHT22_OK;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file dht22_frame.h
+ * @brief Decodificação do quadro de 40 bits do DHT22 a partir das larguras de pulso
+ *
+ * O driver (dht22.c) mede a largura de cada um dos 40 pulsos em nível
+ * alto e entrega o vetor a um decodificador, que converte larguras em
+ * bits (acima de DHT22_FRAME_THRESHOLD_US: bit 1), verifica o checksum e
+ * a faixa e converte os valores. Há dois decodificadores equivalentes:
+ *
+ * - dht22_frame_decode(): sem desvios por bit. Cada grupo de 4 larguras é
+ *   lido como uma palavra de 32 bits; uma soma compara as 4 larguras com
+ *   o limiar de uma vez (o bit 7 de cada byte vira a máscara da
+ *   comparação) e uma multiplicação reúne os 4 bits da máscara em um
+ *   nibble. Checksum, faixa e o sinal-magnitude da temperatura são
+ *   resolvidos com aritmética, em uma só passada.
+ * - dht22_frame_decode_bitwise(): o caminho original, bit a bit, com
+ *   passadas separadas de checksum e conversão; mantido como referência
+ *   para os testes de estresse e benchmarks.
+ *
+ * As larguras são saturadas em DHT22_FRAME_WIDTH_MAX pelo driver, o que
+ * impede o vai-um entre os bytes da soma.
+ */
+#ifndef DHT22_FRAME_H
+#define DHT22_FRAME_H
+
+#include <stdint.h>
+
+#define DHT22_FRAME_BITS 40
+#define DHT22_FRAME_THRESHOLD_US 50     // Pulso alto mais longo que isso: bit 1
+#define DHT22_FRAME_WIDTH_MAX 127       // Saturação das larguras medidas (μs)
+
+/**
+ * @brief Decodificador de quadro: larguras em μs para temperatura e umidade
+ *
+ * @return DHT22_OK, DHT22_ERROR_CHECKSUM ou DHT22_ERROR_INVALID_DATA (dht22.h);
+ *         temperature e humidity só são escritos com DHT22_OK
+ */
+typedef int (*dht22_decoder_t)(const uint8_t widths[DHT22_FRAME_BITS], float *temperature, float *humidity);
+
+int dht22_frame_decode(const uint8_t widths[DHT22_FRAME_BITS], float *temperature, float *humidity);
+int dht22_frame_decode_bitwise(const uint8_t widths[DHT22_FRAME_BITS], float *temperature, float *humidity);
+
+#endif // DHT22_FRAME_H
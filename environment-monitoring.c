@@ -7,90 +7,195 @@
  *
  * Features:
  * - Reads temperature and humidity from a DHT22 sensor.
- * - Reads gas/smoke levels from an MQ2 sensor (via ADC).
- * - Reads light intensity from an LDR (via ADC).
+ * - Reads gas/smoke levels from an MQ2 sensor (via ADC, continuous DMA capture).
+ * - Reads light intensity from an LDR (via ADC, continuous DMA capture).
+ * - Corrects the RP2040 ADC differential non-linearity of every captured
+ *   block with a lookup table (see adc_dnl.h).
+ * - Samples the on-chip temperature sensor and VSYS in the same capture and
+ *   compensates the LDR and MQ2 codes for board temperature and supply
+ *   drift before any threshold or report (see adc_compensation.h).
  * - Activates a servo motor when high temperature is detected.
- * - Activates a relay when high gas/smoke levels are detected.
+ * - Activates a relay when high gas/smoke levels are detected, from the DMA
+ *   interrupt (see gas_alarm.h), independently of the main loop.
+ * - Powers the MQ2 heater and arms the gas alarm only once the sensor has
+ *   warmed up; optionally duty-cycles the heater (see mq2_heater.h).
  * - Turns on a red LED when light intensity exceeds a threshold.
+ * - On the Pico W with NET_ENABLED, joins Wi-Fi, disciplines a UTC clock
+ *   from SNTP (see sntp_client.h and wall_clock.h) and stamps every CBOR
+ *   telemetry record with UTC time. Dashboards connected over WebSocket get
+ *   every sample and actuator event as it happens (see ws_server.h and
+ *   telemetry_live.h).
  *
- * Pin assignments:
- * - DHT22_PIN: GPIO 2 (DHT22 sensor data)
- * - SERVO_PIN: GPIO 3 (Servo PWM control)
- * - MQ2_PIN: GPIO 27 (MQ2 sensor analog output, ADC1)
- * - RELE_PIN: GPIO 5 (Relay control)
- * - LDR_PIN: GPIO 26 (LDR analog output, ADC0)
- * - RED_LED_PIN: GPIO 4 (Red LED)
+ * Pin assignments come from the wiring in diagram.json, through the
+ * build-generated board_config.h and the compile-time checks in board.h:
+ * - BOARD_DHT22_PIN: GPIO 2 (DHT22 sensor data)
+ * - BOARD_SERVO_PIN: GPIO 3 (Servo PWM control, PWM slice 1 channel B)
+ * - BOARD_MQ2_PIN: GPIO 27 (MQ2 sensor analog output, ADC1)
+ * - BOARD_RELE_PIN: GPIO 5 (Relay control)
+ * - BOARD_LDR_PIN: GPIO 26 (LDR analog output, ADC0)
+ * - BOARD_RED_LED_PIN: GPIO 4 (Red LED)
+ * - BOARD_MQ2_HEATER_PIN: GPIO 6 (MQ2 heater switch)
  *
  * Functions:
  * - setup(): Initializes all peripherals and sensors.
  * - init_DHT22(): Initializes the DHT22 sensor.
- * - setup_adc(): Initializes ADC and configures ADC pins.
+ * - setup_adc(): Starts the ADC round-robin DMA capture, the gas alarm and
+ *   the MQ2 heater warm-up.
+ * - setup_network(): Starts the Wi-Fi connection, the UTC clock, the
+ *   SNTP client and the WebSocket server (NET_ENABLED only).
  * - setup_led(): Initializes the red LED GPIO.
  * - setup_rele(): Initializes the relay GPIO.
- * - init_pwm_servo(uint gpio): Initializes PWM for servo control.
- * - toggle_servo(uint32_t gpio, float angle): Sets servo to a specific angle.
- * - temperature_monitoring(bool *servo_triggered): Reads temperature/humidity and controls the servo.
- * - ldr_monitoring(): Reads LDR value and controls the red LED.
- * - mq2_monitoring(): Reads MQ2 value and controls the relay.
+ * - init_pwm_servo(): Initializes PWM for servo control.
+ * - toggle_servo(float angle): Sets servo to a specific angle.
+ * - temperature_monitoring(bool *servo_triggered): Reads temperature/humidity, passes them
+ *   through a running median and controls the servo.
+ * - ldr_monitoring(): Reads the latest LDR value and controls the red LED.
+ * - mq2_monitoring(): Reads the latest MQ2 value and the gas alarm state.
+ * - compensated_adc(): Refers an LDR or MQ2 code to nominal temperature and supply.
+ * - heater_control(): Advances the MQ2 heater state machine, which arms and
+ *   disarms the gas alarm.
+ *   All three tasks publish what they read to the sensor registry, which
+ *   report_telemetry() and is_high_temperature() read back.
+ * - wait_until(): Sleeps until the next deadline or a gas alarm change.
+ * - report_telemetry(): Prints the readings that changed beyond their deadband or
+ *   reached the heartbeat interval (see telemetry.h), or batches them as CBOR.
+ * - report_actuator(): Sends an actuator event (CBOR telemetry, and the
+ *   live stream with NET_ENABLED).
+ *   Telemetry is queued in store_forward.h and sent by store_forward_pump()
+ *   while the USB link is connected, so records survive link outages.
  * - is_high_temperature(): Checks if the temperature exceeds the threshold.
  * - turn_on_red_led(), turn_off_red_led(): Controls the red LED.
  *
  * Main loop:
- * - Continuously monitors sensors and actuates outputs accordingly.
+ * - Runs each task when it is due: the DHT22 every 2 s, the LDR and MQ2 at
+ *   adaptive periods (see adaptive_sampler.h) that shorten when the signal
+ *   moves and relax when it is stable, the MQ2 also whenever the gas
+ *   alarm interrupt changes state, and the heater control at the times
+ *   its state machine asks for.
+ * - Reports telemetry after any sample, sends queued telemetry until the
+ *   next deadline and sleeps.
+ * - With NET_ENABLED, advances the SNTP client and the WebSocket server on
+ *   every pass; the next query time and the server poll period are two
+ *   more deadlines.
+ * - With EXEC_TRACE_ENABLED, records the execution timeline in a RAM ring
+ *   that freezes once a window is full or shortly after a trigger (the gas
+ *   relay switching on), then drains the frozen window over serial a slice
+ *   per pass with exec_trace_pump(), in the slack before the telemetry
+ *   queue. Text only: it cannot be combined with TELEMETRY_FORMAT_CBOR.
  *
  * Dependencies:
  * - pico/stdlib.h
+ * - board.h (pins, ADC channels and PWM slice generated from diagram.json)
  * - dht22.h (external DHT22 driver)
+ * - telemetry.h (sample record and text encoding, shared with host tools)
  * - hardware/pwm.h
- * - hardware/adc.h
+ * - adc_capture.h (ADC round-robin DMA capture)
+ * - adc_compensation.h (fixed-point temperature and supply compensation)
+ * - gas_alarm.h (MQ2 threshold and relay, evaluated in the DMA interrupt)
+ * - mq2_heater.h (MQ2 heater warm-up, duty cycle and readiness)
+ * - latency_trace.h (sample-to-actuator latency histograms per rule)
+ * - telemetry_uplink.h (binary CBOR telemetry, when TELEMETRY_FORMAT_CBOR is 1)
+ * - store_forward.h (RAM and flash queue for telemetry during link outages)
+ * - adaptive_sampler.h (per-channel sampling periods driven by signal dynamics)
+ * - running_median.h (spike rejection on DHT22 readings; the ADC channels are
+ *   median-filtered inside adc_capture.h)
+ * - sensor_registry.h (latest reading of each sensor, seqlock-protected so
+ *   that the DMA interrupt or another core never hands out a torn reading)
+ * - exec_trace.h (execution timeline dumped over serial, when EXEC_TRACE_ENABLED is 1)
+ * - net.h, sntp_client.h, wall_clock.h (Wi-Fi, SNTP and the disciplined UTC
+ *   clock, when NET_ENABLED is 1)
+ * - ws_server.h, telemetry_live.h (live WebSocket stream, when NET_ENABLED is 1)
  */
+#include <math.h>
 #include <stdio.h>
 #include "pico/stdlib.h"
+#include "board.h"
 #include "dht22.h"
+#include "telemetry.h"
 #include "hardware/pwm.h"
-#include "hardware/adc.h"
-
-#define DHT22_PIN 2
-#define SERVO_PIN 3
-#define MQ2_PIN 27
-#define MQ2_ADC_CHANNEL 1
-#define RELE_PIN 5
-#define LDR_PIN 26 // GPIO 26 is ADC0
-#define RED_LED_PIN 4
+#include "adc_capture.h"
+#include "adc_compensation.h"
+#include "gas_alarm.h"
+#include "mq2_heater.h"
+#include "latency_trace.h"
+#include "telemetry_uplink.h"
+#include "store_forward.h"
+#include "adaptive_sampler.h"
+#include "running_median.h"
+#include "sensor_registry.h"
+#include "exec_trace.h"
+#include "message_pools.h"
+#if NET_ENABLED
+#include "net.h"
+#include "sntp_client.h"
+#include "telemetry_live.h"
+#include "wall_clock.h"
+#include "ws_server.h"
+#endif
 
 #define LDR_THRESHOLD 1500
+#define TEMPERATURE_THRESHOLD 300 // Servo threshold, in tenths of °C
+
+#define DHT22_PERIOD_MS 2000 // Sensor minimum interval between reads
+#define DHT22_MEDIAN_WINDOW 3 // Reads in the running median (1: no filtering)
+
+#ifndef TELEMETRY_FORMAT_CBOR
+#define TELEMETRY_FORMAT_CBOR 0 // 1: binary CBOR records instead of text lines
+#endif
+
+#if TELEMETRY_FORMAT_CBOR && EXEC_TRACE_ENABLED
+// exec_trace_pump() prints text lines straight to stdout, which would land inside the binary stream
+#error "EXEC_TRACE_ENABLED cannot be combined with TELEMETRY_FORMAT_CBOR"
+#endif
+
+#ifndef NET_ENABLED
+#define NET_ENABLED 0 // 1: Wi-Fi, SNTP and the WebSocket stream on the Pico W (set by the WIFI_SSID CMake option)
+#endif
 
-int temperature_result;
-uint16_t ldr_value, mq2_value;
-float temperature, humidity;
+bool gas_alarm;
+adaptive_sampler_t ldr_sampler, mq2_sampler;
+static running_median_t temperature_median, humidity_median; // In tenths, like the sensor
+static bool temperature_read_high;        // Last raw read above TEMPERATURE_THRESHOLD
+static latency_stamp_t temperature_cause; // First raw read on the current side of it
 
 void setup();
 void init_DHT22();
 void setup_adc();
+void setup_network();
 void temperature_monitoring(bool *servo_triggered);
 void ldr_monitoring();
 void mq2_monitoring(); 
+uint16_t compensated_adc(adc_compensation_sensor_t sensor, int32_t code);
+void heater_control();
+void report_telemetry();
+void report_actuator(telemetry_actuator_t actuator, uint32_t value);
+void wait_until(uint32_t deadline_ms);
 bool is_high_temperature();
-void toggle_servo(uint32_t gpio, float angle);
-void init_pwm_servo(uint gpio);
+void toggle_servo(float angle);
+void init_pwm_servo();
 void turn_on_red_led();
 void turn_off_red_led();
 
 void turn_off_red_led() {
-    gpio_put(RED_LED_PIN, 0);
+    gpio_put(BOARD_RED_LED_PIN, 0);
 }
 
 void turn_on_red_led() {
-    gpio_put(RED_LED_PIN, 1);
+    gpio_put(BOARD_RED_LED_PIN, 1);
 }
 
 
 void ldr_monitoring()
 {
-    adc_select_input(LDR_PIN - 26); 
-    ldr_value = adc_read();
-    float ldr_voltage = (ldr_value * 3.3f) / 4095.0f; 
-    printf("LDR: %.2f V (Raw: %d)\n", ldr_voltage, ldr_value);
+    static bool red_led_on = false;
+
+    sensor_reading_t adc;
+    sensor_registry_read(SENSOR_REGISTRY_ADC, &adc);
+    latency_stamp_t stamp = latency_trace_stamp(adc.time_us);
+    uint16_t ldr_value = compensated_adc(ADC_COMPENSATION_LDR, adc.value[ADC_CAPTURE_LDR]);
+    sensor_reading_t ldr = {.value = {ldr_value}, .time_us = adc.time_us};
+    sensor_registry_publish(SENSOR_REGISTRY_LDR, &ldr);
+    adaptive_sampler_update(&ldr_sampler, ldr_value, to_ms_since_boot(get_absolute_time()));
     if (ldr_value > LDR_THRESHOLD)
     {
         turn_on_red_led();
@@ -99,62 +204,107 @@ void ldr_monitoring()
     {
         turn_off_red_led();
     }
-    
+
+    // Só as mudanças de estado do LED contam como comandos
+    if ((ldr_value > LDR_THRESHOLD) != red_led_on)
+    {
+        red_led_on = !red_led_on;
+        latency_trace_issue(LATENCY_RULE_LDR_LED, &stamp);
+        report_actuator(TELEMETRY_ACTUATOR_LED, red_led_on);
+    }
 }
 
 void setup_led(){
-    gpio_init(RED_LED_PIN);
-    gpio_set_dir(RED_LED_PIN, GPIO_OUT);
-    gpio_put(RED_LED_PIN, 0);
+    gpio_init(BOARD_RED_LED_PIN);
+    gpio_set_dir(BOARD_RED_LED_PIN, GPIO_OUT);
+    gpio_put(BOARD_RED_LED_PIN, 0);
 }
 
 void setup_rele(){
-    gpio_init(RELE_PIN);
-    gpio_set_dir(RELE_PIN, GPIO_OUT);
-    gpio_put(RELE_PIN, 0);
+    gpio_init(BOARD_RELE_PIN);
+    gpio_set_dir(BOARD_RELE_PIN, GPIO_OUT);
+    gpio_put(BOARD_RELE_PIN, 0);
 }
 
 void setup_adc(){
-    adc_init();
-    adc_gpio_init(LDR_PIN);
-    adc_gpio_init(MQ2_PIN);
+    static const adaptive_sampler_config_t ldr_config = ADAPTIVE_SAMPLER_LDR_DEFAULT;
+    static const adaptive_sampler_config_t mq2_config = ADAPTIVE_SAMPLER_MQ2_DEFAULT;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    adaptive_sampler_init(&ldr_sampler, &ldr_config, now);
+    adaptive_sampler_init(&mq2_sampler, &mq2_config, now);
+
+    gas_alarm_init(BOARD_RELE_PIN, GAS_ALARM_DEFAULT_THRESHOLD);
+    // Disarms the alarm until the sensor has warmed up
+    mq2_heater_init(BOARD_MQ2_HEATER_PIN, gas_alarm_set_armed, now);
+    if (adc_capture_init(gas_alarm_on_block) != ADC_CAPTURE_OK)
+    {
+        printf("Erro ao iniciar a captura do ADC.\n");
+    }
 }
 
-void init_pwm_servo(uint gpio) {
-    gpio_set_function(gpio, GPIO_FUNC_PWM);
-    uint slice = pwm_gpio_to_slice_num(gpio);
-    pwm_set_wrap(slice, 20000);
-    pwm_set_clkdiv(slice, 125.0f);
-    pwm_set_enabled(slice, true);
+void init_pwm_servo() {
+    gpio_set_function(BOARD_SERVO_PIN, GPIO_FUNC_PWM);
+    pwm_set_wrap(BOARD_SERVO_PWM_SLICE, 20000);
+    pwm_set_clkdiv(BOARD_SERVO_PWM_SLICE, 125.0f);
+    pwm_set_enabled(BOARD_SERVO_PWM_SLICE, true);
 }
 
 
-void toggle_servo(uint32_t gpio, float angle) {
+void toggle_servo(float angle) {
     if (angle < 0.0f) angle = 0.0f;
     if (angle > 180.0f) angle = 180.0f;
     uint16_t pulso = 600 + (uint16_t)(angle * (1800.0f / 180.0f));
-    pwm_set_gpio_level(gpio, pulso);
+    pwm_set_chan_level(BOARD_SERVO_PWM_SLICE, BOARD_SERVO_PWM_CHANNEL, pulso);
 }
 
 
 bool is_high_temperature()
 {
-    return temperature > 30.0;
+    sensor_reading_t dht22;
+    sensor_registry_read(SENSOR_REGISTRY_DHT22, &dht22);
+    return dht22.value[0] > TEMPERATURE_THRESHOLD;
 }
 
 void setup(){
     stdio_init_all();
+#if EXEC_TRACE_ENABLED
+    exec_trace_init();
+#endif
+    message_pools_init();
+    store_forward_init();
     init_DHT22();
-    init_pwm_servo(SERVO_PIN);
-    setup_adc();
+    init_pwm_servo();
     setup_led();
     setup_rele();
+    setup_adc();
+    setup_network();
+}
+
+void setup_network() {
+#if NET_ENABLED
+    wall_clock_init();
+    if (net_init() != NET_OK)
+    {
+        printf("Erro ao iniciar a rede.\n");
+        return;
+    }
+    sntp_client_init(SNTP_CLIENT_SERVER, SNTP_CLIENT_PORT, time_us_64, to_ms_since_boot(get_absolute_time()));
+    // One conversion per record header; samples keep their boot-relative offsets
+    telemetry_cbor_set_utc_source(wall_clock_utc_ms_at);
+    if (!ws_server_init(WS_SERVER_PORT))
+    {
+        printf("Erro ao abrir o servidor WebSocket.\n");
+    }
+#endif
 }
 
 void init_DHT22()
 {
-    temperature_result = dht22_init(DHT22_PIN);
-    if (temperature_result != DHT22_OK)
+    running_median_init(&temperature_median, DHT22_MEDIAN_WINDOW);
+    running_median_init(&humidity_median, DHT22_MEDIAN_WINDOW);
+    sensor_reading_t dht22 = {.status = dht22_init(BOARD_DHT22_PIN)};
+    sensor_registry_publish(SENSOR_REGISTRY_DHT22, &dht22);
+    if (dht22.status != DHT22_OK)
     {
         printf("Erro ao inicializar o sensor DHT22.\n");
         return;
@@ -164,55 +314,243 @@ void init_DHT22()
 
 void temperature_monitoring(bool *servo_triggered)
 {
-    temperature_result = dht22_read(&temperature, &humidity);    
+    float temperature, humidity;
+    int result = dht22_read(&temperature, &humidity);
+    uint32_t now_us = time_us_32();
+
+    // On an error the last good values stay in place next to the new status
+    sensor_reading_t dht22;
+    sensor_registry_read(SENSOR_REGISTRY_DHT22, &dht22);
+    dht22.status = result;
+    dht22.time_us = now_us;
+    if (result == DHT22_OK)
+    {
+        // The median follows a step a read late, so the servo answers to the first
+        // raw read past the threshold, stamped when its data phase ended
+        int32_t tenths = lroundf(temperature * 10.0f);
+        if ((tenths > TEMPERATURE_THRESHOLD) != temperature_read_high)
+        {
+            temperature_read_high = !temperature_read_high;
+            temperature_cause = latency_trace_stamp(dht22_data_us());
+        }
 
-    if (temperature_result == DHT22_OK)
+        // A mis-decode that still passes the checksum is a one-read spike
+        dht22.value[0] = running_median_push(&temperature_median, tenths);
+        dht22.value[1] = running_median_push(&humidity_median, lroundf(humidity * 10.0f));
+    }
+    sensor_registry_publish(SENSOR_REGISTRY_DHT22, &dht22);
+
+    if (result == DHT22_OK)
     {
-        printf("Temperatura: %.1f °C | Umidade: %.1f %%\n", temperature, humidity);
         if (is_high_temperature() && !(*servo_triggered))
         {
             *servo_triggered = true;
-            toggle_servo(SERVO_PIN, 180.0f);
+            toggle_servo(180.0f);
+            latency_trace_issue(LATENCY_RULE_TEMP_SERVO, &temperature_cause);
+            report_actuator(TELEMETRY_ACTUATOR_SERVO, 180);
         }
         else if (!is_high_temperature() && *servo_triggered)
         {
             *servo_triggered = false;
-            toggle_servo(SERVO_PIN, 0.0f);
+            toggle_servo(0.0f);
+            latency_trace_issue(LATENCY_RULE_TEMP_SERVO, &temperature_cause);
+            report_actuator(TELEMETRY_ACTUATOR_SERVO, 0);
         }
     }
-    else
+}
+
+void mq2_monitoring() {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    sensor_reading_t adc;
+    sensor_registry_read(SENSOR_REGISTRY_ADC, &adc);
+    uint16_t mq2_value = compensated_adc(ADC_COMPENSATION_MQ2, adc.value[ADC_CAPTURE_MQ2]);
+    bool ready = mq2_heater_is_ready();
+    sensor_reading_t mq2 = {
+        .status = ready ? MQ2_HEATER_OK : MQ2_HEATER_NOT_READY,
+        .value = {mq2_value},
+        .time_us = adc.time_us,
+    };
+    sensor_registry_publish(SENSOR_REGISTRY_MQ2, &mq2);
+    bool active = gas_alarm_is_active();
+    if (active != gas_alarm)
     {
-        printf("Erro na leitura do DHT22: código %d\n", temperature_result);
+        // The relay itself was switched by the DMA interrupt
+        report_actuator(TELEMETRY_ACTUATOR_RELAY, active);
     }
+    gas_alarm = active;
+
+    // Sample the gas event at the fastest rate for as long as it lasts
+    if (active) adaptive_sampler_boost(&mq2_sampler, now);
+    // A warming sensor drifts without any gas: hold the last trusted value meanwhile
+    adaptive_sampler_update(&mq2_sampler, ready ? mq2_value : mq2_sampler.last_value, now);
 }
 
-void mq2_monitoring() {
-    adc_select_input(MQ2_ADC_CHANNEL);
-    mq2_value = adc_read();
-    float mq2_voltage = (mq2_value * 3.3f) / 4095.0f; 
-    printf("MQ2: %.2f V (Raw: %d)\n", mq2_voltage, mq2_value);
-
-    if (mq2_value > 2000) {
-        gpio_put(RELE_PIN, 1); 
-        printf("Alarme ativado!\n");
-    } else {
-        gpio_put(RELE_PIN, 0);
-        printf("Alarme desativado.\n");
+uint16_t compensated_adc(adc_compensation_sensor_t sensor, int32_t code) {
+    // Block means of the temperature sensor and VSYS, published with the samples
+    sensor_reading_t aux;
+    sensor_registry_read(SENSOR_REGISTRY_ADC_AUX, &aux);
+    adc_compensation_t comp;
+    adc_compensation_update(&comp, (uint32_t)aux.value[0], (uint32_t)aux.value[1]);
+    return adc_compensation_apply(&comp, sensor, (uint32_t)code);
+}
+
+void heater_control() {
+    sensor_reading_t adc;
+    sensor_registry_read(SENSOR_REGISTRY_ADC, &adc);
+    mq2_heater_poll(to_ms_since_boot(get_absolute_time()), (uint16_t)adc.value[ADC_CAPTURE_MQ2],
+                    gas_alarm_is_active());
+}
+
+void report_telemetry() {
+    sensor_reading_t dht22, ldr, mq2;
+    sensor_registry_read(SENSOR_REGISTRY_DHT22, &dht22);
+    sensor_registry_read(SENSOR_REGISTRY_LDR, &ldr);
+    sensor_registry_read(SENSOR_REGISTRY_MQ2, &mq2);
+    telemetry_sample_t sample = {
+        .dht22_result = dht22.status,
+        .temperature = dht22.value[0] / 10.0f,
+        .humidity = dht22.value[1] / 10.0f,
+        .ldr_raw = (uint16_t)ldr.value[0],
+        .mq2_raw = (uint16_t)mq2.value[0],
+        .gas_alarm = gas_alarm,
+    };
+
+#if NET_ENABLED
+    // Dashboards get every sample as it is taken, whatever the serial format
+    telemetry_live_sample(to_ms_since_boot(get_absolute_time()), &sample);
+#endif
+
+#if TELEMETRY_FORMAT_CBOR
+    telemetry_uplink_sample(&sample);
+#else
+    static const telemetry_deadband_t policy = TELEMETRY_DEADBAND_DEFAULT;
+    static telemetry_deadband_state_t deadband;
+    static bool reported_alarm;
+    char text[192];
+    unsigned int lines = telemetry_deadband_select(&policy, &deadband, &sample,
+                                                   to_ms_since_boot(get_absolute_time()));
+    if (lines)
+    {
+        int len = telemetry_format_lines(text, sizeof(text), &sample, lines);
+        if (len >= (int)sizeof(text)) len = sizeof(text) - 1;
+        // Alarm changes are kept through long outages; periodic readings and heartbeats may be decimated
+        bool alarm_changed = gas_alarm != reported_alarm;
+        reported_alarm = gas_alarm;
+        store_forward_push((const uint8_t *)text, (size_t)len,
+                           alarm_changed ? STORE_FORWARD_KEEP : STORE_FORWARD_DATA);
+    }
+#endif
+}
+
+void report_actuator(telemetry_actuator_t actuator, uint32_t value) {
+#if NET_ENABLED
+    telemetry_live_actuator(to_ms_since_boot(get_absolute_time()), actuator, value);
+#endif
+#if TELEMETRY_FORMAT_CBOR
+    telemetry_uplink_actuator(actuator, value);
+#else
+    // Text telemetry already shows the alarm line; other actuators are implicit
+    (void)actuator;
+    (void)value;
+#endif
+}
+
+void wait_until(uint32_t deadline_ms) {
+    int32_t remaining = (int32_t)(deadline_ms - to_ms_since_boot(get_absolute_time()));
+    if (remaining <= 0) return;
+    absolute_time_t deadline = delayed_by_ms(get_absolute_time(), (uint32_t)remaining);
+
+    // Any interrupt may wake the core; only a deadline or an alarm change ends the wait
+    while (!best_effort_wfe_or_timeout(deadline))
+    {
+        if (gas_alarm_is_active() != gas_alarm) return;
+#if EXEC_TRACE_ENABLED
+        if (exec_trace_pending()) return;
+#endif
     }
 }
 
-    
+static uint32_t earliest(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0 ? a : b;
+}
+
 int main()
 {
     bool servo_triggered = false;
 
     setup();
 
+    uint32_t next_dht22 = to_ms_since_boot(get_absolute_time());
     while (1)
     {
-        temperature_monitoring(&servo_triggered);
-        ldr_monitoring();
-        mq2_monitoring();
+        bool sampled = false;
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        if ((int32_t)(now - next_dht22) >= 0)
+        {
+            EXEC_TRACE_BEGIN(EXEC_TRACE_TASK_DHT22);
+            temperature_monitoring(&servo_triggered);
+            EXEC_TRACE_END(EXEC_TRACE_TASK_DHT22);
+            next_dht22 = to_ms_since_boot(get_absolute_time()) + DHT22_PERIOD_MS;
+            sampled = true;
+        }
+
+        now = to_ms_since_boot(get_absolute_time());
+        if (adaptive_sampler_due(&ldr_sampler, now))
+        {
+            EXEC_TRACE_BEGIN(EXEC_TRACE_TASK_LDR);
+            ldr_monitoring();
+            EXEC_TRACE_END(EXEC_TRACE_TASK_LDR);
+            sampled = true;
+        }
+        if (adaptive_sampler_due(&mq2_sampler, now) || gas_alarm_is_active() != gas_alarm)
+        {
+            EXEC_TRACE_BEGIN(EXEC_TRACE_TASK_MQ2);
+            mq2_monitoring();
+            EXEC_TRACE_END(EXEC_TRACE_TASK_MQ2);
+            sampled = true;
+        }
+        if ((int32_t)(now - mq2_heater_next_ms()) >= 0)
+        {
+            heater_control();
+        }
+#if NET_ENABLED
+        // Cheap when idle; a reply stamped by the receive callback is handled on the next pass
+        sntp_client_poll(now);
+        // Accepts dashboards and drains their queues; never waits on a slow one
+        ws_server_poll(now);
+#endif
+        if (sampled)
+        {
+            EXEC_TRACE_BEGIN(EXEC_TRACE_TASK_TELEMETRY);
+            report_telemetry();
+            EXEC_TRACE_END(EXEC_TRACE_TASK_TELEMETRY);
+        }
+
+        // Queued telemetry is sent in the slack before the next task is due
+        uint32_t deadline = earliest(next_dht22, earliest(ldr_sampler.next_ms, mq2_sampler.next_ms));
+        deadline = earliest(deadline, mq2_heater_next_ms());
+#if NET_ENABLED
+        deadline = earliest(deadline, sntp_client_next_ms());
+        deadline = earliest(deadline, ws_server_next_ms());
+#endif
+        int32_t slack_ms = (int32_t)(deadline - to_ms_since_boot(get_absolute_time()));
+#if EXEC_TRACE_ENABLED
+        // A frozen trace window drains first, a slice per pass, so sampling never waits on it
+        if (slack_ms > 0 && exec_trace_pending())
+        {
+            exec_trace_pump((uint32_t)slack_ms * 1000);
+            slack_ms = (int32_t)(deadline - to_ms_since_boot(get_absolute_time()));
+        }
+#endif
+        if (slack_ms > 0)
+        {
+            EXEC_TRACE_BEGIN(EXEC_TRACE_TASK_PUMP);
+            store_forward_pump((uint32_t)slack_ms * 1000);
+            EXEC_TRACE_END(EXEC_TRACE_TASK_PUMP);
+        }
+        EXEC_TRACE_BEGIN(EXEC_TRACE_TASK_WAIT);
+        wait_until(deadline);
+        EXEC_TRACE_END(EXEC_TRACE_TASK_WAIT);
     }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,213 @@
+/**
+ * @file exec_trace.c
+ * @brief Implementação da linha do tempo de execução em anel na RAM, congelado para a descarga
+ */
+#include "exec_trace.h"
+
+#if EXEC_TRACE_ENABLED
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#if PICO_ON_DEVICE
+#include "hardware/structs/timer.h"
+#endif
+
+/**
+ * @brief Um evento no anel (16 bytes)
+ */
+typedef struct {
+    uint64_t time_us;
+    uint32_t arg;
+    uint8_t event;              // exec_trace_event_t
+    uint8_t kind;               // exec_trace_kind_t
+} exec_trace_entry_t;
+
+static_assert(EXEC_TRACE_CAPACITY > 0 && (EXEC_TRACE_CAPACITY & (EXEC_TRACE_CAPACITY - 1)) == 0,
+              "EXEC_TRACE_CAPACITY deve ser potência de dois");
+static_assert(EXEC_TRACE_POST_TRIGGER < EXEC_TRACE_CAPACITY, "gatilho sem eventos anteriores na janela");
+
+/**
+ * @brief Estado da gravação
+ *
+ * head, start, stop, first e next contam eventos desde o boot; o evento
+ * n fica em entry[n % EXEC_TRACE_CAPACITY].
+ */
+typedef struct {
+    exec_trace_entry_t entry[EXEC_TRACE_CAPACITY];
+    volatile uint32_t head;             // Próximo evento a gravar
+    uint32_t start;                     // Primeiro evento gravado desde o último congelamento
+    uint32_t stop;                      // Congela ao chegar aqui, se armed
+    volatile bool armed;                // Há um ponto de congelamento (janela cheia ou gatilho)
+    volatile bool frozen;               // Janela esperando descarga: nada é gravado
+    volatile uint32_t dropped;          // Descartados com o anel congelado
+    uint32_t dropped_before;            // Descartados entre a janela anterior e a atual
+    uint32_t first;                     // Primeiro evento da janela congelada
+    uint32_t next;                      // Próximo evento a descarregar
+    bool header_sent;                   // Cabeçalho da janela congelada já escrito
+} exec_trace_state_t;
+
+static exec_trace_state_t exec_trace;
+
+typedef struct {
+    const char *name;
+    const char *track;
+} exec_trace_event_info_t;
+
+static const exec_trace_event_info_t exec_trace_events[EXEC_TRACE_EVENT_COUNT] = {
+    [EXEC_TRACE_TASK_DHT22] = {"task.dht22", "main"},
+    [EXEC_TRACE_TASK_LDR] = {"task.ldr", "main"},
+    [EXEC_TRACE_TASK_MQ2] = {"task.mq2", "main"},
+    [EXEC_TRACE_TASK_TELEMETRY] = {"task.telemetry", "main"},
+    [EXEC_TRACE_TASK_PUMP] = {"task.pump", "main"},
+    [EXEC_TRACE_TASK_WAIT] = {"task.wait", "main"},
+    [EXEC_TRACE_DHT22_START] = {"dht22.start", "main"},
+    [EXEC_TRACE_DHT22_RESPONSE] = {"dht22.response", "main"},
+    [EXEC_TRACE_DHT22_DATA] = {"dht22.data", "main"},
+    [EXEC_TRACE_DHT22_DECODE] = {"dht22.decode", "main"},
+    [EXEC_TRACE_FLASH_ERASE] = {"flash.erase", "main"},
+    [EXEC_TRACE_FLASH_PROGRAM] = {"flash.program", "main"},
+    [EXEC_TRACE_IRQ_DMA] = {"irq.dma", "irq"},
+    [EXEC_TRACE_IRQ_USB] = {"irq.usb", "irq"},
+    [EXEC_TRACE_GAS_RELAY] = {"gas.relay", "irq"},
+    [EXEC_TRACE_MQ2_HEATER] = {"mq2.heater", "main"},
+};
+
+static const char exec_trace_kind_letter[] = {
+    [EXEC_TRACE_KIND_BEGIN] = 'B',
+    [EXEC_TRACE_KIND_END] = 'E',
+    [EXEC_TRACE_KIND_INSTANT] = 'I',
+};
+
+/**
+ * @brief Instante atual em μs, sem passar pela flash
+ *
+ * time_us_64() do SDK fica na flash; aqui o timer é lido cru, repetindo
+ * se a palavra alta mudou entre as duas leituras.
+ */
+static inline uint64_t exec_trace_now_us(void) {
+#if PICO_ON_DEVICE
+    uint32_t hi = timer_hw->timerawh;
+    uint32_t lo;
+    for (;;) {
+        lo = timer_hw->timerawl;
+        uint32_t next = timer_hw->timerawh;
+        if (next == hi) break;
+        hi = next;
+    }
+    return (uint64_t)hi << 32 | lo;
+#else
+    return time_us_64();
+#endif
+}
+
+/**
+ * @brief Volta a gravar depois de uma descarga (ou na inicialização)
+ *
+ * Chamada com as interrupções desabilitadas.
+ */
+static void exec_trace_rearm(void) {
+    exec_trace.start = exec_trace.head;
+#if EXEC_TRACE_CONTINUOUS
+    exec_trace.stop = exec_trace.start + EXEC_TRACE_CAPACITY;
+    exec_trace.armed = true;
+#else
+    exec_trace.armed = false;
+#endif
+    exec_trace.frozen = false;
+}
+
+void __not_in_flash_func(exec_trace_record)(exec_trace_event_t event, exec_trace_kind_t kind, uint32_t arg) {
+    uint32_t irq = save_and_disable_interrupts();
+    if (!exec_trace.frozen) {
+        uint32_t head = exec_trace.head;
+        exec_trace_entry_t *e = &exec_trace.entry[head % EXEC_TRACE_CAPACITY];
+        e->time_us = exec_trace_now_us();
+        e->arg = arg;
+        e->event = (uint8_t)event;
+        e->kind = (uint8_t)kind;
+        exec_trace.head = ++head;
+        if (exec_trace.armed && head == exec_trace.stop) {
+            // Os sobrescritos desde o último congelamento contam como descartados
+            exec_trace.first = head - exec_trace.start > EXEC_TRACE_CAPACITY ? head - EXEC_TRACE_CAPACITY
+                                                                             : exec_trace.start;
+            exec_trace.dropped_before += exec_trace.first - exec_trace.start;
+            exec_trace.next = exec_trace.first;
+            exec_trace.header_sent = false;
+            exec_trace.frozen = true;
+            // Acorda o laço principal para descarregar a janela
+            __sev();
+        }
+    } else {
+        exec_trace.dropped++;
+    }
+    restore_interrupts(irq);
+}
+
+void __not_in_flash_func(exec_trace_trigger)(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t stop = exec_trace.head + EXEC_TRACE_POST_TRIGGER;
+    if (!exec_trace.frozen && (!exec_trace.armed || (int32_t)(stop - exec_trace.stop) < 0)) {
+        exec_trace.stop = stop;
+        exec_trace.armed = true;
+    }
+    restore_interrupts(irq);
+}
+
+#if PICO_ON_DEVICE && LIB_PICO_STDIO_USB
+// Compartilha a interrupção com o TinyUSB e roda antes dele
+static void exec_trace_usb_irq(void) {
+    exec_trace_record(EXEC_TRACE_IRQ_USB, EXEC_TRACE_KIND_INSTANT, 0);
+}
+#endif
+
+void exec_trace_init(void) {
+    exec_trace.head = 0;
+    exec_trace.dropped = 0;
+    exec_trace.dropped_before = 0;
+    exec_trace_rearm();
+#if PICO_ON_DEVICE && LIB_PICO_STDIO_USB
+    irq_add_shared_handler(USBCTRL_IRQ, exec_trace_usb_irq, PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+#endif
+}
+
+bool exec_trace_pending(void) {
+    return exec_trace.frozen;
+}
+
+uint32_t exec_trace_pump(uint32_t budget_us) {
+    if (!exec_trace.frozen) return 0;
+
+    // Congelado, o anel só muda aqui; as interrupções só mexem em dropped
+    uint32_t start = time_us_32();
+    uint32_t head = exec_trace.head;
+    if (!exec_trace.header_sent) {
+        printf("exec_trace: %lu eventos, %lu descartados\n", (unsigned long)(head - exec_trace.first),
+               (unsigned long)exec_trace.dropped_before);
+        exec_trace.header_sent = true;
+    }
+    uint32_t sent = 0;
+    while (exec_trace.next != head && time_us_32() - start < budget_us) {
+        const exec_trace_entry_t *e = &exec_trace.entry[exec_trace.next % EXEC_TRACE_CAPACITY];
+        const exec_trace_event_info_t *info = &exec_trace_events[e->event];
+        printf("@%llu %c %s %s %lu\n", (unsigned long long)e->time_us, exec_trace_kind_letter[e->kind],
+               info->track, info->name, (unsigned long)e->arg);
+        exec_trace.next++;
+        sent++;
+    }
+    if (exec_trace.next != head) return sent;
+    printf("exec_trace: fim\n");
+
+    // Os descartados com o anel congelado ficam antes da próxima janela
+    uint32_t irq = save_and_disable_interrupts();
+    exec_trace.dropped_before = exec_trace.dropped;
+    exec_trace.dropped = 0;
+    exec_trace_rearm();
+    restore_interrupts(irq);
+    return sent;
+}
+
+#endif // EXEC_TRACE_ENABLED
@@ -0,0 +1,148 @@
+/**
+ * @file exec_trace.h
+ * @brief Linha do tempo de execução do firmware (tarefas, interrupções e fases do DHT22)
+ *
+ * Os histogramas de latency_trace.h mostram quanto cada regra demora, mas
+ * não o que aconteceu ao mesmo tempo: uma interrupção que cai no meio da
+ * fase de dados do DHT22, uma gravação na flash que segura o laço. Com
+ * EXEC_TRACE_ENABLED em 1, cada tarefa do laço principal, cada fase de
+ * uma leitura do DHT22, cada operação na flash e cada interrupção
+ * registra eventos de início e fim num anel em RAM, com carimbo de 64
+ * bits em μs.
+ *
+ * O anel guarda sempre os últimos EXEC_TRACE_CAPACITY eventos,
+ * sobrescrevendo os mais antigos, até ser congelado. Com
+ * EXEC_TRACE_CONTINUOUS em 1 (padrão), ele congela sozinho quando junta
+ * EXEC_TRACE_CAPACITY eventos novos, e as janelas se sucedem cobrindo a
+ * execução inteira; em 0, só exec_trace_trigger() (o relé do gás ligando,
+ * por exemplo) o congela, EXEC_TRACE_POST_TRIGGER eventos depois, e a
+ * janela mostra o que levou ao gatilho e o que veio logo em seguida.
+ * Congelado, o anel acorda o laço principal (__sev()), que o descarrega
+ * pela serial com exec_trace_pump(), em linhas de texto, aos poucos, na
+ * folga entre as tarefas, como store_forward_pump(); a aquisição não para
+ * durante a descarga. Ao fim da descarga o anel volta a gravar. Os
+ * eventos perdidos entre uma janela e a seguinte (sobrescritos antes do
+ * congelamento ou ocorridos com o anel congelado) são só contados e
+ * aparecem no cabeçalho da seguinte. O formato é:
+ * @code
+ * exec_trace: <eventos> eventos, <descartados> descartados
+ * @<t_us> <B|E|I> <trilha> <nome> <argumento>
+ * ...
+ * exec_trace: fim
+ * @endcode
+ * e host/exec_trace_export converte a captura da serial em JSON de trace
+ * do Chrome, que o Perfetto (ui.perfetto.dev) abre diretamente.
+ *
+ * Registrar um evento custa algumas dezenas de ciclos (interrupções
+ * desabilitadas em volta de uma escrita de 16 bytes e da leitura do
+ * contador do timer) e não depende da flash, então pode ser chamado da
+ * interrupção do DMA durante escritas na flash. Com EXEC_TRACE_ENABLED em
+ * 0 (padrão), as macros não geram código e o anel não ocupa RAM.
+ */
+#ifndef EXEC_TRACE_H
+#define EXEC_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef EXEC_TRACE_ENABLED
+#define EXEC_TRACE_ENABLED 0                // 1: registra a linha do tempo de execução
+#endif
+#ifndef EXEC_TRACE_CAPACITY
+#define EXEC_TRACE_CAPACITY 1024            // Eventos por janela (16 bytes cada), potência de dois
+#endif
+#ifndef EXEC_TRACE_CONTINUOUS
+#define EXEC_TRACE_CONTINUOUS 1             // 1: janelas seguidas; 0: só congela no gatilho
+#endif
+#ifndef EXEC_TRACE_POST_TRIGGER
+#define EXEC_TRACE_POST_TRIGGER (EXEC_TRACE_CAPACITY / 4)  // Eventos gravados depois do gatilho
+#endif
+
+/**
+ * @brief Eventos registrados
+ *
+ * Tarefas, fases do DHT22 e operações na flash ficam na trilha do laço
+ * principal (aninhadas); interrupções, na trilha das interrupções.
+ */
+typedef enum {
+    EXEC_TRACE_TASK_DHT22,          // temperature_monitoring()
+    EXEC_TRACE_TASK_LDR,            // ldr_monitoring()
+    EXEC_TRACE_TASK_MQ2,            // mq2_monitoring()
+    EXEC_TRACE_TASK_TELEMETRY,      // report_telemetry()
+    EXEC_TRACE_TASK_PUMP,           // store_forward_pump()
+    EXEC_TRACE_TASK_WAIT,           // wait_until(): núcleo ocioso
+    EXEC_TRACE_DHT22_START,         // Sinal de início (18 ms em nível baixo)
+    EXEC_TRACE_DHT22_RESPONSE,      // Espera da resposta do sensor
+    EXEC_TRACE_DHT22_DATA,          // Medição dos 40 pulsos
+    EXEC_TRACE_DHT22_DECODE,        // Decodificação do quadro
+    EXEC_TRACE_FLASH_ERASE,         // Apagamento de setor (interrupções suspensas)
+    EXEC_TRACE_FLASH_PROGRAM,       // Gravação de página (interrupções suspensas)
+    EXEC_TRACE_IRQ_DMA,             // Interrupção do DMA do ADC, com o alarme de gás
+    EXEC_TRACE_IRQ_USB,             // Entrada na interrupção do USB (instantâneo)
+    EXEC_TRACE_GAS_RELAY,           // Mudança do relé; argumento: novo estado (instantâneo)
+    EXEC_TRACE_MQ2_HEATER,          // Aquecedor do MQ2 ligado/desligado; argumento: novo estado (instantâneo)
+    EXEC_TRACE_EVENT_COUNT
+} exec_trace_event_t;
+
+typedef enum {
+    EXEC_TRACE_KIND_BEGIN,
+    EXEC_TRACE_KIND_END,
+    EXEC_TRACE_KIND_INSTANT,
+} exec_trace_kind_t;
+
+#if EXEC_TRACE_ENABLED
+#define EXEC_TRACE_BEGIN(event) exec_trace_record((event), EXEC_TRACE_KIND_BEGIN, 0)
+#define EXEC_TRACE_END(event) exec_trace_record((event), EXEC_TRACE_KIND_END, 0)
+#define EXEC_TRACE_INSTANT(event, arg) exec_trace_record((event), EXEC_TRACE_KIND_INSTANT, (arg))
+#define EXEC_TRACE_TRIGGER() exec_trace_trigger()
+#else
+#define EXEC_TRACE_BEGIN(event) ((void)0)
+#define EXEC_TRACE_END(event) ((void)0)
+#define EXEC_TRACE_INSTANT(event, arg) ((void)(arg))
+#define EXEC_TRACE_TRIGGER() ((void)0)
+#endif
+
+/**
+ * @brief Prepara o anel e, com USB, registra a entrada na interrupção do USB
+ *
+ * Deve ser chamada depois de stdio_init_all().
+ */
+void exec_trace_init(void);
+
+/**
+ * @brief Registra um evento agora (use as macros EXEC_TRACE_*)
+ *
+ * Pode ser chamada de interrupção. Com o anel congelado, o evento só é
+ * contado como descartado.
+ */
+void exec_trace_record(exec_trace_event_t event, exec_trace_kind_t kind, uint32_t arg);
+
+/**
+ * @brief Congela o anel daqui a EXEC_TRACE_POST_TRIGGER eventos (use EXEC_TRACE_TRIGGER())
+ *
+ * Pode ser chamada de interrupção. Sem efeito se já houver um gatilho
+ * pendente ou uma janela esperando descarga.
+ */
+void exec_trace_trigger(void);
+
+/**
+ * @brief Indica se há uma janela congelada esperando exec_trace_pump()
+ */
+bool exec_trace_pending(void);
+
+/**
+ * @brief Escreve na saída padrão parte da janela congelada
+ *
+ * Escreve um evento por vez (cerca de 40 bytes), na vazão da serial, até
+ * a janela acabar ou o orçamento de tempo acabar; a chamada seguinte
+ * continua de onde esta parou. Escrito o último evento, o anel volta a
+ * gravar. O texto vai direto para a saída, fora da fila de reenvio: por
+ * isso environment-monitoring.c não compila com TELEMETRY_FORMAT_CBOR.
+ *
+ * @param budget_us Tempo máximo gasto na chamada
+ *
+ * @return Eventos escritos
+ */
+uint32_t exec_trace_pump(uint32_t budget_us);
+
+#endif // EXEC_TRACE_H
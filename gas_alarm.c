@@ -0,0 +1,106 @@
+/**
+ * @file gas_alarm.c
+ * @brief Implementação do alarme de gás avaliado na interrupção do DMA
+ */
+#include "gas_alarm.h"
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "adc_capture.h"
+#include "exec_trace.h"
+#include "latency_trace.h"
+
+/**
+ * @brief Estado do alarme (escrito apenas pela interrupção)
+ */
+typedef struct {
+    uint32_t relay_pin;
+    uint16_t threshold;
+    volatile bool armed;
+    volatile bool active;
+    gas_alarm_stats_t stats;
+} gas_alarm_state_t;
+
+static gas_alarm_state_t gas_alarm_state = {.threshold = GAS_ALARM_DEFAULT_THRESHOLD};
+
+int gas_alarm_init(uint32_t relay_pin, uint16_t threshold) {
+    gas_alarm_state.relay_pin = relay_pin;
+    gas_alarm_state.threshold = threshold;
+    gas_alarm_state.armed = true;
+    gas_alarm_state.active = false;
+    gpio_put(relay_pin, 0);
+    return GAS_ALARM_OK;
+}
+
+void gas_alarm_set_armed(bool armed) {
+    uint32_t irq = save_and_disable_interrupts();
+    gas_alarm_state.armed = armed;
+    if (!armed && gas_alarm_state.active) {
+        gpio_put(gas_alarm_state.relay_pin, 0);
+        gas_alarm_state.active = false;
+        __sev();
+        EXEC_TRACE_INSTANT(EXEC_TRACE_GAS_RELAY, 0);
+    }
+    restore_interrupts(irq);
+}
+
+void __not_in_flash_func(gas_alarm_on_block)(const uint16_t *samples, uint32_t end_us) {
+    // Sensor aquecendo ou com o aquecedor desligado: a leitura não vale
+    if (!gas_alarm_state.armed) return;
+
+    const uint16_t *mq2 = samples + ADC_CAPTURE_MQ2;
+    int first_above = -1;
+
+    for (int i = 0; i < ADC_CAPTURE_BLOCK_SAMPLES; i += ADC_CAPTURE_CHANNELS) {
+        if (mq2[i] > gas_alarm_state.threshold) {
+            first_above = i;
+            break;
+        }
+    }
+
+    if (first_above >= 0 && !gas_alarm_state.active) {
+        // O relé primeiro; o carimbo da amostra só serve à medida, depois
+        gpio_put(gas_alarm_state.relay_pin, 1);
+        uint32_t relay_us = time_us_32();
+
+        // A última amostra do bloco foi convertida por volta de end_us; só inteiros
+        // (o bloco é potência de dois), nada de ponto flutuante da flash na interrupção
+        uint32_t samples_after = ADC_CAPTURE_BLOCK_SAMPLES - 1 - (uint32_t)(first_above + ADC_CAPTURE_MQ2);
+        latency_stamp_t stamp =
+            latency_trace_stamp(end_us - samples_after * ADC_CAPTURE_BLOCK_US / ADC_CAPTURE_BLOCK_SAMPLES);
+        latency_trace_issue(LATENCY_RULE_GAS_RELAY, &stamp);
+        gas_alarm_state.active = true;
+        __sev();
+        EXEC_TRACE_INSTANT(EXEC_TRACE_GAS_RELAY, 1);
+        EXEC_TRACE_TRIGGER();
+
+        uint32_t latency = relay_us - stamp.acquired_us;
+
+        gas_alarm_state.stats.activations++;
+        gas_alarm_state.stats.last_latency_us = latency;
+        if (latency > gas_alarm_state.stats.max_latency_us) {
+            gas_alarm_state.stats.max_latency_us = latency;
+        }
+    } else if (first_above < 0 && gas_alarm_state.active) {
+        gpio_put(gas_alarm_state.relay_pin, 0);
+        gas_alarm_state.active = false;
+        __sev();
+        EXEC_TRACE_INSTANT(EXEC_TRACE_GAS_RELAY, 0);
+    }
+
+    uint32_t isr_us = time_us_32() - end_us;
+    if (isr_us > gas_alarm_state.stats.max_isr_us) {
+        gas_alarm_state.stats.max_isr_us = isr_us;
+    }
+}
+
+bool gas_alarm_is_active(void) {
+    return gas_alarm_state.active;
+}
+
+void gas_alarm_get_stats(gas_alarm_stats_t *stats) {
+    // Cópia consistente: a interrupção não roda durante a cópia
+    uint32_t irq = save_and_disable_interrupts();
+    *stats = gas_alarm_state.stats;
+    restore_interrupts(irq);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file gas_alarm.h
+ * @brief Alarme de gás de tempo real: limiar do MQ2 avaliado na interrupção do DMA
+ *
+ * O alarme é a função crítica de segurança do sistema, por isso não passa
+ * pelo laço principal: gas_alarm_on_block() é o callback de bloco de
+ * adc_capture e roda dentro da interrupção DMA_IRQ_0 (prioridade máxima).
+ * Leituras bloqueantes do DHT22 ou printf lentos não atrasam o relé.
+ *
+ * Regra de decisão por bloco:
+ * - liga o relé na primeira amostra do MQ2 acima do limiar;
+ * - desliga somente quando todas as amostras do bloco estão no limiar ou abaixo.
+ *
+ * Latência ADC -> relé: no pior caso, a amostra que cruza o limiar é a
+ * primeira do bloco, então o relé é acionado até ADC_CAPTURE_BLOCK_US
+ * (800 μs) mais a latência da interrupção após a conversão. A latência
+ * de cada acionamento é medida e disponibilizada em gas_alarm_stats_t.
+ *
+ * Cada mudança de estado também sinaliza um evento (__sev()), que
+ * acorda o laço principal se ele estiver esperando em
+ * best_effort_wfe_or_timeout().
+ *
+ * O alarme só avalia os blocos enquanto está armado: o aquecedor do MQ2
+ * (mq2_heater.h) o desarma enquanto as leituras não são confiáveis.
+ */
+#ifndef GAS_ALARM_H
+#define GAS_ALARM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GAS_ALARM_OK 0                      // Operação realizada com sucesso
+
+#define GAS_ALARM_DEFAULT_THRESHOLD 2000    // Limiar do MQ2 (código do ADC, corrigido da DNL)
+
+/**
+ * @brief Estatísticas de latência do alarme
+ *
+ * As latências vão da conversão estimada da primeira amostra acima do
+ * limiar até o gpio_put() do relé, em microssegundos.
+ */
+typedef struct {
+    uint32_t activations;           // Número de acionamentos do relé
+    uint32_t last_latency_us;       // Latência do último acionamento
+    uint32_t max_latency_us;        // Maior latência observada
+    uint32_t max_isr_us;            // Maior duração da avaliação do bloco
+} gas_alarm_stats_t;
+
+/**
+ * @brief Inicializa o alarme
+ *
+ * O pino do relé deve estar configurado como saída antes da chamada.
+ *
+ * @param relay_pin GPIO que aciona o relé
+ * @param threshold Limiar do MQ2 em código do ADC (corrigido da DNL, sem compensação)
+ *
+ * @return GAS_ALARM_OK
+ */
+int gas_alarm_init(uint32_t relay_pin, uint16_t threshold);
+
+/**
+ * @brief Arma ou desarma o alarme (armado depois de gas_alarm_init())
+ *
+ * Desarmado, os blocos são ignorados e, se o relé estava ligado, ele é
+ * desligado. Pode ser usada como mq2_heater_ready_fn.
+ */
+void gas_alarm_set_armed(bool armed);
+
+/**
+ * @brief Callback de bloco para adc_capture_init() (contexto de interrupção)
+ */
+void gas_alarm_on_block(const uint16_t *samples, uint32_t end_us);
+
+/**
+ * @brief Estado atual do relé do alarme
+ */
+bool gas_alarm_is_active(void);
+
+/**
+ * @brief Copia as estatísticas de latência
+ */
+void gas_alarm_get_stats(gas_alarm_stats_t *stats);
+
+#endif // GAS_ALARM_H
@@ -0,0 +1,119 @@
+/**
+ * @file adc_compensation_check.c
+ * @brief Confere a compensação em ponto fixo (adc_compensation.h) contra o cálculo em double
+ *
+ * Varre as médias possíveis do ADC4 e do ADC3 e, numa grade das duas,
+ * todos os códigos de cada sensor, comparando com as mesmas fórmulas
+ * em ponto flutuante:
+ * - temperatura do chip: 27 - (V - 0,706) / 0,001721, em toda a faixa
+ *   de -40 a 125 °C;
+ * - VSYS: 3 * V;
+ * - código compensado: código / (1 + ppm * 10^-6 * ΔT) * VSYS nominal /
+ *   VSYS, com os mesmos limites de temperatura e de VSYS do módulo.
+ * O alvo é compilado com os coeficientes nos extremos aceitos (±5000
+ * ppm/°C) e o MQ2 alimentado por VSYS, para que a varredura passe pelos
+ * maiores produtos intermediários e pelos dois tipos de alimentação.
+ *
+ * Imprime o maior erro de cada grandeza e sai com 1 se algum passar da
+ * tolerância: 5 m°C, 1 mV e 1 código.
+ *
+ * Uso:
+ * @code
+ * adc_compensation_check
+ * @endcode
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "adc_compensation.h"
+
+#define CHECK_DIE_TOLERANCE_MC 5.0
+#define CHECK_VSYS_TOLERANCE_MV 1.0
+#define CHECK_CODE_TOLERANCE 1.0
+#define CHECK_Q4_FULL_SCALE (ADC_COMPENSATION_FULL_SCALE * 16)
+
+static const struct {
+    const char *name;
+    double ppm_per_c;
+    bool vsys;
+} sensors[ADC_COMPENSATION_SENSORS] = {
+    {"LDR", ADC_COMPENSATION_LDR_PPM_PER_C, ADC_COMPENSATION_LDR_SUPPLY == ADC_COMPENSATION_SUPPLY_VSYS},
+    {"MQ2", ADC_COMPENSATION_MQ2_PPM_PER_C, ADC_COMPENSATION_MQ2_SUPPLY == ADC_COMPENSATION_SUPPLY_VSYS},
+};
+
+static double q4_to_volts(uint32_t q4) {
+    return q4 / 16.0 * (ADC_COMPENSATION_VREF_MV / 1000.0) / ADC_COMPENSATION_FULL_SCALE;
+}
+
+static double die_reference_c(uint32_t temp_q4) {
+    return 27.0 - (q4_to_volts(temp_q4) - ADC_COMPENSATION_TEMP_27C_UV / 1e6) / (ADC_COMPENSATION_TEMP_SLOPE_UV / 1e6);
+}
+
+static double clamp(double v, double lo, double hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+int main(void) {
+    // Médias do ADC4 que cobrem a faixa de operação, com folga para os limites
+    uint32_t temp_lo = CHECK_Q4_FULL_SCALE, temp_hi = 0;
+    double die_error = 0.0;
+    for (uint32_t q4 = 1; q4 <= CHECK_Q4_FULL_SCALE; q4++) {
+        double ref_c = die_reference_c(q4);
+        if (ref_c < ADC_COMPENSATION_MIN_MC / 1000.0 - 10.0 || ref_c > ADC_COMPENSATION_MAX_MC / 1000.0 + 10.0) {
+            continue;
+        }
+        if (q4 < temp_lo) temp_lo = q4;
+        if (q4 > temp_hi) temp_hi = q4;
+        double error = fabs(adc_compensation_die_mc(q4) - ref_c * 1000.0);
+        if (error > die_error) die_error = error;
+    }
+
+    double vsys_error = 0.0;
+    for (uint32_t q4 = 0; q4 <= CHECK_Q4_FULL_SCALE; q4++) {
+        double ref_mv = q4_to_volts(q4) * ADC_COMPENSATION_VSYS_DIVIDER * 1000.0;
+        double error = fabs(adc_compensation_vsys_mv(q4) - ref_mv);
+        if (error > vsys_error) vsys_error = error;
+    }
+
+    double code_error[ADC_COMPENSATION_SENSORS] = {0};
+    double worst_die_c[ADC_COMPENSATION_SENSORS] = {0}, worst_vsys_v[ADC_COMPENSATION_SENSORS] = {0};
+    long compared = 0;
+    for (uint32_t temp_q4 = temp_lo; temp_q4 <= temp_hi; temp_q4 += 3) {
+        double dt = clamp(die_reference_c(temp_q4), ADC_COMPENSATION_MIN_MC / 1000.0, ADC_COMPENSATION_MAX_MC / 1000.0) -
+                    ADC_COMPENSATION_REF_MC / 1000.0;
+        for (uint32_t vsys_q4 = 16; vsys_q4 <= CHECK_Q4_FULL_SCALE; vsys_q4 += 61) {
+            adc_compensation_t comp;
+            adc_compensation_update(&comp, temp_q4, vsys_q4);
+            double nominal_v = ADC_COMPENSATION_VSYS_NOMINAL_MV / 1000.0;
+            double vsys_v = clamp(q4_to_volts(vsys_q4) * ADC_COMPENSATION_VSYS_DIVIDER, nominal_v / 2, nominal_v * 2);
+
+            for (int s = 0; s < ADC_COMPENSATION_SENSORS; s++) {
+                double gain = 1.0 / (1.0 + sensors[s].ppm_per_c * 1e-6 * dt);
+                if (sensors[s].vsys) gain *= nominal_v / vsys_v;
+                for (uint32_t code = 0; code <= ADC_COMPENSATION_FULL_SCALE; code += 13) {
+                    double ref = fmin(code * gain, ADC_COMPENSATION_FULL_SCALE);
+                    double error = fabs(adc_compensation_apply(&comp, (adc_compensation_sensor_t)s, code) - ref);
+                    if (error > code_error[s]) {
+                        code_error[s] = error;
+                        worst_die_c[s] = dt + ADC_COMPENSATION_REF_MC / 1000.0;
+                        worst_vsys_v[s] = vsys_v;
+                    }
+                    compared++;
+                }
+            }
+        }
+    }
+
+    bool ok = die_error <= CHECK_DIE_TOLERANCE_MC && vsys_error <= CHECK_VSYS_TOLERANCE_MV;
+    printf("temperatura do chip: erro máximo %.2f m°C (tolerância %.0f)\n", die_error, CHECK_DIE_TOLERANCE_MC);
+    printf("VSYS: erro máximo %.3f mV (tolerância %.0f)\n", vsys_error, CHECK_VSYS_TOLERANCE_MV);
+    for (int s = 0; s < ADC_COMPENSATION_SENSORS; s++) {
+        ok = ok && code_error[s] <= CHECK_CODE_TOLERANCE;
+        printf("%s (%+.0f ppm/°C, %s): erro máximo %.3f códigos (tolerância %.0f), pior caso a %.1f °C e %.2f V\n",
+               sensors[s].name, sensors[s].ppm_per_c, sensors[s].vsys ? "VSYS" : "3,3 V", code_error[s],
+               CHECK_CODE_TOLERANCE, worst_die_c[s], worst_vsys_v[s]);
+    }
+    printf("%ld códigos comparados: %s\n", compared, ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
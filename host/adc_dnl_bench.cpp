@@ -0,0 +1,238 @@
+/**
+ * @file adc_dnl_bench.cpp
+ * @brief Erro do ADC com e sem a correção da DNL (adc_dnl.h) e custo da correção por bloco
+ *
+ * Precisão: cada curva de transferência simulada dá a largura de cada
+ * código; a entrada varre a faixa em passos de 1/16 de LSB e o código
+ * de saída é comparado com o centro ideal (entrada - 1/2 LSB), antes da
+ * correção, com a tabela do modelo nominal e com a tabela calibrada a
+ * partir do histograma de uma rampa simulada com ruído, como faz
+ * adc_dnl_calibrate.c na placa. As curvas:
+ * - ideal: todos os códigos com 1 LSB;
+ * - nominal: os quatro códigos largos com 1 + ADC_DNL_SPIKE_LSB, a mesma
+ *   curva do modelo da tabela e da simulação (sim_set_adc_dnl);
+ * - placas simuladas: códigos largos de outras larguras e uma DNL
+ *   aleatória em todos os códigos.
+ * Para cada uma, imprime o maior erro e o RMS em LSB, e o erro na
+ * entrada em que a leitura passa de LDR_THRESHOLD (1500) e do limiar do
+ * alarme de gás, em LSB.
+ *
+ * Vazão: adc_dnl_correct_block() sobre blocos de ADC_CAPTURE_BLOCK_SAMPLES
+ * amostras, ao lado de uma tabela de uint16_t com o código corrigido
+ * (8 kB em vez de 4 kB). No RP2040, os ciclos por bloco saem na serial
+ * de adc_dnl_calibrate.c.
+ *
+ * Uso:
+ * @code
+ * adc_dnl_bench [blocos]
+ * @endcode
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+extern "C" {
+#include "adc_capture.h"
+#include "adc_dnl.h"
+#include "gas_alarm.h"
+}
+
+#define BENCH_LDR_THRESHOLD 1500            // LDR_THRESHOLD de environment-monitoring.c
+#define BENCH_STEPS_PER_LSB 16              // Resolução da varredura da entrada
+#define BENCH_RAMP_SAMPLES (4096u * 1024u)  // Mesma captura de adc_dnl_calibrate.c
+#define BENCH_RAMP_NOISE_LSB 0.3            // Ruído RMS na entrada durante a rampa
+
+using bench_clock = std::chrono::steady_clock;
+
+static volatile uint32_t bench_sink;  // Impede que o compilador descarte as correções
+
+static uint64_t cycles_now() {
+#if BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static uint32_t rng = 12345;
+
+static double next_uniform() {
+    rng = rng * 1664525u + 1013904223u;
+    return ((rng >> 8) + 0.5) / 16777216.0;
+}
+
+static double next_gaussian() {
+    return std::sqrt(-2.0 * std::log(next_uniform())) * std::cos(2.0 * M_PI * next_uniform());
+}
+
+/**
+ * @brief Curva de transferência: início de cada código na escala da entrada (LSB)
+ */
+struct Curve {
+    const char *name;
+    std::vector<double> start;      // ADC_DNL_CODES + 1 bordas
+
+    // Larguras dos códigos 1 a 4094 normalizadas para 4094 LSB, 0 e 4095 com 1 LSB
+    Curve(const char *curve_name, std::vector<double> widths) : name(curve_name), start(ADC_DNL_CODES + 1) {
+        double interior = 0;
+        for (int k = 1; k < ADC_DNL_CODES - 1; k++) interior += widths[k];
+        start[0] = 0;
+        start[1] = 1;
+        for (int k = 1; k < ADC_DNL_CODES - 1; k++) start[k + 1] = start[k] + widths[k] * (ADC_DNL_CODES - 2) / interior;
+        start[ADC_DNL_CODES] = ADC_DNL_CODES;
+    }
+
+    uint16_t convert(double x) const {
+        if (x < start[1]) return 0;
+        if (x >= start[ADC_DNL_CODES - 1]) return ADC_DNL_CODES - 1;
+        int lo = 1, hi = ADC_DNL_CODES - 1;     // start[lo] <= x < start[hi]
+        while (hi - lo > 1) {
+            int mid = (lo + hi) / 2;
+            (x < start[mid] ? hi : lo) = mid;
+        }
+        return (uint16_t)lo;
+    }
+};
+
+static std::vector<double> spike_widths(const double extra[4], double dnl_rms) {
+    std::vector<double> widths(ADC_DNL_CODES, 1.0);
+    for (int k = 1; k < ADC_DNL_CODES - 1; k++) {
+        if (adc_dnl_is_spike(k)) widths[k] += extra[k / ADC_DNL_SPIKE_PERIOD];
+        else widths[k] = std::fmax(widths[k] + dnl_rms * next_gaussian(), 0.05);
+    }
+    return widths;
+}
+
+struct Error {
+    double max_lsb = 0;
+    double rms_lsb = 0;
+    double ldr_lsb = 0;             // Erro da entrada que passa de LDR_THRESHOLD
+    double mq2_lsb = 0;             // Erro da entrada que passa do limiar do alarme
+};
+
+// Erro da leitura (corrigida por correct) contra o centro ideal, em toda a faixa
+template <typename F>
+static Error measure_error(const Curve &curve, F &&correct) {
+    Error e;
+    double sum2 = 0;
+    double ldr_cross = -1, mq2_cross = -1;
+    long steps = 0;
+    for (long i = BENCH_STEPS_PER_LSB / 2; i < (long)ADC_DNL_CODES * BENCH_STEPS_PER_LSB; i++, steps++) {
+        double x = (i + 0.5) / BENCH_STEPS_PER_LSB;
+        int out = correct(curve.convert(x));
+        double err = out - (x - 0.5);
+        if (x > 1.0 && x < ADC_DNL_CODES - 1) e.max_lsb = std::fmax(e.max_lsb, std::fabs(err));
+        sum2 += err * err;
+        if (ldr_cross < 0 && out > BENCH_LDR_THRESHOLD) ldr_cross = x;
+        if (mq2_cross < 0 && out > GAS_ALARM_DEFAULT_THRESHOLD) mq2_cross = x;
+    }
+    e.rms_lsb = std::sqrt(sum2 / steps);
+    // Num ADC ideal, a leitura passa do limiar T com a entrada em T + 1
+    e.ldr_lsb = ldr_cross - (BENCH_LDR_THRESHOLD + 1);
+    e.mq2_lsb = mq2_cross - (GAS_ALARM_DEFAULT_THRESHOLD + 1);
+    return e;
+}
+
+// Histograma de uma rampa lenta de -8 a 4104 LSB com ruído, como na calibração na placa
+static std::vector<uint32_t> ramp_histogram(const Curve &curve) {
+    std::vector<uint32_t> histogram(ADC_DNL_CODES);
+    for (uint32_t i = 0; i < BENCH_RAMP_SAMPLES; i++) {
+        double x = -8.0 + (ADC_DNL_CODES + 16.0) * i / BENCH_RAMP_SAMPLES;
+        histogram[curve.convert(x + BENCH_RAMP_NOISE_LSB * next_gaussian())]++;
+    }
+    return histogram;
+}
+
+static void print_error(const char *label, const Error &e) {
+    std::printf("  %-10s %9.2f %9.2f %+10.2f %+10.2f\n", label, e.max_lsb, e.rms_lsb, e.ldr_lsb, e.mq2_lsb);
+}
+
+struct Throughput {
+    double ns_per_block;
+    double cycles_per_block;
+};
+
+template <typename F>
+static Throughput measure_blocks(std::vector<uint16_t> &samples, size_t blocks, F &&correct_block) {
+    size_t per_pass = samples.size() / ADC_CAPTURE_BLOCK_SAMPLES;
+    auto start = bench_clock::now();
+    uint64_t c0 = cycles_now();
+    for (size_t b = 0; b < blocks; b++) {
+        correct_block(&samples[(b % per_pass) * ADC_CAPTURE_BLOCK_SAMPLES]);
+    }
+    uint64_t c1 = cycles_now();
+    double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    bench_sink = samples[blocks % samples.size()];
+    return {ns / blocks, (double)(c1 - c0) / blocks};
+}
+
+int main(int argc, char **argv) {
+    size_t blocks = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 4000000;
+
+    static const double nominal[4] = {ADC_DNL_SPIKE_LSB, ADC_DNL_SPIKE_LSB, ADC_DNL_SPIKE_LSB, ADC_DNL_SPIKE_LSB};
+    static const double zero[4] = {0, 0, 0, 0};
+    static const double board_a[4] = {6.5, 9.2, 7.1, 10.3};
+    static const double board_b[4] = {3.0, 4.5, 2.5, 5.0};
+    std::vector<Curve> curves;
+    curves.emplace_back("ideal", spike_widths(zero, 0.0));
+    curves.emplace_back("nominal", spike_widths(nominal, 0.0));
+    curves.emplace_back("placa A (DNL 0,1 LSB)", spike_widths(board_a, 0.1));
+    curves.emplace_back("placa B (DNL 0,2 LSB)", spike_widths(board_b, 0.2));
+
+    std::printf("erro da leitura em LSB (1 LSB = %.3f mV); limiares: LDR %d, alarme de gás %d\n", 3300.0 / 4096,
+                BENCH_LDR_THRESHOLD, GAS_ALARM_DEFAULT_THRESHOLD);
+    std::printf("  %-10s %9s %9s %10s %10s\n", "", "máximo", "RMS", "LDR", "MQ2");
+    for (const Curve &curve : curves) {
+        std::printf("%s\n", curve.name);
+        print_error("bruto", measure_error(curve, [](uint16_t code) { return (int)code; }));
+        adc_dnl_init();
+        print_error("nominal", measure_error(curve, [](uint16_t code) { return (int)adc_dnl_correct(code); }));
+        std::vector<uint32_t> histogram = ramp_histogram(curve);
+        int status = adc_dnl_build(histogram.data());
+        if (status != ADC_DNL_OK) {
+            std::fprintf(stderr, "%s: histograma recusado (%d)\n", curve.name, status);
+            return 1;
+        }
+        print_error("calibrado", measure_error(curve, [](uint16_t code) { return (int)adc_dnl_correct(code); }));
+    }
+
+    // Vazão: 64 kB de amostras (cabem na cache, como o bloco recém-escrito pelo DMA no RP2040)
+    adc_dnl_init();
+    std::vector<uint16_t> samples(32768);
+    for (uint16_t &s : samples) s = (uint16_t)(next_uniform() * ADC_DNL_CODES);
+    std::vector<uint16_t> map(ADC_DNL_CODES);
+    for (int k = 0; k < ADC_DNL_CODES; k++) map[k] = adc_dnl_correct((uint16_t)k);
+
+    // Cada correção volta a um código válido: aplicadas em sequência, medem o mesmo trabalho
+    Throughput offsets = measure_blocks(samples, blocks, [](uint16_t *block) {
+        adc_dnl_correct_block(block, ADC_CAPTURE_BLOCK_SAMPLES);
+    });
+    Throughput full = measure_blocks(samples, blocks, [&map](uint16_t *block) {
+        for (int i = 0; i < ADC_CAPTURE_BLOCK_SAMPLES; i++) block[i] = map[block[i] & (ADC_DNL_CODES - 1)];
+    });
+
+    std::printf("\ncorreção de %zu blocos de %d amostras\n", blocks, ADC_CAPTURE_BLOCK_SAMPLES);
+    std::printf("  %-26s %10s %12s", "", "ns/bloco", "Mamostras/s");
+    if (BENCH_HAS_TSC) std::printf(" %13s", "ciclos/bloco");
+    std::printf("\n");
+    const struct {
+        const char *name;
+        Throughput t;
+    } rows[] = {{"deslocamentos int8_t (4 kB)", offsets}, {"códigos uint16_t (8 kB)", full}};
+    for (const auto &row : rows) {
+        std::printf("  %-26s %10.1f %12.0f", row.name, row.t.ns_per_block,
+                    ADC_CAPTURE_BLOCK_SAMPLES * 1e3 / row.t.ns_per_block);
+        if (BENCH_HAS_TSC) std::printf(" %13.0f", row.t.cycles_per_block);
+        std::printf("\n");
+    }
+    return 0;
+}
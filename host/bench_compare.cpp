@@ -0,0 +1,320 @@
+/**
+ * @file bench_compare.cpp
+ * @brief Compara dois resultados de bench_runner e aponta regressões significativas
+ *
+ * Para cada caso presente na linha de base e no resultado atual, compara
+ * as rodadas (trial_ns) pelo teste t de Welch, unilateral: o caso regrediu
+ * se ficou mais lento que o limiar relativo e a probabilidade de uma
+ * diferença desse tamanho surgir só do ruído entre rodadas é menor que
+ * alfa. Melhoras significativas também são listadas. Casos que só
+ * existem de um lado são mostrados, mas não contam como regressão.
+ *
+ * Uso:
+ * @code
+ * bench_compare linha_de_base.json atual.json [--threshold pct] [--alpha a]
+ * @endcode
+ *
+ * Padrões: limiar de 5% e alfa de 0,01. Termina com código 1 se algum
+ * caso regrediu, 2 em erro de uso ou de leitura.
+ */
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+struct CaseResult {
+    double ns = 0;
+    double bytes = 0;
+    std::vector<double> trial_ns;
+};
+
+/**
+ * @brief Leitor mínimo de JSON, suficiente para o formato de bench_suite.h
+ *
+ * Percorre qualquer JSON válido, mas só guarda, de cada objeto de
+ * "results", os campos name, ns, bytes e trial_ns.
+ */
+class ResultReader {
+public:
+    explicit ResultReader(const std::string &text) : p_(text.c_str()), end_(p_ + text.size()) {}
+
+    bool read(std::map<std::string, CaseResult> &out) {
+        out_ = &out;
+        skip_ws();
+        bool ok = value("");
+        skip_ws();
+        return ok && p_ == end_;
+    }
+
+private:
+    void skip_ws() {
+        while (p_ < end_ && std::isspace((unsigned char)*p_)) p_++;
+    }
+
+    bool string(std::string &s) {
+        if (p_ >= end_ || *p_ != '"') return false;
+        for (p_++; p_ < end_ && *p_ != '"'; p_++) {
+            if (*p_ == '\\' && p_ + 1 < end_) p_++;
+            s += *p_;
+        }
+        if (p_ >= end_) return false;
+        p_++;
+        return true;
+    }
+
+    bool number(double &v) {
+        char *next;
+        v = std::strtod(p_, &next);
+        if (next == p_) return false;
+        p_ = next;
+        return true;
+    }
+
+    // key: chave do valor no objeto pai, para reconhecer os campos de interesse
+    bool value(const std::string &key) {
+        skip_ws();
+        if (p_ >= end_) return false;
+        if (*p_ == '{') return object();
+        if (*p_ == '[') return array(key);
+        if (*p_ == '"') {
+            std::string s;
+            if (!string(s)) return false;
+            if (key == "name" && depth_result_) current_name_ = s;
+            return true;
+        }
+        for (const char *word : {"true", "false", "null"}) {
+            size_t len = std::strlen(word);
+            if ((size_t)(end_ - p_) >= len && !std::strncmp(p_, word, len)) {
+                p_ += len;
+                return true;
+            }
+        }
+        double v;
+        if (!number(v)) return false;
+        if (depth_result_) {
+            if (key == "ns") current_.ns = v;
+            else if (key == "bytes") current_.bytes = v;
+            else if (key == "trial_ns") current_.trial_ns.push_back(v);
+        }
+        return true;
+    }
+
+    bool object() {
+        bool is_result = in_results_ && !depth_result_;
+        if (is_result) {
+            depth_result_ = true;
+            current_ = CaseResult();
+            current_name_.clear();
+        }
+        p_++;
+        skip_ws();
+        bool first = true;
+        while (p_ < end_ && *p_ != '}') {
+            if (!first) {
+                if (*p_ != ',') return false;
+                p_++;
+                skip_ws();
+            }
+            first = false;
+            std::string key;
+            if (!string(key)) return false;
+            skip_ws();
+            if (p_ >= end_ || *p_ != ':') return false;
+            p_++;
+            if (!value(key)) return false;
+            skip_ws();
+        }
+        if (p_ >= end_) return false;
+        p_++;
+        if (is_result) {
+            depth_result_ = false;
+            if (!current_name_.empty()) (*out_)[current_name_] = current_;
+        }
+        return true;
+    }
+
+    bool array(const std::string &key) {
+        bool results = key == "results" && !depth_result_;
+        if (results) in_results_ = true;
+        p_++;
+        skip_ws();
+        bool first = true;
+        while (p_ < end_ && *p_ != ']') {
+            if (!first) {
+                if (*p_ != ',') return false;
+                p_++;
+                skip_ws();
+            }
+            first = false;
+            // Os elementos de trial_ns chegam a value() com a chave do array
+            if (!value(depth_result_ ? key : "")) return false;
+            skip_ws();
+        }
+        if (p_ >= end_) return false;
+        p_++;
+        if (results) in_results_ = false;
+        return true;
+    }
+
+    const char *p_;
+    const char *end_;
+    std::map<std::string, CaseResult> *out_ = nullptr;
+    bool in_results_ = false;
+    bool depth_result_ = false;
+    CaseResult current_;
+    std::string current_name_;
+};
+
+static bool load(const char *path, std::map<std::string, CaseResult> &out) {
+    FILE *f = std::fopen(path, "rb");
+    if (!f) {
+        std::perror(path);
+        return false;
+    }
+    std::string text;
+    char buf[65536];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    std::fclose(f);
+    if (!ResultReader(text).read(out)) {
+        std::fprintf(stderr, "%s: JSON inválido\n", path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Função beta incompleta regularizada I_x(a, b), por fração contínua
+ */
+static double incomplete_beta(double a, double b, double x) {
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+    if (x > (a + 1) / (a + b + 2)) return 1 - incomplete_beta(b, a, 1 - x);
+
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) +
+                            b * std::log(1 - x)) / a;
+    // Algoritmo de Lentz
+    const double tiny = 1e-300;
+    double f = 1, c = 1, d = 0;
+    for (int i = 0; i <= 400; i++) {
+        int m = i / 2;
+        double numerator;
+        if (i == 0) {
+            numerator = 1;
+        } else if (i % 2 == 0) {
+            numerator = (m * (b - m) * x) / ((a + 2 * m - 1) * (a + 2 * m));
+        } else {
+            numerator = -((a + m) * (a + b + m) * x) / ((a + 2 * m) * (a + 2 * m + 1));
+        }
+        d = 1 + numerator * d;
+        if (std::fabs(d) < tiny) d = tiny;
+        d = 1 / d;
+        c = 1 + numerator / c;
+        if (std::fabs(c) < tiny) c = tiny;
+        double cd = c * d;
+        f *= cd;
+        if (std::fabs(1 - cd) < 1e-12) break;
+    }
+    return front * (f - 1);
+}
+
+struct Welch {
+    double t;
+    double df;
+    double p_slower;    // P(diferença >= observada | médias iguais), unilateral
+};
+
+static double mean(const std::vector<double> &v) {
+    double s = 0;
+    for (double x : v) s += x;
+    return s / v.size();
+}
+
+static double variance(const std::vector<double> &v, double m) {
+    double s = 0;
+    for (double x : v) s += (x - m) * (x - m);
+    return v.size() > 1 ? s / (v.size() - 1) : 0;
+}
+
+static Welch welch(const std::vector<double> &base, const std::vector<double> &current) {
+    double mb = mean(base), mc = mean(current);
+    double vb = variance(base, mb) / base.size(), vc = variance(current, mc) / current.size();
+    double se = std::sqrt(vb + vc);
+    if (se == 0) return {0, 1, mc > mb ? 0.0 : 1.0};
+    double t = (mc - mb) / se;
+    double df = (vb + vc) * (vb + vc) /
+                (vb * vb / (base.size() - 1) + vc * vc / (current.size() - 1));
+    // Cauda superior da t de Student: I_{df/(df+t²)}(df/2, 1/2) / 2
+    double tail = 0.5 * incomplete_beta(df / 2, 0.5, df / (df + t * t));
+    return {t, df, t > 0 ? tail : 1 - tail};
+}
+
+int main(int argc, char **argv) {
+    const char *paths[2] = {nullptr, nullptr};
+    int npaths = 0;
+    double threshold = 5.0, alpha = 0.01;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--threshold") && i + 1 < argc) {
+            threshold = std::strtod(argv[++i], nullptr);
+        } else if (!std::strcmp(argv[i], "--alpha") && i + 1 < argc) {
+            alpha = std::strtod(argv[++i], nullptr);
+        } else if (npaths < 2 && argv[i][0] != '-') {
+            paths[npaths++] = argv[i];
+        } else {
+            npaths = -1;
+            break;
+        }
+    }
+    if (npaths != 2) {
+        std::fprintf(stderr, "uso: %s linha_de_base.json atual.json [--threshold pct] [--alpha a]\n", argv[0]);
+        return 2;
+    }
+
+    std::map<std::string, CaseResult> base, current;
+    if (!load(paths[0], base) || !load(paths[1], current)) return 2;
+
+    int regressions = 0, improvements = 0;
+    std::printf("%-32s %12s %12s %9s %9s  %s\n", "caso", "base ns/op", "atual ns/op", "variação", "p", "");
+    for (const auto &entry : current) {
+        const std::string &name = entry.first;
+        const CaseResult &cur = entry.second;
+        auto it = base.find(name);
+        if (it == base.end()) {
+            std::printf("%-32s %12s %12.2f %9s %9s  novo\n", name.c_str(), "-", cur.ns, "-", "-");
+            continue;
+        }
+        const CaseResult &old = it->second;
+        if (old.trial_ns.size() < 2 || cur.trial_ns.size() < 2) {
+            std::printf("%-32s %12.2f %12.2f %9s %9s  sem rodadas\n", name.c_str(), old.ns, cur.ns, "-", "-");
+            continue;
+        }
+
+        double change = 100.0 * (cur.ns - old.ns) / old.ns;
+        Welch w = welch(old.trial_ns, cur.trial_ns);
+        double p_faster = 1 - w.p_slower;
+        const char *verdict = "";
+        if (change > threshold && w.p_slower < alpha) {
+            verdict = "REGRESSÃO";
+            regressions++;
+        } else if (change < -threshold && p_faster < alpha) {
+            verdict = "melhora";
+            improvements++;
+        }
+        double p = change >= 0 ? w.p_slower : p_faster;
+        std::printf("%-32s %12.2f %12.2f %+8.1f%% %9.2g  %s", name.c_str(), old.ns, cur.ns, change, p, verdict);
+        if (old.bytes != cur.bytes) std::printf(" (bytes/op %.1f -> %.1f)", old.bytes, cur.bytes);
+        std::printf("\n");
+    }
+    for (const auto &entry : base) {
+        if (!current.count(entry.first)) {
+            std::printf("%-32s %12.2f %12s %9s %9s  removido\n", entry.first.c_str(), entry.second.ns, "-", "-", "-");
+        }
+    }
+
+    std::printf("%d regressões, %d melhoras (limiar %.1f%%, alfa %g)\n", regressions, improvements, threshold, alpha);
+    return regressions ? 1 : 0;
+}
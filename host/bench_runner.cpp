@@ -0,0 +1,319 @@
+/**
+ * @file bench_runner.cpp
+ * @brief Benchmarks do firmware no host, com resultado em JSON para comparação
+ *
+ * Reúne os caminhos medidos pelos benchmarks avulsos (dht22_decode_bench,
+ * running_median_bench, telemetry_bench, sensor_registry_bench,
+ * block_pool_bench, sensor_pipeline_bench, adc_dnl_bench) numa única execução de
+ * bench_suite.h, com várias rodadas por caso, e grava o JSON que
+ * bench_compare compara com uma linha de base. Os nomes dos
+ * casos são estáveis: renomear um caso o faz sumir da comparação.
+ *
+ * Uso:
+ * @code
+ * bench_runner [-o resultado.json] [--label texto] [--filter prefixo] [--trials n] [--min-ms ms]
+ * @endcode
+ *
+ * Sem -o, o JSON sai em stdout; o resumo legível sai sempre em stderr.
+ * O alvo "bench" do CMake roda este programa e grava bench-results.json
+ * na pasta de build.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench_suite.h"
+#include "sensor_pipeline.h"
+
+extern "C" {
+#include "adaptive_sampler.h"
+#include "adc_capture.h"
+#include "adc_dnl.h"
+#include "block_pool.h"
+#include "dht22.h"
+#include "dht22_frame.h"
+#include "gas_alarm.h"
+#include "running_median.h"
+#include "sensor_registry.h"
+#include "telemetry.h"
+#include "telemetry_cbor.h"
+#include "telemetry_ring.h"
+}
+
+#define RUNNER_FRAMES 4096          // Potência de 2
+#define RUNNER_SAMPLES 4096         // Potência de 2
+#define RUNNER_BATCH_SAMPLES 8      // Amostras por lote CBOR, como no firmware
+
+static volatile uint64_t bench_sink;   // Impede que o compilador descarte os resultados
+
+static uint32_t rng = 12345;
+
+static uint32_t next_random() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+struct Frame {
+    uint8_t widths[DHT22_FRAME_BITS];
+};
+
+// Mesmos quadros de dht22_decode_bench: 1/16 com checksum errado, 1/16 fora de faixa
+static std::vector<Frame> make_frames() {
+    std::vector<Frame> frames(RUNNER_FRAMES);
+    for (size_t f = 0; f < frames.size(); f++) {
+        uint16_t h10 = (uint16_t)(next_random() % 1001);
+        int t10 = (int)(next_random() % 1201) - 400;
+        if (f % 16 == 5) h10 = 1200;
+        uint16_t raw = (uint16_t)(t10 < 0 ? (0x8000 | -t10) : t10);
+        uint8_t data[5] = {(uint8_t)(h10 >> 8), (uint8_t)h10, (uint8_t)(raw >> 8), (uint8_t)raw, 0};
+        data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3] + (f % 16 == 9));
+        for (int i = 0; i < DHT22_FRAME_BITS; i++) {
+            bool bit = data[i / 8] & (1 << (7 - i % 8));
+            frames[f].widths[i] = (uint8_t)((bit ? 70 : 26) + (int)(next_random() % 13) - 6);
+        }
+    }
+    return frames;
+}
+
+// Código de ADC com ruído e 1/32 de picos, como o do MQ2
+static std::vector<int32_t> make_adc_signal() {
+    std::vector<int32_t> signal(RUNNER_SAMPLES);
+    for (size_t i = 0; i < signal.size(); i++) {
+        int32_t v = 2048 + (int32_t)(i % 256) * 4 + (int32_t)(next_random() % 31) - 15;
+        if (next_random() % 32 == 0) v = (next_random() & 1) ? 4095 : 0;
+        signal[i] = v;
+    }
+    return signal;
+}
+
+// Mesmas amostras de telemetry_bench
+static std::vector<telemetry_sample_t> make_samples() {
+    std::vector<telemetry_sample_t> samples(RUNNER_SAMPLES);
+    for (size_t i = 0; i < samples.size(); i++) {
+        telemetry_sample_t &s = samples[i];
+        s.dht22_result = i % 97 == 0 ? -2 : 0;
+        s.temperature = 15.0f + (float)(i % 300) / 10.0f;
+        s.humidity = 30.0f + (float)(i % 500) / 10.0f;
+        s.ldr_raw = (uint16_t)((i * 37) % 4096);
+        s.mq2_raw = (uint16_t)(300 + (i * 11) % 1900);
+        s.gas_alarm = i % 1000 < 10;
+    }
+    return samples;
+}
+
+static void add_dht22_cases(BenchSuite &suite, const std::vector<Frame> &frames) {
+    struct Backend {
+        const char *name;
+        dht22_decoder_t decode;
+    };
+    static const Backend backends[] = {{"table", dht22_frame_decode}, {"bitwise", dht22_frame_decode_bitwise}};
+    for (const Backend &b : backends) {
+        dht22_decoder_t decode = b.decode;
+        suite.add(std::string("dht22_frame/") + b.name, [&frames, decode](size_t n) {
+            float t = 0, h = 0;
+            int acc = 0;
+            for (size_t i = 0; i < n; i++) acc += decode(frames[i & (RUNNER_FRAMES - 1)].widths, &t, &h);
+            bench_sink = (uint64_t)(acc + (int)t + (int)h);
+            return (uint64_t)0;
+        });
+    }
+}
+
+static void add_median_cases(BenchSuite &suite, const std::vector<int32_t> &signal) {
+    static const int windows[] = {3, 31, 255};
+    for (int w : windows) {
+        suite.add("running_median/w" + std::to_string(w), [&signal, w](size_t n) {
+            static running_median_t m;
+            running_median_init(&m, (uint8_t)w);
+            int64_t acc = 0;
+            for (size_t i = 0; i < n; i++) acc += running_median_push(&m, signal[i & (RUNNER_SAMPLES - 1)]);
+            bench_sink = (uint64_t)acc;
+            return (uint64_t)0;
+        });
+    }
+}
+
+// Correção da DNL de um bloco de captura e cadeia do MQ2 (mediana de 3 e regra do
+// alarme por bloco) em C e em sensor_pipeline.h
+static void add_pipeline_cases(BenchSuite &suite, const std::vector<int32_t> &signal) {
+    static_assert(RUNNER_SAMPLES % ADC_CAPTURE_BLOCK_SAMPLES == 0, "o sinal deve ter blocos inteiros");
+    suite.add("adc_dnl/correct_block", [&signal](size_t n) {
+        adc_dnl_init();
+        uint16_t block[ADC_CAPTURE_BLOCK_SAMPLES];
+        uint64_t acc = 0;
+        for (size_t b = 0; b < n; b++) {
+            size_t base = b * ADC_CAPTURE_BLOCK_SAMPLES & (RUNNER_SAMPLES - 1);
+            for (int i = 0; i < ADC_CAPTURE_BLOCK_SAMPLES; i++) block[i] = (uint16_t)signal[base + i];
+            adc_dnl_correct_block(block, ADC_CAPTURE_BLOCK_SAMPLES);
+            acc += block[b & (ADC_CAPTURE_BLOCK_SAMPLES - 1)];
+        }
+        bench_sink = acc;
+        return (uint64_t)0;
+    });
+    suite.add("sensor_pipeline/mq2_c", [&signal](size_t n) {
+        static running_median_t m;
+        running_median_init(&m, 3);
+        uint16_t block[ADC_CAPTURE_BLOCK_SAMPLES];
+        bool active = false;
+        uint64_t changes = 0;
+        for (size_t b = 0; b < n; b++) {
+            size_t base = b * ADC_CAPTURE_BLOCK_SAMPLES & (RUNNER_SAMPLES - 1);
+            for (int i = 0; i < ADC_CAPTURE_BLOCK_SAMPLES; i++) block[i] = (uint16_t)signal[base + i];
+            bool above = false;
+            for (int i = ADC_CAPTURE_MQ2; i < ADC_CAPTURE_BLOCK_SAMPLES; i += ADC_CAPTURE_CHANNELS) {
+                above |= running_median_push(&m, block[i]) > GAS_ALARM_DEFAULT_THRESHOLD;
+            }
+            if (above != active) {
+                active = above;
+                changes++;
+            }
+        }
+        bench_sink = changes;
+        return (uint64_t)0;
+    });
+    suite.add("sensor_pipeline/mq2_template", [&signal](size_t n) {
+        struct Count {
+            void operator()(bool) const { bench_sink = bench_sink + 1; }
+        };
+        namespace sp = sensor_pipeline;
+        sp::Pipeline<sp::Channel<ADC_CAPTURE_CHANNELS, ADC_CAPTURE_MQ2>, sp::Median<3>,
+                     sp::LatchAbove<GAS_ALARM_DEFAULT_THRESHOLD>, sp::Actuator<Count>>
+                pipeline;
+        uint16_t block[ADC_CAPTURE_BLOCK_SAMPLES];
+        for (size_t b = 0; b < n; b++) {
+            size_t base = b * ADC_CAPTURE_BLOCK_SAMPLES & (RUNNER_SAMPLES - 1);
+            for (int i = 0; i < ADC_CAPTURE_BLOCK_SAMPLES; i++) block[i] = (uint16_t)signal[base + i];
+            pipeline.run_block(block, ADC_CAPTURE_BLOCK_SAMPLES);
+        }
+        return (uint64_t)0;
+    });
+}
+
+static void add_telemetry_cases(BenchSuite &suite, const std::vector<telemetry_sample_t> &samples) {
+    suite.add("telemetry/text", [&samples](size_t n) {
+        char text[192];
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < n; i++) {
+            bytes += (uint64_t)telemetry_format_sample(text, sizeof(text), &samples[i & (RUNNER_SAMPLES - 1)]);
+        }
+        return bytes;
+    });
+    suite.add("telemetry/cbor_batch", [&samples](size_t n) {
+        static uint8_t storage[4096];
+        telemetry_ring_t ring;
+        telemetry_ring_init(&ring, storage, sizeof(storage));
+        telemetry_cbor_t enc;
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (i % RUNNER_BATCH_SAMPLES == 0) telemetry_cbor_batch_begin(&enc, &ring, (uint32_t)(i * 2000));
+            telemetry_cbor_batch_sample(&enc, (uint32_t)(i % RUNNER_BATCH_SAMPLES) * 2000,
+                                        &samples[i & (RUNNER_SAMPLES - 1)]);
+            if (i % RUNNER_BATCH_SAMPLES == RUNNER_BATCH_SAMPLES - 1 || i == n - 1) {
+                telemetry_cbor_batch_end(&enc);
+                const uint8_t *data;
+                size_t len;
+                while ((len = telemetry_ring_peek(&ring, &data)) > 0) {
+                    telemetry_ring_consume(&ring, len);
+                    bytes += len;
+                }
+            }
+        }
+        return bytes;
+    });
+}
+
+static void add_firmware_state_cases(BenchSuite &suite, const std::vector<int32_t> &signal) {
+    suite.add("sensor_registry/read", [](size_t n) {
+        sensor_reading_t r = {0, {245, 601}, 1000, 0};
+        sensor_registry_publish(SENSOR_REGISTRY_DHT22, &r);
+        int64_t acc = 0;
+        for (size_t i = 0; i < n; i++) {
+            sensor_registry_read(SENSOR_REGISTRY_DHT22, &r);
+            acc += r.value[0];
+        }
+        bench_sink = (uint64_t)acc;
+        return (uint64_t)0;
+    });
+    suite.add("block_pool/free_alloc", [](size_t n) {
+        static uint8_t blocks[64][256];
+        static uint16_t next[64];
+        static block_pool_t pool;
+        block_pool_init(&pool, "bench", blocks, next, sizeof(blocks[0]), 64);
+        void *held[8];
+        for (void *&p : held) p = block_pool_alloc(&pool);
+        for (size_t i = 0; i < n; i++) {
+            void *&p = held[i & 7];
+            block_pool_free(&pool, p);
+            p = block_pool_alloc(&pool);
+        }
+        for (void *p : held) block_pool_free(&pool, p);
+        bench_sink = (uint64_t)(uintptr_t)held[0];
+        return (uint64_t)0;
+    });
+    suite.add("adaptive_sampler/update", [&signal](size_t n) {
+        static const adaptive_sampler_config_t config = ADAPTIVE_SAMPLER_MQ2_DEFAULT;
+        adaptive_sampler_t sampler;
+        adaptive_sampler_init(&sampler, &config, 0);
+        for (size_t i = 0; i < n; i++) {
+            adaptive_sampler_update(&sampler, (uint16_t)signal[i & (RUNNER_SAMPLES - 1)], (uint32_t)i * 50);
+        }
+        bench_sink = sampler.next_ms;
+        return (uint64_t)0;
+    });
+}
+
+static int usage(const char *argv0) {
+    std::fprintf(stderr,
+                 "uso: %s [-o resultado.json] [--label texto] [--filter prefixo] [--trials n] [--min-ms ms]\n",
+                 argv0);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = nullptr;
+    std::string label, filter;
+    BenchSuite suite;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) return usage(argv[0]);
+        i++;
+        if (!std::strcmp(arg, "-o")) {
+            out_path = value;
+        } else if (!std::strcmp(arg, "--label")) {
+            label = value;
+        } else if (!std::strcmp(arg, "--filter")) {
+            filter = value;
+        } else if (!std::strcmp(arg, "--trials")) {
+            suite.trials = std::atoi(value);
+        } else if (!std::strcmp(arg, "--min-ms")) {
+            suite.min_trial_ns = std::strtod(value, nullptr) * 1e6;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (suite.trials < 2 || suite.min_trial_ns <= 0) return usage(argv[0]);
+
+    std::vector<Frame> frames = make_frames();
+    std::vector<int32_t> signal = make_adc_signal();
+    std::vector<telemetry_sample_t> samples = make_samples();
+    add_dht22_cases(suite, frames);
+    add_median_cases(suite, signal);
+    add_pipeline_cases(suite, signal);
+    add_telemetry_cases(suite, samples);
+    add_firmware_state_cases(suite, signal);
+
+    suite.run(filter, true);
+
+    FILE *out = out_path ? std::fopen(out_path, "w") : stdout;
+    if (!out) {
+        std::perror(out_path);
+        return 1;
+    }
+    suite.write_json(out, label);
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file bench_suite.h
+ * @brief Execução repetida de micro-benchmarks com resultado em JSON
+ *
+ * Cada caso é uma função que executa n operações e devolve os bytes
+ * produzidos (0 se não se aplica). O caso é aquecido, calibrado para que
+ * uma rodada dure pelo menos BenchSuite::min_trial_ns e então executado
+ * em várias rodadas; de cada rodada saem ns e ciclos (TSC, em x86) por
+ * operação, com as rodadas dos casos intercaladas. As rodadas, e não só
+ * a média, vão para o JSON, para que bench_compare possa testar se uma
+ * diferença entre duas execuções é significativa.
+ *
+ * Formato do JSON (um objeto por caso em "results"):
+ * @code
+ * {"schema": 1, "label": "...", "trials": 15, "results": [
+ *   {"name": "dht22_frame/table", "ns": 9.1, "ns_stddev": 0.2, "cycles": 27.4,
+ *    "bytes": 0, "iterations": 2097152, "trial_ns": [9.0, 9.2, ...]}, ...]}
+ * @endcode
+ */
+#ifndef BENCH_SUITE_H
+#define BENCH_SUITE_H
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+class BenchSuite {
+public:
+    // Executa n operações; devolve os bytes produzidos por elas
+    using Body = std::function<uint64_t(size_t n)>;
+
+    struct Result {
+        std::string name;
+        double ns = 0;                  // Média das rodadas, por operação
+        double ns_stddev = 0;           // Desvio padrão entre rodadas
+        double cycles = 0;              // Média das rodadas, por operação (0 sem TSC)
+        double bytes = 0;               // Bytes por operação
+        size_t iterations = 0;          // Operações por rodada
+        std::vector<double> trial_ns;   // ns por operação em cada rodada
+    };
+
+    int trials = 15;
+    double min_trial_ns = 20e6;
+
+    void add(const std::string &name, Body body) { cases_.push_back({name, std::move(body)}); }
+
+    /**
+     * @brief Roda os casos cujo nome começa com filter (vazio: todos)
+     *
+     * As rodadas são intercaladas entre os casos (uma de cada por vez),
+     * para que variações lentas da máquina, como a frequência do
+     * processador, atinjam todos os casos por igual.
+     */
+    void run(const std::string &filter, bool verbose) {
+        std::vector<const Case *> selected;
+        for (const Case &c : cases_) {
+            if (c.name.compare(0, filter.size(), filter) == 0) selected.push_back(&c);
+        }
+
+        size_t first = results_.size();
+        for (const Case *c : selected) {
+            Result r;
+            r.name = c->name;
+            r.iterations = calibrate(*c);
+            results_.push_back(r);
+        }
+        std::vector<double> cycles(selected.size()), bytes(selected.size());
+        for (int t = 0; t < trials; t++) {
+            for (size_t i = 0; i < selected.size(); i++) {
+                Result &r = results_[first + i];
+                auto start = clock::now();
+                uint64_t c0 = cycles_now();
+                uint64_t b = selected[i]->body(r.iterations);
+                uint64_t c1 = cycles_now();
+                double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+                r.trial_ns.push_back(ns / r.iterations);
+                cycles[i] += (double)(c1 - c0) / r.iterations;
+                bytes[i] += (double)b / r.iterations;
+            }
+        }
+
+        for (size_t i = 0; i < selected.size(); i++) {
+            Result &r = results_[first + i];
+            double sum = 0;
+            for (double v : r.trial_ns) sum += v;
+            r.ns = sum / trials;
+            double sq = 0;
+            for (double v : r.trial_ns) sq += (v - r.ns) * (v - r.ns);
+            r.ns_stddev = trials > 1 ? std::sqrt(sq / (trials - 1)) : 0;
+            r.cycles = cycles[i] / trials;
+            r.bytes = bytes[i] / trials;
+            if (verbose) {
+                std::fprintf(stderr, "%-32s %10.2f ns/op ± %5.2f%%  %9.1f ciclos/op  %7.1f bytes/op\n", r.name.c_str(),
+                             r.ns, 100.0 * r.ns_stddev / r.ns, r.cycles, r.bytes);
+            }
+        }
+    }
+
+    void write_json(FILE *out, const std::string &label) const {
+        std::fprintf(out, "{\"schema\": 1, \"label\": \"%s\", \"trials\": %d, \"results\": [", label.c_str(), trials);
+        for (size_t i = 0; i < results_.size(); i++) {
+            const Result &r = results_[i];
+            std::fprintf(out,
+                         "%s\n  {\"name\": \"%s\", \"ns\": %.4f, \"ns_stddev\": %.4f, \"cycles\": %.2f, "
+                         "\"bytes\": %.2f, \"iterations\": %zu, \"trial_ns\": [",
+                         i ? "," : "", r.name.c_str(), r.ns, r.ns_stddev, r.cycles, r.bytes, r.iterations);
+            for (size_t t = 0; t < r.trial_ns.size(); t++) std::fprintf(out, "%s%.4f", t ? ", " : "", r.trial_ns[t]);
+            std::fprintf(out, "]}");
+        }
+        std::fprintf(out, "\n]}\n");
+    }
+
+    const std::vector<Result> &results() const { return results_; }
+
+private:
+    struct Case {
+        std::string name;
+        Body body;
+    };
+
+    using clock = std::chrono::steady_clock;
+
+    static uint64_t cycles_now() {
+#if BENCH_HAS_TSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Dobra as operações até uma rodada passar de min_trial_ns (a primeira aquece)
+     */
+    size_t calibrate(const Case &c) const {
+        size_t n = 1;
+        for (;;) {
+            auto start = clock::now();
+            c.body(n);
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            if (ns >= min_trial_ns || n >= (size_t(1) << 40)) return n;
+            n *= 2;
+        }
+    }
+
+    std::vector<Case> cases_;
+    std::vector<Result> results_;
+};
+
+#endif // BENCH_SUITE_H
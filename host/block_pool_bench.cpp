@@ -0,0 +1,243 @@
+/**
+ * @file block_pool_bench.cpp
+ * @brief Pools de blocos fixos (block_pool.h) comparados com malloc/free
+ *
+ * Duas medidas, cada uma com o pool e com o malloc da libc:
+ * - latência de um par liberar/alocar numa carga de mensagens: um
+ *   conjunto de buffers vivos em que, a cada passo, um buffer sorteado é
+ *   liberado e outro alocado, com tamanhos de 16 a 256 bytes e 1/8 dos
+ *   buffers retidos por mais tempo, o que fragmenta o heap. Mostra média,
+ *   percentis e máximo, pois o que o pool promete é a cauda estável;
+ * - vazão com várias threads alocando e liberando do mesmo pool, cada uma
+ *   marcando o bloco que recebeu e conferindo a marca antes de liberá-lo.
+ *   Uma marca alterada significa que o mesmo bloco foi entregue a duas
+ *   threads; o programa então termina com código 1.
+ *
+ * No RP2040 a medida de latência roda em block_pool_bench.c (raiz do
+ * projeto), contra o malloc da newlib, com ciclos contados pelo SysTick.
+ *
+ * Uso:
+ * @code
+ * block_pool_bench [operações] [--threads n]
+ * @endcode
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "block_pool.h"
+}
+
+#define BENCH_LIVE 64               // Buffers vivos na carga de mensagens
+#define BENCH_RETAINED 512          // Buffers retidos por mais tempo
+#define BENCH_MAX_BYTES 256
+#define BENCH_THREAD_BLOCKS 256
+
+using bench_clock = std::chrono::steady_clock;
+
+static volatile uintptr_t bench_sink;   // Impede que o compilador descarte os buffers
+
+struct Block {
+    uint8_t bytes[BENCH_MAX_BYTES];
+};
+
+static Block message_blocks[BENCH_LIVE + BENCH_RETAINED];
+static uint16_t message_next[BENCH_LIVE + BENCH_RETAINED];
+static block_pool_t message_pool;
+
+static Block thread_blocks[BENCH_THREAD_BLOCKS];
+static uint16_t thread_next[BENCH_THREAD_BLOCKS];
+static block_pool_t thread_pool;
+
+struct Allocator {
+    const char *name;
+    void *(*alloc)(size_t bytes);
+    void (*free)(void *p);
+};
+
+static void *pool_alloc(size_t) {
+    return block_pool_alloc(&message_pool);
+}
+
+static void pool_free(void *p) {
+    block_pool_free(&message_pool, p);
+}
+
+static const Allocator allocators[] = {
+    {"block_pool", pool_alloc, pool_free},
+    {"malloc", std::malloc, std::free},
+};
+
+struct Latency {
+    double mean, p50, p99, p999, max;
+};
+
+static uint32_t next_random(uint32_t &rng) {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+/**
+ * @brief Carga de mensagens: ns por par liberar/alocar
+ *
+ * O pool é reiniciado e o heap recebe a mesma sequência de tamanhos; os
+ * buffers são tocados depois de alocados, como seriam ao serem preenchidos.
+ */
+static Latency message_latency(const Allocator &a, size_t operations) {
+    block_pool_init(&message_pool, "message_pool", message_blocks, message_next, sizeof(Block),
+                    BENCH_LIVE + BENCH_RETAINED);
+    uint32_t rng = 12345;
+    std::vector<void *> live(BENCH_LIVE), retained(BENCH_RETAINED);
+    for (void *&p : live) p = a.alloc(16 + next_random(rng) % (BENCH_MAX_BYTES - 15));
+    for (void *&p : retained) p = a.alloc(16 + next_random(rng) % (BENCH_MAX_BYTES - 15));
+
+    std::vector<double> ns(operations);
+    uintptr_t acc = 0;
+    for (size_t i = 0; i < operations; i++) {
+        uint32_t r = next_random(rng);
+        size_t bytes = 16 + r % (BENCH_MAX_BYTES - 15);
+        void *&slot = (r >> 12) % 8 == 0 ? retained[(r >> 4) % BENCH_RETAINED] : live[(r >> 4) % BENCH_LIVE];
+        auto start = bench_clock::now();
+        a.free(slot);
+        slot = a.alloc(bytes);
+        ns[i] = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+        std::memset(slot, (int)i, bytes < 32 ? bytes : 32);
+        acc += (uintptr_t)slot;
+    }
+    for (void *p : live) a.free(p);
+    for (void *p : retained) a.free(p);
+    bench_sink = acc;
+
+    // Custo da própria medição, descontado de todos os percentis
+    double overhead = 1e9;
+    for (int i = 0; i < 1000; i++) {
+        auto start = bench_clock::now();
+        overhead = std::min(overhead, std::chrono::duration<double, std::nano>(bench_clock::now() - start).count());
+    }
+    double sum = 0;
+    for (double &v : ns) {
+        v = std::max(0.0, v - overhead);
+        sum += v;
+    }
+    std::sort(ns.begin(), ns.end());
+    auto at = [&ns](double q) { return ns[std::min(ns.size() - 1, (size_t)(q * ns.size()))]; };
+    return {sum / ns.size(), at(0.5), at(0.99), at(0.999), ns.back()};
+}
+
+static size_t thread_pool_blocks(int threads) {
+    return std::min<size_t>(BENCH_THREAD_BLOCKS, 2 * (size_t)threads);
+}
+
+struct ThreadResult {
+    double ops_per_s;
+    long corrupted;
+};
+
+/**
+ * @brief Threads alocando e liberando, com marca de dono em cada bloco
+ *
+ * Cada thread retém até 4 blocos por vez e o pool tem 2 por thread, para
+ * que ele se esgote com frequência.
+ */
+static ThreadResult thread_throughput(bool use_pool, int threads, size_t operations) {
+    block_pool_init(&thread_pool, "thread_pool", thread_blocks, thread_next, sizeof(Block), thread_pool_blocks(threads));
+    std::atomic<long> corrupted{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            while (!go.load()) {
+            }
+            uint32_t rng = 777u + (uint32_t)t;
+            void *held[4] = {nullptr, nullptr, nullptr, nullptr};
+            uint32_t stamp[4] = {0, 0, 0, 0};
+            long bad = 0;
+            for (size_t i = 0; i < operations; i++) {
+                size_t k = next_random(rng) % 4;
+                if (held[k]) {
+                    uint32_t seen;
+                    std::memcpy(&seen, held[k], sizeof(seen));
+                    if (seen != stamp[k]) bad++;
+                    if (use_pool) block_pool_free(&thread_pool, held[k]);
+                    else std::free(held[k]);
+                    held[k] = nullptr;
+                }
+                held[k] = use_pool ? block_pool_alloc(&thread_pool) : std::malloc(sizeof(Block));
+                if (held[k]) {
+                    stamp[k] = (uint32_t)t << 24 | (uint32_t)(i & 0xFFFFFF);
+                    std::memcpy(held[k], &stamp[k], sizeof(stamp[k]));
+                }
+            }
+            for (size_t k = 0; k < 4; k++) {
+                if (!held[k]) continue;
+                uint32_t seen;
+                std::memcpy(&seen, held[k], sizeof(seen));
+                if (seen != stamp[k]) bad++;
+                if (use_pool) block_pool_free(&thread_pool, held[k]);
+                else std::free(held[k]);
+            }
+            corrupted += bad;
+        });
+    }
+    auto start = bench_clock::now();
+    go = true;
+    for (std::thread &w : workers) w.join();
+    double s = std::chrono::duration<double>(bench_clock::now() - start).count();
+    return {(double)threads * operations / s, corrupted.load()};
+}
+
+int main(int argc, char **argv) {
+    size_t operations = 2000000;
+    int threads = (int)std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            operations = std::strtoull(argv[i], nullptr, 0);
+        } else {
+            std::fprintf(stderr, "uso: %s [operações] [--threads n]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (operations == 0 || threads < 1) return 2;
+
+    std::printf("carga de mensagens: %d vivos, %d retidos, %zu pares liberar/alocar de 16 a %d bytes\n", BENCH_LIVE,
+                BENCH_RETAINED, operations, BENCH_MAX_BYTES);
+    std::printf("%-12s %9s %9s %9s %9s %9s   (ns por par)\n", "", "média", "p50", "p99", "p99.9", "máximo");
+    block_pool_stats_t stats;
+    for (const Allocator &a : allocators) {
+        Latency l = message_latency(a, operations);
+        std::printf("%-12s %9.1f %9.1f %9.1f %9.1f %9.0f\n", a.name, l.mean, l.p50, l.p99, l.p999, l.max);
+        if (a.alloc != pool_alloc) continue;
+        block_pool_stats(&message_pool, &stats);
+        if (stats.in_use != 0 || stats.high_water != BENCH_LIVE + BENCH_RETAINED || stats.exhausted != 0) {
+            std::fprintf(stderr, "contadores do pool incoerentes: em uso %u, pico %u, negadas %u\n", stats.in_use,
+                         stats.high_water, stats.exhausted);
+            return 1;
+        }
+    }
+
+    long corrupted = 0;
+    size_t per_thread = operations / threads;
+    std::printf("\n%d threads, %zu operações cada, pool de %zu blocos\n", threads, per_thread,
+                thread_pool_blocks(threads));
+    for (bool use_pool : {true, false}) {
+        ThreadResult r = thread_throughput(use_pool, threads, per_thread);
+        std::printf("%-12s %9.1f Mop/s", use_pool ? "block_pool" : "malloc", r.ops_per_s / 1e6);
+        if (use_pool) {
+            block_pool_stats(&thread_pool, &stats);
+            std::printf("  (pico %u blocos, %u alocações negadas, %ld marcas alteradas)", stats.high_water,
+                        stats.exhausted, r.corrupted);
+            if (stats.in_use != 0 || stats.high_water > thread_pool_blocks(threads)) r.corrupted++;
+        }
+        std::printf("\n");
+        corrupted += r.corrupted;
+    }
+    return corrupted ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file dht22_decode_bench.cpp
+ * @brief Benchmark dos decodificadores de quadro do DHT22 (dht22_frame.h)
+ *
+ * Gera vetores de 40 larguras de pulso como o driver os mede (bit 0 em
+ * torno de 26 μs, bit 1 em torno de 70 μs, com jitter), incluindo quadros
+ * com checksum errado e fora de faixa, e mede tempo e ciclos (TSC, em
+ * x86) por quadro de cada decodificador. Antes, confere que os dois
+ * concordam no resultado e nos valores de todos os quadros.
+ *
+ * No RP2040 a mesma comparação roda em dht22_decode_bench.c (raiz do
+ * projeto), com ciclos contados pelo SysTick.
+ *
+ * Uso:
+ * @code
+ * dht22_decode_bench [quadros]
+ * @endcode
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+extern "C" {
+#include "dht22.h"
+#include "dht22_frame.h"
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+#define BENCH_FRAMES 4096       // Potência de 2
+
+static volatile int bench_sink;  // Impede que o compilador descarte as decodificações
+
+struct Frame {
+    uint8_t widths[DHT22_FRAME_BITS];
+};
+
+static uint64_t cycles_now() {
+#if BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct Result {
+    double ns_per_frame;
+    double cycles_per_frame;
+};
+
+static Result measure(const std::vector<Frame> &frames, size_t count, dht22_decoder_t decode) {
+    float t = 0, h = 0;
+    int acc = 0;
+    size_t mask = frames.size() - 1;
+    auto start = bench_clock::now();
+    uint64_t c0 = cycles_now();
+    for (size_t i = 0; i < count; i++) acc += decode(frames[i & mask].widths, &t, &h);
+    uint64_t c1 = cycles_now();
+    double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    bench_sink = acc + (int)t + (int)h;
+    return {ns / count, (double)(c1 - c0) / count};
+}
+
+static void print(const char *name, const Result &r) {
+    std::printf("%-10s %8.2f ns/quadro", name, r.ns_per_frame);
+    if (BENCH_HAS_TSC) std::printf(" %8.1f ciclos/quadro", r.cycles_per_frame);
+    std::printf("\n");
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 20000000;
+
+    // Quadros variados: 1/16 com checksum errado, 1/16 fora de faixa
+    std::vector<Frame> frames(BENCH_FRAMES);
+    uint32_t rng = 12345;
+    auto next = [&rng]() {
+        rng = rng * 1664525u + 1013904223u;
+        return rng >> 8;
+    };
+    for (size_t f = 0; f < frames.size(); f++) {
+        uint16_t h10 = (uint16_t)(next() % 1001);
+        int t10 = (int)(next() % 1201) - 400;
+        if (f % 16 == 5) h10 = 1200;
+        uint16_t raw = (uint16_t)(t10 < 0 ? (0x8000 | -t10) : t10);
+        uint8_t data[5] = {(uint8_t)(h10 >> 8), (uint8_t)h10, (uint8_t)(raw >> 8), (uint8_t)raw, 0};
+        data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3] + (f % 16 == 9));
+        for (int i = 0; i < DHT22_FRAME_BITS; i++) {
+            bool bit = data[i / 8] & (1 << (7 - i % 8));
+            int w = (bit ? 70 : 26) + (int)(next() % 13) - 6;
+            frames[f].widths[i] = (uint8_t)w;
+        }
+    }
+
+    for (size_t f = 0; f < frames.size(); f++) {
+        float t1 = 0, h1 = 0, t2 = 0, h2 = 0;
+        int r1 = dht22_frame_decode_bitwise(frames[f].widths, &t1, &h1);
+        int r2 = dht22_frame_decode(frames[f].widths, &t2, &h2);
+        if (r1 != r2 || std::fabs(t1 - t2) > 0.01f || std::fabs(h1 - h2) > 0.01f) {
+            std::fprintf(stderr, "quadro %zu: bit a bit %d (%.1f, %.1f), tabela %d (%.1f, %.1f)\n", f, r1, t1, h1,
+                         r2, t2, h2);
+            return 1;
+        }
+    }
+
+    Result bitwise = measure(frames, count, dht22_frame_decode_bitwise);
+    Result table = measure(frames, count, dht22_frame_decode);
+
+    std::printf("%zu quadros (%zu distintos, resultados idênticos)\n", count, frames.size());
+    print("bit a bit", bitwise);
+    print("tabela", table);
+    std::printf("tabela: %.2fx mais rápido\n", bitwise.ns_per_frame / table.ns_per_frame);
+    return 0;
+}
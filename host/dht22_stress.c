@@ -0,0 +1,313 @@
+/**
+ * @file dht22_stress.c
+ * @brief Taxa de sucesso dos decodificadores do DHT22 em função do jitter
+ *
+ * Cada decodificador roda sobre o SDK substituto (pico_shim) enquanto o
+ * modelo do sensor responde com formas de onda imperfeitas
+ * (dht22_waveform.h). Para cada nível de jitter, são feitas N leituras de
+ * valores aleatórios e cada resultado é classificado em: correto, errado
+ * sem detecção (checksum confere mas o valor difere), erro de checksum,
+ * timeout e dado inválido. Ao fim, a vazão de cada decodificador em
+ * leituras por segundo de relógio de parede, com a forma de onda nominal.
+ *
+ * Com --vcd, as respostas vêm de uma captura de analisador lógico (ou de
+ * firmware_sim --vcd): cada decodificador lê cada resposta capturada uma
+ * vez, e "ok" passa a significar checksum e faixa válidos, já que o valor
+ * transmitido não é conhecido. A vazão é medida sobre as capturas.
+ *
+ * Uso:
+ * @code
+ * dht22_stress [--reads N] [--dist uniform|gauss|laplace] [--jitter a,b,...]
+ *              [--skew f] [--rise us] [--glitch prob:us] [--drop prob]
+ *              [--irq intervalo_us:duração_us] [--seed n] [--csv]
+ * dht22_stress --vcd captura.vcd[:sinal] [--reads N] [--csv]
+ * @endcode
+ *
+ * O sinal padrão é "gpio2", o nome do pino de dados nos VCDs da simulação.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dht22.h"
+#include "sim.h"
+#include "vcd.h"
+
+#define DHT22_STRESS_PIN 2
+#define DHT22_STRESS_MAX_POINTS 32
+#define DHT22_STRESS_SIGNAL "gpio2"
+
+/**
+ * @brief Um decodificador de quadro, usado por dht22_read() sobre o shim
+ */
+typedef struct {
+    const char *name;
+    dht22_decoder_t decode;
+} decoder_backend_t;
+
+static const decoder_backend_t backends[] = {
+    {"bitwise", dht22_frame_decode_bitwise},    // O caminho original, bit a bit
+    {"table", dht22_frame_decode},              // Máscaras de comparação, sem desvios por bit
+};
+
+typedef enum {
+    OUTCOME_OK,
+    OUTCOME_WRONG,              // DHT22_OK com valor diferente do transmitido
+    OUTCOME_CHECKSUM,
+    OUTCOME_TIMEOUT,
+    OUTCOME_INVALID,
+    OUTCOME_COUNT,
+} outcome_t;
+
+static const char *const outcome_names[OUTCOME_COUNT] = {"ok", "errado", "checksum", "timeout", "inválido"};
+
+// Valores que o sensor simulado transmite na próxima leitura
+static struct {
+    float temperature;
+    float humidity;
+} truth;
+static bool replaying;          // Respostas capturadas: valor transmitido desconhecido
+
+static uint64_t rng_state = 0x2545F4914F6CDD1Dull;
+
+static uint32_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static void stress_inputs(uint64_t t_us, sim_inputs_t *inputs, void *ctx) {
+    (void)t_us;
+    (void)ctx;
+    memset(inputs, 0, sizeof(*inputs));
+    inputs->temperature = truth.temperature;
+    inputs->humidity = truth.humidity;
+    inputs->link_up = true;
+}
+
+static outcome_t read_once(const decoder_backend_t *backend) {
+    // Décimos exatos, como o sensor transmite
+    truth.temperature = (float)((int)(next_random() % 1201) - 400) / 10.0f;
+    truth.humidity = (float)(next_random() % 1001) / 10.0f;
+    sim_set_input_source(stress_inputs, NULL);
+
+    float temperature = 0, humidity = 0;
+    dht22_set_decoder(backend->decode);
+    switch (dht22_read(&temperature, &humidity)) {
+    case DHT22_OK:
+        if (replaying) return OUTCOME_OK;
+        return fabsf(temperature - truth.temperature) < 0.05f && fabsf(humidity - truth.humidity) < 0.05f
+                   ? OUTCOME_OK
+                   : OUTCOME_WRONG;
+    case DHT22_ERROR_CHECKSUM:
+        return OUTCOME_CHECKSUM;
+    case DHT22_ERROR_TIMEOUT:
+        return OUTCOME_TIMEOUT;
+    default:
+        return OUTCOME_INVALID;
+    }
+}
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int parse_jitter_list(const char *text, double *out) {
+    int n = 0;
+    char *end;
+    while (*text && n < DHT22_STRESS_MAX_POINTS) {
+        out[n++] = strtod(text, &end);
+        if (end == text) return -1;
+        text = *end == ',' ? end + 1 : end;
+    }
+    return n;
+}
+
+static int usage(const char *argv0) {
+    fprintf(stderr,
+            "uso: %s [--reads N] [--dist uniform|gauss|laplace] [--jitter a,b,...] [--skew f] [--rise us]\n"
+            "          [--glitch prob:us] [--drop prob] [--irq intervalo_us:duração_us] [--seed n] [--csv]\n"
+            "     %s --vcd captura.vcd[:sinal] [--reads N] [--csv]\n",
+            argv0, argv0);
+    return 2;
+}
+
+static void print_outcomes(const char *label, const long *count, long total, bool csv) {
+    printf(csv ? "%s" : "  %9s", label);
+    for (int o = 0; o < OUTCOME_COUNT; o++) {
+        printf(csv ? ",%.4f" : " %8.2f%%", (csv ? 1.0 : 100.0) * (double)count[o] / (double)total);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Cada decodificador sobre cada resposta capturada
+ */
+static int replay_capture(char *spec, int reads, bool csv) {
+    char *signal = strrchr(spec, ':');
+    if (signal) *signal++ = '\0';
+
+    vcd_trace_t trace;
+    char error[256];
+    if (!vcd_read_trace(spec, signal ? signal : DHT22_STRESS_SIGNAL, &trace, error, sizeof(error))) {
+        fprintf(stderr, "erro: %s\n", error);
+        return 1;
+    }
+    int max = (int)(trace.count / 2) + 1;
+    dht22_waveform_t *responses = malloc((size_t)max * sizeof(*responses));
+    int count = vcd_trace_dht22_responses(&trace, SIM_DHT22_MIN_START_US, responses, max);
+    vcd_trace_free(&trace);
+    if (!count) {
+        fprintf(stderr, "erro: %s: nenhuma resposta do DHT22 encontrada\n", spec);
+        free(responses);
+        return 1;
+    }
+
+    replaying = true;
+    sim_set_dht22_replay(responses, count);
+    if (csv) {
+        printf("decoder,capture");
+        for (int o = 0; o < OUTCOME_COUNT; o++) printf(",%s", outcome_names[o]);
+        printf("\n");
+    } else {
+        printf("%s: %d respostas capturadas\n\n  %-9s", spec, count, "decodif.");
+        for (int o = 0; o < OUTCOME_COUNT; o++) printf(" %9s", outcome_names[o]);
+        printf("\n");
+    }
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        long tally[OUTCOME_COUNT] = {0};
+        sim_set_dht22_replay(responses, count);
+        for (int r = 0; r < count; r++) tally[read_once(&backends[b])]++;
+        char label[64];
+        snprintf(label, sizeof(label), csv ? "%s,%s" : "%s", backends[b].name, spec);
+        print_outcomes(label, tally, count, csv);
+    }
+
+    if (!csv) printf("\nvazão (capturas em ciclo):\n");
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        double start = wall_seconds();
+        for (int r = 0; r < reads; r++) read_once(&backends[b]);
+        double elapsed = wall_seconds() - start;
+        if (csv) {
+            printf("# %s,throughput,%.0f reads/s\n", backends[b].name, reads / elapsed);
+        } else {
+            printf("  %-10s %10.0f leituras/s (host), %.2f μs/leitura\n", backends[b].name, reads / elapsed,
+                   elapsed * 1e6 / reads);
+        }
+    }
+    free(responses);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    dht22_waveform_config_t config = {.skew = 1.0};
+    double jitter[DHT22_STRESS_MAX_POINTS] = {0, 1, 2, 4, 6, 8, 10, 12, 15, 20};
+    int points = 10;
+    int reads = 2000;
+    uint64_t seed = 1;
+    bool csv = false;
+    char *capture = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(arg, "--csv")) {
+            csv = true;
+            continue;
+        }
+        if (!value) return usage(argv[0]);
+        i++;
+        if (!strcmp(arg, "--reads")) {
+            reads = atoi(value);
+        } else if (!strcmp(arg, "--dist")) {
+            int dist = dht22_jitter_parse(value);
+            if (dist < 0) return usage(argv[0]);
+            config.dist = (dht22_jitter_dist_t)dist;
+        } else if (!strcmp(arg, "--jitter")) {
+            points = parse_jitter_list(value, jitter);
+            if (points <= 0) return usage(argv[0]);
+        } else if (!strcmp(arg, "--skew")) {
+            config.skew = strtod(value, NULL);
+        } else if (!strcmp(arg, "--rise")) {
+            config.rise_us = strtod(value, NULL);
+        } else if (!strcmp(arg, "--glitch")) {
+            if (sscanf(value, "%lf:%lf", &config.glitch_prob, &config.glitch_us) != 2) return usage(argv[0]);
+        } else if (!strcmp(arg, "--drop")) {
+            config.drop_prob = strtod(value, NULL);
+        } else if (!strcmp(arg, "--irq")) {
+            if (sscanf(value, "%lf:%lf", &config.irq_every_us, &config.irq_us) != 2) return usage(argv[0]);
+        } else if (!strcmp(arg, "--vcd")) {
+            capture = argv[i];
+        } else if (!strcmp(arg, "--seed")) {
+            seed = strtoull(value, NULL, 10);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (reads <= 0) return usage(argv[0]);
+
+    sim_init(0, UINT64_MAX, NULL);
+    sim_set_dht22_pin(DHT22_STRESS_PIN);
+    dht22_init(DHT22_STRESS_PIN);
+    rng_state ^= seed * 0x9E3779B97F4A7C15ull;
+    if (capture) return replay_capture(capture, reads, csv);
+
+    if (csv) {
+        printf("decoder,dist,jitter_us");
+        for (int o = 0; o < OUTCOME_COUNT; o++) printf(",%s", outcome_names[o]);
+        printf("\n");
+    } else {
+        printf("%d leituras por ponto; jitter %s, skew %.3f, subida %.1f μs, glitch %.3f × %.1f μs, "
+               "perda %.3f, interrupções a cada %.0f μs por %.1f μs\n",
+               reads, dht22_jitter_name(config.dist), config.skew, config.rise_us, config.glitch_prob,
+               config.glitch_us, config.drop_prob, config.irq_every_us, config.irq_us);
+    }
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (!csv) {
+            printf("\n%s:\n  %9s", backends[b].name, "jitter μs");
+            for (int o = 0; o < OUTCOME_COUNT; o++) printf(" %9s", outcome_names[o]);
+            printf("\n");
+        }
+        for (int p = 0; p < points; p++) {
+            long count[OUTCOME_COUNT] = {0};
+            config.jitter_us = jitter[p];
+            sim_set_dht22_waveform(&config, seed + (uint64_t)p);
+            for (int r = 0; r < reads; r++) count[read_once(&backends[b])]++;
+
+            char label[64];
+            if (csv) {
+                snprintf(label, sizeof(label), "%s,%s,%g", backends[b].name, dht22_jitter_name(config.dist),
+                         jitter[p]);
+            } else {
+                snprintf(label, sizeof(label), "%g", jitter[p]);
+            }
+            print_outcomes(label, count, reads, csv);
+        }
+    }
+
+    // Vazão com a forma de onda nominal: custo de decodificação no host
+    if (!csv) printf("\nvazão (forma de onda nominal):\n");
+    const dht22_waveform_config_t nominal = {.skew = 1.0};
+    sim_set_dht22_waveform(&nominal, seed);
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        int ok = 0;
+        uint64_t virtual_start = sim_now_us();
+        double start = wall_seconds();
+        for (int r = 0; r < reads; r++) ok += read_once(&backends[b]) == OUTCOME_OK;
+        double elapsed = wall_seconds() - start;
+        double virtual_s = (double)(sim_now_us() - virtual_start) / 1e6;
+        if (csv) {
+            printf("# %s,throughput,%.0f reads/s\n", backends[b].name, reads / elapsed);
+        } else {
+            printf("  %-10s %10.0f leituras/s (host), %.2f μs/leitura, %d/%d corretas, %.1f s simulados\n",
+                   backends[b].name, reads / elapsed, elapsed * 1e6 / reads, ok, reads, virtual_s);
+        }
+    }
+    return 0;
+}
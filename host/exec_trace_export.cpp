@@ -0,0 +1,211 @@
+/**
+ * @file exec_trace_export.cpp
+ * @brief Converte as descargas de exec_trace.h em JSON de trace do Chrome
+ *
+ * Lê a captura da serial do firmware (arquivo ou stdin) compilado com
+ * EXEC_TRACE_ENABLED, extrai as janelas entre "exec_trace: N eventos" e
+ * "exec_trace: fim" e escreve o formato JSON de eventos de trace do
+ * Chrome, que o Perfetto (ui.perfetto.dev) e o chrome://tracing abrem.
+ * As demais linhas da serial (telemetria em texto) são ignoradas.
+ *
+ * Cada trilha do firmware ("main", "irq") vira uma thread do processo.
+ * Fatias abertas no fim de uma janela (o anel congelou no meio delas) são
+ * fechadas no último instante da janela; fins sem início no começo da
+ * janela seguinte são descartados. O início de cada janela depois da
+ * primeira leva um marcador "exec_trace.gap" com o número de eventos
+ * descartados entre as duas.
+ *
+ * Uso:
+ * @code
+ * exec_trace_export [captura|-] [-o trace.json]
+ * firmware_sim_trace scenarios/actuator-latency.txt --echo | exec_trace_export -o trace.json
+ * @endcode
+ *
+ * Termina com código 1 se uma janela estiver truncada ou tiver instantes
+ * fora de ordem.
+ */
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+struct Event {
+    uint64_t ts;
+    char kind;                  // B, E ou I
+    std::string track;
+    std::string name;
+    unsigned long arg;
+};
+
+class ChromeTraceWriter {
+public:
+    explicit ChromeTraceWriter(FILE *out) : out_(out) { std::fprintf(out_, "{\"traceEvents\":[\n"); }
+
+    int tid(const std::string &track) {
+        auto it = tids_.find(track);
+        if (it != tids_.end()) return it->second;
+        int id = (int)tids_.size() + 1;
+        tids_[track] = id;
+        separator();
+        std::fprintf(out_, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                     id, track.c_str());
+        separator();
+        std::fprintf(out_, "{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+                     id, id);
+        return id;
+    }
+
+    void slice(char ph, const std::string &track, const std::string &name, uint64_t ts, unsigned long arg) {
+        int id = tid(track);
+        separator();
+        std::fprintf(out_, "{\"ph\":\"%c\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%" PRIu64, ph, name.c_str(), id,
+                     ts);
+        if (ph == 'i') std::fprintf(out_, ",\"s\":\"t\",\"args\":{\"arg\":%lu}", arg);
+        std::fprintf(out_, "}");
+        events_++;
+    }
+
+    void gap(uint64_t ts, unsigned long dropped) {
+        separator();
+        std::fprintf(out_,
+                     "{\"ph\":\"i\",\"name\":\"exec_trace.gap\",\"pid\":1,\"tid\":0,\"ts\":%" PRIu64
+                     ",\"s\":\"g\",\"args\":{\"descartados\":%lu}}",
+                     ts, dropped);
+        events_++;
+    }
+
+    void finish() {
+        std::fprintf(out_, "\n],\"otherData\":{\"source\":\"exec_trace\"}}\n");
+    }
+
+    size_t events() const { return events_; }
+
+private:
+    void separator() {
+        if (!first_) std::fprintf(out_, ",\n");
+        first_ = false;
+    }
+
+    FILE *out_;
+    bool first_ = true;
+    size_t events_ = 0;
+    std::map<std::string, int> tids_;
+};
+
+/**
+ * @brief Escreve uma janela, fechando as fatias abertas no seu último instante
+ *
+ * @return Fins sem início descartados
+ */
+static size_t write_window(ChromeTraceWriter &writer, const std::vector<Event> &window) {
+    std::map<std::string, std::vector<std::string>> open;     // Fatias abertas por trilha
+    size_t orphans = 0;
+    for (const Event &e : window) {
+        auto &stack = open[e.track];
+        if (e.kind == 'B') {
+            stack.push_back(e.name);
+            writer.slice('B', e.track, e.name, e.ts, e.arg);
+        } else if (e.kind == 'E') {
+            if (stack.empty() || stack.back() != e.name) {
+                orphans++;
+                continue;
+            }
+            stack.pop_back();
+            writer.slice('E', e.track, e.name, e.ts, e.arg);
+        } else {
+            writer.slice('i', e.track, e.name, e.ts, e.arg);
+        }
+    }
+    uint64_t last = window.empty() ? 0 : window.back().ts;
+    for (auto &track : open) {
+        while (!track.second.empty()) {
+            writer.slice('E', track.first, track.second.back(), last, 0);
+            track.second.pop_back();
+        }
+    }
+    return orphans;
+}
+
+int main(int argc, char **argv) {
+    const char *path = "-";
+    const char *out_path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-o") && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1]) {
+            std::fprintf(stderr, "uso: %s [captura|-] [-o trace.json]\n", argv[0]);
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE *in = std::strcmp(path, "-") ? std::fopen(path, "r") : stdin;
+    if (!in) {
+        std::perror(path);
+        return 1;
+    }
+    FILE *out = out_path ? std::fopen(out_path, "w") : stdout;
+    if (!out) {
+        std::perror(out_path);
+        return 1;
+    }
+
+    ChromeTraceWriter writer(out);
+    std::vector<Event> window;
+    bool in_window = false;
+    unsigned long expected = 0, dropped = 0, total_dropped = 0;
+    size_t windows = 0, truncated = 0, out_of_order = 0, orphans = 0;
+    uint64_t first_ts = 0, last_ts = 0;
+    char line[512];
+
+    while (std::fgets(line, sizeof(line), in)) {
+        unsigned long count, lost;
+        if (std::sscanf(line, "exec_trace: %lu eventos, %lu descartados", &count, &lost) == 2) {
+            if (in_window) truncated++;
+            in_window = true;
+            expected = count;
+            dropped = lost;
+            window.clear();
+            continue;
+        }
+        if (!in_window) continue;
+        if (!std::strncmp(line, "exec_trace: fim", 15)) {
+            in_window = false;
+            if (window.size() != expected) truncated++;
+            if (window.empty()) continue;
+            if (windows) writer.gap(window.front().ts, dropped);
+            else first_ts = window.front().ts;
+            orphans += write_window(writer, window);
+            last_ts = window.back().ts;
+            total_dropped += dropped;
+            windows++;
+            continue;
+        }
+
+        Event e;
+        char kind, track[64], name[64];
+        if (std::sscanf(line, "@%" SCNu64 " %c %63s %63s %lu", &e.ts, &kind, track, name, &e.arg) != 5 ||
+            (kind != 'B' && kind != 'E' && kind != 'I')) {
+            continue;   // Linha da telemetria intercalada ou corrompida
+        }
+        e.kind = kind;
+        e.track = track;
+        e.name = name;
+        if (!window.empty() && e.ts < window.back().ts) out_of_order++;
+        window.push_back(e);
+    }
+    if (in_window) truncated++;
+    writer.finish();
+    if (in != stdin) std::fclose(in);
+    if (out != stdout) std::fclose(out);
+
+    std::fprintf(stderr,
+                 "%zu janelas, %zu eventos de trace, %.3f s de execução; %lu eventos descartados entre janelas, "
+                 "%zu fins sem início, %zu janelas truncadas, %zu eventos fora de ordem\n",
+                 windows, writer.events(), (last_ts - first_ts) / 1e6, total_dropped, orphans, truncated,
+                 out_of_order);
+    return truncated || out_of_order ? 1 : 0;
+}
@@ -0,0 +1,514 @@
+/**
+ * @file fleet_loadgen.cpp
+ * @brief Gerador de carga: simula milhares de dispositivos de monitoramento
+ *
+ * Cada dispositivo simulado produz amostras com formas de onda
+ * plausíveis (ciclo diário de temperatura, umidade e luz, eventos de
+ * gás e falhas ocasionais do DHT22) e as codifica com o mesmo
+ * telemetry_format_sample() usado pelo firmware. As mensagens são
+ * enviadas a um destino TCP, a um broker MQTT (3.1.1, QoS 0) ou a um
+ * pseudo-terminal que imita a porta serial.
+ *
+ * Cada mensagem é precedida de uma linha de enquadramento
+ * "@<device_id> <instante_de_envio_us>", que o modo "sink" usa para
+ * medir a latência de ponta a ponta (os dois lados devem compartilhar
+ * o relógio, ou seja, rodar no mesmo host ou com NTP).
+ *
+ * Uso:
+ * @code
+ * fleet_loadgen gen <tcp:host:porta|mqtt:host:porta|pty> [dispositivos] [msgs/s por dispositivo]
+ *               [duração_s] [conexões]
+ * fleet_loadgen sink <tcp:porta|mqtt:host:porta|file:caminho>
+ * @endcode
+ *
+ * Exemplo: 5000 dispositivos a 1 msg/s durante 60 s
+ * @code
+ * fleet_loadgen sink tcp:9000 &
+ * fleet_loadgen gen tcp:127.0.0.1:9000 5000 1 60
+ * @endcode
+ */
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+extern "C" {
+#include "telemetry.h"
+}
+
+#define MQTT_TOPIC_PREFIX "environment-monitoring/"
+
+static int64_t wall_us() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+static void write_all(int fd, const void *data, size_t size) {
+    const char *p = static_cast<const char *>(data);
+    while (size) {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0) throw std::runtime_error(std::string("write: ") + std::strerror(errno));
+        p += n;
+        size -= (size_t)n;
+    }
+}
+
+/**
+ * @brief Descritores fechados ao sair do escopo, inclusive por exceção
+ */
+struct FdSet {
+    std::vector<int> fds;
+    FdSet() = default;
+    FdSet(const FdSet &) = delete;
+    FdSet &operator=(const FdSet &) = delete;
+    ~FdSet() {
+        for (int fd : fds) ::close(fd);
+    }
+};
+
+static int tcp_connect(const std::string &host, const std::string &port) {
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) {
+        throw std::runtime_error("endereço inválido: " + host + ":" + port);
+    }
+    // Tenta cada endereço resolvido (IPv6 e IPv4, por exemplo) até um aceitar
+    int fd = -1;
+    for (addrinfo *ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    if (fd < 0) throw std::runtime_error("não foi possível conectar em " + host + ":" + port);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// ---------------------------------------------------------------------------
+// MQTT 3.1.1 mínimo (CONNECT, PUBLISH QoS 0, SUBSCRIBE)
+// ---------------------------------------------------------------------------
+
+static void mqtt_put_length(std::string &out, size_t len) {
+    do {
+        uint8_t b = len % 128;
+        len /= 128;
+        out.push_back((char)(len ? b | 0x80 : b));
+    } while (len);
+}
+
+static void mqtt_put_string(std::string &out, const std::string &s) {
+    out.push_back((char)(s.size() >> 8));
+    out.push_back((char)(s.size() & 0xFF));
+    out += s;
+}
+
+static void mqtt_packet(std::string &out, uint8_t type, const std::string &body) {
+    out.push_back((char)type);
+    mqtt_put_length(out, body.size());
+    out += body;
+}
+
+static int mqtt_connect(const std::string &host, const std::string &port, const std::string &client_id) {
+    FdSet owner;
+    int fd = tcp_connect(host, port);
+    owner.fds.push_back(fd);
+    std::string body, pkt;
+    mqtt_put_string(body, "MQTT");
+    body.push_back(4);          // Nível do protocolo 3.1.1
+    body.push_back(0x02);       // Clean session
+    body.push_back(0);
+    body.push_back(60);         // Keep alive 60 s
+    mqtt_put_string(body, client_id);
+    mqtt_packet(pkt, 0x10, body);
+    write_all(fd, pkt.data(), pkt.size());
+
+    uint8_t connack[4];
+    size_t got = 0;
+    while (got < sizeof(connack)) {
+        ssize_t n = ::read(fd, connack + got, sizeof(connack) - got);
+        if (n <= 0) throw std::runtime_error("broker MQTT fechou a conexão");
+        got += (size_t)n;
+    }
+    if (connack[0] != 0x20 || connack[3] != 0) {
+        throw std::runtime_error("broker MQTT recusou a conexão");
+    }
+    owner.fds.clear();
+    return fd;
+}
+
+// ---------------------------------------------------------------------------
+// Dispositivo simulado
+// ---------------------------------------------------------------------------
+
+struct SimDevice {
+    uint64_t id;
+    double phase;           // Fase do ciclo diário (rad)
+    uint32_t rng;
+    int64_t gas_until_us;   // Fim do evento de gás em andamento
+    size_t connection;
+
+    uint32_t next_random() {
+        rng = rng * 1664525u + 1013904223u;
+        return rng >> 8;
+    }
+
+    double noise(double amplitude) {
+        return ((double)(next_random() & 0xFFFF) / 32768.0 - 1.0) * amplitude;
+    }
+
+    telemetry_sample_t sample(int64_t now_us) {
+        telemetry_sample_t s = {};
+        double day = (double)(now_us % 86400000000ll) / 86400e6 * 2.0 * M_PI + phase;
+
+        // Cerca de 0,5% das leituras do DHT22 falham por timeout ou checksum
+        uint32_t r = next_random() % 1000;
+        s.dht22_result = r < 3 ? -2 : r < 5 ? -1 : 0;
+        s.temperature = (float)(25.0 + 6.0 * std::sin(day) + noise(0.2));
+        s.humidity = (float)(55.0 - 12.0 * std::sin(day) + noise(0.5));
+        s.ldr_raw = (uint16_t)std::clamp(2000.0 + 1800.0 * std::sin(day - M_PI / 2) + noise(20), 0.0, 4095.0);
+
+        // Eventos de gás raros, de 30 s a 5 min
+        if (now_us >= gas_until_us && next_random() % 20000 == 0) {
+            gas_until_us = now_us + (30 + next_random() % 270) * 1000000ll;
+        }
+        double mq2 = now_us < gas_until_us ? 2600.0 + noise(300) : 400.0 + noise(15);
+        s.mq2_raw = (uint16_t)std::clamp(mq2, 0.0, 4095.0);
+        s.gas_alarm = s.mq2_raw > 2000;
+        return s;
+    }
+};
+
+static double percentile(std::vector<int64_t> &v, double p) {
+    if (v.empty()) return 0;
+    size_t k = std::min(v.size() - 1, (size_t)(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return (double)v[k];
+}
+
+// ---------------------------------------------------------------------------
+// Modo gerador
+// ---------------------------------------------------------------------------
+
+enum class SinkKind { Tcp, Mqtt, Pty };
+
+static int run_generator(int argc, char **argv) {
+    std::string target = argv[2];
+    size_t devices = argc > 3 ? std::strtoul(argv[3], nullptr, 0) : 1000;
+    double rate = argc > 4 ? std::atof(argv[4]) : 1.0;
+    double duration = argc > 5 ? std::atof(argv[5]) : 30.0;
+    size_t connections = argc > 6 ? std::strtoul(argv[6], nullptr, 0) : 1;
+    if (devices == 0 || rate <= 0 || connections == 0) {
+        throw std::runtime_error("parâmetros inválidos");
+    }
+
+    SinkKind kind;
+    std::string host, port;
+    if (target == "pty") {
+        kind = SinkKind::Pty;
+        connections = 1;
+    } else {
+        size_t a = target.find(':'), b = target.rfind(':');
+        if (a == std::string::npos || a == b) throw std::runtime_error("destino inválido: " + target);
+        kind = target.compare(0, a, "mqtt") == 0 ? SinkKind::Mqtt : SinkKind::Tcp;
+        host = target.substr(a + 1, b - a - 1);
+        port = target.substr(b + 1);
+    }
+
+    FdSet owner;    // Todos os descritores abertos aqui, fechados em qualquer saída
+    std::vector<int> fds;
+    if (kind == SinkKind::Pty) {
+        int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+        if (master >= 0) owner.fds.push_back(master);
+        if (master < 0 || ::grantpt(master) != 0 || ::unlockpt(master) != 0) {
+            throw std::runtime_error("não foi possível criar o pseudo-terminal");
+        }
+        const char *slave = ::ptsname(master);
+        // O escravo fica aberto durante a execução, para o mestre não ver EIO sem leitor
+        int sfd = ::open(slave, O_RDWR | O_NOCTTY);
+        if (sfd >= 0) owner.fds.push_back(sfd);
+        termios tio;
+        if (sfd >= 0 && ::tcgetattr(sfd, &tio) == 0) {
+            ::cfmakeraw(&tio);
+            ::tcsetattr(sfd, TCSANOW, &tio);
+        }
+        std::fprintf(stderr, "porta serial simulada: %s\n", slave);
+        fds.push_back(master);
+    } else {
+        for (size_t c = 0; c < connections; c++) {
+            fds.push_back(kind == SinkKind::Mqtt
+                              ? mqtt_connect(host, port, "em-loadgen-" + std::to_string(c))
+                              : tcp_connect(host, port));
+            owner.fds.push_back(fds.back());
+        }
+    }
+
+    const int64_t period_us = (int64_t)(1e6 / rate);
+    std::vector<SimDevice> fleet(devices);
+    using Due = std::pair<int64_t, size_t>;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> schedule;
+
+    const int64_t start = wall_us();
+    for (size_t d = 0; d < devices; d++) {
+        fleet[d] = {d, (double)(d % 360) * M_PI / 180.0, (uint32_t)(d * 2654435761u + 1), 0, d % connections};
+        // Espalha os dispositivos uniformemente dentro do primeiro período
+        schedule.push({start + (int64_t)(d * period_us / devices), d});
+    }
+
+    std::vector<std::string> pending(fds.size());
+    std::vector<int64_t> lag;
+    uint64_t sent = 0, bytes = 0, interval_sent = 0;
+    int64_t next_report = start + 1000000;
+    const int64_t end = start + (int64_t)(duration * 1e6);
+    char text[256];
+
+    auto flush = [&](size_t c) {
+        if (pending[c].empty()) return;
+        write_all(fds[c], pending[c].data(), pending[c].size());
+        bytes += pending[c].size();
+        pending[c].clear();
+    };
+
+    while (!schedule.empty()) {
+        Due due = schedule.top();
+        if (due.first >= end) break;
+
+        int64_t now = wall_us();
+        if (due.first > now) {
+            // Nada a enviar agora: esvazia os buffers antes de dormir
+            for (size_t c = 0; c < fds.size(); c++) flush(c);
+            now = wall_us();
+            if (due.first - now > 200) {
+                std::this_thread::sleep_for(std::chrono::microseconds(due.first - now - 100));
+            }
+            continue;
+        }
+        schedule.pop();
+
+        SimDevice &dev = fleet[due.second];
+        telemetry_sample_t s = dev.sample(now);
+        int header = std::snprintf(text, sizeof(text), "@%llu %lld\n",
+                                   (unsigned long long)dev.id, (long long)now);
+        int body = telemetry_format_sample(text + header, sizeof(text) - header, &s);
+
+        std::string &out = pending[dev.connection];
+        if (kind == SinkKind::Mqtt) {
+            std::string payload;
+            mqtt_put_string(payload, MQTT_TOPIC_PREFIX + std::to_string(dev.id) + "/telemetry");
+            payload.append(text, (size_t)(header + body));
+            mqtt_packet(out, 0x30, payload);
+        } else {
+            out.append(text, (size_t)(header + body));
+        }
+        if (out.size() > 16384) flush(dev.connection);
+
+        lag.push_back(now - due.first);
+        sent++;
+        interval_sent++;
+        schedule.push({due.first + period_us, due.second});
+
+        if (now >= next_report) {
+            std::fprintf(stderr, "gerador: %llu msgs/s, atraso de agendamento p50 %.0f us p99 %.0f us\n",
+                         (unsigned long long)interval_sent, percentile(lag, 0.50), percentile(lag, 0.99));
+            interval_sent = 0;
+            lag.clear();
+            next_report += 1000000;
+        }
+    }
+    for (size_t c = 0; c < fds.size(); c++) flush(c);
+
+    double elapsed = (double)(wall_us() - start) / 1e6;
+    std::printf("dispositivos: %zu, enviadas: %llu, %.0f msgs/s, %.2f MB/s\n",
+                devices, (unsigned long long)sent, sent / elapsed, bytes / elapsed / 1e6);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Modo sink: recebe as mensagens e mede a latência
+// ---------------------------------------------------------------------------
+
+struct SinkStream {
+    int fd;
+    bool mqtt;
+    std::string buffer;
+};
+
+static void sink_lines(const char *data, size_t size, std::vector<int64_t> &latency, uint64_t &count,
+                       std::string *carry) {
+    if (carry) {
+        carry->append(data, size);
+        data = carry->data();
+        size = carry->size();
+    }
+    size_t pos = 0;
+    for (;;) {
+        const char *nl = static_cast<const char *>(std::memchr(data + pos, '\n', size - pos));
+        if (!nl) break;
+        if (data[pos] == '@') {
+            unsigned long long device;
+            long long sent_us;
+            if (std::sscanf(data + pos, "@%llu %lld", &device, &sent_us) == 2) {
+                latency.push_back(wall_us() - sent_us);
+                count++;
+            }
+        }
+        pos = (size_t)(nl - data) + 1;
+    }
+    if (carry) carry->erase(0, pos);
+}
+
+// Extrai pacotes PUBLISH completos do buffer de uma conexão MQTT
+static void sink_mqtt(SinkStream &s, std::vector<int64_t> &latency, uint64_t &count) {
+    for (;;) {
+        const std::string &b = s.buffer;
+        size_t len = 0, shift = 0, i = 1;
+        for (; i < b.size() && i < 5; i++) {
+            len |= (size_t)(b[i] & 0x7F) << shift;
+            shift += 7;
+            if (!(b[i] & 0x80)) break;
+        }
+        if (i >= b.size() || b.size() < i + 1 + len) return;
+
+        const char *body = b.data() + i + 1;
+        if (((uint8_t)b[0] >> 4) == 3 && len >= 2) {
+            size_t topic = ((uint8_t)body[0] << 8) | (uint8_t)body[1];
+            size_t header = 2 + topic + (((uint8_t)b[0] & 0x06) ? 2 : 0);
+            if (header <= len) sink_lines(body + header, len - header, latency, count, nullptr);
+        }
+        s.buffer.erase(0, i + 1 + len);
+    }
+}
+
+static int run_sink(const std::string &source) {
+    std::vector<pollfd> pfds;
+    std::vector<SinkStream> streams;
+    int listener = -1;
+
+    if (source.compare(0, 4, "tcp:") == 0) {
+        listener = ::socket(AF_INET6, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in6 addr = {};
+        addr.sin6_family = AF_INET6;
+        addr.sin6_port = htons((uint16_t)std::atoi(source.c_str() + 4));
+        addr.sin6_addr = in6addr_any;
+        if (listener < 0 || ::bind(listener, (sockaddr *)&addr, sizeof(addr)) != 0 || ::listen(listener, 128) != 0) {
+            if (listener >= 0) ::close(listener);
+            throw std::runtime_error("não foi possível escutar em " + source);
+        }
+        pfds.push_back({listener, POLLIN, 0});
+        streams.push_back({listener, false, {}});
+    } else if (source.compare(0, 5, "mqtt:") == 0) {
+        size_t b = source.rfind(':');
+        int fd = mqtt_connect(source.substr(5, b - 5), source.substr(b + 1), "em-loadgen-sink");
+        FdSet owner;
+        owner.fds.push_back(fd);
+        std::string body, pkt;
+        body.push_back(0);
+        body.push_back(1);          // Identificador do pacote
+        mqtt_put_string(body, MQTT_TOPIC_PREFIX "+/telemetry");
+        body.push_back(0);          // QoS 0
+        mqtt_packet(pkt, 0x82, body);
+        write_all(fd, pkt.data(), pkt.size());
+        owner.fds.clear();
+        pfds.push_back({fd, POLLIN, 0});
+        streams.push_back({fd, true, {}});
+    } else if (source.compare(0, 5, "file:") == 0) {
+        int fd = ::open(source.c_str() + 5, O_RDONLY | O_NOCTTY);
+        if (fd < 0) throw std::runtime_error("não foi possível abrir " + source);
+        pfds.push_back({fd, POLLIN, 0});
+        streams.push_back({fd, false, {}});
+    } else {
+        throw std::runtime_error("origem inválida: " + source);
+    }
+
+    std::vector<int64_t> latency;
+    uint64_t count = 0;
+    int64_t next_report = wall_us() + 1000000;
+    char buf[65536];
+
+    for (;;) {
+        ::poll(pfds.data(), pfds.size(), 100);
+        for (size_t i = 0; i < pfds.size(); i++) {
+            if (!(pfds[i].revents & (POLLIN | POLLHUP))) continue;
+            if (pfds[i].fd == listener) {
+                int fd = ::accept(listener, nullptr, nullptr);
+                if (fd >= 0) {
+                    pfds.push_back({fd, POLLIN, 0});
+                    streams.push_back({fd, false, {}});
+                }
+                continue;
+            }
+            ssize_t n = ::read(pfds[i].fd, buf, sizeof(buf));
+            if (n <= 0) {
+                ::close(pfds[i].fd);
+                pfds.erase(pfds.begin() + i);
+                streams.erase(streams.begin() + i);
+                i--;
+                continue;
+            }
+            SinkStream &s = streams[i];
+            if (s.mqtt) {
+                s.buffer.append(buf, (size_t)n);
+                sink_mqtt(s, latency, count);
+            } else {
+                sink_lines(buf, (size_t)n, latency, count, &s.buffer);
+            }
+        }
+
+        int64_t now = wall_us();
+        if (now >= next_report) {
+            if (count) {
+                std::printf("sink: %llu msgs/s, latência p50 %.0f us p90 %.0f us p99 %.0f us p99.9 %.0f us\n",
+                            (unsigned long long)count, percentile(latency, 0.50),
+                            percentile(latency, 0.90), percentile(latency, 0.99),
+                            percentile(latency, 0.999));
+                std::fflush(stdout);
+            }
+            latency.clear();
+            count = 0;
+            next_report += 1000000;
+        }
+        if (pfds.empty()) return 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3 || (std::strcmp(argv[1], "gen") && std::strcmp(argv[1], "sink"))) {
+        std::fprintf(stderr,
+                     "uso: %s gen <tcp:host:porta|mqtt:host:porta|pty> [dispositivos] [msgs/s] "
+                     "[duração_s] [conexões]\n"
+                     "     %s sink <tcp:porta|mqtt:host:porta|file:caminho>\n",
+                     argv[0], argv[0]);
+        return 2;
+    }
+    // Um destino que fecha a conexão vira erro de write(), não término por SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+    try {
+        return std::strcmp(argv[1], "gen") == 0 ? run_generator(argc, argv) : run_sink(argv[2]);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "erro: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * @file fleet_query.cpp
+ * @brief Implementação do motor de consulta paralela
+ */
+#include "fleet_query.h"
+
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+void bucket_reduce(const int32_t *v, size_t n, BucketStats &out) {
+    size_t i = 0;
+    int32_t vmin = out.min, vmax = out.max;
+    int64_t sum = 0;
+
+#if defined(__AVX2__)
+    if (n >= 8) {
+        __m256i mn = _mm256_set1_epi32(vmin);
+        __m256i mx = _mm256_set1_epi32(vmax);
+        __m256i acc = _mm256_setzero_si256();   // 4 somas de 64 bits
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(v + i));
+            mn = _mm256_min_epi32(mn, x);
+            mx = _mm256_max_epi32(mx, x);
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+        }
+        alignas(32) int32_t lanes_min[8], lanes_max[8];
+        alignas(32) int64_t lanes_sum[4];
+        _mm256_store_si256((__m256i *)lanes_min, mn);
+        _mm256_store_si256((__m256i *)lanes_max, mx);
+        _mm256_store_si256((__m256i *)lanes_sum, acc);
+        for (int k = 0; k < 8; k++) {
+            if (lanes_min[k] < vmin) vmin = lanes_min[k];
+            if (lanes_max[k] > vmax) vmax = lanes_max[k];
+        }
+        sum = lanes_sum[0] + lanes_sum[1] + lanes_sum[2] + lanes_sum[3];
+    }
+#elif defined(__SSE4_1__)
+    if (n >= 4) {
+        __m128i mn = _mm_set1_epi32(vmin);
+        __m128i mx = _mm_set1_epi32(vmax);
+        __m128i acc = _mm_setzero_si128();      // 2 somas de 64 bits
+        for (; i + 4 <= n; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i *)(v + i));
+            mn = _mm_min_epi32(mn, x);
+            mx = _mm_max_epi32(mx, x);
+            acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(x));
+            acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(x, 8)));
+        }
+        alignas(16) int32_t lanes_min[4], lanes_max[4];
+        alignas(16) int64_t lanes_sum[2];
+        _mm_store_si128((__m128i *)lanes_min, mn);
+        _mm_store_si128((__m128i *)lanes_max, mx);
+        _mm_store_si128((__m128i *)lanes_sum, acc);
+        for (int k = 0; k < 4; k++) {
+            if (lanes_min[k] < vmin) vmin = lanes_min[k];
+            if (lanes_max[k] > vmax) vmax = lanes_max[k];
+        }
+        sum = lanes_sum[0] + lanes_sum[1];
+    }
+#endif
+
+    for (; i < n; i++) {
+        if (v[i] < vmin) vmin = v[i];
+        if (v[i] > vmax) vmax = v[i];
+        sum += v[i];
+    }
+
+    out.min = vmin;
+    out.max = vmax;
+    out.sum += sum;
+    out.count += n;
+}
+
+FleetQuery::FleetQuery(const std::vector<std::string> &paths) {
+    for (const auto &p : paths) {
+        readers_.emplace_back(new SeriesReader(p));
+    }
+}
+
+uint64_t FleetQuery::sample_count() const {
+    uint64_t total = 0;
+    for (const auto &r : readers_) total += r->sample_count();
+    return total;
+}
+
+std::vector<DeviceBuckets> FleetQuery::run(const TimeBucketQuery &q, WorkPool &pool) const {
+    if (q.bucket_us <= 0 || q.t1 < q.t0 || q.chunks_per_task == 0 || q.channel < 0 || q.channel >= SERIES_CH_COUNT) {
+        throw std::invalid_argument("consulta inválida: bucket <= 0, t1 < t0 ou canal desconhecido");
+    }
+    // t1 - t0 em unsigned: não transborda mesmo com os extremos de int64
+    const size_t bucket_count = (size_t)(((uint64_t)q.t1 - (uint64_t)q.t0) / (uint64_t)q.bucket_us + 1);
+    std::vector<DeviceBuckets> result(readers_.size());
+    std::vector<std::mutex> locks(readers_.size());
+
+    for (size_t d = 0; d < readers_.size(); d++) {
+        const SeriesReader &reader = *readers_[d];
+        result[d].device_id = reader.device_id();
+        result[d].buckets.resize(bucket_count);
+
+        auto range = reader.chunk_range(q.t0, q.t1);
+        for (size_t first = range.first; first < range.second; first += q.chunks_per_task) {
+            size_t last = std::min(first + q.chunks_per_task, range.second);
+            pool.submit([&, d, first, last] {
+                const SeriesReader &r = *readers_[d];
+
+                // Buckets tocados por esta fatia: o leitor garante chunks ordenados no tempo e
+                // cada instante dentro do [t_min, t_max] do seu chunk, então b fica em [b0, b1]
+                int64_t lo_t = std::max(r.chunk(first).t_min, q.t0);
+                size_t b0 = (size_t)((lo_t - q.t0) / q.bucket_us);
+                int64_t hi_t = std::min(r.chunk(last - 1).t_max, q.t1);
+                size_t b1 = (size_t)((hi_t - q.t0) / q.bucket_us);
+                std::vector<BucketStats> partial(b1 - b0 + 1);
+
+                r.scan_chunks(first, last, q.t0, q.t1, q.channel, INT32_MIN, INT32_MAX,
+                              [&](const int64_t *t, const int32_t *v, size_t n) {
+                    size_t i = 0;
+                    while (i < n) {
+                        size_t b = (size_t)((t[i] - q.t0) / q.bucket_us);
+                        int64_t end = q.t0 + (int64_t)(b + 1) * q.bucket_us;
+                        size_t j = std::lower_bound(t + i, t + n, end) - t;
+                        bucket_reduce(v + i, j - i, partial[b - b0]);
+                        i = j;
+                    }
+                });
+
+                std::lock_guard<std::mutex> lock(locks[d]);
+                for (size_t k = 0; k < partial.size(); k++) {
+                    if (partial[k].count) result[d].buckets[b0 + k].merge(partial[k]);
+                }
+            });
+        }
+    }
+
+    pool.wait();
+    return result;
+}
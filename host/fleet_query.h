@@ -0,0 +1,94 @@
+/**
+ * @file fleet_query.h
+ * @brief Agregações por intervalo de tempo sobre os arquivos de série da frota
+ */
+#ifndef FLEET_QUERY_H
+#define FLEET_QUERY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "series_reader.h"
+#include "work_pool.h"
+
+/**
+ * @brief Estatísticas parciais de um bucket de tempo
+ *
+ * Mínimo, máximo, soma e contagem são combináveis, então resultados
+ * parciais de threads diferentes podem ser mesclados em qualquer ordem.
+ */
+struct BucketStats {
+    int64_t sum = 0;
+    uint64_t count = 0;
+    int32_t min = INT32_MAX;
+    int32_t max = INT32_MIN;
+
+    void merge(const BucketStats &o) {
+        sum += o.sum;
+        count += o.count;
+        if (o.min < min) min = o.min;
+        if (o.max > max) max = o.max;
+    }
+};
+
+/**
+ * @brief Consulta "agregado de um canal por dispositivo a cada bucket_us"
+ *
+ * Os buckets são alinhados a t0: o bucket k cobre
+ * [t0 + k * bucket_us, t0 + (k + 1) * bucket_us).
+ */
+struct TimeBucketQuery {
+    series_channel_t channel = SERIES_CH_MQ2;
+    int64_t t0 = 0;
+    int64_t t1 = 0;
+    int64_t bucket_us = 3600ll * 1000000;
+    size_t chunks_per_task = 64;    // Granularidade da divisão do trabalho
+};
+
+/**
+ * @brief Resultado de um dispositivo: um BucketStats por bucket
+ *
+ * Buckets sem amostras ficam com count == 0.
+ */
+struct DeviceBuckets {
+    uint64_t device_id = 0;
+    std::vector<BucketStats> buckets;
+};
+
+/**
+ * @brief Motor de consulta paralela sobre um conjunto de arquivos de série
+ *
+ * Cada arquivo é dividido em fatias de chunks que viram tarefas no
+ * WorkPool. Uma tarefa descomprime apenas a coluna de tempo e a coluna
+ * consultada, reduz cada bucket com um kernel SIMD e mescla o
+ * resultado parcial no dispositivo correspondente.
+ */
+class FleetQuery {
+public:
+    explicit FleetQuery(const std::vector<std::string> &paths);
+
+    size_t device_count() const { return readers_.size(); }
+    uint64_t sample_count() const;
+
+    /**
+     * @brief Executa a consulta
+     *
+     * @throws std::invalid_argument com bucket_us <= 0, t1 < t0 ou canal inválido
+     * @throws std::runtime_error com um chunk corrompido (relançada por WorkPool::wait())
+     */
+    std::vector<DeviceBuckets> run(const TimeBucketQuery &query, WorkPool &pool) const;
+
+private:
+    std::vector<std::unique_ptr<SeriesReader>> readers_;
+};
+
+/**
+ * @brief Reduz um bloco contíguo de valores (mínimo, máximo, soma, contagem)
+ *
+ * Usa AVX2 ou SSE4.1 quando disponíveis em tempo de compilação e cai
+ * para um laço escalar caso contrário.
+ */
+void bucket_reduce(const int32_t *v, size_t n, BucketStats &out);
+
+#endif // FLEET_QUERY_H
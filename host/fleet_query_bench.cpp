@@ -0,0 +1,101 @@
+/**
+ * @file fleet_query_bench.cpp
+ * @brief Benchmark de escalabilidade do motor de consulta paralela
+ *
+ * Gera (uma única vez) uma frota sintética de arquivos de série e
+ * executa "máximo do MQ2 por dispositivo por hora" sobre toda a série
+ * com 1, 2, 4, ... threads até o número de núcleos, imprimindo vazão e
+ * speedup relativo a uma thread. Os resultados de cada execução são
+ * comparados com os da execução de referência.
+ *
+ * Uso:
+ * @code
+ * fleet_query_bench <diretório> [dispositivos] [amostras_por_dispositivo]
+ * @endcode
+ *
+ * O padrão é 64 dispositivos com 30 dias a 1 amostra/s.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <sys/stat.h>
+
+#include "fleet_query.h"
+#include "series_synth.h"
+
+using bench_clock = std::chrono::steady_clock;
+
+static bool same_result(const std::vector<DeviceBuckets> &a, const std::vector<DeviceBuckets> &b) {
+    if (a.size() != b.size()) return false;
+    for (size_t d = 0; d < a.size(); d++) {
+        for (size_t k = 0; k < a[d].buckets.size(); k++) {
+            const BucketStats &x = a[d].buckets[k], &y = b[d].buckets[k];
+            if (x.count != y.count || x.sum != y.sum || x.min != y.min || x.max != y.max) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "uso: %s <diretório> [dispositivos] [amostras_por_dispositivo]\n", argv[0]);
+        return 2;
+    }
+    std::string dir = argv[1];
+    unsigned devices = argc > 2 ? (unsigned)std::atoi(argv[2]) : 64;
+    uint64_t samples = argc > 3 ? std::strtoull(argv[3], nullptr, 0) : 30ull * 86400;
+
+    try {
+        ::mkdir(dir.c_str(), 0755);
+        std::vector<std::string> paths;
+        for (unsigned d = 0; d < devices; d++) {
+            std::string path = dir + "/device-" + std::to_string(d) + ".ems";
+            struct stat st;
+            if (::stat(path.c_str(), &st) != 0) {
+                series_synth_write(path, d, samples);
+            }
+            paths.push_back(path);
+        }
+
+        FleetQuery fleet(paths);
+        TimeBucketQuery q;
+        q.channel = SERIES_CH_MQ2;
+        q.t0 = 0;
+        q.t1 = (int64_t)samples * 1000000;
+        q.bucket_us = 3600ll * 1000000;
+
+        const double total = (double)fleet.sample_count();
+        std::printf("%zu dispositivos, %.0f amostras\n", fleet.device_count(), total);
+
+        unsigned max_threads = std::thread::hardware_concurrency();
+        if (max_threads == 0) max_threads = 1;
+
+        std::vector<DeviceBuckets> reference;
+        double base = 0;
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+            WorkPool pool(threads);
+            fleet.run(q, pool);     // Aquece o page cache
+
+            auto start = bench_clock::now();
+            auto result = fleet.run(q, pool);
+            double t = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+            if (threads == 1) {
+                reference = std::move(result);
+                base = t;
+            } else if (!same_result(reference, result)) {
+                std::fprintf(stderr, "erro: resultado com %u threads difere da referência\n", threads);
+                return 1;
+            }
+            std::printf("%2u threads: %8.1f ms  %7.1f M amostras/s  speedup %.2fx  roubos %llu\n",
+                        threads, t * 1e3, total / t / 1e6, base / t,
+                        (unsigned long long)pool.steals());
+            if (threads < max_threads && threads * 2 > max_threads) threads = max_threads / 2;
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "erro: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
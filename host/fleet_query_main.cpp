@@ -0,0 +1,91 @@
+/**
+ * @file fleet_query_main.cpp
+ * @brief Ferramenta de linha de comando para agregações sobre a frota
+ *
+ * Exemplo: máximo do MQ2 por dispositivo por hora no último mês
+ * @code
+ * fleet_query mq2 max 3600 1757000000 1759592000 device-*.ems
+ * @endcode
+ *
+ * A saída é CSV: device_id,inicio_do_bucket_s,valor
+ * Buckets sem amostras são omitidos.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "fleet_query.h"
+
+static const char *const channel_names[SERIES_CH_COUNT] = {"temperature", "humidity", "ldr", "mq2"};
+
+enum Aggregate { AGG_MIN, AGG_MAX, AGG_MEAN, AGG_SUM, AGG_COUNT, AGG_KINDS };
+
+static const char *const aggregate_names[AGG_KINDS] = {"min", "max", "mean", "sum", "count"};
+
+static void usage(const char *prog) {
+    std::fprintf(stderr,
+                 "uso: %s [-j threads] <temperature|humidity|ldr|mq2> "
+                 "<min|max|mean|sum|count> <bucket_s> <t0_s> <t1_s> arquivo...\n",
+                 prog);
+}
+
+int main(int argc, char **argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    int arg = 1;
+    if (arg + 1 < argc && std::strcmp(argv[arg], "-j") == 0) {
+        threads = (unsigned)std::atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (argc - arg < 6) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    TimeBucketQuery q;
+    int channel = -1;
+    for (int c = 0; c < SERIES_CH_COUNT; c++) {
+        if (std::strcmp(argv[arg], channel_names[c]) == 0) channel = c;
+    }
+    int agg = -1;
+    for (int a = 0; a < AGG_KINDS; a++) {
+        if (std::strcmp(argv[arg + 1], aggregate_names[a]) == 0) agg = a;
+    }
+    if (channel < 0 || agg < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    q.channel = (series_channel_t)channel;
+    q.bucket_us = std::atoll(argv[arg + 2]) * 1000000;
+    q.t0 = std::atoll(argv[arg + 3]) * 1000000;
+    q.t1 = std::atoll(argv[arg + 4]) * 1000000 - 1;
+    if (q.bucket_us <= 0 || q.t1 < q.t0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    try {
+        FleetQuery fleet(std::vector<std::string>(argv + arg + 5, argv + argc));
+        WorkPool pool(threads);
+        for (const DeviceBuckets &dev : fleet.run(q, pool)) {
+            for (size_t k = 0; k < dev.buckets.size(); k++) {
+                const BucketStats &b = dev.buckets[k];
+                if (!b.count) continue;
+                double value = 0;
+                switch (agg) {
+                case AGG_MIN: value = b.min; break;
+                case AGG_MAX: value = b.max; break;
+                case AGG_MEAN: value = (double)b.sum / b.count; break;
+                case AGG_SUM: value = (double)b.sum; break;
+                case AGG_COUNT: value = (double)b.count; break;
+                }
+                std::printf("%llu,%lld,%g\n", (unsigned long long)dev.device_id,
+                            (long long)((q.t0 + (int64_t)k * q.bucket_us) / 1000000), value);
+            }
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "erro: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
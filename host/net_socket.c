@@ -0,0 +1,169 @@
+/**
+ * @file net_socket.c
+ * @brief Implementação de net.h com sockets POSIX, para as ferramentas do host
+ *
+ * Os sockets são não bloqueantes e os callbacks de recepção são chamados
+ * de dentro de net_poll(), na thread que a chama. A resolução usa
+ * getaddrinfo() e bloqueia até a resposta; o enlace está sempre pronto.
+ *
+ * No TCP, NET_TCP_TX_BYTES vira o SO_SNDBUF das conexões (o sistema
+ * impõe um mínimo de alguns KiB), para que um cliente que não lê encha o
+ * buffer logo, como no dispositivo.
+ */
+#include "net.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct net_udp {
+    bool open;
+    int fd;
+    net_udp_recv_fn on_recv;
+    void *ctx;
+};
+
+struct net_tcp_listener {
+    bool open;
+    int fd;
+};
+
+struct net_tcp {
+    bool open;
+    int fd;
+};
+
+static net_udp_t udp_sockets[NET_UDP_SOCKETS];
+static net_tcp_listener_t tcp_listener;
+static net_tcp_t tcp_conns[NET_TCP_CONNECTIONS];
+
+int net_init(void) {
+    return NET_OK;
+}
+
+bool net_is_up(void) {
+    return true;
+}
+
+void net_poll(void) {
+    uint8_t data[NET_UDP_MAX_PAYLOAD];
+    for (int i = 0; i < NET_UDP_SOCKETS; i++) {
+        net_udp_t *udp = &udp_sockets[i];
+        while (udp->open) {
+            ssize_t len = recv(udp->fd, data, sizeof(data), 0);
+            if (len < 0) break;
+            udp->on_recv(udp->ctx, data, (size_t)len);
+        }
+    }
+}
+
+int net_resolve(const char *host, net_addr_t *addr) {
+    struct in_addr in;
+    if (inet_pton(AF_INET, host, &in) != 1) {
+        struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_DGRAM};
+        struct addrinfo *result;
+        if (getaddrinfo(host, NULL, &hints, &result) != 0) return NET_ERROR_RESOLVE;
+        in = ((const struct sockaddr_in *)result->ai_addr)->sin_addr;
+        freeaddrinfo(result);
+    }
+    memcpy(addr->bytes, &in.s_addr, 4);
+    return NET_OK;
+}
+
+net_udp_t *net_udp_open(net_udp_recv_fn on_recv, void *ctx) {
+    for (int i = 0; i < NET_UDP_SOCKETS; i++) {
+        net_udp_t *udp = &udp_sockets[i];
+        if (udp->open) continue;
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) return NULL;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        udp->open = true;
+        udp->fd = fd;
+        udp->on_recv = on_recv;
+        udp->ctx = ctx;
+        return udp;
+    }
+    return NULL;
+}
+
+int net_udp_sendto(net_udp_t *udp, const net_addr_t *addr, uint16_t port, const void *data, size_t len) {
+    struct sockaddr_in to = {.sin_family = AF_INET, .sin_port = htons(port)};
+    memcpy(&to.sin_addr.s_addr, addr->bytes, 4);
+    ssize_t sent = sendto(udp->fd, data, len, 0, (const struct sockaddr *)&to, sizeof(to));
+    return sent == (ssize_t)len ? NET_OK : NET_ERROR_SEND;
+}
+
+void net_udp_close(net_udp_t *udp) {
+    close(udp->fd);
+    udp->open = false;
+}
+
+net_tcp_listener_t *net_tcp_listen(uint16_t port) {
+    if (tcp_listener.open) return NULL;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return NULL;
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    struct sockaddr_in local = {.sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_ANY)};
+    if (bind(fd, (const struct sockaddr *)&local, sizeof(local)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return NULL;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    tcp_listener.open = true;
+    tcp_listener.fd = fd;
+    return &tcp_listener;
+}
+
+uint16_t net_tcp_local_port(const net_tcp_listener_t *listener) {
+    struct sockaddr_in local;
+    socklen_t len = sizeof(local);
+    if (getsockname(listener->fd, (struct sockaddr *)&local, &len) != 0) return 0;
+    return ntohs(local.sin_port);
+}
+
+net_tcp_t *net_tcp_accept(net_tcp_listener_t *listener) {
+    for (;;) {
+        int fd = accept(listener->fd, NULL, NULL);
+        if (fd < 0) return NULL;
+        for (int i = 0; i < NET_TCP_CONNECTIONS; i++) {
+            net_tcp_t *conn = &tcp_conns[i];
+            if (conn->open) continue;
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            int on = 1, size = NET_TCP_TX_BYTES;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+            conn->open = true;
+            conn->fd = fd;
+            return conn;
+        }
+        // Sem vaga: recusa e tenta a próxima da fila do sistema
+        close(fd);
+    }
+}
+
+int net_tcp_recv(net_tcp_t *conn, void *buf, size_t max) {
+    if (max == 0) return 0;
+    ssize_t n = recv(conn->fd, buf, max, MSG_DONTWAIT);
+    if (n > 0) return (int)n;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+    return NET_ERROR_CLOSED;
+}
+
+int net_tcp_send(net_tcp_t *conn, const void *data, size_t len) {
+    ssize_t n = send(conn->fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n >= 0) return (int)n;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+    return NET_ERROR_CLOSED;
+}
+
+void net_tcp_close(net_tcp_t *conn) {
+    close(conn->fd);
+    conn->open = false;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file dht22_waveform.c
+ * @brief Implementação do gerador de formas de onda do DHT22
+ */
+#include "dht22_waveform.h"
+
+#include <math.h>
+#include <string.h>
+
+static const char *const dht22_jitter_names[] = {"uniform", "gauss", "laplace"};
+
+static uint64_t wave_next(uint64_t *rng) {
+    // xorshift64*
+    uint64_t x = *rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *rng = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+// Uniforme em (0, 1)
+static double wave_unit(uint64_t *rng) {
+    return ((double)(wave_next(rng) >> 11) + 0.5) / (double)(1ull << 53);
+}
+
+static double wave_jitter(const dht22_waveform_config_t *cfg, uint64_t *rng) {
+    if (cfg->jitter_us <= 0.0) return 0.0;
+    switch (cfg->dist) {
+    case DHT22_JITTER_GAUSSIAN:
+        return cfg->jitter_us * sqrt(-2.0 * log(wave_unit(rng))) * cos(2.0 * M_PI * wave_unit(rng));
+    case DHT22_JITTER_LAPLACE: {
+        double u = wave_unit(rng) - 0.5;
+        double b = cfg->jitter_us / sqrt(2.0);
+        return u < 0 ? b * log(1.0 + 2.0 * u) : -b * log(1.0 - 2.0 * u);
+    }
+    case DHT22_JITTER_UNIFORM:
+    default:
+        return cfg->jitter_us * sqrt(3.0) * (2.0 * wave_unit(rng) - 1.0);
+    }
+}
+
+/**
+ * @brief Sequência ideal de níveis com duração perturbada por skew e jitter
+ */
+typedef struct {
+    double t;                   // Instante da próxima borda
+    dht22_waveform_t *out;
+} wave_builder_t;
+
+static void wave_edge(wave_builder_t *b, double at, bool level) {
+    dht22_waveform_t *w = b->out;
+    if (w->edge_count == DHT22_WAVEFORM_MAX_EDGES) return;
+    w->edge[w->edge_count].t_us = (uint32_t)(at + 0.5);
+    w->edge[w->edge_count].level = level;
+    w->edge_count++;
+}
+
+static void wave_interval(wave_builder_t *b, const dht22_waveform_config_t *cfg, uint64_t *rng, double nominal_us,
+                          bool level) {
+    double skew = cfg->skew > 0.0 ? cfg->skew : 1.0;
+    double d = nominal_us * skew + wave_jitter(cfg, rng);
+    if (d < 1.0) d = 1.0;
+
+    // Pulso espúrio no meio do intervalo: o nível oposto por glitch_us
+    if (cfg->glitch_prob > 0.0 && cfg->glitch_us > 0.0 && wave_unit(rng) < cfg->glitch_prob && d > cfg->glitch_us + 2) {
+        double at = b->t + 1.0 + wave_unit(rng) * (d - cfg->glitch_us - 2.0);
+        wave_edge(b, at, !level);
+        wave_edge(b, at + cfg->glitch_us, level);
+    }
+    b->t += d;
+}
+
+/**
+ * @brief Aplica o atraso das subidas e remove pulsos altos que não cruzam o limiar
+ */
+static void wave_apply_rise(dht22_waveform_t *w, double rise_us) {
+    if (rise_us <= 0.0) return;
+    int n = 0;
+    for (int i = 0; i < w->edge_count; i++) {
+        dht22_edge_t e = w->edge[i];
+        if (e.level) {
+            uint32_t crossed = e.t_us + (uint32_t)(rise_us + 0.5);
+            // A linha volta a baixo antes de chegar ao limiar: o pulso some
+            if (i + 1 < w->edge_count && w->edge[i + 1].t_us <= crossed) {
+                i++;
+                continue;
+            }
+            e.t_us = crossed;
+        }
+        w->edge[n++] = e;
+    }
+    w->edge_count = n;
+}
+
+void dht22_waveform_generate(const dht22_waveform_config_t *config, const uint8_t data[5], uint64_t *rng,
+                             dht22_waveform_t *out) {
+    memset(out, 0, sizeof(*out));
+    wave_builder_t b = {.t = 0.0, .out = out};
+
+    // Início: linha ainda em alto pelo pull-up, então o sensor responde
+    wave_interval(&b, config, rng, 20, true);
+    wave_edge(&b, b.t, false);
+    wave_interval(&b, config, rng, 80, false);
+    wave_edge(&b, b.t, true);
+    wave_interval(&b, config, rng, 80, true);
+    wave_edge(&b, b.t, false);
+
+    for (int i = 0; i < 40; i++) {
+        bool bit = data[i / 8] & (1 << (7 - (i % 8)));
+        if (config->drop_prob > 0.0 && wave_unit(rng) < config->drop_prob) continue;
+        wave_interval(&b, config, rng, 50, false);
+        wave_edge(&b, b.t, true);
+        wave_interval(&b, config, rng, bit ? 70 : 26, true);
+        wave_edge(&b, b.t, false);
+    }
+    wave_interval(&b, config, rng, 50, false);
+    wave_edge(&b, b.t, true);           // Libera a linha
+
+    wave_apply_rise(out, config->rise_us);
+
+    // Interrupções do host: chegadas de Poisson durante a transação
+    if (config->irq_every_us > 0.0 && config->irq_us > 0.0) {
+        double end = b.t + config->rise_us + 200.0;
+        double t = -config->irq_every_us * log(wave_unit(rng));
+        while (t < end && out->stall_count < DHT22_WAVEFORM_MAX_STALLS) {
+            out->stall_start_us[out->stall_count] = (uint32_t)t;
+            out->stall_end_us[out->stall_count] = (uint32_t)(t + config->irq_us);
+            out->stall_count++;
+            t += config->irq_us - config->irq_every_us * log(wave_unit(rng));
+        }
+    }
+}
+
+const char *dht22_jitter_name(dht22_jitter_dist_t dist) {
+    return (unsigned)dist < sizeof(dht22_jitter_names) / sizeof(dht22_jitter_names[0]) ? dht22_jitter_names[dist]
+                                                                                       : "?";
+}
+
+int dht22_jitter_parse(const char *name) {
+    for (int i = 0; i < (int)(sizeof(dht22_jitter_names) / sizeof(dht22_jitter_names[0])); i++) {
+        if (!strcmp(name, dht22_jitter_names[i])) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file dht22_waveform.h
+ * @brief Gerador de formas de onda da resposta do DHT22 com imperfeições físicas
+ *
+ * Produz a sequência de bordas que o sensor impõe à linha de dados depois
+ * que o host a libera, com as imperfeições que o decodificador encontra
+ * no mundo real:
+ * - desvio de escala (skew): todos os tempos nominais multiplicados, como
+ *   um sensor com oscilador lento ou rápido;
+ * - jitter por intervalo, com distribuição uniforme, gaussiana ou de
+ *   Laplace (caudas longas);
+ * - bordas de subida lentas (capacitância do cabo com o pull-up): cada
+ *   subida cruza o limiar rise_us depois; um pulso alto mais curto que
+ *   isso nem chega a ser visto;
+ * - pulsos espúrios (glitches) dentro dos bits;
+ * - bits perdidos: o par baixo/alto de um bit não é transmitido;
+ * - interrupções no host: janelas em que a CPU não consulta o pino
+ *   (chegadas de Poisson), aplicadas pelo modelo de GPIO do shim.
+ *
+ * Tempos nominais (μs): 20 até o sensor assumir a linha, 80 baixo, 80
+ * alto, e por bit 50 baixo seguido de 26 (bit 0) ou 70 (bit 1) alto; ao
+ * final, 50 baixo e a linha é liberada.
+ */
+#ifndef DHT22_WAVEFORM_H
+#define DHT22_WAVEFORM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DHT22_WAVEFORM_MAX_EDGES 248    // 84 nominais + 2 por pulso espúrio
+#define DHT22_WAVEFORM_MAX_STALLS 64
+
+typedef enum {
+    DHT22_JITTER_UNIFORM,       // Uniforme com o desvio padrão pedido
+    DHT22_JITTER_GAUSSIAN,
+    DHT22_JITTER_LAPLACE,
+} dht22_jitter_dist_t;
+
+/**
+ * @brief Imperfeições aplicadas à forma de onda (zeros: forma nominal)
+ */
+typedef struct {
+    double skew;                // Fator sobre os tempos nominais (0 ou 1: nominal)
+    double jitter_us;           // Desvio padrão do jitter de cada intervalo
+    dht22_jitter_dist_t dist;
+    double rise_us;             // Atraso da borda de subida até o limiar
+    double glitch_prob;         // Probabilidade de pulso espúrio, por bit
+    double glitch_us;           // Largura do pulso espúrio
+    double drop_prob;           // Probabilidade de bit perdido
+    double irq_every_us;        // Intervalo médio entre interrupções do host (0: nenhuma)
+    double irq_us;              // Duração de cada interrupção
+} dht22_waveform_config_t;
+
+typedef struct {
+    uint32_t t_us;              // Instante relativo à liberação da linha pelo host
+    bool level;                 // Nível a partir deste instante
+} dht22_edge_t;
+
+/**
+ * @brief Uma transação: bordas da linha e janelas ocupadas do host
+ */
+typedef struct {
+    dht22_edge_t edge[DHT22_WAVEFORM_MAX_EDGES];
+    int edge_count;
+    uint32_t stall_start_us[DHT22_WAVEFORM_MAX_STALLS];
+    uint32_t stall_end_us[DHT22_WAVEFORM_MAX_STALLS];
+    int stall_count;
+} dht22_waveform_t;
+
+/**
+ * @brief Gera a resposta do sensor para os 5 bytes de dados
+ *
+ * @param rng Estado do gerador pseudoaleatório (não nulo), atualizado
+ */
+void dht22_waveform_generate(const dht22_waveform_config_t *config, const uint8_t data[5], uint64_t *rng,
+                             dht22_waveform_t *out);
+
+/**
+ * @brief Nome da distribuição, ou -1 em dht22_jitter_parse() se desconhecida
+ */
+const char *dht22_jitter_name(dht22_jitter_dist_t dist);
+int dht22_jitter_parse(const char *name);
+
+#endif // DHT22_WAVEFORM_H
@@ -0,0 +1,27 @@
+/**
+ * @file adc.h
+ * @brief Substituto de host para hardware/adc.h
+ */
+#ifndef PICO_SHIM_ADC_H
+#define PICO_SHIM_ADC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t fifo;     // Apenas como endereço de leitura do DMA
+} adc_hw_t;
+
+extern adc_hw_t *const adc_hw;
+
+void adc_init(void);
+void adc_gpio_init(unsigned int gpio);
+void adc_select_input(unsigned int input);
+uint16_t adc_read(void);
+void adc_set_round_robin(unsigned int input_mask);
+void adc_set_temp_sensor_enabled(bool enable);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_set_clkdiv(float clkdiv);
+void adc_run(bool run);
+
+#endif // PICO_SHIM_ADC_H
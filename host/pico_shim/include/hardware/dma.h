@@ -0,0 +1,63 @@
+/**
+ * @file dma.h
+ * @brief Substituto de host para hardware/dma.h
+ *
+ * Modela apenas transferências com DREQ do ADC: um canal iniciado termina
+ * após transfer_count conversões, preenche o destino com as amostras e
+ * dispara o encadeamento e a interrupção DMA_IRQ_0.
+ */
+#ifndef PICO_SHIM_DMA_H
+#define PICO_SHIM_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NUM_DMA_CHANNELS 12
+#define DREQ_ADC 36
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+typedef struct {
+    unsigned int chain_to;
+    unsigned int dreq;
+    enum dma_channel_transfer_size size;
+    bool read_increment;
+    bool write_increment;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(unsigned int channel);
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+    c->size = size;
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    c->read_increment = incr;
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    c->write_increment = incr;
+}
+
+static inline void channel_config_set_dreq(dma_channel_config *c, unsigned int dreq) {
+    c->dreq = dreq;
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config *c, unsigned int chain_to) {
+    c->chain_to = chain_to;
+}
+
+void dma_channel_configure(unsigned int channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, unsigned int transfer_count, bool trigger);
+void dma_channel_set_write_addr(unsigned int channel, volatile void *write_addr, bool trigger);
+void dma_channel_start(unsigned int channel);
+void dma_channel_set_irq0_enabled(unsigned int channel, bool enabled);
+bool dma_channel_get_irq0_status(unsigned int channel);
+void dma_channel_acknowledge_irq0(unsigned int channel);
+
+#endif // PICO_SHIM_DMA_H
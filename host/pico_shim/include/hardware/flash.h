@@ -0,0 +1,27 @@
+/**
+ * @file flash.h
+ * @brief Substituto de host para hardware/flash.h
+ *
+ * A flash é uma imagem em RAM, lida pelo mapeamento XIP (XIP_BASE +
+ * deslocamento) como no RP2040. Apagar deixa os bytes em 0xFF e programar
+ * só consegue zerar bits, como em uma NOR real. Cada operação avança o
+ * relógio virtual pelo tempo típico da memória; as interrupções (alarmes
+ * do relógio, DMA) continuam rodando durante esse tempo.
+ */
+#ifndef PICO_SHIM_FLASH_H
+#define PICO_SHIM_FLASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+extern uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash_image)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif // PICO_SHIM_FLASH_H
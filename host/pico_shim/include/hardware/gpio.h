@@ -0,0 +1,27 @@
+/**
+ * @file gpio.h
+ * @brief Substituto de host para hardware/gpio.h
+ */
+#ifndef PICO_SHIM_GPIO_H
+#define PICO_SHIM_GPIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+enum gpio_function {
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+void gpio_init(unsigned int gpio);
+void gpio_set_dir(unsigned int gpio, bool out);
+void gpio_put(unsigned int gpio, bool value);
+bool gpio_get(unsigned int gpio);
+void gpio_set_pulls(unsigned int gpio, bool up, bool down);
+void gpio_set_function(unsigned int gpio, enum gpio_function fn);
+
+#endif // PICO_SHIM_GPIO_H
@@ -0,0 +1,26 @@
+/**
+ * @file irq.h
+ * @brief Substituto de host para hardware/irq.h
+ *
+ * Os handlers rodam dentro do avanço do relógio virtual, o que equivale a
+ * interromper o código que estava dormindo ou consultando um pino.
+ */
+#ifndef PICO_SHIM_IRQ_H
+#define PICO_SHIM_IRQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DMA_IRQ_0 11
+#define DMA_IRQ_1 12
+#define PICO_HIGHEST_IRQ_PRIORITY 0x00
+#define PICO_LOWEST_IRQ_PRIORITY 0xff
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(unsigned int num, irq_handler_t handler);
+void irq_set_priority(unsigned int num, uint8_t hardware_priority);
+void irq_set_enabled(unsigned int num, bool enabled);
+bool irq_is_enabled(unsigned int num);
+
+#endif // PICO_SHIM_IRQ_H
@@ -0,0 +1,25 @@
+/**
+ * @file pwm.h
+ * @brief Substituto de host para hardware/pwm.h
+ */
+#ifndef PICO_SHIM_PWM_H
+#define PICO_SHIM_PWM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+static inline unsigned int pwm_gpio_to_slice_num(unsigned int gpio) {
+    return (gpio >> 1) & 7;
+}
+
+static inline unsigned int pwm_gpio_to_channel(unsigned int gpio) {
+    return gpio & 1;
+}
+
+void pwm_set_wrap(unsigned int slice, uint16_t wrap);
+void pwm_set_clkdiv(unsigned int slice, float divider);
+void pwm_set_enabled(unsigned int slice, bool enabled);
+void pwm_set_gpio_level(unsigned int gpio, uint16_t level);
+void pwm_set_chan_level(unsigned int slice, unsigned int chan, uint16_t level);
+
+#endif // PICO_SHIM_PWM_H
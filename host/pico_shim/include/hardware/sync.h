@@ -0,0 +1,34 @@
+/**
+ * @file sync.h
+ * @brief Substituto de host para hardware/sync.h
+ *
+ * A simulação é monotarefa: interrupções só rodam dentro do avanço do
+ * relógio, então desabilitá-las não tem efeito. __sev() marca o registro
+ * de evento consumido por best_effort_wfe_or_timeout() (pico/time.h).
+ */
+#ifndef PICO_SHIM_SYNC_H
+#define PICO_SHIM_SYNC_H
+
+#include <stdint.h>
+
+static inline uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void sim_sev(void);
+
+static inline void __sev(void) {
+    sim_sev();
+}
+
+static inline void __wfe(void) {}
+
+#endif // PICO_SHIM_SYNC_H
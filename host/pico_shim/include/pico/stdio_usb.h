@@ -0,0 +1,15 @@
+/**
+ * @file stdio_usb.h
+ * @brief Substituto de host para pico/stdio_usb.h
+ *
+ * O enlace USB está conectado enquanto o roteiro não indicar queda
+ * ("event ... link down").
+ */
+#ifndef PICO_SHIM_STDIO_USB_H
+#define PICO_SHIM_STDIO_USB_H
+
+#include <stdbool.h>
+
+bool stdio_usb_connected(void);
+
+#endif // PICO_SHIM_STDIO_USB_H
@@ -0,0 +1,31 @@
+/**
+ * @file stdlib.h
+ * @brief Substituto de host para pico/stdlib.h
+ *
+ * Declara apenas o subconjunto do SDK usado pelo firmware. As
+ * implementações estão em pico_shim.c e rodam sobre o relógio virtual
+ * da simulação (ver sim.h).
+ */
+#ifndef PICO_SHIM_STDLIB_H
+#define PICO_SHIM_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+typedef unsigned int uint;
+
+// Atributos de seção do SDK (sem efeito no host)
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+#define __force_inline inline
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+void stdio_init_all(void);
+
+static inline void tight_loop_contents(void) {}
+
+#endif // PICO_SHIM_STDLIB_H
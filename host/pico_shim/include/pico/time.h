@@ -0,0 +1,68 @@
+/**
+ * @file time.h
+ * @brief Substituto de host para pico/time.h (relógio virtual)
+ */
+#ifndef PICO_SHIM_TIME_H
+#define PICO_SHIM_TIME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint64_t absolute_time_t;
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+absolute_time_t get_absolute_time(void);
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) {
+    return t + us;
+}
+
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) {
+    return t + (uint64_t)ms * 1000;
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+bool time_reached(absolute_time_t t);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+void busy_wait_us_32(uint32_t us);
+
+/**
+ * @brief Espera por um evento (__sev()) ou até o instante t
+ *
+ * Diferente do hardware, só acorda com __sev() ou no prazo, nunca a
+ * cada interrupção; quem chama deve tolerar os dois casos.
+ *
+ * @return true se o prazo foi alcançado
+ */
+bool best_effort_wfe_or_timeout(absolute_time_t t);
+
+/**
+ * @brief Alarmes do SDK: o callback roda quando o relógio virtual
+ *        alcança o instante; um retorno positivo reagenda em +N μs,
+ *        negativo reagenda em -N μs a partir do instante original
+ */
+alarm_id_t add_alarm_at(absolute_time_t t, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t id);
+
+#endif // PICO_SHIM_TIME_H
@@ -0,0 +1,903 @@
+/**
+ * @file pico_shim.c
+ * @brief Implementação de host do subconjunto do SDK usado pelo firmware
+ *
+ * Todo o tempo é virtual (ver sim.h). Os periféricos são modelados no
+ * nível necessário ao firmware:
+ * - GPIO: níveis de saída registrados; o pino do DHT22 é dirigido por
+ *   um modelo do sensor que responde ao sinal de início com a forma de
+ *   onda do protocolo de 1 fio (dht22_waveform.c, nominal por padrão).
+ * - ADC: cada leitura devolve a entrada selecionada no instante atual,
+ *   passada pela curva de transferência com os códigos largos do RP2040
+ *   (sim_set_adc_dnl); em modo contínuo (adc_run) as conversões alimentam
+ *   canais de DMA com DREQ do ADC, que terminam no instante exato da
+ *   última conversão do bloco.
+ * - DMA/IRQ: o fim de um bloco encadeia o próximo canal e chama o handler
+ *   de DMA_IRQ_0 dentro do avanço do relógio, como uma interrupção real;
+ *   blocos ociosos podem ser pulados (sim_set_adc_fast_forward).
+ * - PWM: níveis registrados por pino.
+ * - VCD: a atividade de todos os GPIOs e PWMs pode ser registrada em um
+ *   arquivo VCD (vcd.h); as respostas do DHT22 podem vir de capturas.
+ * - stdout: redirecionado para contar bytes e descartar a saída durante
+ *   quedas do enlace, opcionalmente com vazão limitada.
+ * - Flash: imagem em RAM com semântica de NOR e tempos típicos de apagar
+ *   e programar.
+ */
+#define _GNU_SOURCE
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "vcd.h"
+
+#define SIM_MAX_ALARMS 16
+#define SIM_ADC_CONVERSION_US 2         // Duração de uma conversão do ADC
+#define SIM_ADC_CLOCK_MHZ 48.0          // clk_adc
+#define SIM_IRQ_COUNT 32
+#define SIM_FLASH_ERASE_US 45000        // Apagar um setor de 4 kB
+#define SIM_FLASH_PROGRAM_US 500        // Programar uma página de 256 bytes
+#define SIM_ADC_SKIP_MAX_US 60000000    // Maior salto de blocos ociosos (tempos de 32 bits no firmware)
+
+typedef struct {
+    alarm_id_t id;
+    uint64_t time;
+    alarm_callback_t callback;
+    void *user_data;
+} sim_alarm_t;
+
+static struct {
+    uint64_t now;
+    uint64_t end;
+    void (*on_end)(void);
+    sim_input_fn source;
+    void *source_ctx;
+    sim_inputs_t inputs;            // Entradas do milissegundo inputs_ms
+    uint64_t inputs_ms;
+    bool echo;
+    uint32_t link_bytes_per_s;
+    bool event;                         // Registro de evento (__sev/WFE)
+    uint64_t horizon;                   // Fim do avanço em curso: o laço principal volta aí
+    sim_gpio_observer_fn observer;
+    sim_stats_t stats;
+
+    bool gpio_out[SIM_GPIO_COUNT];
+    bool gpio_level[SIM_GPIO_COUNT];
+    uint16_t pwm_level[SIM_GPIO_COUNT];
+    bool gpio_pwm[SIM_GPIO_COUNT];      // Função PWM selecionada
+    unsigned int adc_selected;
+
+    sim_alarm_t alarms[SIM_MAX_ALARMS];
+    alarm_id_t next_alarm_id;
+} sim = {.end = UINT64_MAX, .inputs_ms = UINT64_MAX, .next_alarm_id = 1};
+
+// ADC em modo contínuo, DMA e interrupções
+static struct {
+    bool running;
+    unsigned int rr_mask;
+    unsigned int rr_input;          // Próxima entrada a converter
+    double sample_us;               // Período entre conversões
+    bool temp_sensor;               // Sensor de temperatura (ADC4) ligado
+    bool transfer_ready;            // Curva de transferência construída
+    uint16_t transfer[SIM_ADC_CODES];   // Código do RP2040 para cada código ideal
+    sim_input_bounds_fn bounds;     // Blocos ociosos (sim_set_adc_fast_forward)
+    sim_adc_idle_fn idle;
+} adc_state = {.sample_us = SIM_ADC_CONVERSION_US};
+
+typedef struct {
+    bool claimed;
+    dma_channel_config config;
+    volatile void *write_addr;
+    unsigned int count;
+    bool busy;
+    alarm_id_t completion;          // Alarme que encerra a transferência
+    double started_us;              // Início da transferência (fracionário)
+    bool irq0_enabled;
+    bool irq0_status;
+} sim_dma_channel_t;
+
+static sim_dma_channel_t dma_ch[NUM_DMA_CHANNELS];
+static irq_handler_t irq_handler[SIM_IRQ_COUNT];
+static bool irq_on[SIM_IRQ_COUNT];
+
+static adc_hw_t adc_hw_regs;
+adc_hw_t *const adc_hw = &adc_hw_regs;
+
+// Modelo do DHT22
+static struct {
+    unsigned int pin;
+    uint64_t low_since;             // Início do nível baixo imposto pelo host
+    uint64_t low_duration;          // Duração do último nível baixo imposto
+    uint64_t low_end;               // Subida que encerrou esse nível baixo
+    dht22_waveform_config_t waveform;
+    uint64_t rng;
+    uint64_t start;                 // Instante em que o host liberou a linha
+    dht22_waveform_t wave;          // Bordas e interrupções relativas a start
+    int edge_index;
+    int stall_index;
+    const dht22_waveform_t *replay; // Respostas capturadas, reproduzidas em ciclo
+    int replay_count;
+    int replay_next;
+    bool polled;                    // Já houve uma consulta ao pino
+    bool last_level;                // Nível devolvido na última consulta
+} dht = {.pin = 2, .rng = 0x9E3779B97F4A7C15ull};
+
+// Registro em VCD
+static struct {
+    bool on;
+    vcd_writer_t writer;
+    bool line[SIM_GPIO_COUNT];      // Último nível registrado de cada linha
+    int dht_index;                  // Próxima borda do sensor a registrar
+} vcd;
+
+static void vcd_dht_flush(uint64_t until_us);
+static void vcd_line_changed(unsigned int gpio);
+
+// ---------------------------------------------------------------------------
+// Relógio virtual
+// ---------------------------------------------------------------------------
+
+void sim_init(uint64_t start_us, uint64_t end_us, void (*on_end)(void)) {
+    sim.now = start_us;
+    sim.end = end_us;
+    sim.on_end = on_end;
+}
+
+void sim_set_input_source(sim_input_fn fn, void *ctx) {
+    sim.source = fn;
+    sim.source_ctx = ctx;
+    sim.inputs_ms = UINT64_MAX;
+}
+
+void sim_set_dht22_pin(unsigned int gpio) {
+    dht.pin = gpio;
+}
+
+void sim_set_dht22_waveform(const dht22_waveform_config_t *config, uint64_t seed) {
+    dht.waveform = *config;
+    dht.rng = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+void sim_set_dht22_replay(const dht22_waveform_t *responses, int count) {
+    dht.replay = responses;
+    dht.replay_count = count;
+    dht.replay_next = 0;
+}
+
+void sim_set_echo(bool echo) {
+    sim.echo = echo;
+}
+
+void sim_set_adc_fast_forward(sim_input_bounds_fn bounds, sim_adc_idle_fn idle) {
+    adc_state.bounds = bounds;
+    adc_state.idle = idle;
+}
+
+void sim_set_link_rate(uint32_t bytes_per_s) {
+    sim.link_bytes_per_s = bytes_per_s;
+}
+
+void sim_set_gpio_observer(sim_gpio_observer_fn fn) {
+    sim.observer = fn;
+}
+
+uint64_t sim_now_us(void) {
+    return sim.now;
+}
+
+const sim_stats_t *sim_stats(void) {
+    return &sim.stats;
+}
+
+bool sim_gpio_level(unsigned int gpio) {
+    return gpio < SIM_GPIO_COUNT && sim.gpio_level[gpio];
+}
+
+uint16_t sim_pwm_level(unsigned int gpio) {
+    return gpio < SIM_GPIO_COUNT ? sim.pwm_level[gpio] : 0;
+}
+
+static sim_alarm_t *next_alarm(void) {
+    sim_alarm_t *next = NULL;
+    for (int i = 0; i < SIM_MAX_ALARMS; i++) {
+        if (sim.alarms[i].id && (!next || sim.alarms[i].time < next->time)) {
+            next = &sim.alarms[i];
+        }
+    }
+    return next;
+}
+
+/**
+ * @brief Dispara, em ordem, os alarmes vencidos até t_us
+ *
+ * Com until_event, para logo após o alarme que sinalizar um evento.
+ */
+static void sim_advance(uint64_t t_us, bool until_event) {
+    sim_alarm_t *a;
+    uint64_t horizon = sim.horizon;
+    sim.horizon = t_us;
+    while ((a = next_alarm()) && a->time <= t_us && !(until_event && sim.event)) {
+        if (a->time > sim.now) sim.now = a->time;
+        alarm_id_t id = a->id;
+        int64_t r = a->callback(id, a->user_data);
+        if (a->id != id) continue;  // Cancelado dentro do callback
+        if (r > 0) {
+            a->time = sim.now + (uint64_t)r;
+        } else if (r < 0) {
+            a->time = a->time + (uint64_t)(-r);
+        } else {
+            a->id = 0;
+        }
+    }
+    sim.horizon = horizon;
+
+    if (t_us > sim.now && !(until_event && sim.event)) sim.now = t_us;
+
+    if (sim.now >= sim.end && sim.on_end) {
+        void (*fn)(void) = sim.on_end;
+        sim.on_end = NULL;
+        fn();
+    }
+}
+
+void sim_advance_to(uint64_t t_us) {
+    sim_advance(t_us, false);
+}
+
+static const sim_inputs_t *sim_input_cache(uint64_t t_us) {
+    // Entradas discretizadas em 1 ms (ver sim.h)
+    uint64_t ms = t_us / 1000;
+    if (ms != sim.inputs_ms) {
+        sim.inputs = (sim_inputs_t){.temperature = 25.0f, .humidity = 50.0f, .link_up = true};
+        if (sim.source) sim.source(ms * 1000, &sim.inputs, sim.source_ctx);
+        sim.inputs_ms = ms;
+    }
+    return &sim.inputs;
+}
+
+static sim_inputs_t sim_inputs_at(uint64_t t_us) {
+    return *sim_input_cache(t_us);
+}
+
+static sim_inputs_t sim_inputs(void) {
+    return sim_inputs_at(sim.now);
+}
+
+// ---------------------------------------------------------------------------
+// pico/time.h
+// ---------------------------------------------------------------------------
+
+uint32_t time_us_32(void) {
+    return (uint32_t)sim.now;
+}
+
+uint64_t time_us_64(void) {
+    return sim.now;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return sim.now;
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us) {
+    return sim.now + us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return sim.now + (uint64_t)ms * 1000;
+}
+
+bool time_reached(absolute_time_t t) {
+    return sim.now >= t;
+}
+
+void sleep_us(uint64_t us) {
+    sim_advance_to(sim.now + us);
+}
+
+void sleep_ms(uint32_t ms) {
+    sim_advance_to(sim.now + (uint64_t)ms * 1000);
+}
+
+void sleep_until(absolute_time_t t) {
+    sim_advance_to(t);
+}
+
+void sim_sev(void) {
+    sim.event = true;
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t t) {
+    sim_advance(t, true);
+    sim.event = false;
+    return sim.now >= t;
+}
+
+void busy_wait_us_32(uint32_t us) {
+    sim_advance_to(sim.now + us);
+}
+
+alarm_id_t add_alarm_at(absolute_time_t t, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    if (t <= sim.now && !fire_if_past) return 0;
+    for (int i = 0; i < SIM_MAX_ALARMS; i++) {
+        if (!sim.alarms[i].id) {
+            sim.alarms[i] = (sim_alarm_t){sim.next_alarm_id++, t, callback, user_data};
+            return sim.alarms[i].id;
+        }
+    }
+    return -1;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_at(sim.now + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_at(sim.now + (uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t id) {
+    for (int i = 0; i < SIM_MAX_ALARMS; i++) {
+        if (sim.alarms[i].id == id) {
+            sim.alarms[i].id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Modelo do DHT22
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Gera a forma de onda de resposta a partir do instante em que o
+ *        host libera a linha
+ */
+static void dht_start_response(void) {
+    sim_inputs_t in = sim_inputs();
+    vcd_dht_flush(sim.now);
+    vcd.dht_index = 0;
+    dht.wave.edge_count = 0;
+    dht.wave.stall_count = 0;
+    dht.edge_index = 0;
+    dht.stall_index = 0;
+    dht.start = sim.now;
+    sim.stats.dht22_transactions++;
+    if (dht.replay_count) {
+        // Capturas são relativas à subida que encerra o sinal de início
+        dht.wave = dht.replay[dht.replay_next++ % dht.replay_count];
+        dht.start = dht.low_end;
+        return;
+    }
+    if (in.dht22_fault == SIM_DHT22_NO_RESPONSE) return;
+
+    float t = in.temperature;
+    uint16_t h = (uint16_t)(in.humidity * 10.0f + 0.5f);
+    uint16_t tt = (uint16_t)((t < 0 ? -t : t) * 10.0f + 0.5f) | (t < 0 ? 0x8000 : 0);
+    uint8_t data[5] = {h >> 8, h & 0xFF, tt >> 8, tt & 0xFF, 0};
+    data[4] = data[0] + data[1] + data[2] + data[3];
+    if (in.dht22_fault == SIM_DHT22_BAD_CHECKSUM) data[4]++;
+
+    dht22_waveform_generate(&dht.waveform, data, &dht.rng, &dht.wave);
+}
+
+static bool dht_level(uint64_t *next_edge) {
+    const dht22_waveform_t *w = &dht.wave;
+    while (dht.edge_index < w->edge_count && dht.start + w->edge[dht.edge_index].t_us <= sim.now) {
+        dht.edge_index++;
+    }
+    *next_edge = dht.edge_index < w->edge_count ? dht.start + w->edge[dht.edge_index].t_us : UINT64_MAX;
+    return dht.edge_index == 0 ? true : w->edge[dht.edge_index - 1].level;
+}
+
+/**
+ * @brief Interrupção do host em curso: a consulta só acontece quando ela termina
+ */
+static void dht_wait_stall(void) {
+    const dht22_waveform_t *w = &dht.wave;
+    while (dht.stall_index < w->stall_count && dht.start + w->stall_end_us[dht.stall_index] <= sim.now) {
+        dht.stall_index++;
+    }
+    if (dht.stall_index < w->stall_count && dht.start + w->stall_start_us[dht.stall_index] <= sim.now) {
+        sim_advance_to(dht.start + w->stall_end_us[dht.stall_index]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// hardware/gpio.h
+// ---------------------------------------------------------------------------
+
+void gpio_init(unsigned int gpio) {
+    sim.gpio_out[gpio] = false;
+    sim.gpio_level[gpio] = false;
+    vcd_line_changed(gpio);
+}
+
+void gpio_set_dir(unsigned int gpio, bool out) {
+    bool was_out = sim.gpio_out[gpio];
+    vcd_dht_flush(sim.now);             // Bordas do sensor antes de o host assumir a linha
+    sim.gpio_out[gpio] = out;
+    if (gpio == dht.pin && was_out && !out && dht.low_duration >= SIM_DHT22_MIN_START_US) {
+        dht.low_duration = 0;
+        dht_start_response();
+    }
+    vcd_line_changed(gpio);
+}
+
+void gpio_put(unsigned int gpio, bool value) {
+    if (sim.gpio_level[gpio] != value && sim.gpio_out[gpio]) {
+        sim.stats.gpio_edges[gpio]++;
+        if (sim.observer) sim.observer(gpio, value, sim.now);
+    }
+    if (gpio == dht.pin) {
+        if (!value) {
+            dht.low_since = sim.now;
+        } else if (!sim.gpio_level[gpio]) {
+            dht.low_duration = sim.now - dht.low_since;
+            dht.low_end = sim.now;
+        }
+    }
+    sim.gpio_level[gpio] = value;
+    vcd_line_changed(gpio);
+}
+
+bool gpio_get(unsigned int gpio) {
+    if (sim.gpio_out[gpio] || gpio != dht.pin) return sim.gpio_level[gpio];
+
+    dht_wait_stall();
+    uint64_t next_edge;
+    bool level = dht_level(&next_edge);
+
+    // Consulta repetida sem borda: avança o relógio em vez de girar em falso
+    if (dht.polled && level == dht.last_level) {
+        uint64_t target = sim.now + SIM_POLL_JUMP_US;
+        sim_advance_to(next_edge < target ? next_edge : target);
+        dht_wait_stall();
+        level = dht_level(&next_edge);
+    }
+    dht.polled = true;
+    dht.last_level = level;
+    return level;
+}
+
+void gpio_set_pulls(unsigned int gpio, bool up, bool down) {
+    (void)down;
+    if (!sim.gpio_out[gpio]) sim.gpio_level[gpio] = up;
+    vcd_line_changed(gpio);
+}
+
+void gpio_set_function(unsigned int gpio, enum gpio_function fn) {
+    sim.gpio_pwm[gpio] = fn == GPIO_FUNC_PWM;
+}
+
+// ---------------------------------------------------------------------------
+// Registro em VCD
+// ---------------------------------------------------------------------------
+
+static bool line_level(unsigned int gpio) {
+    if (sim.gpio_out[gpio] || gpio != dht.pin) return sim.gpio_level[gpio];
+    uint64_t next_edge;
+    return dht_level(&next_edge);
+}
+
+/**
+ * @brief Registra as bordas do sensor até until_us
+ *
+ * As bordas do DHT22 são geradas de antemão; cada escrita no VCD as
+ * registra antes, para que os instantes do arquivo nunca retrocedam.
+ */
+static void vcd_dht_flush(uint64_t until_us) {
+    if (!vcd.on) return;
+    const dht22_waveform_t *w = &dht.wave;
+    while (vcd.dht_index < w->edge_count && dht.start + w->edge[vcd.dht_index].t_us <= until_us) {
+        const dht22_edge_t *e = &w->edge[vcd.dht_index++];
+        if (sim.gpio_out[dht.pin] || e->level == vcd.line[dht.pin]) continue;
+        vcd.line[dht.pin] = e->level;
+        vcd_writer_gpio(&vcd.writer, dht.start + e->t_us, (int)dht.pin, e->level);
+    }
+}
+
+static void vcd_line_changed(unsigned int gpio) {
+    if (!vcd.on) return;
+    vcd_dht_flush(sim.now);
+    bool level = line_level(gpio);
+    if (level == vcd.line[gpio]) return;
+    vcd.line[gpio] = level;
+    vcd_writer_gpio(&vcd.writer, sim.now, (int)gpio, level);
+}
+
+void sim_set_vcd(FILE *out) {
+    if (vcd.on) {
+        vcd_dht_flush(sim.now);
+        vcd_writer_end(&vcd.writer, sim.now);
+        vcd.on = false;
+    }
+    if (!out) return;
+
+    for (unsigned int g = 0; g < SIM_GPIO_COUNT; g++) vcd.line[g] = line_level(g);
+    vcd.dht_index = dht.edge_index;
+    vcd_writer_begin(&vcd.writer, out, SIM_GPIO_COUNT, vcd.line, sim.pwm_level, sim.now);
+    vcd.on = true;
+}
+
+// ---------------------------------------------------------------------------
+// hardware/adc.h
+// ---------------------------------------------------------------------------
+
+void adc_init(void) {}
+
+void adc_gpio_init(unsigned int gpio) {
+    (void)gpio;
+}
+
+void adc_select_input(unsigned int input) {
+    sim.adc_selected = input;
+}
+
+void sim_set_adc_dnl(unsigned int spike_lsb) {
+    // Larguras dos códigos 1 a 4094, normalizadas para 4094 LSB; o código 1 começa em 1 LSB
+    double scale = (SIM_ADC_CODES - 2) / (SIM_ADC_CODES - 2 + 4.0 * spike_lsb);
+    double start = 1.0;
+    unsigned int code = 1;
+    for (unsigned int ideal = 0; ideal < SIM_ADC_CODES; ideal++) {
+        double x = ideal + 0.5;
+        if (x < 1.0) {
+            adc_state.transfer[ideal] = 0;
+            continue;
+        }
+        for (;;) {
+            double width = (code % 1024 == 512 ? 1.0 + spike_lsb : 1.0) * scale;
+            if (code == SIM_ADC_CODES - 1 || x < start + width) break;
+            start += width;
+            code++;
+        }
+        adc_state.transfer[ideal] = (uint16_t)code;
+    }
+    adc_state.transfer_ready = true;
+}
+
+/**
+ * @brief Código de uma entrada; o sensor de temperatura (ADC4) desligado lê 0
+ */
+static uint16_t adc_input(const sim_inputs_t *in, unsigned int input) {
+    input %= SIM_ADC_INPUTS;
+    if (input == SIM_ADC_TEMP_INPUT && !adc_state.temp_sensor) return 0;
+    if (!adc_state.transfer_ready) sim_set_adc_dnl(SIM_ADC_DNL_SPIKE_LSB);
+    return adc_state.transfer[in->adc[input] & 0x0FFF];
+}
+
+uint16_t adc_read(void) {
+    sim_inputs_t in = sim_inputs();
+    sim_advance_to(sim.now + SIM_ADC_CONVERSION_US);
+    return adc_input(&in, sim.adc_selected);
+}
+
+void adc_set_round_robin(unsigned int input_mask) {
+    adc_state.rr_mask = input_mask & 0x1F;
+}
+
+void adc_set_temp_sensor_enabled(bool enable) {
+    adc_state.temp_sensor = enable;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+    (void)en;
+    (void)dreq_en;
+    (void)dreq_thresh;
+    (void)err_in_fifo;
+    (void)byte_shift;
+}
+
+void adc_set_clkdiv(float clkdiv) {
+    // Uma conversão leva no mínimo 96 ciclos de clk_adc
+    double cycles = clkdiv + 1.0 < 96.0 ? 96.0 : clkdiv + 1.0;
+    adc_state.sample_us = cycles / SIM_ADC_CLOCK_MHZ;
+}
+
+static void dma_schedule(unsigned int channel);
+
+void adc_run(bool run) {
+    adc_state.running = run;
+    adc_state.rr_input = sim.adc_selected;
+    if (!run) return;
+    for (unsigned int c = 0; c < NUM_DMA_CHANNELS; c++) {
+        if (dma_ch[c].busy && !dma_ch[c].completion) {
+            dma_ch[c].started_us = (double)sim.now;
+            dma_schedule(c);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// hardware/dma.h e hardware/irq.h
+// ---------------------------------------------------------------------------
+
+static unsigned int adc_next_input(void) {
+    unsigned int input = adc_state.rr_input;
+    if (adc_state.rr_mask) {
+        do {
+            adc_state.rr_input = adc_state.rr_input + 1 == SIM_ADC_INPUTS ? 0 : adc_state.rr_input + 1;
+        } while (!(adc_state.rr_mask & (1u << adc_state.rr_input)));
+    }
+    return input;
+}
+
+static void dma_start_at(unsigned int channel, double t_us);
+static int64_t dma_complete(alarm_id_t id, void *user_data);
+
+/**
+ * @brief Pula os blocos ociosos do canal que acabou de começar (ver sim_set_adc_fast_forward())
+ */
+static void dma_fast_forward(unsigned int channel) {
+    sim_dma_channel_t *ch = &dma_ch[channel];
+    if (!adc_state.idle || !adc_state.bounds || !ch->completion) return;
+
+    // O salto para antes do próximo alarme que não é de DMA e da volta ao laço principal
+    uint64_t limit = sim.horizon;
+    for (int i = 0; i < SIM_MAX_ALARMS; i++) {
+        if (sim.alarms[i].id && sim.alarms[i].callback != dma_complete && sim.alarms[i].time < limit) {
+            limit = sim.alarms[i].time;
+        }
+    }
+    double block_us = ch->count * adc_state.sample_us;
+    double room = (double)limit - ch->started_us - 2.0 * block_us - 1.0;
+    if (room > SIM_ADC_SKIP_MAX_US) room = SIM_ADC_SKIP_MAX_US;
+    uint64_t pairs = room > 0.0 ? (uint64_t)(room / (2.0 * block_us)) : 0;
+    if (pairs == 0) return;
+
+    double skip_us = (double)pairs * 2.0 * block_us;
+    uint16_t lo[SIM_ADC_INPUTS], hi[SIM_ADC_INPUTS];
+    adc_state.bounds((uint64_t)ch->started_us, (uint64_t)(ch->started_us + skip_us), lo, hi, sim.source_ctx);
+    if (!adc_state.idle(lo, hi)) return;
+
+    // O round-robin avança as conversões puladas
+    unsigned int inputs = (unsigned int)__builtin_popcount(adc_state.rr_mask);
+    if (inputs > 1) {
+        for (uint64_t k = pairs * 2 * ch->count % inputs; k > 0; k--) adc_next_input();
+    }
+    cancel_alarm(ch->completion);
+    ch->started_us += skip_us;
+    dma_schedule(channel);
+    sim.stats.adc_blocks_skipped += pairs * 2;
+}
+
+static int64_t dma_complete(alarm_id_t id, void *user_data) {
+    (void)id;
+    unsigned int c = (unsigned int)(uintptr_t)user_data;
+    sim_dma_channel_t *ch = &dma_ch[c];
+
+    // Amostra k convertida em started + (k + 1) * período, com as entradas
+    // do milissegundo correspondente
+    volatile uint8_t *dst = ch->write_addr;
+    size_t step = ch->config.write_increment ? (size_t)1 << ch->config.size : 0;
+    double t = ch->started_us;
+    for (unsigned int k = 0; k < ch->count; k++, dst += step) {
+        t += adc_state.sample_us;
+        uint16_t v = adc_input(sim_input_cache((uint64_t)t), adc_next_input());
+        if (ch->config.size == DMA_SIZE_16) *(volatile uint16_t *)dst = v;
+        else if (ch->config.size == DMA_SIZE_32) *(volatile uint32_t *)dst = v;
+        else *dst = (uint8_t)(v >> 4);
+    }
+    if (ch->config.write_increment) ch->write_addr = (volatile void *)dst;
+
+    double end_us = ch->started_us + ch->count * adc_state.sample_us;
+    ch->busy = false;
+    ch->completion = 0;
+
+    // Encadeamento acontece antes da interrupção, como no hardware
+    if (ch->config.chain_to != c) dma_start_at(ch->config.chain_to, end_us);
+
+    if (ch->irq0_enabled) {
+        ch->irq0_status = true;
+        if (irq_on[DMA_IRQ_0] && irq_handler[DMA_IRQ_0]) irq_handler[DMA_IRQ_0]();
+    }
+    if (ch->config.chain_to != c) dma_fast_forward(ch->config.chain_to);
+    return 0;
+}
+
+static void dma_schedule(unsigned int channel) {
+    sim_dma_channel_t *ch = &dma_ch[channel];
+    double end_us = ch->started_us + ch->count * adc_state.sample_us;
+    ch->completion = add_alarm_at((uint64_t)(end_us + 0.999), dma_complete,
+                                  (void *)(uintptr_t)channel, true);
+}
+
+static void dma_start_at(unsigned int channel, double t_us) {
+    sim_dma_channel_t *ch = &dma_ch[channel];
+    if (ch->busy || ch->count == 0) return;
+    ch->busy = true;
+    ch->started_us = t_us;
+    if (adc_state.running && ch->config.dreq == DREQ_ADC) dma_schedule(channel);
+}
+
+int dma_claim_unused_channel(bool required) {
+    (void)required;
+    for (int c = 0; c < NUM_DMA_CHANNELS; c++) {
+        if (!dma_ch[c].claimed) {
+            dma_ch[c].claimed = true;
+            return c;
+        }
+    }
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(unsigned int channel) {
+    dma_channel_config c = {
+        .chain_to = channel,
+        .dreq = 0x3f,
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+    };
+    return c;
+}
+
+void dma_channel_configure(unsigned int channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, unsigned int transfer_count, bool trigger) {
+    (void)read_addr;
+    dma_ch[channel].config = *config;
+    dma_ch[channel].write_addr = write_addr;
+    dma_ch[channel].count = transfer_count;
+    if (trigger) dma_channel_start(channel);
+}
+
+void dma_channel_set_write_addr(unsigned int channel, volatile void *write_addr, bool trigger) {
+    dma_ch[channel].write_addr = write_addr;
+    if (trigger) dma_channel_start(channel);
+}
+
+void dma_channel_start(unsigned int channel) {
+    dma_start_at(channel, (double)sim.now);
+}
+
+void dma_channel_set_irq0_enabled(unsigned int channel, bool enabled) {
+    dma_ch[channel].irq0_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(unsigned int channel) {
+    return dma_ch[channel].irq0_status;
+}
+
+void dma_channel_acknowledge_irq0(unsigned int channel) {
+    dma_ch[channel].irq0_status = false;
+}
+
+void irq_set_exclusive_handler(unsigned int num, irq_handler_t handler) {
+    irq_handler[num] = handler;
+}
+
+void irq_set_priority(unsigned int num, uint8_t hardware_priority) {
+    (void)num;
+    (void)hardware_priority;
+}
+
+void irq_set_enabled(unsigned int num, bool enabled) {
+    irq_on[num] = enabled;
+}
+
+bool irq_is_enabled(unsigned int num) {
+    return irq_on[num];
+}
+
+// ---------------------------------------------------------------------------
+// hardware/pwm.h
+// ---------------------------------------------------------------------------
+
+void pwm_set_wrap(unsigned int slice, uint16_t wrap) {
+    (void)slice;
+    (void)wrap;
+}
+
+void pwm_set_clkdiv(unsigned int slice, float divider) {
+    (void)slice;
+    (void)divider;
+}
+
+void pwm_set_enabled(unsigned int slice, bool enabled) {
+    (void)slice;
+    (void)enabled;
+}
+
+void pwm_set_gpio_level(unsigned int gpio, uint16_t level) {
+    if (sim.pwm_level[gpio] != level) {
+        sim.stats.pwm_changes[gpio]++;
+        if (sim.observer) sim.observer(gpio, level > sim.pwm_level[gpio], sim.now);
+        if (vcd.on) {
+            vcd_dht_flush(sim.now);
+            vcd_writer_pwm(&vcd.writer, sim.now, (int)gpio, level);
+        }
+    }
+    sim.pwm_level[gpio] = level;
+}
+
+// Como no RP2040, o nível vai para todo GPIO em função PWM ligado à saída da fatia
+void pwm_set_chan_level(unsigned int slice, unsigned int chan, uint16_t level) {
+    for (unsigned int gpio = 0; gpio < SIM_GPIO_COUNT; gpio++) {
+        if (sim.gpio_pwm[gpio] && pwm_gpio_to_slice_num(gpio) == slice && pwm_gpio_to_channel(gpio) == chan) {
+            pwm_set_gpio_level(gpio, level);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// stdio
+// ---------------------------------------------------------------------------
+
+static ssize_t sim_stdout_write(void *cookie, const char *buf, size_t size) {
+    (void)cookie;
+    if (sim_inputs().link_up) {
+        sim.stats.stdout_bytes += size;
+        if (sim.link_bytes_per_s) {
+            sim_advance_to(sim.now + (uint64_t)size * 1000000 / sim.link_bytes_per_s);
+        }
+        if (sim.echo) {
+            size_t done = 0;
+            while (done < size) {
+                ssize_t n = write(STDOUT_FILENO, buf + done, size - done);
+                if (n <= 0) break;
+                done += (size_t)n;
+            }
+        }
+    } else {
+        sim.stats.stdout_dropped += size;
+    }
+    return (ssize_t)size;
+}
+
+bool stdio_usb_connected(void) {
+    return sim_inputs().link_up;
+}
+
+void stdio_init_all(void) {
+    cookie_io_functions_t io = {.write = sim_stdout_write};
+    FILE *f = fopencookie(NULL, "w", io);
+    if (f) {
+        setvbuf(f, NULL, _IOLBF, 0);
+        stdout = f;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// hardware/flash.h
+// ---------------------------------------------------------------------------
+
+uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+static bool sim_flash_ready;
+
+static void sim_flash_init(void) {
+    if (sim_flash_ready) return;
+    memset(sim_flash_image, 0xFF, sizeof(sim_flash_image));
+    sim_flash_ready = true;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    sim_flash_init();
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "flash_range_erase: faixa inválida %u+%zu\n", flash_offs, count);
+        abort();
+    }
+    memset(sim_flash_image + flash_offs, 0xFF, count);
+    sim.stats.flash_erases += count / FLASH_SECTOR_SIZE;
+    sim_advance_to(sim.now + SIM_FLASH_ERASE_US * (count / FLASH_SECTOR_SIZE));
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    sim_flash_init();
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "flash_range_program: faixa inválida %u+%zu\n", flash_offs, count);
+        abort();
+    }
+    // NOR: programar só zera bits
+    for (size_t i = 0; i < count; i++) sim_flash_image[flash_offs + i] &= data[i];
+    sim.stats.flash_pages += count / FLASH_PAGE_SIZE;
+    sim_advance_to(sim.now + SIM_FLASH_PROGRAM_US * (count / FLASH_PAGE_SIZE));
+}
@@ -0,0 +1,180 @@
+/**
+ * @file sim.h
+ * @brief Controle da simulação de host: relógio virtual, entradas e saídas
+ *
+ * O firmware compilado para host chama as funções do SDK declaradas em
+ * include/ (pico/stdlib.h, hardware/adc.h, ...). Elas não esperam tempo
+ * real: o relógio virtual só avança quando o firmware dorme (sleep_ms,
+ * sleep_us), quando consulta repetidamente um pino sem mudança de nível
+ * (avança até a próxima borda) ou quando lê o ADC. Com isso semanas de
+ * operação simulada levam segundos.
+ *
+ * A fonte de entradas é consultada no início de cada milissegundo e o
+ * resultado vale até o próximo: o DMA do ADC lê milhares de amostras por
+ * segundo simulado. Os blocos de DMA que o firmware não distinguiria são
+ * pulados de uma vez (sim_set_adc_fast_forward()).
+ *
+ * O relógio é determinístico: a mesma fonte de entradas produz sempre a
+ * mesma sequência de eventos.
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "dht22_waveform.h"
+
+#define SIM_GPIO_COUNT 30
+#define SIM_ADC_INPUTS 5
+#define SIM_ADC_TEMP_INPUT 4    // Sensor de temperatura do chip: lê 0 até adc_set_temp_sensor_enabled()
+#define SIM_ADC_CODES 4096
+#define SIM_ADC_DNL_SPIKE_LSB 8 // Largura extra padrão dos códigos 512, 1536, 2560 e 3584
+#define SIM_POLL_JUMP_US 10     // Avanço máximo por consulta de pino sem borda
+#define SIM_DHT22_MIN_START_US 1000     // Nível baixo mínimo para reconhecer o início
+
+/**
+ * @brief Falhas que o modelo do DHT22 pode injetar
+ */
+typedef enum {
+    SIM_DHT22_OK = 0,           // Responde normalmente
+    SIM_DHT22_NO_RESPONSE,      // Não responde ao sinal de início
+    SIM_DHT22_BAD_CHECKSUM,     // Responde com checksum corrompido
+} sim_dht22_fault_t;
+
+/**
+ * @brief Estado do ambiente simulado em um instante
+ */
+typedef struct {
+    float temperature;              // Temperatura vista pelo DHT22 (°C)
+    float humidity;                 // Umidade vista pelo DHT22 (%)
+    sim_dht22_fault_t dht22_fault;  // Falha injetada no DHT22
+    uint16_t adc[SIM_ADC_INPUTS];   // Código de cada entrada do ADC (0-4095; 3: VSYS / 3, 4: temperatura)
+    bool link_up;                   // Enlace de saída (stdout) disponível
+} sim_inputs_t;
+
+/**
+ * @brief Fonte das entradas: preenche o estado do ambiente no instante t_us
+ */
+typedef void (*sim_input_fn)(uint64_t t_us, sim_inputs_t *inputs, void *ctx);
+
+/**
+ * @brief Limites das entradas do ADC em [t0_us, t1_us]; ctx é o da fonte de entradas
+ */
+typedef void (*sim_input_bounds_fn)(uint64_t t0_us, uint64_t t1_us, uint16_t lo[SIM_ADC_INPUTS],
+                                    uint16_t hi[SIM_ADC_INPUTS], void *ctx);
+
+/**
+ * @brief Diz se blocos do ADC com as entradas nesses limites não teriam efeito no firmware
+ */
+typedef bool (*sim_adc_idle_fn)(const uint16_t lo[SIM_ADC_INPUTS], const uint16_t hi[SIM_ADC_INPUTS]);
+
+/**
+ * @brief Observador de saídas: chamado a cada mudança de nível de um GPIO de saída
+ *
+ * Em saídas PWM, level indica se o nível do PWM aumentou.
+ */
+typedef void (*sim_gpio_observer_fn)(unsigned int gpio, bool level, uint64_t t_us);
+
+/**
+ * @brief Estatísticas acumuladas pela simulação
+ */
+typedef struct {
+    uint64_t dht22_transactions;            // Sinais de início reconhecidos
+    uint64_t gpio_edges[SIM_GPIO_COUNT];    // Mudanças de nível em saídas
+    uint64_t pwm_changes[SIM_GPIO_COUNT];   // Mudanças de nível PWM
+    uint64_t stdout_bytes;                  // Bytes entregues com enlace ativo
+    uint64_t stdout_dropped;                // Bytes perdidos com enlace inativo
+    uint64_t flash_erases;                  // Setores apagados
+    uint64_t flash_pages;                   // Páginas programadas
+    uint64_t adc_blocks_skipped;            // Blocos de DMA pulados sem interrupção
+} sim_stats_t;
+
+/**
+ * @brief Prepara a simulação
+ *
+ * @param start_us Instante inicial desde o boot (permite começar perto
+ *                 de um wrap, p.ex. dos 49,7 dias de to_ms_since_boot())
+ * @param end_us Instante em que a simulação termina
+ * @param on_end Chamado uma vez ao atingir end_us; deve encerrar o processo
+ */
+void sim_init(uint64_t start_us, uint64_t end_us, void (*on_end)(void));
+
+void sim_set_input_source(sim_input_fn fn, void *ctx);
+void sim_set_dht22_pin(unsigned int gpio);
+
+/**
+ * @brief Imperfeições da forma de onda do DHT22 nas próximas transações
+ *
+ * Por padrão a resposta é a nominal, sem jitter (ver dht22_waveform.h).
+ *
+ * @param seed Semente do gerador pseudoaleatório das imperfeições
+ */
+void sim_set_dht22_waveform(const dht22_waveform_config_t *config, uint64_t seed);
+
+/**
+ * @brief Reproduz respostas capturadas do DHT22 em vez de gerá-las
+ *
+ * Cada sinal de início recebe a próxima resposta, em ciclo, com os
+ * tempos relativos à subida que encerra o sinal de início (ver
+ * vcd_trace_dht22_responses()). As falhas injetadas pelas entradas são
+ * ignoradas. O vetor deve permanecer válido; count 0 volta ao gerador.
+ */
+void sim_set_dht22_replay(const dht22_waveform_t *responses, int count);
+void sim_set_echo(bool echo);
+void sim_set_gpio_observer(sim_gpio_observer_fn fn);
+
+/**
+ * @brief Curva de transferência do ADC: largura extra dos códigos 512, 1536, 2560 e 3584
+ *
+ * As entradas (sim_inputs_t.adc) são códigos de um ADC ideal; cada
+ * conversão devolve o código que o ADC do RP2040 daria para o centro
+ * daquele LSB. Os quatro códigos largos têm 1 + spike_lsb LSB, os
+ * códigos 0 e 4095 têm 1 e os demais dividem o resto por igual, como no
+ * modelo nominal de adc_dnl.h. O padrão é SIM_ADC_DNL_SPIKE_LSB; com 0,
+ * o ADC é ideal.
+ */
+void sim_set_adc_dnl(unsigned int spike_lsb);
+
+/**
+ * @brief Pula os blocos ociosos da captura contínua do ADC
+ *
+ * Um bloco de DMA a cada poucas centenas de µs domina o custo de semanas
+ * simuladas, embora quase nenhum mude algo além dos últimos valores, que
+ * o laço principal só lê quando acorda. Depois de cada bloco, se idle()
+ * aceita os limites das entradas até perto do próximo retorno ao laço
+ * principal ou do próximo alarme, o canal que começou avança de uma vez
+ * um número par de blocos (o ping-pong volta ao mesmo canal): não são
+ * escritos nem chegam a DMA_IRQ_0, como interrupções perdidas. Os dois
+ * últimos blocos antes desse ponto são sempre entregues, então os
+ * últimos valores e a janela da mediana saem iguais. Com NULL, todo
+ * bloco é entregue.
+ */
+void sim_set_adc_fast_forward(sim_input_bounds_fn bounds, sim_adc_idle_fn idle);
+
+/**
+ * @brief Limita a vazão do enlace de saída (0 = ilimitada)
+ *
+ * Cada escrita em stdout com o enlace ativo avança o relógio virtual
+ * pelo tempo de transmissão dos bytes.
+ */
+void sim_set_link_rate(uint32_t bytes_per_s);
+
+/**
+ * @brief Inicia o registro da atividade de GPIO e PWM em VCD (ver vcd.h)
+ *
+ * Com NULL, encerra o registro em andamento. O arquivo continua sendo
+ * do chamador.
+ */
+void sim_set_vcd(FILE *out);
+
+uint64_t sim_now_us(void);
+void sim_advance_to(uint64_t t_us);
+
+bool sim_gpio_level(unsigned int gpio);
+uint16_t sim_pwm_level(unsigned int gpio);
+const sim_stats_t *sim_stats(void);
+
+#endif // SIM_H
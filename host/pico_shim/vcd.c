@@ -0,0 +1,208 @@
+/**
+ * @file vcd.c
+ * @brief Implementação da escrita e da leitura de VCD
+ */
+#include "vcd.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VCD_PWM_ID_BASE 32      // Identificadores dos PWM depois dos GPIOs
+#define VCD_TOKEN_MAX 256
+
+// Identificadores de um caractere: '!' em diante
+static char vcd_id(int index) {
+    return (char)('!' + index);
+}
+
+static void vcd_time(vcd_writer_t *w, uint64_t t_us) {
+    if (t_us <= w->time) return;
+    w->time = t_us;
+    fprintf(w->out, "#%llu\n", (unsigned long long)t_us);
+}
+
+static void vcd_pwm_value(FILE *out, int gpio, uint16_t level) {
+    char bits[17];
+    int n = 0;
+    for (int b = 15; b >= 0; b--) {
+        if (n || (level >> b) & 1 || b == 0) bits[n++] = (char)('0' + ((level >> b) & 1));
+    }
+    bits[n] = '\0';
+    fprintf(out, "b%s %c\n", bits, vcd_id(VCD_PWM_ID_BASE + gpio));
+}
+
+void vcd_writer_begin(vcd_writer_t *w, FILE *out, int gpio_count, const bool *levels, const uint16_t *pwm,
+                      uint64_t t_us) {
+    w->out = out;
+    w->gpio_count = gpio_count;
+    w->time = t_us;
+
+    fprintf(out, "$version environment-monitoring firmware_sim $end\n$timescale 1us $end\n$scope module pico $end\n");
+    for (int g = 0; g < gpio_count; g++) fprintf(out, "$var wire 1 %c gpio%d $end\n", vcd_id(g), g);
+    for (int g = 0; g < gpio_count; g++) {
+        fprintf(out, "$var reg 16 %c pwm%d $end\n", vcd_id(VCD_PWM_ID_BASE + g), g);
+    }
+    fprintf(out, "$upscope $end\n$enddefinitions $end\n#%llu\n$dumpvars\n", (unsigned long long)t_us);
+    for (int g = 0; g < gpio_count; g++) fprintf(out, "%c%c\n", levels[g] ? '1' : '0', vcd_id(g));
+    for (int g = 0; g < gpio_count; g++) vcd_pwm_value(out, g, pwm[g]);
+    fprintf(out, "$end\n");
+}
+
+void vcd_writer_gpio(vcd_writer_t *w, uint64_t t_us, int gpio, bool level) {
+    vcd_time(w, t_us);
+    fprintf(w->out, "%c%c\n", level ? '1' : '0', vcd_id(gpio));
+}
+
+void vcd_writer_pwm(vcd_writer_t *w, uint64_t t_us, int gpio, uint16_t level) {
+    vcd_time(w, t_us);
+    vcd_pwm_value(w->out, gpio, level);
+}
+
+void vcd_writer_end(vcd_writer_t *w, uint64_t t_us) {
+    vcd_time(w, t_us);
+    fflush(w->out);
+}
+
+// ---------------------------------------------------------------------------
+// Leitura
+// ---------------------------------------------------------------------------
+
+static bool vcd_token(FILE *in, char *token) {
+    return fscanf(in, "%255s", token) == 1;
+}
+
+// Descarta tokens até o $end da declaração, concatenando-os em text (se não nulo)
+static void vcd_skip_to_end(FILE *in, char *text, size_t text_size) {
+    char token[VCD_TOKEN_MAX];
+    if (text) text[0] = '\0';
+    while (vcd_token(in, token) && strcmp(token, "$end")) {
+        if (text && strlen(text) + strlen(token) < text_size) strcat(text, token);
+    }
+}
+
+// Nanossegundos por unidade de tempo, p.ex. "1us" ou "10ns"; 0 se inválida
+static double vcd_timescale_ns(const char *text) {
+    static const struct {
+        const char *unit;
+        double ns;
+    } units[] = {{"s", 1e9}, {"ms", 1e6}, {"us", 1e3}, {"ns", 1}, {"ps", 1e-3}, {"fs", 1e-6}};
+    char *unit;
+    double factor = strtod(text, &unit);
+    if (unit == text) factor = 1;
+    for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); i++) {
+        if (!strcmp(unit, units[i].unit)) return factor * units[i].ns;
+    }
+    return 0;
+}
+
+static void vcd_trace_push(vcd_trace_t *trace, uint64_t t_ns, bool level) {
+    if (trace->count && trace->level[trace->count - 1] == level) return;
+    if (trace->count == trace->capacity) {
+        trace->capacity = trace->capacity ? trace->capacity * 2 : 1024;
+        trace->t_ns = realloc(trace->t_ns, trace->capacity * sizeof(uint64_t));
+        trace->level = realloc(trace->level, trace->capacity * sizeof(bool));
+    }
+    trace->t_ns[trace->count] = t_ns;
+    trace->level[trace->count] = level;
+    trace->count++;
+}
+
+bool vcd_read_trace(const char *path, const char *signal, vcd_trace_t *trace, char *error, size_t error_size) {
+    memset(trace, 0, sizeof(*trace));
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        snprintf(error, error_size, "%s: não foi possível abrir", path);
+        return false;
+    }
+
+    char token[VCD_TOKEN_MAX], id[VCD_TOKEN_MAX] = "", text[VCD_TOKEN_MAX];
+    double scale_ns = 1;
+    uint64_t now = 0;
+    bool ok = true;
+
+    while (ok && vcd_token(in, token)) {
+        if (!strcmp(token, "$timescale")) {
+            vcd_skip_to_end(in, text, sizeof(text));
+            scale_ns = vcd_timescale_ns(text);
+            if (scale_ns <= 0) {
+                snprintf(error, error_size, "%s: escala de tempo inválida \"%s\"", path, text);
+                ok = false;
+            }
+        } else if (!strcmp(token, "$var")) {
+            char type[VCD_TOKEN_MAX], size[VCD_TOKEN_MAX], var_id[VCD_TOKEN_MAX], name[VCD_TOKEN_MAX];
+            if (vcd_token(in, type) && vcd_token(in, size) && vcd_token(in, var_id) && vcd_token(in, name) &&
+                !strcmp(name, signal) && !id[0]) {
+                strcpy(id, var_id);
+            }
+            vcd_skip_to_end(in, NULL, 0);
+        } else if (!strcmp(token, "$enddefinitions")) {
+            vcd_skip_to_end(in, NULL, 0);
+            if (!id[0]) {
+                snprintf(error, error_size, "%s: sinal \"%s\" não encontrado", path, signal);
+                ok = false;
+            }
+        } else if (!strcmp(token, "$dumpvars") || !strcmp(token, "$dumpall") || !strcmp(token, "$dumpon") ||
+                   !strcmp(token, "$dumpoff") || !strcmp(token, "$end")) {
+            // Os valores seguem normalmente até o $end
+        } else if (token[0] == '$') {
+            vcd_skip_to_end(in, NULL, 0);       // $date, $version, $comment, $scope, $upscope
+        } else if (token[0] == '#') {
+            now = (uint64_t)(strtod(token + 1, NULL) * scale_ns + 0.5);
+        } else if (token[0] == 'b' || token[0] == 'B' || token[0] == 'r' || token[0] == 'R') {
+            char var_id[VCD_TOKEN_MAX];
+            if (!vcd_token(in, var_id)) break;
+            char bit = token[strlen(token) - 1];
+            if ((token[0] == 'b' || token[0] == 'B') && !strcmp(var_id, id) && bit != 'x' && bit != 'X') {
+                vcd_trace_push(trace, now, bit != '0');
+            }
+        } else if (strchr("01xXzZ", token[0]) && !strcmp(token + 1, id)) {
+            if (tolower((unsigned char)token[0]) != 'x') vcd_trace_push(trace, now, token[0] != '0');
+        }
+    }
+    fclose(in);
+    if (ok && !id[0]) {
+        snprintf(error, error_size, "%s: sinal \"%s\" não encontrado", path, signal);
+        ok = false;
+    }
+    if (!ok) vcd_trace_free(trace);
+    return ok;
+}
+
+void vcd_trace_free(vcd_trace_t *trace) {
+    free(trace->t_ns);
+    free(trace->level);
+    memset(trace, 0, sizeof(*trace));
+}
+
+int vcd_trace_dht22_responses(const vcd_trace_t *trace, uint32_t min_start_us, dht22_waveform_t *responses,
+                              int max) {
+    const uint64_t gap_ns = (uint64_t)min_start_us * 1000;
+    int n = 0;
+    size_t i = 0;
+
+    while (i + 1 < trace->count && n < max) {
+        // Sinal de início: nível baixo longo seguido da subida
+        if (trace->level[i] || trace->t_ns[i + 1] - trace->t_ns[i] < gap_ns) {
+            i++;
+            continue;
+        }
+        uint64_t t0 = trace->t_ns[i + 1];
+        dht22_waveform_t *r = &responses[n++];
+        memset(r, 0, sizeof(*r));
+
+        size_t j = i + 2;
+        uint64_t prev = t0;
+        while (j < trace->count && trace->t_ns[j] - prev < gap_ns && r->edge_count < DHT22_WAVEFORM_MAX_EDGES) {
+            // Outro sinal de início antes da pausa: a transação acabou
+            if (!trace->level[j] && j + 1 < trace->count && trace->t_ns[j + 1] - trace->t_ns[j] >= gap_ns) break;
+            r->edge[r->edge_count].t_us = (uint32_t)((trace->t_ns[j] - t0 + 500) / 1000);
+            r->edge[r->edge_count].level = trace->level[j];
+            r->edge_count++;
+            prev = trace->t_ns[j];
+            j++;
+        }
+        i = j;
+    }
+    return n;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file vcd.h
+ * @brief Escrita e leitura de formas de onda no formato VCD (Value Change Dump)
+ *
+ * A escrita registra a atividade dos GPIOs e dos níveis de PWM da
+ * simulação para inspeção em visualizadores como o GTKWave: um fio de
+ * 1 bit "gpioN" com o nível da linha de cada pino (o nível imposto pelo
+ * sensor, nos pinos de entrada modelados) e um registrador de 16 bits
+ * "pwmN" com o nível de PWM, ambos no escopo "pico", com resolução de 1 μs.
+ *
+ * A leitura extrai as bordas de um sinal de 1 bit de um VCD qualquer,
+ * como os exportados por analisadores lógicos (sigrok/PulseView, Saleae),
+ * em qualquer escala de tempo; valores z são lidos como alto (pull-up) e
+ * x é ignorado. Das bordas da linha de dados do DHT22 são recortadas as
+ * respostas do sensor, que o modelo do shim pode reproduzir para os
+ * decodificadores (sim_set_dht22_replay()).
+ */
+#ifndef VCD_H
+#define VCD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "dht22_waveform.h"
+
+typedef struct {
+    FILE *out;
+    int gpio_count;
+    uint64_t time;              // Último instante escrito (μs)
+} vcd_writer_t;
+
+/**
+ * @brief Escreve o cabeçalho e os valores iniciais no instante t_us
+ */
+void vcd_writer_begin(vcd_writer_t *w, FILE *out, int gpio_count, const bool *levels, const uint16_t *pwm,
+                      uint64_t t_us);
+void vcd_writer_gpio(vcd_writer_t *w, uint64_t t_us, int gpio, bool level);
+void vcd_writer_pwm(vcd_writer_t *w, uint64_t t_us, int gpio, uint16_t level);
+
+/**
+ * @brief Marca o fim do registro em t_us e esvazia o buffer do arquivo
+ */
+void vcd_writer_end(vcd_writer_t *w, uint64_t t_us);
+
+/**
+ * @brief Bordas de um sinal de 1 bit, em ns desde o início do arquivo
+ */
+typedef struct {
+    uint64_t *t_ns;
+    bool *level;
+    size_t count;
+    size_t capacity;
+} vcd_trace_t;
+
+/**
+ * @brief Lê as bordas do sinal chamado signal
+ *
+ * @return false com a mensagem em error se o arquivo não pôde ser lido
+ *         ou o sinal não existe
+ */
+bool vcd_read_trace(const char *path, const char *signal, vcd_trace_t *trace, char *error, size_t error_size);
+void vcd_trace_free(vcd_trace_t *trace);
+
+/**
+ * @brief Recorta as respostas do DHT22 das bordas da linha de dados
+ *
+ * Cada transação começa no fim de um nível baixo de pelo menos
+ * min_start_us (o sinal de início do host); as bordas seguintes, até
+ * uma pausa de min_start_us sem bordas, formam a resposta, com tempos
+ * relativos a essa subida.
+ *
+ * @return Número de respostas escritas em responses (no máximo max)
+ */
+int vcd_trace_dht22_responses(const vcd_trace_t *trace, uint32_t min_start_us, dht22_waveform_t *responses,
+                              int max);
+
+#endif // VCD_H
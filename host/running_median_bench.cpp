@@ -0,0 +1,142 @@
+/**
+ * @file running_median_bench.cpp
+ * @brief Custo por amostra da mediana móvel (running_median.h) por tamanho de janela
+ *
+ * Para cada janela de 5 a 255, confere a saída de running_median_push()
+ * contra a mediana calculada por ordenação parcial da janela e mede o
+ * custo por amostra, ao lado do de uma janela mantida ordenada por
+ * inserção (O(n) por amostra), a alternativa óbvia sem heaps.
+ *
+ * O sinal é um código de ADC de 12 bits com ruído e picos isolados, como
+ * o do MQ2. No RP2040 a mesma medida roda em running_median_bench.c
+ * (raiz do projeto), com ciclos contados pelo SysTick.
+ *
+ * Uso:
+ * @code
+ * running_median_bench [amostras]
+ * @endcode
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+extern "C" {
+#include "running_median.h"
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+static const int windows[] = {5, 7, 15, 31, 63, 127, 255};
+
+static volatile int32_t bench_sink;  // Impede que o compilador descarte os filtros
+
+static uint64_t cycles_now() {
+#if BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Janela ordenada por inserção: retira o mais antigo e insere o novo
+ */
+struct SortedWindow {
+    std::vector<int32_t> ring, sorted;
+    size_t next = 0;
+
+    explicit SortedWindow(int window) : ring(window), sorted(window) {}
+
+    int32_t push(int32_t value) {
+        int32_t old = ring[next];
+        ring[next] = value;
+        next = (next + 1) % ring.size();
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), old);
+        sorted.erase(it);
+        sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), value), value);
+        return sorted[sorted.size() / 2];
+    }
+};
+
+struct Result {
+    double ns_per_sample;
+    double cycles_per_sample;
+};
+
+template <typename F>
+static Result measure(const std::vector<int32_t> &signal, F &&push) {
+    int32_t acc = 0;
+    auto start = bench_clock::now();
+    uint64_t c0 = cycles_now();
+    for (int32_t v : signal) acc += push(v);
+    uint64_t c1 = cycles_now();
+    double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    bench_sink = acc;
+    return {ns / signal.size(), (double)(c1 - c0) / signal.size()};
+}
+
+int main(int argc, char **argv) {
+    size_t samples = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 2000000;
+
+    std::vector<int32_t> signal(samples);
+    uint32_t rng = 12345;
+    for (size_t i = 0; i < samples; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        int32_t v = 400 + (int32_t)((rng >> 8) % 61) - 30;
+        if ((rng >> 20) % 500 == 0) v = 4095;                   // Pico isolado
+        if (i / 50000 % 4 == 3) v += 2200;                      // Degraus de gás
+        signal[i] = v;
+    }
+
+    // Conferência contra a mediana por ordenação parcial, inclusive enquanto a janela enche
+    for (int w : windows) {
+        static running_median_t m;
+        running_median_init(&m, (uint8_t)w);
+        std::vector<int32_t> window;
+        for (size_t i = 0; i < std::min<size_t>(samples, 200000); i++) {
+            window.push_back(signal[i]);
+            if (window.size() > (size_t)w) window.erase(window.begin());
+            std::vector<int32_t> sorted = window;
+            size_t mid = (sorted.size() - 1) / 2 + (sorted.size() % 2 == 0);
+            std::nth_element(sorted.begin(), sorted.begin() + mid, sorted.end());
+            int32_t got = running_median_push(&m, signal[i]);
+            if (sorted.size() % 2 ? got != sorted[mid]
+                                  : got != sorted[mid] && got != *std::max_element(sorted.begin(),
+                                                                                  sorted.begin() + mid)) {
+                std::fprintf(stderr, "janela %d, amostra %zu: %d, esperado %d\n", w, i, got, sorted[mid]);
+                return 1;
+            }
+        }
+    }
+
+    std::printf("%zu amostras por janela (saídas conferidas)\n", samples);
+    std::printf("%7s %14s", "janela", "heap ns/amostra");
+    if (BENCH_HAS_TSC) std::printf(" %8s", "ciclos");
+    std::printf(" %18s", "inserção ns/amostra");
+    if (BENCH_HAS_TSC) std::printf(" %8s", "ciclos");
+    std::printf("\n");
+
+    for (int w : windows) {
+        static running_median_t m;
+        running_median_init(&m, (uint8_t)w);
+        Result heap = measure(signal, [](int32_t v) { return running_median_push(&m, v); });
+        SortedWindow sorted(w);
+        Result insertion = measure(signal, [&sorted](int32_t v) { return sorted.push(v); });
+
+        std::printf("%7d %15.1f", w, heap.ns_per_sample);
+        if (BENCH_HAS_TSC) std::printf(" %8.0f", heap.cycles_per_sample);
+        std::printf(" %19.1f", insertion.ns_per_sample);
+        if (BENCH_HAS_TSC) std::printf(" %8.0f", insertion.cycles_per_sample);
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,244 @@
+/**
+ * @file sampling_replay.cpp
+ * @brief Compara a amostragem adaptativa com taxas fixas sobre séries gravadas
+ *
+ * Para o LDR e o MQ2 de cada arquivo de série, reproduz quatro
+ * amostradores sobre o sinal gravado (tomado como verdade e mantido
+ * entre as amostras da série):
+ * - adaptativo: adaptive_sampler.c com a configuração padrão do firmware;
+ *   no MQ2, como no firmware, o alarme de gás acorda o laço na mudança de
+ *   estado e força o período mínimo enquanto dura;
+ * - fixo 2 s: o período do laço antes da amostragem adaptativa;
+ * - fixo igual: a mesma taxa média do adaptativo, em período fixo;
+ * - fixo mínimo: o período mínimo do adaptativo, o tempo todo.
+ *
+ * Para cada um, informa a taxa média e a fidelidade: eventos capturados
+ * (trechos acima do limiar do canal: alarme de gás no MQ2, LED no LDR),
+ * atraso da primeira amostra acima do limiar em relação ao início do
+ * evento, e erro RMS e máximo do sinal reconstruído (último valor
+ * amostrado) contra o gravado.
+ *
+ * Uso:
+ * @code
+ * sampling_replay [--synth amostras] <arquivo.ems>...
+ * @endcode
+ *
+ * Com --synth, cada arquivo é antes gerado por series_synth_write(), que
+ * grava uma amostra por segundo: períodos abaixo de 1 s veem o mesmo
+ * valor repetido.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "series_reader.h"
+#include "series_synth.h"
+
+extern "C" {
+#include "adaptive_sampler.h"
+#include "gas_alarm.h"
+}
+
+#define LDR_THRESHOLD 1500      // Mesmo limiar do LED em environment-monitoring.c
+#define FIXED_PERIOD_MS 2000    // Período do laço antes da amostragem adaptativa
+
+/**
+ * @brief Um canal gravado, com tempo em ms desde a primeira amostra
+ */
+struct Trace {
+    std::vector<int64_t> t;
+    std::vector<int32_t> v;
+};
+
+/**
+ * @brief Amostras tomadas por um amostrador
+ */
+struct Run {
+    std::vector<int64_t> t;
+    std::vector<int32_t> v;
+
+    void add(int64_t at, int32_t value) {
+        t.push_back(at);
+        v.push_back(value);
+    }
+};
+
+struct Fidelity {
+    double rate = 0;
+    size_t events = 0;
+    size_t captured = 0;
+    double delay_mean_s = 0;
+    double delay_max_s = 0;
+    double rms = 0;
+    int max_error = 0;
+};
+
+static Run run_fixed(const Trace &tr, int64_t period_ms) {
+    Run run;
+    size_t i = 0;
+    for (int64_t now = tr.t.front(); now <= tr.t.back(); now += period_ms) {
+        while (i + 1 < tr.t.size() && tr.t[i + 1] <= now) i++;
+        run.add(now, tr.v[i]);
+    }
+    return run;
+}
+
+static Run run_adaptive(const Trace &tr, const adaptive_sampler_config_t &config, int threshold,
+                        bool alarm_wakeup) {
+    adaptive_sampler_t sampler;
+    adaptive_sampler_init(&sampler, &config, (uint32_t)tr.t.front());
+    Run run;
+    size_t i = 0, n = tr.t.size();
+
+    for (int64_t now = tr.t.front(); now <= tr.t.back();) {
+        while (i + 1 < n && tr.t[i + 1] <= now) i++;
+        int32_t value = tr.v[i];
+        bool above = value > threshold;
+        if (alarm_wakeup && above) adaptive_sampler_boost(&sampler, (uint32_t)now);
+        adaptive_sampler_update(&sampler, (uint16_t)value, (uint32_t)now);
+        run.add(now, value);
+
+        int64_t next = now + sampler.period_ms;
+        if (alarm_wakeup) {
+            // A interrupção do DMA acorda o laço quando o alarme muda
+            for (size_t j = i + 1; j < n && tr.t[j] < next; j++) {
+                if ((tr.v[j] > threshold) != above) {
+                    next = tr.t[j];
+                    break;
+                }
+            }
+        }
+        now = next;
+    }
+    return run;
+}
+
+static Fidelity evaluate(const Trace &tr, const Run &run, int threshold) {
+    Fidelity f;
+    size_t n = tr.t.size();
+    double seconds = (double)(tr.t.back() - tr.t.front()) / 1000.0;
+    f.rate = seconds > 0 ? (double)run.t.size() / seconds : 0;
+
+    // Eventos: trechos da série acima do limiar
+    double delay_sum = 0;
+    size_t k = 0;
+    for (size_t i = 0; i < n;) {
+        if (tr.v[i] <= threshold) {
+            i++;
+            continue;
+        }
+        size_t end = i;
+        while (end < n && tr.v[end] > threshold) end++;
+        int64_t start_t = tr.t[i];
+        int64_t end_t = end < n ? tr.t[end] : tr.t.back() + 1;
+        f.events++;
+
+        while (k < run.t.size() && run.t[k] < start_t) k++;
+        size_t s = k;
+        while (s < run.t.size() && run.t[s] < end_t && run.v[s] <= threshold) s++;
+        if (s < run.t.size() && run.t[s] < end_t) {
+            double delay = (double)(run.t[s] - start_t) / 1000.0;
+            f.captured++;
+            delay_sum += delay;
+            f.delay_max_s = std::max(f.delay_max_s, delay);
+        }
+        i = end;
+    }
+    f.delay_mean_s = f.captured ? delay_sum / (double)f.captured : 0;
+
+    // Reconstrução pelo último valor amostrado
+    double sq = 0;
+    size_t s = 0;
+    for (size_t i = 0; i < n; i++) {
+        while (s + 1 < run.t.size() && run.t[s + 1] <= tr.t[i]) s++;
+        int error = std::abs(tr.v[i] - run.v[s]);
+        sq += (double)error * error;
+        f.max_error = std::max(f.max_error, error);
+    }
+    f.rms = std::sqrt(sq / (double)n);
+    return f;
+}
+
+static void print(const char *name, const Fidelity &f) {
+    std::printf("    %-13s %8.3f %6zu/%-6zu %7.2f %7.2f %9.1f %8d\n", name, f.rate, f.captured, f.events,
+                f.delay_mean_s, f.delay_max_s, f.rms, f.max_error);
+}
+
+static void compare(const char *channel, const Trace &tr, const adaptive_sampler_config_t &config, int threshold,
+                    bool alarm_wakeup) {
+    Run adaptive = run_adaptive(tr, config, threshold, alarm_wakeup);
+    Fidelity fa = evaluate(tr, adaptive, threshold);
+    int64_t same_period = fa.rate > 0 ? (int64_t)std::llround(1000.0 / fa.rate) : FIXED_PERIOD_MS;
+
+    std::printf("  %s (limiar %d, período %u-%u ms):\n", channel, threshold, config.min_period_ms,
+                config.max_period_ms);
+    std::printf("    %-13s %8s %13s %15s %9s %8s\n", "amostrador", "taxa/s", "eventos", "atraso méd/máx s",
+                "erro RMS", "erro máx");
+    print("adaptativo", fa);
+    print("fixo 2 s", evaluate(tr, run_fixed(tr, FIXED_PERIOD_MS), threshold));
+    print("fixo igual", evaluate(tr, run_fixed(tr, same_period), threshold));
+    print("fixo mínimo", evaluate(tr, run_fixed(tr, config.min_period_ms), threshold));
+}
+
+static void replay(const std::string &path) {
+    SeriesReader reader(path);
+    Trace ldr, mq2;
+    std::vector<int64_t> t;
+    std::vector<int32_t> v;
+
+    for (size_t c = 0; c < reader.chunk_count(); c++) {
+        size_t n = reader.chunk(c).count;
+        t.resize(n);
+        v.resize(n);
+        reader.decode_time(c, t.data());
+        for (size_t i = 0; i < n; i++) {
+            int64_t ms = t[i] / 1000;
+            ldr.t.push_back(ms);
+            mq2.t.push_back(ms);
+        }
+        reader.decode_channel(c, SERIES_CH_LDR, v.data());
+        ldr.v.insert(ldr.v.end(), v.begin(), v.end());
+        reader.decode_channel(c, SERIES_CH_MQ2, v.data());
+        mq2.v.insert(mq2.v.end(), v.begin(), v.end());
+    }
+    if (ldr.t.empty()) {
+        std::printf("%s: vazio\n", path.c_str());
+        return;
+    }
+
+    std::printf("%s: %llu amostras em %.1f h\n", path.c_str(), (unsigned long long)reader.sample_count(),
+                (double)(ldr.t.back() - ldr.t.front()) / 3.6e6);
+    const adaptive_sampler_config_t ldr_config = ADAPTIVE_SAMPLER_LDR_DEFAULT;
+    const adaptive_sampler_config_t mq2_config = ADAPTIVE_SAMPLER_MQ2_DEFAULT;
+    compare("LDR", ldr, ldr_config, LDR_THRESHOLD, false);
+    compare("MQ2", mq2, mq2_config, GAS_ALARM_DEFAULT_THRESHOLD, true);
+}
+
+int main(int argc, char **argv) {
+    uint64_t synth = 0;
+    int first = 1;
+    if (argc > 2 && !std::strcmp(argv[1], "--synth")) {
+        synth = std::strtoull(argv[2], nullptr, 10);
+        first = 3;
+    }
+    if (first >= argc) {
+        std::fprintf(stderr, "uso: %s [--synth amostras] <arquivo.ems>...\n", argv[0]);
+        return 2;
+    }
+
+    try {
+        for (int i = first; i < argc; i++) {
+            if (synth) series_synth_write(argv[i], (uint64_t)(i - first + 1), synth);
+            replay(argv[i]);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "erro: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
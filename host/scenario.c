@@ -0,0 +1,386 @@
+/**
+ * @file scenario.c
+ * @brief Leitura e avaliação dos roteiros de cenário
+ */
+#include "scenario.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const channel_names[SCENARIO_CH_COUNT] = {"temperature", "humidity", "ldr", "mq2",
+                                                              "chip", "vsys"};
+
+bool scenario_parse_time(const char *text, uint64_t *us) {
+    uint64_t total = 0;
+    const char *p = text;
+    if (!*p) return false;
+
+    while (*p) {
+        char *unit;
+        double v = strtod(p, &unit);
+        if (unit == p || v < 0) return false;
+
+        double scale;
+        if (!strncmp(unit, "us", 2)) { scale = 1; unit += 2; }
+        else if (!strncmp(unit, "ms", 2)) { scale = 1e3; unit += 2; }
+        else if (*unit == 's') { scale = 1e6; unit++; }
+        else if (*unit == 'm') { scale = 60e6; unit++; }
+        else if (*unit == 'h') { scale = 3600e6; unit++; }
+        else if (*unit == 'd') { scale = 86400e6; unit++; }
+        else return false;
+
+        total += (uint64_t)(v * scale);
+        p = unit;
+    }
+    *us = total;
+    return true;
+}
+
+static int parse_channel(const char *name) {
+    for (int c = 0; c < SCENARIO_CH_COUNT; c++) {
+        if (name && !strcmp(name, channel_names[c])) return c;
+    }
+    return -1;
+}
+
+bool scenario_load(const char *path, scenario_t *sc, char *error, int error_size) {
+    memset(sc, 0, sizeof(*sc));
+    sc->seed = 1;
+    sc->adc_spike_lsb = SIM_ADC_DNL_SPIKE_LSB;
+    sc->signal[SCENARIO_CH_TEMPERATURE].mean = 25.0;
+    sc->signal[SCENARIO_CH_HUMIDITY].mean = 50.0;
+    sc->signal[SCENARIO_CH_CHIP].mean = 25.0;
+    sc->signal[SCENARIO_CH_VSYS].mean = 5.0;
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        snprintf(error, error_size, "não foi possível abrir %s", path);
+        return false;
+    }
+
+    char line[256];
+    int lineno = 0;
+    const char *msg = NULL;
+
+    while (!msg && fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char *tok[10] = {0};
+        int n = 0;
+        for (char *t = strtok(line, " \t\r\n"); t && n < 10; t = strtok(NULL, " \t\r\n")) {
+            tok[n++] = t;
+        }
+        if (n == 0) continue;
+
+        if (!strcmp(tok[0], "start") && n == 2) {
+            if (!scenario_parse_time(tok[1], &sc->start_us)) msg = "tempo inválido";
+        } else if (!strcmp(tok[0], "duration") && n == 2) {
+            if (!scenario_parse_time(tok[1], &sc->duration_us)) msg = "tempo inválido";
+        } else if (!strcmp(tok[0], "seed") && n == 2) {
+            sc->seed = (uint32_t)strtoul(tok[1], NULL, 0);
+        } else if (!strcmp(tok[0], "linkrate") && n == 2) {
+            sc->link_bytes_per_s = (uint32_t)strtoul(tok[1], NULL, 0);
+        } else if (!strcmp(tok[0], "adcdnl") && n == 2) {
+            sc->adc_spike_lsb = (unsigned int)strtoul(tok[1], NULL, 0);
+        } else if (!strcmp(tok[0], "signal") && n >= 4) {
+            int c = parse_channel(tok[1]);
+            if (c < 0) { msg = "canal desconhecido"; break; }
+            scenario_signal_t *s = &sc->signal[c];
+            s->mean = atof(tok[3]);
+            s->amplitude = 0;
+            if (!strcmp(tok[2], "sine") && n >= 6) {
+                s->amplitude = atof(tok[4]);
+                if (!scenario_parse_time(tok[5], &s->period_us) || s->period_us == 0) msg = "período inválido";
+                s->phase_rad = n >= 7 ? atof(tok[6]) * M_PI / 180.0 : 0.0;
+            } else if (strcmp(tok[2], "const") != 0) {
+                msg = "curva desconhecida (use const ou sine)";
+            }
+        } else if (!strcmp(tok[0], "noise") && n == 3) {
+            int c = parse_channel(tok[1]);
+            if (c < 0) msg = "canal desconhecido";
+            else sc->signal[c].noise = atof(tok[2]);
+        } else if (!strcmp(tok[0], "event") && n >= 6 && !strcmp(tok[n - 2], "for")) {
+            if (sc->event_count == SCENARIO_MAX_EVENTS) { msg = "eventos demais"; break; }
+            scenario_event_t *e = &sc->event[sc->event_count];
+            if (!scenario_parse_time(tok[1], &e->start_us) ||
+                !scenario_parse_time(tok[n - 1], &e->duration_us)) {
+                msg = "tempo inválido";
+                break;
+            }
+            int c = parse_channel(tok[2]);
+            if (!strcmp(tok[2], "dht22") && n == 6) {
+                e->kind = SCENARIO_EVENT_DHT22_FAULT;
+                if (!strcmp(tok[3], "timeout")) e->fault = SIM_DHT22_NO_RESPONSE;
+                else if (!strcmp(tok[3], "checksum")) e->fault = SIM_DHT22_BAD_CHECKSUM;
+                else msg = "falha do DHT22 desconhecida (use timeout ou checksum)";
+            } else if (!strcmp(tok[2], "link") && n == 6 && !strcmp(tok[3], "down")) {
+                e->kind = SCENARIO_EVENT_LINK_DOWN;
+            } else if (c >= 0 && n == 7) {
+                e->channel = (scenario_channel_t)c;
+                e->value = atof(tok[4]);
+                if (!strcmp(tok[3], "set")) e->kind = SCENARIO_EVENT_SET;
+                else if (!strcmp(tok[3], "offset")) e->kind = SCENARIO_EVENT_OFFSET;
+                else if (!strcmp(tok[3], "ramp")) e->kind = SCENARIO_EVENT_RAMP;
+                else msg = "evento desconhecido (use set, offset ou ramp)";
+            } else {
+                msg = "evento inválido";
+            }
+            sc->event_count++;
+        } else if (!strcmp(tok[0], "heater") && n == 5) {
+            scenario_heater_t *h = &sc->heater;
+            h->enabled = true;
+            h->gpio = (unsigned int)atoi(tok[1]);
+            h->cold = atof(tok[4]);
+            if (h->gpio >= SIM_GPIO_COUNT) msg = "GPIO inválido";
+            else if (!scenario_parse_time(tok[2], &h->heat_tau_us) || !scenario_parse_time(tok[3], &h->cool_tau_us) ||
+                     h->heat_tau_us == 0 || h->cool_tau_us == 0) {
+                msg = "constante de tempo inválida";
+            }
+        } else if (!strcmp(tok[0], "probe") && (n == 4 || n == 5)) {
+            int c = parse_channel(tok[1]);
+            if (sc->probe_count == SCENARIO_MAX_PROBES) { msg = "sondas demais"; break; }
+            scenario_probe_t *p = &sc->probe[sc->probe_count++];
+            p->gpio = (unsigned int)atoi(tok[2]);
+            p->percentile = 100.0;
+            if (c < 0) msg = "canal desconhecido";
+            else if (!scenario_parse_time(tok[3], &p->budget_us)) msg = "tempo inválido";
+            else if (n == 5 && (tok[4][0] != 'p' || (p->percentile = atof(tok[4] + 1)) <= 0.0 ||
+                                p->percentile > 100.0)) {
+                msg = "percentil inválido";
+            }
+            p->channel = (scenario_channel_t)c;
+        } else {
+            msg = "comando inválido";
+        }
+    }
+    fclose(f);
+
+    if (!msg && sc->duration_us == 0) {
+        msg = "duration ausente";
+        lineno = 0;
+    }
+    if (msg) {
+        snprintf(error, error_size, "%s:%d: %s", path, lineno, msg);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Ruído uniforme em [-1, 1], determinístico em (t, canal, semente)
+ *
+ * Avaliado por milissegundo: o ruído é constante dentro de cada 1 ms.
+ */
+static double noise_at(uint64_t t_us, int channel, uint32_t seed) {
+    uint64_t x = t_us * 0x9E3779B97F4A7C15ull ^ ((uint64_t)seed << 32 | (uint64_t)channel);
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 29;
+    return (double)(x >> 11) / (double)(1ull << 52) - 1.0;
+}
+
+static double signal_at(const scenario_t *sc, int c, uint64_t rel_us) {
+    const scenario_signal_t *s = &sc->signal[c];
+    double v = s->mean;
+    if (s->amplitude != 0.0) {
+        double cycles = (double)(rel_us % s->period_us) / (double)s->period_us;
+        v += s->amplitude * sin(2.0 * M_PI * cycles + s->phase_rad);
+    }
+    return v;
+}
+
+/**
+ * @brief Temperatura relativa do elemento em t_us, sem mudança do GPIO desde since_us
+ */
+static double heater_level_at(const scenario_heater_t *h, uint64_t t_us) {
+    double dt = t_us > h->since_us ? (double)(t_us - h->since_us) : 0.0;
+    return h->on ? 1.0 - (1.0 - h->level_at_since) * exp(-dt / (double)h->heat_tau_us)
+                 : h->level_at_since * exp(-dt / (double)h->cool_tau_us);
+}
+
+/**
+ * @brief Temperatura relativa do elemento do MQ2 em t_us (0: frio, 1: aquecido)
+ */
+static double heater_level(scenario_heater_t *h, uint64_t t_us) {
+    double level = heater_level_at(h, t_us);
+    bool on = sim_gpio_level(h->gpio);
+    if (on != h->on) {
+        h->on = on;
+        h->since_us = t_us;
+        h->level_at_since = level;
+    }
+    return level;
+}
+
+/**
+ * @brief Código do ADC para uma tensão, com a referência de 3,3 V
+ */
+static uint16_t adc_code(double volts) {
+    return (uint16_t)fmin(fmax(volts / 3.3 * 4095.0 + 0.5, 0.0), 4095.0);
+}
+
+void scenario_inputs(uint64_t t_us, sim_inputs_t *in, void *ctx) {
+    scenario_t *sc = ctx;
+    uint64_t rel = t_us - sc->start_us;
+    double value[SCENARIO_CH_COUNT];
+
+    for (int c = 0; c < SCENARIO_CH_COUNT; c++) {
+        value[c] = signal_at(sc, c, rel);
+    }
+    in->dht22_fault = SIM_DHT22_OK;
+    in->link_up = true;
+
+    // Eventos aplicados na ordem do roteiro
+    for (int i = 0; i < sc->event_count; i++) {
+        const scenario_event_t *e = &sc->event[i];
+        if (rel < e->start_us || rel >= e->start_us + e->duration_us) continue;
+        switch (e->kind) {
+        case SCENARIO_EVENT_SET:
+            value[e->channel] = e->value;
+            break;
+        case SCENARIO_EVENT_OFFSET:
+            value[e->channel] += e->value;
+            break;
+        case SCENARIO_EVENT_RAMP: {
+            double k = (double)(rel - e->start_us) / (double)e->duration_us;
+            value[e->channel] += (e->value - value[e->channel]) * k;
+            break;
+        }
+        case SCENARIO_EVENT_DHT22_FAULT:
+            in->dht22_fault = e->fault;
+            break;
+        case SCENARIO_EVENT_LINK_DOWN:
+            in->link_up = false;
+            break;
+        }
+    }
+
+    for (int c = 0; c < SCENARIO_CH_COUNT; c++) {
+        if (sc->signal[c].noise != 0.0) {
+            value[c] += sc->signal[c].noise * noise_at(rel / 1000, c, sc->seed);
+        }
+    }
+
+    if (sc->heater.enabled) {
+        double level = heater_level(&sc->heater, t_us);
+        value[SCENARIO_CH_MQ2] += (sc->heater.cold - value[SCENARIO_CH_MQ2]) * (1.0 - level);
+    }
+
+    in->temperature = (float)value[SCENARIO_CH_TEMPERATURE];
+    in->humidity = (float)fmin(fmax(value[SCENARIO_CH_HUMIDITY], 0.0), 100.0);
+    in->adc[0] = (uint16_t)fmin(fmax(value[SCENARIO_CH_LDR], 0.0), 4095.0);
+    in->adc[1] = (uint16_t)fmin(fmax(value[SCENARIO_CH_MQ2], 0.0), 4095.0);
+    in->adc[3] = adc_code(value[SCENARIO_CH_VSYS] / 3.0);
+    // Sensor de temperatura do RP2040: 0,706 V a 27 °C, -1,721 mV/°C
+    in->adc[4] = adc_code(0.706 - (value[SCENARIO_CH_CHIP] - 27.0) * 0.001721);
+}
+
+/**
+ * @brief Faixa de um sinal senoidal em [rel0, rel1]: as pontas e as cristas no meio
+ */
+static void signal_range(const scenario_t *sc, int c, uint64_t rel0, uint64_t rel1, double *lo, double *hi) {
+    const scenario_signal_t *s = &sc->signal[c];
+    *lo = *hi = s->mean;
+    if (s->amplitude == 0.0) return;
+    double a = fabs(s->amplitude);
+    if (rel1 - rel0 >= s->period_us) {
+        *lo -= a;
+        *hi += a;
+        return;
+    }
+    double v0 = signal_at(sc, c, rel0), v1 = signal_at(sc, c, rel1);
+    *lo = fmin(v0, v1);
+    *hi = fmax(v0, v1);
+
+    // Fase em ciclos: máximo do seno em 1/4 e mínimo em 3/4 de cada ciclo
+    double u0 = (double)(rel0 % s->period_us) / (double)s->period_us + s->phase_rad / (2.0 * M_PI);
+    double u1 = u0 + (double)(rel1 - rel0) / (double)s->period_us;
+    for (double peak = 0.25; peak < 1.0; peak += 0.5) {
+        if (floor(u1 - peak) >= ceil(u0 - peak)) {
+            double v = s->mean + s->amplitude * (peak < 0.5 ? 1.0 : -1.0);
+            *lo = fmin(*lo, v);
+            *hi = fmax(*hi, v);
+        }
+    }
+}
+
+static uint16_t clamp_code(double v) {
+    return (uint16_t)fmin(fmax(v, 0.0), 4095.0);
+}
+
+void scenario_input_bounds(uint64_t t0_us, uint64_t t1_us, uint16_t lo[SIM_ADC_INPUTS],
+                           uint16_t hi[SIM_ADC_INPUTS], void *ctx) {
+    const scenario_t *sc = ctx;
+    // As entradas valem por milissegundo inteiro (ver scenario_inputs())
+    uint64_t from = t0_us / 1000 * 1000;
+    uint64_t rel0 = from > sc->start_us ? from - sc->start_us : 0;
+    uint64_t rel1 = t1_us > sc->start_us ? t1_us - sc->start_us : 0;
+    double vlo[SCENARIO_CH_COUNT], vhi[SCENARIO_CH_COUNT];
+
+    for (int c = 0; c < SCENARIO_CH_COUNT; c++) {
+        signal_range(sc, c, rel0, rel1, &vlo[c], &vhi[c]);
+    }
+
+    // Eventos que tocam o intervalo, na ordem do roteiro: a faixa passa a
+    // cobrir o valor antes e depois de cada um
+    for (int i = 0; i < sc->event_count; i++) {
+        const scenario_event_t *e = &sc->event[i];
+        if (e->kind > SCENARIO_EVENT_RAMP || e->start_us > rel1 || e->start_us + e->duration_us <= rel0) continue;
+        double *l = &vlo[e->channel], *h = &vhi[e->channel];
+        switch (e->kind) {
+        case SCENARIO_EVENT_SET:
+        case SCENARIO_EVENT_RAMP:
+            *l = fmin(*l, e->value);
+            *h = fmax(*h, e->value);
+            break;
+        case SCENARIO_EVENT_OFFSET:
+            *l = fmin(*l, *l + e->value);
+            *h = fmax(*h, *h + e->value);
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (int c = 0; c < SCENARIO_CH_COUNT; c++) {
+        vlo[c] -= fabs(sc->signal[c].noise);
+        vhi[c] += fabs(sc->signal[c].noise);
+    }
+
+    if (sc->heater.enabled) {
+        // Leitura = sinal * nível + frio * (1 - nível), com o nível monótono
+        // enquanto o GPIO não muda; um GPIO que acabou de mudar cobre de 0 a 1
+        const scenario_heater_t *h = &sc->heater;
+        double l0 = 0.0, l1 = 1.0;
+        if (sim_gpio_level(h->gpio) == h->on) {
+            l0 = heater_level_at(h, t0_us);
+            l1 = heater_level_at(h, t1_us);
+        }
+        double mlo = vlo[SCENARIO_CH_MQ2], mhi = vhi[SCENARIO_CH_MQ2];
+        vlo[SCENARIO_CH_MQ2] = INFINITY;
+        vhi[SCENARIO_CH_MQ2] = -INFINITY;
+        const double level[2] = {l0, l1}, value[2] = {mlo, mhi};
+        for (int a = 0; a < 2; a++) {
+            for (int b = 0; b < 2; b++) {
+                double v = value[a] * level[b] + h->cold * (1.0 - level[b]);
+                vlo[SCENARIO_CH_MQ2] = fmin(vlo[SCENARIO_CH_MQ2], v);
+                vhi[SCENARIO_CH_MQ2] = fmax(vhi[SCENARIO_CH_MQ2], v);
+            }
+        }
+    }
+
+    lo[0] = clamp_code(vlo[SCENARIO_CH_LDR]);
+    hi[0] = clamp_code(vhi[SCENARIO_CH_LDR]);
+    lo[1] = clamp_code(vlo[SCENARIO_CH_MQ2]);
+    hi[1] = clamp_code(vhi[SCENARIO_CH_MQ2]);
+    lo[2] = hi[2] = 0;
+    lo[3] = adc_code(vlo[SCENARIO_CH_VSYS] / 3.0);
+    hi[3] = adc_code(vhi[SCENARIO_CH_VSYS] / 3.0);
+    // A tensão do sensor de temperatura cai com a temperatura
+    lo[4] = adc_code(0.706 - (vhi[SCENARIO_CH_CHIP] - 27.0) * 0.001721);
+    hi[4] = adc_code(0.706 - (vlo[SCENARIO_CH_CHIP] - 27.0) * 0.001721);
+}
@@ -0,0 +1,174 @@
+/**
+ * @file scenario.h
+ * @brief Roteiros de cenário para a simulação em tempo virtual
+ *
+ * Um roteiro descreve, em texto, a evolução do ambiente ao longo de uma
+ * execução: curvas de cada sinal, ruído, eventos temporários e falhas.
+ * Exemplo (um comando por linha, '#' inicia comentário):
+ * @code
+ * start 49d17h                    # instante inicial desde o boot
+ * duration 14d                    # duração simulada (obrigatória)
+ * seed 7
+ * linkrate 2000                   # vazão do enlace em bytes/s (padrão: ilimitada)
+ * adcdnl 8                        # largura extra dos códigos largos do ADC (0: ADC ideal)
+ *
+ * signal temperature sine 25 6 1d # média amplitude período [fase_graus]
+ * signal humidity sine 55 -12 1d
+ * signal ldr sine 2000 -1800 1d
+ * signal mq2 const 400
+ * noise mq2 15                    # ruído uniforme ±15
+ * heater 6 3s 15s 3500            # aquecedor do MQ2 no GPIO 6 (ver abaixo)
+ *
+ * event 3d12h mq2 set 2600 for 10m
+ * event 5d temperature offset 15 for 6h
+ * event 6d temperature ramp 45 for 2h   # rampa linear até 45 durante 2 h
+ * event 8d dht22 timeout for 1h
+ * event 9d dht22 checksum for 30m
+ * event 10d link down for 2h
+ *
+ * probe mq2 5 1ms                 # latência evento do mq2 -> borda de subida no GPIO 5
+ * probe temperature 3 2500ms p95  # p95 da latência evento -> aumento do PWM do servo
+ * @endcode
+ *
+ * Uma sonda ("probe") mede, para cada evento do canal indicado, o tempo
+ * entre o início do evento e a primeira borda de subida no GPIO dentro
+ * da janela do evento (em saídas PWM, o primeiro aumento do nível),
+ * comparando o percentil dado (padrão p100, o máximo) com o orçamento. Como as entradas
+ * são discretizadas em 1 ms (ver sim.h), o início conta a partir do
+ * primeiro milissegundo inteiro do evento.
+ *
+ * Com "heater", a leitura do MQ2 depende da temperatura do elemento,
+ * entre 0 (frio) e 1 (aquecido), que segue o GPIO do aquecedor com as
+ * constantes de tempo de aquecimento e de resfriamento dadas: a leitura
+ * é o valor do sinal misturado ao valor frio, na proporção do quanto
+ * falta aquecer. Sem "heater", o MQ2 está sempre aquecido.
+ *
+ * Tempos aceitam combinações de us, ms, s, m, h e d (p.ex. "3d12h30m").
+ * Os instantes dos eventos são relativos ao início da simulação.
+ * Canais: temperature e humidity (DHT22, °C e %), ldr (ADC0) e mq2
+ * (ADC1), estes em código de um ADC ideal de 0 a 4095 (convertido pela
+ * curva de transferência de sim_set_adc_dnl(), padrão
+ * SIM_ADC_DNL_SPIKE_LSB, ou a de "adcdnl"), chip (temperatura do
+ * RP2040 em °C, padrão 25, lida pelo ADC4 com a curva do datasheet) e
+ * vsys (V, padrão 5, lida como VSYS / 3 pelo ADC3).
+ */
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+#define SCENARIO_MAX_EVENTS 256
+#define SCENARIO_MAX_PROBES 4
+
+typedef enum {
+    SCENARIO_CH_TEMPERATURE,
+    SCENARIO_CH_HUMIDITY,
+    SCENARIO_CH_LDR,
+    SCENARIO_CH_MQ2,
+    SCENARIO_CH_CHIP,
+    SCENARIO_CH_VSYS,
+    SCENARIO_CH_COUNT
+} scenario_channel_t;
+
+typedef enum {
+    SCENARIO_EVENT_SET,         // Substitui o valor do canal
+    SCENARIO_EVENT_OFFSET,      // Soma ao valor do canal
+    SCENARIO_EVENT_RAMP,        // Rampa linear do valor atual até o alvo
+    SCENARIO_EVENT_DHT22_FAULT, // Falha do DHT22
+    SCENARIO_EVENT_LINK_DOWN,   // Queda do enlace de saída
+} scenario_event_kind_t;
+
+typedef struct {
+    double mean;
+    double amplitude;           // 0 para sinal constante
+    uint64_t period_us;
+    double phase_rad;
+    double noise;               // Amplitude do ruído uniforme
+} scenario_signal_t;
+
+typedef struct {
+    scenario_event_kind_t kind;
+    scenario_channel_t channel;
+    sim_dht22_fault_t fault;
+    uint64_t start_us;          // Relativo ao início da simulação
+    uint64_t duration_us;
+    double value;
+} scenario_event_t;
+
+typedef struct {
+    scenario_channel_t channel; // Canal cujos eventos iniciam a medição
+    unsigned int gpio;          // Saída observada
+    uint64_t budget_us;         // Latência máxima aceitável no percentil
+    double percentile;          // Percentil avaliado (100 = todos os eventos)
+} scenario_probe_t;
+
+/**
+ * @brief Modelo térmico do aquecedor do MQ2
+ */
+typedef struct {
+    bool enabled;
+    unsigned int gpio;          // Saída que liga o aquecedor
+    uint64_t heat_tau_us;       // Constante de tempo com o aquecedor ligado
+    uint64_t cool_tau_us;       // Constante de tempo com o aquecedor desligado
+    double cold;                // Leitura com o elemento frio
+
+    // Estado ao longo da simulação
+    bool on;
+    uint64_t since_us;          // Última mudança do GPIO
+    double level_at_since;      // Temperatura relativa nessa mudança
+} scenario_heater_t;
+
+typedef struct {
+    uint64_t start_us;          // Instante inicial desde o boot
+    uint64_t duration_us;
+    uint32_t seed;
+    uint32_t link_bytes_per_s;  // 0: enlace sem limite de vazão
+    unsigned int adc_spike_lsb; // Largura extra dos códigos largos do ADC
+    scenario_signal_t signal[SCENARIO_CH_COUNT];
+    scenario_event_t event[SCENARIO_MAX_EVENTS];
+    int event_count;
+    scenario_probe_t probe[SCENARIO_MAX_PROBES];
+    int probe_count;
+    scenario_heater_t heater;
+} scenario_t;
+
+/**
+ * @brief Lê um roteiro de arquivo
+ *
+ * @param path Caminho do arquivo
+ * @param sc Cenário a ser preenchido
+ * @param error Buffer para a mensagem de erro (com número da linha)
+ * @param error_size Tamanho do buffer de erro
+ *
+ * @return true se o roteiro é válido
+ */
+bool scenario_load(const char *path, scenario_t *sc, char *error, int error_size);
+
+/**
+ * @brief Fonte de entradas para sim_set_input_source(); ctx é o scenario_t
+ *
+ * Atualiza o estado do modelo do aquecedor; os instantes devem ser
+ * crescentes, como os consultados pela simulação.
+ */
+void scenario_inputs(uint64_t t_us, sim_inputs_t *inputs, void *ctx);
+
+/**
+ * @brief Limites das entradas do ADC em [t0_us, t1_us], para sim_set_adc_fast_forward(); ctx é o scenario_t
+ *
+ * Conservadores: cobrem o seno, o ruído, os eventos que tocam o
+ * intervalo e o aquecimento do MQ2, sem alterar o modelo do aquecedor.
+ */
+void scenario_input_bounds(uint64_t t0_us, uint64_t t1_us, uint16_t lo[SIM_ADC_INPUTS],
+                           uint16_t hi[SIM_ADC_INPUTS], void *ctx);
+
+/**
+ * @brief Converte um tempo como "3d12h" em microssegundos
+ *
+ * @return true se o texto é válido
+ */
+bool scenario_parse_time(const char *text, uint64_t *us);
+
+#endif // SCENARIO_H
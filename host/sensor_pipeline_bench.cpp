@@ -0,0 +1,315 @@
+/**
+ * @file sensor_pipeline_bench.cpp
+ * @brief Cadeias de sensor_pipeline.h contra o código em C que elas substituem
+ *
+ * Três cadeias, cada uma ao lado da versão escrita à mão em C:
+ * - LDR: mediana de 3 do adc_capture e limiar de ldr_monitoring() sobre
+ *   a última amostra do bloco (C: running_median_push() e comparação);
+ * - MQ2: mediana de 3 e a regra por bloco de gas_alarm_on_block()
+ *   (liga na primeira amostra acima, desliga num bloco sem nenhuma);
+ * - completa: sobreamostragem de 2, mediana de 5, EWMA de 1/8 e
+ *   histerese, como exemplo das etapas que o firmware ainda não usa
+ *   (C: os mesmos cálculos em funções separadas).
+ *
+ * Os blocos são os de adc_capture.h (LDR e MQ2 intercalados, 8 amostras
+ * de cada), com ruído, picos isolados e degraus que cruzam os limiares.
+ * Em cada rodada, as mudanças do atuador das duas versões (bloco e
+ * estado) são conferidas; se diferirem, o programa termina com código 1.
+ * Mostra ns e ciclos (TSC, em x86) por bloco, da melhor de BENCH_ROUNDS
+ * rodadas. No RP2040 a mesma comparação roda em
+ * sensor_pipeline_bench.cpp (raiz do projeto).
+ *
+ * Uso:
+ * @code
+ * sensor_pipeline_bench [blocos]
+ * @endcode
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+#include "sensor_pipeline.h"
+
+extern "C" {
+#include "adc_capture.h"
+#include "gas_alarm.h"
+#include "running_median.h"
+}
+
+#define BENCH_BLOCK_SAMPLES ADC_CAPTURE_BLOCK_SAMPLES
+#define BENCH_PER_CHANNEL (ADC_CAPTURE_BLOCK_SAMPLES / ADC_CAPTURE_CHANNELS)
+#define BENCH_LDR_THRESHOLD 1500    // LDR_THRESHOLD de environment-monitoring.c
+#define BENCH_FULL_ON 1600
+#define BENCH_FULL_OFF 1400
+#define BENCH_ROUNDS 5
+
+namespace sp = sensor_pipeline;
+
+using bench_clock = std::chrono::steady_clock;
+
+/**
+ * @brief Registro das mudanças de um atuador: contagem e soma dependente da ordem
+ */
+struct Events {
+    uint32_t changes = 0;
+    uint64_t hash = 0;
+};
+
+static uint32_t current_block;      // Bloco em processamento, para o registro dos atuadores
+static Events events[2];            // 0: C, 1: template
+
+static inline void record(Events &e, bool on) {
+    e.changes++;
+    e.hash = e.hash * 1000003u + current_block * 2u + on;
+}
+
+template <int Version>
+struct Record {
+    void operator()(bool on) const { record(events[Version], on); }
+};
+
+// ---------------------------------------------------------------- C
+
+struct CLdr {
+    running_median_t median;
+    bool on;
+};
+
+struct CMq2 {
+    running_median_t median;
+    bool active;
+};
+
+struct CFull {
+    int32_t sum;
+    int count;
+    running_median_t median;
+    int32_t acc;
+    bool primed;
+    bool on;
+};
+
+static void c_ldr_init(CLdr *c) {
+    running_median_init(&c->median, 3);
+    c->on = false;
+}
+
+static void c_ldr_block(CLdr *c, const uint16_t *block) {
+    int32_t latest = 0;
+    for (int i = ADC_CAPTURE_LDR; i < BENCH_BLOCK_SAMPLES; i += ADC_CAPTURE_CHANNELS) {
+        latest = running_median_push(&c->median, block[i]);
+    }
+    if ((latest > BENCH_LDR_THRESHOLD) != c->on) {
+        c->on = !c->on;
+        record(events[0], c->on);
+    }
+}
+
+static void c_mq2_init(CMq2 *c) {
+    running_median_init(&c->median, 3);
+    c->active = false;
+}
+
+static void c_mq2_block(CMq2 *c, const uint16_t *block) {
+    int32_t filtered[BENCH_PER_CHANNEL];
+    for (int i = 0; i < BENCH_PER_CHANNEL; i++) {
+        filtered[i] = running_median_push(&c->median, block[i * ADC_CAPTURE_CHANNELS + ADC_CAPTURE_MQ2]);
+    }
+    int first_above = -1;
+    for (int i = 0; i < BENCH_PER_CHANNEL; i++) {
+        if (filtered[i] > GAS_ALARM_DEFAULT_THRESHOLD) {
+            first_above = i;
+            break;
+        }
+    }
+    if (first_above >= 0 && !c->active) {
+        c->active = true;
+        record(events[0], true);
+    } else if (first_above < 0 && c->active) {
+        c->active = false;
+        record(events[0], false);
+    }
+}
+
+static void c_full_init(CFull *c) {
+    c->sum = 0;
+    c->count = 0;
+    running_median_init(&c->median, 5);
+    c->primed = false;
+    c->on = false;
+}
+
+static void c_full_sample(CFull *c, int32_t v) {
+    c->sum += v;
+    if (++c->count < 2) return;
+    v = c->sum / 2;
+    c->sum = 0;
+    c->count = 0;
+
+    v = running_median_push(&c->median, v);
+    if (!c->primed) {
+        c->acc = v << 3;
+        c->primed = true;
+    } else {
+        c->acc += v - (c->acc >> 3);
+    }
+    v = (c->acc + 4) >> 3;
+
+    bool on = c->on ? v > BENCH_FULL_OFF : v > BENCH_FULL_ON;
+    if (on != c->on) {
+        c->on = on;
+        record(events[0], on);
+    }
+}
+
+static void c_full_block(CFull *c, const uint16_t *block) {
+    for (int i = ADC_CAPTURE_LDR; i < BENCH_BLOCK_SAMPLES; i += ADC_CAPTURE_CHANNELS) c_full_sample(c, block[i]);
+}
+
+// ---------------------------------------------------------------- template
+
+using LdrPipeline = sp::Pipeline<sp::Channel<ADC_CAPTURE_CHANNELS, ADC_CAPTURE_LDR>, sp::Median<3>,
+                                 sp::Decimate<BENCH_PER_CHANNEL>, sp::Hysteresis<BENCH_LDR_THRESHOLD, BENCH_LDR_THRESHOLD>,
+                                 sp::Actuator<Record<1>>>;
+
+using Mq2Pipeline = sp::Pipeline<sp::Channel<ADC_CAPTURE_CHANNELS, ADC_CAPTURE_MQ2>, sp::Median<3>,
+                                 sp::LatchAbove<GAS_ALARM_DEFAULT_THRESHOLD>, sp::Actuator<Record<1>>>;
+
+using FullPipeline = sp::Pipeline<sp::Channel<ADC_CAPTURE_CHANNELS, ADC_CAPTURE_LDR>, sp::Oversample<2>,
+                                  sp::Median<5>, sp::Ewma<3>, sp::Hysteresis<BENCH_FULL_ON, BENCH_FULL_OFF>,
+                                  sp::Actuator<Record<1>>>;
+
+// ---------------------------------------------------------------- medida
+
+static uint64_t cycles_now() {
+#if BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief LDR e MQ2 intercalados; o LDR oscila em torno do limiar, o MQ2 tem vazamentos
+ */
+static std::vector<uint16_t> make_blocks(size_t blocks) {
+    std::vector<uint16_t> samples(blocks * BENCH_BLOCK_SAMPLES);
+    uint32_t rng = 12345;
+    for (size_t i = 0; i < blocks * BENCH_PER_CHANNEL; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        int32_t noise = (int32_t)((rng >> 8) % 61) - 30;
+        int32_t ldr = 1500 + (int32_t)(i % 4000) / 4 - 500 + noise;
+        int32_t mq2 = 400 + noise;
+        if (i / 3000 % 5 == 4) mq2 += 1650 + (int32_t)((rng >> 14) % 101) - 50;  // Vazamento perto do limiar
+        if ((rng >> 20) % 300 == 0) ldr = mq2 = 4095;                             // Pico isolado
+        samples[i * ADC_CAPTURE_CHANNELS + ADC_CAPTURE_LDR] = (uint16_t)(ldr < 0 ? 0 : ldr);
+        samples[i * ADC_CAPTURE_CHANNELS + ADC_CAPTURE_MQ2] = (uint16_t)mq2;
+    }
+    return samples;
+}
+
+struct Result {
+    double ns_per_block;
+    double cycles_per_block;
+};
+
+template <typename F>
+static Result measure(const std::vector<uint16_t> &samples, F &&process) {
+    size_t blocks = samples.size() / BENCH_BLOCK_SAMPLES;
+    auto start = bench_clock::now();
+    uint64_t c0 = cycles_now();
+    for (size_t b = 0; b < blocks; b++) {
+        current_block = (uint32_t)b;
+        process(&samples[b * BENCH_BLOCK_SAMPLES]);
+    }
+    uint64_t c1 = cycles_now();
+    double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    return {ns / blocks, (double)(c1 - c0) / blocks};
+}
+
+struct Case {
+    const char *name;
+    Result (*c)(const std::vector<uint16_t> &);
+    Result (*pipeline)(const std::vector<uint16_t> &);
+};
+
+static const Case cases[] = {
+    {"LDR",
+     [](const std::vector<uint16_t> &s) {
+         static CLdr c;
+         c_ldr_init(&c);
+         return measure(s, [](const uint16_t *block) { c_ldr_block(&c, block); });
+     },
+     [](const std::vector<uint16_t> &s) {
+         static LdrPipeline p;
+         p = LdrPipeline();
+         return measure(s, [](const uint16_t *block) { p.run_block(block, BENCH_BLOCK_SAMPLES); });
+     }},
+    {"MQ2",
+     [](const std::vector<uint16_t> &s) {
+         static CMq2 c;
+         c_mq2_init(&c);
+         return measure(s, [](const uint16_t *block) { c_mq2_block(&c, block); });
+     },
+     [](const std::vector<uint16_t> &s) {
+         static Mq2Pipeline p;
+         p = Mq2Pipeline();
+         return measure(s, [](const uint16_t *block) { p.run_block(block, BENCH_BLOCK_SAMPLES); });
+     }},
+    {"completa",
+     [](const std::vector<uint16_t> &s) {
+         static CFull c;
+         c_full_init(&c);
+         return measure(s, [](const uint16_t *block) { c_full_block(&c, block); });
+     },
+     [](const std::vector<uint16_t> &s) {
+         static FullPipeline p;
+         p = FullPipeline();
+         return measure(s, [](const uint16_t *block) { p.run_block(block, BENCH_BLOCK_SAMPLES); });
+     }},
+};
+
+int main(int argc, char **argv) {
+    size_t blocks = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 500000;
+    if (blocks == 0) return 2;
+    std::vector<uint16_t> samples = make_blocks(blocks);
+
+    std::printf("%zu blocos de %d amostras (mudanças dos atuadores conferidas)\n", blocks, BENCH_BLOCK_SAMPLES);
+    std::printf("%-10s %9s %12s", "cadeia", "mudanças", "C ns/bloco");
+    if (BENCH_HAS_TSC) std::printf(" %8s", "ciclos");
+    std::printf(" %19s", "template ns/bloco");
+    if (BENCH_HAS_TSC) std::printf(" %8s", "ciclos");
+    std::printf("\n");
+
+    int failed = 0;
+    for (const Case &k : cases) {
+        // Melhor de BENCH_ROUNDS rodadas intercaladas; toda rodada confere os atuadores
+        Result c = {1e30, 0}, t = {1e30, 0};
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            events[0] = events[1] = Events();
+            Result rc = k.c(samples);
+            Result rt = k.pipeline(samples);
+            if (rc.ns_per_block < c.ns_per_block) c = rc;
+            if (rt.ns_per_block < t.ns_per_block) t = rt;
+            if (events[0].changes != events[1].changes || events[0].hash != events[1].hash) {
+                std::fprintf(stderr, "%s: atuador diverge (C %u mudanças, template %u)\n", k.name,
+                             events[0].changes, events[1].changes);
+                failed = 1;
+            }
+        }
+        std::printf("%-10s %9u %12.1f", k.name, events[1].changes, c.ns_per_block);
+        if (BENCH_HAS_TSC) std::printf(" %8.0f", c.cycles_per_block);
+        std::printf(" %19.1f", t.ns_per_block);
+        if (BENCH_HAS_TSC) std::printf(" %8.0f", t.cycles_per_block);
+        std::printf("\n");
+    }
+    return failed;
+}
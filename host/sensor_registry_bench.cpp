@@ -0,0 +1,88 @@
+/**
+ * @file sensor_registry_bench.cpp
+ * @brief Custo de leitura do registro de últimos valores (sensor_registry.h)
+ *
+ * Mede o tempo por leitura de um canal em três situações: uma cópia
+ * simples dos mesmos quatro campos, sem proteção (a referência); o
+ * registro sem escritor ativo; e o registro com uma thread publicando no
+ * mesmo canal sem parar, em que a leitura às vezes precisa ser repetida.
+ * Neste último caso também mostra a fração de tentativas que cruzaram
+ * uma publicação.
+ *
+ * Uso:
+ * @code
+ * sensor_registry_bench [leituras]
+ * @endcode
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+extern "C" {
+#include "sensor_registry.h"
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+static volatile int32_t bench_sink;     // Impede que o compilador descarte as leituras
+
+// Referência: os mesmos campos, lidos sem contador de sequência
+static volatile sensor_reading_t plain;
+
+template <typename Read>
+static double measure(size_t count, Read read) {
+    int32_t acc = 0;
+    auto start = bench_clock::now();
+    for (size_t i = 0; i < count; i++) acc += read();
+    double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    bench_sink = acc;
+    return ns / count;
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 50000000;
+
+    sensor_reading_t reading = {0, {245, 601}, 1000, 0};
+    sensor_registry_publish(SENSOR_REGISTRY_DHT22, &reading);
+
+    double copy_ns = measure(count, [] {
+        sensor_reading_t r;
+        r.status = plain.status;
+        r.value[0] = plain.value[0];
+        r.value[1] = plain.value[1];
+        r.time_us = plain.time_us;
+        return r.status + r.value[0] + r.value[1] + (int32_t)r.time_us;
+    });
+    double idle_ns = measure(count, [] {
+        sensor_reading_t r;
+        sensor_registry_read(SENSOR_REGISTRY_DHT22, &r);
+        return r.status + r.value[0] + r.value[1] + (int32_t)r.time_us;
+    });
+
+    std::atomic<bool> running{true};
+    std::thread writer([&running] {
+        sensor_reading_t w = {0, {0, 0}, 0, 0};
+        while (running.load(std::memory_order_relaxed)) {
+            w.value[0]++;
+            w.time_us += 2000;
+            sensor_registry_publish(SENSOR_REGISTRY_DHT22, &w);
+        }
+    });
+    size_t failed = 0;
+    double contended_ns = measure(count, [&failed] {
+        sensor_reading_t r;
+        while (!sensor_registry_try_read(SENSOR_REGISTRY_DHT22, &r)) failed++;
+        return r.status + r.value[0] + r.value[1] + (int32_t)r.time_us;
+    });
+    running = false;
+    writer.join();
+
+    std::printf("%zu leituras por caso\n", count);
+    std::printf("%8.2f ns/leitura  cópia sem proteção\n", copy_ns);
+    std::printf("%8.2f ns/leitura  seqlock, sem escritor\n", idle_ns);
+    std::printf("%8.2f ns/leitura  seqlock, escritor ativo (%.3f%% das tentativas repetidas)\n", contended_ns,
+                100.0 * failed / (count + failed));
+    return 0;
+}
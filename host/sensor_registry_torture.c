@@ -0,0 +1,210 @@
+/**
+ * @file sensor_registry_torture.c
+ * @brief Teste de tortura do registro de últimos valores (sensor_registry.h)
+ *
+ * Um escritor por canal publica leituras sem parar, em que todos os
+ * campos derivam do número da publicação; várias threads leitoras leem
+ * canais sorteados e conferem que cada leitura é inteira (todos os campos
+ * da mesma publicação, com sequence igual ao número dela) e que nenhum
+ * canal volta no tempo. Uma das leitoras usa só sensor_registry_try_read(),
+ * como faria uma interrupção, e conta as tentativas que cruzaram uma
+ * publicação.
+ *
+ * Com --unprotected, os mesmos campos são publicados e lidos sem o
+ * contador de sequência, para mostrar as leituras rasgadas que o seqlock
+ * evita. Sai com 1 se o registro entregou alguma leitura rasgada.
+ *
+ * Uso:
+ * @code
+ * sensor_registry_torture [--seconds s] [--readers n] [--unprotected]
+ * @endcode
+ */
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sensor_registry.h"
+
+#define TORTURE_MAX_READERS 64
+#define TORTURE_TIME_KEY 0xA5A5A5A5u
+
+/**
+ * @brief Campos sem seqlock, para o modo --unprotected
+ */
+static struct {
+    _Atomic int32_t status;
+    _Atomic int32_t value[2];
+    _Atomic uint32_t time_us;
+} unprotected[SENSOR_REGISTRY_CHANNELS];
+
+static bool use_registry = true;
+static atomic_bool running = true;
+
+typedef struct {
+    int id;
+    bool isr;                   // Só tentativas únicas, como numa interrupção
+    long reads;
+    long torn;
+    long backwards;
+    long failed_tries;
+} reader_stats_t;
+
+// Publicação n: todos os campos derivam de n
+static void make_reading(uint32_t n, sensor_reading_t *r) {
+    r->status = (int32_t)n;
+    r->value[0] = (int32_t)(n * 7u);
+    r->value[1] = (int32_t)~n;
+    r->time_us = n ^ TORTURE_TIME_KEY;
+}
+
+static bool reading_is_whole(const sensor_reading_t *r, bool check_sequence) {
+    uint32_t n = (uint32_t)r->status;
+    return (uint32_t)r->value[0] == n * 7u && (uint32_t)r->value[1] == ~n && r->time_us == (n ^ TORTURE_TIME_KEY) &&
+           (!check_sequence || r->sequence == n);
+}
+
+static void *writer_main(void *arg) {
+    sensor_registry_channel_t channel = (sensor_registry_channel_t)(intptr_t)arg;
+    sensor_reading_t r;
+    for (uint32_t n = 1; atomic_load_explicit(&running, memory_order_relaxed); n++) {
+        make_reading(n, &r);
+        if (use_registry) {
+            sensor_registry_publish(channel, &r);
+        } else {
+            atomic_store_explicit(&unprotected[channel].status, r.status, memory_order_relaxed);
+            atomic_store_explicit(&unprotected[channel].value[0], r.value[0], memory_order_relaxed);
+            atomic_store_explicit(&unprotected[channel].value[1], r.value[1], memory_order_relaxed);
+            atomic_store_explicit(&unprotected[channel].time_us, r.time_us, memory_order_relaxed);
+        }
+    }
+    return NULL;
+}
+
+static void read_unprotected(sensor_registry_channel_t channel, sensor_reading_t *r) {
+    r->status = atomic_load_explicit(&unprotected[channel].status, memory_order_relaxed);
+    r->value[0] = atomic_load_explicit(&unprotected[channel].value[0], memory_order_relaxed);
+    r->value[1] = atomic_load_explicit(&unprotected[channel].value[1], memory_order_relaxed);
+    r->time_us = atomic_load_explicit(&unprotected[channel].time_us, memory_order_relaxed);
+    r->sequence = (uint32_t)r->status;
+}
+
+static void *reader_main(void *arg) {
+    reader_stats_t *stats = arg;
+    uint32_t last[SENSOR_REGISTRY_CHANNELS] = {0};
+    uint32_t rng = 2463534242u + (uint32_t)stats->id;
+
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        sensor_registry_channel_t channel = (sensor_registry_channel_t)(rng % SENSOR_REGISTRY_CHANNELS);
+
+        sensor_reading_t r;
+        if (!use_registry) {
+            read_unprotected(channel, &r);
+        } else if (stats->isr) {
+            if (!sensor_registry_try_read(channel, &r)) {
+                stats->failed_tries++;
+                continue;
+            }
+        } else {
+            sensor_registry_read(channel, &r);
+        }
+
+        stats->reads++;
+        if (r.sequence == 0) continue;     // Canal ainda não publicado
+        if (!reading_is_whole(&r, use_registry)) {
+            stats->torn++;
+        } else if (r.sequence < last[channel]) {
+            stats->backwards++;
+        } else {
+            last[channel] = r.sequence;
+        }
+    }
+    return NULL;
+}
+
+static int usage(const char *argv0) {
+    fprintf(stderr, "uso: %s [--seconds s] [--readers n] [--unprotected]\n", argv0);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    double seconds = 2.0;
+    int readers = 3;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(arg, "--unprotected")) {
+            use_registry = false;
+            continue;
+        }
+        if (!value) return usage(argv[0]);
+        i++;
+        if (!strcmp(arg, "--seconds")) {
+            seconds = strtod(value, NULL);
+        } else if (!strcmp(arg, "--readers")) {
+            readers = atoi(value);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (seconds <= 0 || readers < 1 || readers > TORTURE_MAX_READERS) return usage(argv[0]);
+
+    pthread_t writer[SENSOR_REGISTRY_CHANNELS];
+    pthread_t reader[TORTURE_MAX_READERS];
+    reader_stats_t stats[TORTURE_MAX_READERS] = {{0}};
+
+    for (int c = 0; c < SENSOR_REGISTRY_CHANNELS; c++) {
+        pthread_create(&writer[c], NULL, writer_main, (void *)(intptr_t)c);
+    }
+    for (int r = 0; r < readers; r++) {
+        stats[r].id = r;
+        stats[r].isr = r == readers - 1 && readers > 1;
+        pthread_create(&reader[r], NULL, reader_main, &stats[r]);
+    }
+
+    struct timespec pause = {(time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9)};
+    nanosleep(&pause, NULL);
+    atomic_store(&running, false);
+
+    for (int c = 0; c < SENSOR_REGISTRY_CHANNELS; c++) pthread_join(writer[c], NULL);
+    long torn = 0, backwards = 0;
+    for (int r = 0; r < readers; r++) {
+        pthread_join(reader[r], NULL);
+        torn += stats[r].torn;
+        backwards += stats[r].backwards;
+    }
+
+    sensor_reading_t final;
+    long published = 0;
+    for (int c = 0; c < SENSOR_REGISTRY_CHANNELS; c++) {
+        if (use_registry) {
+            sensor_registry_read((sensor_registry_channel_t)c, &final);
+        } else {
+            read_unprotected((sensor_registry_channel_t)c, &final);
+        }
+        published += final.sequence;
+    }
+
+    printf("%s: %d escritores, %d leitores, %.1f s, %ld publicações\n",
+           use_registry ? "seqlock" : "sem proteção", SENSOR_REGISTRY_CHANNELS, readers, seconds, published);
+    for (int r = 0; r < readers; r++) {
+        printf("leitor %d%s: %ld leituras, %ld rasgadas, %ld fora de ordem", r, stats[r].isr ? " (interrupção)" : "",
+               stats[r].reads, stats[r].torn, stats[r].backwards);
+        if (stats[r].isr) {
+            long tries = stats[r].reads + stats[r].failed_tries;
+            printf(", %ld tentativas falhas (%.3f%%)", stats[r].failed_tries,
+                   tries ? 100.0 * stats[r].failed_tries / tries : 0.0);
+        }
+        printf("\n");
+    }
+    printf("total: %ld leituras rasgadas, %ld fora de ordem\n", torn, backwards);
+
+    return use_registry && (torn || backwards) ? 1 : 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file series_bench.cpp
+ * @brief Benchmark de varredura do formato colunar
+ *
+ * Gera um arquivo de série sintético (formas de onda plausíveis para
+ * temperatura, umidade, LDR e MQ2 a 1 amostra/s) e mede:
+ * - vazão de escrita do coletor;
+ * - varredura completa de um canal;
+ * - varredura de uma janela estreita de tempo (poda pelo índice);
+ * - varredura filtrada por valor (poda pelos zone maps).
+ *
+ * Uso:
+ * @code
+ * series_bench <arquivo.ems> [amostras]
+ * @endcode
+ *
+ * O padrão de 400 milhões de amostras produz alguns GB de dados
+ * descomprimidos (24 bytes por amostra).
+ */
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "series_reader.h"
+#include "series_synth.h"
+
+using bench_clock = std::chrono::steady_clock;
+
+static double seconds_since(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "uso: %s <arquivo.ems> [amostras]\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[1];
+    uint64_t samples = argc > 2 ? std::strtoull(argv[2], nullptr, 0) : 400000000ull;
+
+    try {
+        auto start = bench_clock::now();
+        series_synth_write(path, 1, samples);
+        double t_write = seconds_since(start);
+
+        SeriesReader reader(path);
+        double raw_gb = (double)samples * sizeof(series_sample_t) / 1e9;
+        std::printf("amostras: %llu, chunks: %zu\n",
+                    (unsigned long long)reader.sample_count(), reader.chunk_count());
+        std::printf("arquivo: %.2f GB (descomprimido: %.2f GB, %.2f bytes/amostra)\n",
+                    reader.file_size() / 1e9, raw_gb, (double)reader.file_size() / samples);
+        std::printf("escrita: %.1f M amostras/s\n", samples / t_write / 1e6);
+
+        // Varredura completa de um canal
+        start = bench_clock::now();
+        int64_t sum = 0;
+        reader.scan(INT64_MIN, INT64_MAX, SERIES_CH_MQ2,
+                    [&](const int64_t *, const int32_t *v, size_t n) {
+                        for (size_t i = 0; i < n; i++) sum += v[i];
+                    });
+        double t_full = seconds_since(start);
+        std::printf("varredura completa (MQ2): %.1f M amostras/s (soma %lld)\n",
+                    samples / t_full / 1e6, (long long)sum);
+
+        // Janela de 1 hora no meio da série
+        int64_t mid = (int64_t)(samples / 2) * 1000000;
+        uint64_t hits = 0;
+        start = bench_clock::now();
+        reader.scan(mid, mid + 3600ll * 1000000, SERIES_CH_TEMPERATURE,
+                    [&](const int64_t *, const int32_t *, size_t n) { hits += n; });
+        std::printf("janela de 1 h: %llu amostras em %.3f ms\n",
+                    (unsigned long long)hits, seconds_since(start) * 1e3);
+
+        // Filtro por valor: apenas chunks com MQ2 acima do limiar do alarme
+        uint64_t scanned = 0, alarms = 0;
+        start = bench_clock::now();
+        reader.scan_where(INT64_MIN, INT64_MAX, SERIES_CH_MQ2, 2001, INT32_MAX,
+                          [&](const int64_t *, const int32_t *v, size_t n) {
+                              scanned += n;
+                              for (size_t i = 0; i < n; i++) alarms += v[i] > 2000;
+                          });
+        double t_where = seconds_since(start);
+        std::printf("filtro MQ2 > 2000: %llu alarmes, %.1f%% das amostras descomprimidas, "
+                    "%.1f M amostras/s efetivas\n",
+                    (unsigned long long)alarms, 100.0 * scanned / samples,
+                    samples / t_where / 1e6);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "erro: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file series_collect.cpp
+ * @brief Coletor: converte a saída serial do firmware em um arquivo de série
+ *
+ * Lê da entrada padrão as linhas impressas pelo laço principal de
+ * environment-monitoring.c. O firmware só imprime as linhas que mudaram
+ * além da banda morta, mais um heartbeat (telemetry.h); o coletor
+ * guarda o último valor de cada canal e grava uma amostra a cada linha
+ * de telemetria recebida, com todos os canais nos valores mantidos. A
+ * primeira amostra sai quando todos os canais já apareceram (a primeira
+ * passagem do firmware imprime todas as linhas). Uma linha de erro do
+ * DHT22 mantém temperatura e umidade anteriores e é contada no resumo;
+ * as linhas do alarme também geram uma amostra. O instante de cada
+ * amostra é o relógio do host na recepção da linha, que nunca volta
+ * atrás (host_time_us()).
+ *
+ * Só a telemetria em texto é lida: a saída de um firmware compilado com
+ * TELEMETRY_FORMAT_CBOR=1 não tem essas linhas (use telemetry_decode), e
+ * o coletor termina com erro se não reconhecer nenhuma.
+ *
+ * Uso:
+ * @code
+ * cat /dev/ttyACM0 | series_collect <device_id> <saida.ems>
+ * @endcode
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "series_writer.h"
+
+/**
+ * @brief Relógio do host em μs desde 1970, sem voltar atrás
+ *
+ * O relógio de parede só dá a origem, lida uma vez; daí em diante conta
+ * o monotônico, e um ajuste do NTP não desordena as amostras.
+ */
+static int64_t host_time_us() {
+    using namespace std::chrono;
+    static const steady_clock::time_point steady0 = steady_clock::now();
+    static const int64_t wall0_us = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+    return wall0_us + duration_cast<microseconds>(steady_clock::now() - steady0).count();
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "uso: %s <device_id> <saida.ems>\n", argv[0]);
+        return 2;
+    }
+
+    try {
+        SeriesWriter writer(argv[2], std::strtoull(argv[1], nullptr, 0));
+        series_sample_t sample = {};
+        unsigned seen = 0;              // Canais que já apareceram, em bits de series_channel_t
+        unsigned long lines = 0, dht22_errors = 0;
+        char line[256];
+
+        while (std::fgets(line, sizeof(line), stdin)) {
+            float temperature, humidity, voltage;
+            int raw;
+
+            if (std::sscanf(line, "Temperatura: %f °C | Umidade: %f", &temperature, &humidity) == 2) {
+                sample.value[SERIES_CH_TEMPERATURE] = (int32_t)(temperature * 10.0f + (temperature < 0 ? -0.5f : 0.5f));
+                sample.value[SERIES_CH_HUMIDITY] = (int32_t)(humidity * 10.0f + 0.5f);
+                seen |= 1u << SERIES_CH_TEMPERATURE | 1u << SERIES_CH_HUMIDITY;
+            } else if (std::sscanf(line, "Erro na leitura do DHT22: código %d", &raw) == 1) {
+                dht22_errors++;
+            } else if (std::sscanf(line, "LDR: %f V (Raw: %d)", &voltage, &raw) == 2) {
+                sample.value[SERIES_CH_LDR] = raw;
+                seen |= 1u << SERIES_CH_LDR;
+            } else if (std::sscanf(line, "MQ2: %f V (Raw: %d)", &voltage, &raw) == 2) {
+                sample.value[SERIES_CH_MQ2] = raw;
+                seen |= 1u << SERIES_CH_MQ2;
+            } else if (std::strncmp(line, "Alarme ", 7) != 0) {
+                continue;
+            }
+            lines++;
+            if (seen == (1u << SERIES_CH_COUNT) - 1) {
+                sample.t_us = host_time_us();
+                writer.append(sample);
+            }
+        }
+
+        writer.close();
+        if (!lines) {
+            throw std::runtime_error("nenhuma linha de telemetria em texto na entrada (o coletor não lê CBOR)");
+        }
+        std::fprintf(stderr, "%lu linhas de telemetria (%lu erros do DHT22), %llu amostras, %llu bytes\n", lines,
+                     dht22_errors, (unsigned long long)writer.sample_count(),
+                     (unsigned long long)writer.bytes_written());
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "erro: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file series_format.h
+ * @brief Formato colunar em disco para as séries coletadas dos dispositivos
+ *
+ * Um arquivo de série guarda as leituras de um único dispositivo
+ * (temperatura, umidade, LDR e MQ2) organizadas em chunks. Dentro de
+ * cada chunk, cada canal é um bloco de coluna comprimido de forma
+ * independente, de modo que uma varredura de um canal não precisa
+ * descomprimir os demais.
+ *
+ * Layout do arquivo:
+ * @code
+ * [series_file_header_t]
+ * [chunk 0: coluna de tempo | coluna canal 0 | ... | coluna canal N-1]
+ * [chunk 1: ...]
+ * ...
+ * [series_chunk_index_t x chunk_count]   <- índice de tempo + zone maps
+ * [series_file_footer_t]
+ * @endcode
+ *
+ * O índice fica no final do arquivo para que o coletor possa escrever
+ * em fluxo contínuo. O leitor mapeia o arquivo com mmap, localiza o
+ * índice pelo rodapé e decide quais chunks tocar usando apenas o
+ * intervalo de tempo e os valores mínimo/máximo de cada coluna.
+ *
+ * Compressão:
+ * - Tempo: delta-of-delta com zigzag + varint (amostragem regular
+ *   ocupa 1 byte por amostra).
+ * - Canais: delta com zigzag + varint sobre valores inteiros escalados
+ *   (temperatura e umidade em décimos, LDR e MQ2 em código bruto do ADC).
+ *
+ * Todos os campos inteiros são little-endian.
+ */
+#ifndef SERIES_FORMAT_H
+#define SERIES_FORMAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SERIES_MAGIC "EMSERIE1"
+#define SERIES_FOOTER_MAGIC "EMSEND01"
+#define SERIES_VERSION 1
+
+#define SERIES_CHUNK_MAX_SAMPLES 4096   // Amostras por chunk antes de fechar o bloco
+
+/**
+ * @brief Canais armazenados em cada arquivo de série
+ */
+typedef enum {
+    SERIES_CH_TEMPERATURE = 0,  // Temperatura em décimos de °C
+    SERIES_CH_HUMIDITY = 1,     // Umidade em décimos de %
+    SERIES_CH_LDR = 2,          // Código bruto do ADC0 (0-4095)
+    SERIES_CH_MQ2 = 3,          // Código bruto do ADC1 (0-4095)
+    SERIES_CH_COUNT = 4
+} series_channel_t;
+
+/**
+ * @brief Uma amostra completa, como produzida pelo laço principal do firmware
+ */
+typedef struct {
+    int64_t t_us;                       // Instante da amostra (μs)
+    int32_t value[SERIES_CH_COUNT];     // Valores escalados de cada canal
+} series_sample_t;
+
+/**
+ * @brief Cabeçalho no início do arquivo
+ */
+typedef struct {
+    char magic[8];              // SERIES_MAGIC
+    uint32_t version;           // SERIES_VERSION
+    uint32_t channel_count;     // SERIES_CH_COUNT
+    uint64_t device_id;         // Identificador do dispositivo de origem
+} series_file_header_t;
+
+/**
+ * @brief Referência a um bloco de coluna, relativa ao início do chunk
+ */
+typedef struct {
+    uint32_t offset;            // Deslocamento do bloco dentro do chunk
+    uint32_t size;              // Tamanho comprimido em bytes
+} series_column_ref_t;
+
+/**
+ * @brief Entrada do índice: localização, intervalo de tempo e zone maps de um chunk
+ */
+typedef struct {
+    uint64_t offset;                            // Deslocamento do chunk no arquivo
+    uint32_t size;                              // Tamanho total do chunk em bytes
+    uint32_t count;                             // Número de amostras no chunk
+    int64_t t_min;                              // Primeiro instante do chunk (μs)
+    int64_t t_max;                              // Último instante do chunk (μs)
+    series_column_ref_t time_column;            // Coluna de tempo
+    series_column_ref_t column[SERIES_CH_COUNT];// Colunas de cada canal
+    int32_t v_min[SERIES_CH_COUNT];             // Zone map: mínimo de cada canal
+    int32_t v_max[SERIES_CH_COUNT];             // Zone map: máximo de cada canal
+} series_chunk_index_t;
+
+/**
+ * @brief Rodapé no final do arquivo
+ */
+typedef struct {
+    uint64_t index_offset;      // Deslocamento da primeira entrada do índice
+    uint64_t chunk_count;       // Número de entradas no índice
+    uint64_t sample_count;      // Total de amostras no arquivo
+    char magic[8];              // SERIES_FOOTER_MAGIC
+} series_file_footer_t;
+
+/**
+ * @brief Codifica um inteiro sem sinal como varint (LEB128)
+ *
+ * @param out Buffer de saída com pelo menos 10 bytes livres
+ * @param v Valor a ser codificado
+ * @return Número de bytes escritos
+ */
+static inline size_t series_put_varint(uint8_t *out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+/**
+ * @brief Decodifica um varint (LEB128) sem passar de end
+ *
+ * @param in Ponteiro para o início do varint; avança até o byte seguinte
+ * @param end Fim do bloco que contém o varint
+ * @param v Valor decodificado
+ * @return false se o varint passa de end ou de 10 bytes (arquivo corrompido)
+ */
+static inline bool series_get_varint(const uint8_t **in, const uint8_t *end, uint64_t *v) {
+    const uint8_t *p = *in;
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 70 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        value |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *in = p;
+            *v = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint64_t series_zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t series_unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+#endif // SERIES_FORMAT_H
@@ -0,0 +1,149 @@
+/**
+ * @file series_reader.cpp
+ * @brief Implementação do leitor de arquivos de série
+ */
+#include "series_reader.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SeriesReader::SeriesReader(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("não foi possível abrir " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("fstat falhou em " + path);
+    }
+    size_ = (size_t)st.st_size;
+    if (size_ < sizeof(series_file_header_t) + sizeof(series_file_footer_t)) {
+        ::close(fd);
+        throw std::runtime_error(path + ": arquivo truncado");
+    }
+
+    void *map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("mmap falhou em " + path);
+    }
+    base_ = static_cast<const uint8_t *>(map);
+
+    header_ = reinterpret_cast<const series_file_header_t *>(base_);
+    footer_ = reinterpret_cast<const series_file_footer_t *>(
+        base_ + size_ - sizeof(series_file_footer_t));
+
+    const char *error = nullptr;
+    if (std::memcmp(header_->magic, SERIES_MAGIC, sizeof(header_->magic)) != 0) {
+        error = ": cabeçalho inválido";
+    } else if (header_->version != SERIES_VERSION || header_->channel_count != SERIES_CH_COUNT) {
+        error = ": versão não suportada";
+    } else if (std::memcmp(footer_->magic, SERIES_FOOTER_MAGIC, sizeof(footer_->magic)) != 0) {
+        error = ": rodapé ausente (arquivo não foi fechado?)";
+    } else if (!index_valid()) {
+        error = ": índice inconsistente";
+    }
+    if (error) {
+        ::munmap(const_cast<uint8_t *>(base_), size_);
+        throw std::runtime_error(path + error);
+    }
+
+    // Varreduras percorrem o arquivo em ordem
+    ::madvise(const_cast<uint8_t *>(base_), size_, MADV_SEQUENTIAL);
+}
+
+static bool column_valid(const series_column_ref_t &col, const series_chunk_index_t &c) {
+    // Cada valor ocupa ao menos um byte
+    return col.offset <= c.size && col.size <= c.size - col.offset && c.count <= col.size;
+}
+
+bool SeriesReader::index_valid() {
+    // Índice entre o cabeçalho e o rodapé, com exatamente chunk_count entradas
+    uint64_t index_end = size_ - sizeof(series_file_footer_t);
+    uint64_t index_offset = footer_->index_offset;
+    if (index_offset < sizeof(series_file_header_t) || index_offset > index_end) return false;
+    uint64_t index_bytes = index_end - index_offset;
+    if (index_bytes % sizeof(series_chunk_index_t) != 0 ||
+        index_bytes / sizeof(series_chunk_index_t) != footer_->chunk_count) {
+        return false;
+    }
+    index_ = reinterpret_cast<const series_chunk_index_t *>(base_ + index_offset);
+
+    // Cada chunk entre o cabeçalho e o índice, e cada coluna dentro do chunk
+    for (size_t i = 0; i < chunk_count(); i++) {
+        const series_chunk_index_t &c = index_[i];
+        if (c.offset < sizeof(series_file_header_t) || c.offset > index_offset ||
+            c.size > index_offset - c.offset || !column_valid(c.time_column, c)) {
+            return false;
+        }
+        // chunk_range() e as consultas supõem chunks em ordem de tempo
+        if (c.t_min > c.t_max || (i > 0 && c.t_min < index_[i - 1].t_max)) return false;
+        for (int ch = 0; ch < SERIES_CH_COUNT; ch++) {
+            if (!column_valid(c.column[ch], c)) return false;
+        }
+    }
+    return true;
+}
+
+SeriesReader::~SeriesReader() {
+    if (base_) {
+        ::munmap(const_cast<uint8_t *>(base_), size_);
+    }
+}
+
+std::pair<size_t, size_t> SeriesReader::chunk_range(int64_t t0, int64_t t1) const {
+    const series_chunk_index_t *begin = index_;
+    const series_chunk_index_t *end = index_ + chunk_count();
+
+    // Primeiro chunk que termina em t0 ou depois
+    const series_chunk_index_t *first = std::lower_bound(
+        begin, end, t0,
+        [](const series_chunk_index_t &c, int64_t t) { return c.t_max < t; });
+    // Primeiro chunk que começa depois de t1
+    const series_chunk_index_t *last = std::upper_bound(
+        first, end, t1,
+        [](int64_t t, const series_chunk_index_t &c) { return t < c.t_min; });
+
+    return {(size_t)(first - begin), (size_t)(last - begin)};
+}
+
+size_t SeriesReader::decode_time(size_t i, int64_t *out) const {
+    const series_chunk_index_t &c = index_[i];
+    const uint8_t *p = base_ + c.offset + c.time_column.offset;
+    const uint8_t *end = p + c.time_column.size;
+    int64_t prev = 0, prev_delta = 0;
+    uint64_t negative = 0;          // OU dos deltas depois do primeiro: bit 63 se algum voltou no tempo
+    for (uint32_t k = 0; k < c.count; k++) {
+        uint64_t v;
+        if (!series_get_varint(&p, end, &v)) throw std::runtime_error("coluna de tempo corrompida");
+        prev_delta += series_unzigzag(v);
+        prev += prev_delta;
+        out[k] = prev;
+        if (k) negative |= (uint64_t)prev_delta;
+    }
+    // Fora de ordem ou do intervalo do índice, o recorte e os buckets das consultas sairiam errados
+    if (c.count && ((negative >> 63) || out[0] < c.t_min || out[c.count - 1] > c.t_max)) {
+        throw std::runtime_error("coluna de tempo fora de ordem ou do intervalo do índice");
+    }
+    return c.count;
+}
+
+size_t SeriesReader::decode_channel(size_t i, series_channel_t ch, int32_t *out) const {
+    const series_chunk_index_t &c = index_[i];
+    const uint8_t *p = base_ + c.offset + c.column[ch].offset;
+    const uint8_t *end = p + c.column[ch].size;
+    int64_t last = 0;
+    for (uint32_t k = 0; k < c.count; k++) {
+        uint64_t v;
+        if (!series_get_varint(&p, end, &v)) throw std::runtime_error("coluna de canal corrompida");
+        last += series_unzigzag(v);
+        out[k] = (int32_t)last;
+    }
+    return c.count;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file series_reader.h
+ * @brief Leitura de arquivos de série via mmap com varredura por intervalo
+ */
+#ifndef SERIES_READER_H
+#define SERIES_READER_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "series_format.h"
+
+/**
+ * @brief Leitor somente-leitura de um arquivo de série mapeado em memória
+ *
+ * Abrir o arquivo custa apenas a validação do cabeçalho, do rodapé e do
+ * índice (cada chunk e cada coluna dentro do arquivo); nenhum chunk é
+ * tocado até que uma varredura o selecione, e a decodificação não lê
+ * além do fim de cada coluna. As
+ * varreduras usam o índice de tempo (busca binária) e, opcionalmente,
+ * os zone maps de cada coluna para descartar chunks inteiros antes de
+ * descomprimir qualquer byte.
+ *
+ * Exemplo de uso:
+ * @code
+ * SeriesReader reader("device-7.ems");
+ * int32_t mq2_max = INT32_MIN;
+ * reader.scan(t0, t1, SERIES_CH_MQ2,
+ *             [&](const int64_t *t, const int32_t *v, size_t n) {
+ *                 for (size_t i = 0; i < n; i++) mq2_max = std::max(mq2_max, v[i]);
+ *             });
+ * @endcode
+ *
+ * Arquivos inválidos ou truncados são reportados com std::runtime_error.
+ */
+class SeriesReader {
+public:
+    explicit SeriesReader(const std::string &path);
+    ~SeriesReader();
+
+    SeriesReader(const SeriesReader &) = delete;
+    SeriesReader &operator=(const SeriesReader &) = delete;
+
+    uint64_t device_id() const { return header_->device_id; }
+    uint64_t sample_count() const { return footer_->sample_count; }
+    size_t chunk_count() const { return (size_t)footer_->chunk_count; }
+    size_t file_size() const { return size_; }
+    const series_chunk_index_t &chunk(size_t i) const { return index_[i]; }
+
+    /**
+     * @brief Intervalo [primeiro, último+1) de chunks que podem conter
+     *        amostras com t_us em [t0, t1]
+     */
+    std::pair<size_t, size_t> chunk_range(int64_t t0, int64_t t1) const;
+
+    /**
+     * @brief Descomprime a coluna de tempo de um chunk
+     *
+     * Os instantes decodificados são conferidos: em ordem crescente e
+     * dentro de [t_min, t_max] do índice, ou std::runtime_error.
+     *
+     * @param out Buffer com espaço para chunk(i).count valores
+     * @return Número de amostras decodificadas
+     */
+    size_t decode_time(size_t i, int64_t *out) const;
+
+    /**
+     * @brief Descomprime um único canal de um chunk
+     *
+     * @param out Buffer com espaço para chunk(i).count valores
+     * @return Número de amostras decodificadas
+     */
+    size_t decode_channel(size_t i, series_channel_t ch, int32_t *out) const;
+
+    /**
+     * @brief Varre um canal no intervalo [t0, t1]
+     *
+     * O callback recebe blocos (tempo, valor, n) já recortados ao
+     * intervalo pedido. Somente a coluna de tempo e a coluna do canal
+     * pedido são descomprimidas.
+     */
+    template <typename F>
+    void scan(int64_t t0, int64_t t1, series_channel_t ch, F &&fn) const {
+        scan_where(t0, t1, ch, INT32_MIN, INT32_MAX, std::forward<F>(fn));
+    }
+
+    /**
+     * @brief Varre um canal no intervalo [t0, t1], descartando chunks
+     *        cujo zone map não intersecta [lo, hi]
+     *
+     * O filtro por valor é apenas em nível de chunk: os blocos entregues
+     * ao callback podem conter valores fora de [lo, hi].
+     */
+    template <typename F>
+    void scan_where(int64_t t0, int64_t t1, series_channel_t ch,
+                    int32_t lo, int32_t hi, F &&fn) const {
+        auto range = chunk_range(t0, t1);
+        scan_chunks(range.first, range.second, t0, t1, ch, lo, hi, std::forward<F>(fn));
+    }
+
+    /**
+     * @brief Igual a scan_where(), restrito aos chunks [first, last)
+     *
+     * Permite dividir uma varredura entre várias threads, cada uma
+     * responsável por uma fatia do índice obtido com chunk_range().
+     */
+    template <typename F>
+    void scan_chunks(size_t first_chunk, size_t last_chunk, int64_t t0, int64_t t1,
+                     series_channel_t ch, int32_t lo, int32_t hi, F &&fn) const {
+        std::vector<int64_t> t;
+        std::vector<int32_t> v;
+        for (size_t i = first_chunk; i < last_chunk; i++) {
+            const series_chunk_index_t &c = index_[i];
+            if (c.v_max[ch] < lo || c.v_min[ch] > hi) continue;
+
+            t.resize(c.count);
+            v.resize(c.count);
+            decode_time(i, t.data());
+            decode_channel(i, ch, v.data());
+
+            // Recorta as bordas apenas nos chunks parcialmente cobertos
+            size_t first = 0, last = c.count;
+            if (c.t_min < t0) {
+                first = std::lower_bound(t.begin(), t.end(), t0) - t.begin();
+            }
+            if (c.t_max > t1) {
+                last = std::upper_bound(t.begin(), t.end(), t1) - t.begin();
+            }
+            if (first < last) {
+                fn(t.data() + first, v.data() + first, last - first);
+            }
+        }
+    }
+
+private:
+    bool index_valid();
+
+    const uint8_t *base_ = nullptr;
+    size_t size_ = 0;
+    const series_file_header_t *header_ = nullptr;
+    const series_file_footer_t *footer_ = nullptr;
+    const series_chunk_index_t *index_ = nullptr;
+};
+
+#endif // SERIES_READER_H
@@ -0,0 +1,31 @@
+/**
+ * @file series_synth.cpp
+ * @brief Implementação do gerador de séries sintéticas
+ */
+#include "series_synth.h"
+
+#include <cmath>
+
+#include "series_writer.h"
+
+void series_synth_write(const std::string &path, uint64_t device_id, uint64_t samples) {
+    SeriesWriter writer(path, device_id);
+    uint32_t noise = 12345u + (uint32_t)device_id * 2654435761u;
+    uint64_t phase = (device_id * 7919u) % 86400u;
+    series_sample_t s = {};
+
+    for (uint64_t i = 0; i < samples; i++) {
+        noise = noise * 1664525u + 1013904223u;
+        int32_t jitter = (int32_t)(noise >> 29) - 4;          // -4..3
+        double day = (double)((i + phase) % 86400) / 86400.0 * 2.0 * M_PI;
+
+        s.t_us = (int64_t)i * 1000000;
+        s.value[SERIES_CH_TEMPERATURE] = 250 + (int32_t)(60.0 * std::sin(day)) + jitter / 2;
+        s.value[SERIES_CH_HUMIDITY] = 550 - (int32_t)(120.0 * std::sin(day)) + jitter / 2;
+        s.value[SERIES_CH_LDR] = 2000 + (int32_t)(1800.0 * std::sin(day - M_PI / 2)) + jitter;
+        // Linha de base do MQ2 com um evento de gás a cada ~6 h
+        s.value[SERIES_CH_MQ2] = ((i + phase) % 21600) < 300 ? 2600 + jitter * 8 : 400 + jitter;
+        writer.append(s);
+    }
+    writer.close();
+}
@@ -0,0 +1,26 @@
+/**
+ * @file series_synth.h
+ * @brief Geração de séries sintéticas para benchmarks no host
+ */
+#ifndef SERIES_SYNTH_H
+#define SERIES_SYNTH_H
+
+#include <string>
+
+#include "series_format.h"
+
+/**
+ * @brief Grava um arquivo de série sintético de um dispositivo
+ *
+ * Uma amostra por segundo a partir de t = 0, com ciclo diário de
+ * temperatura/umidade/luminosidade, ruído pseudoaleatório e um evento
+ * de gás de 5 minutos a cada 6 horas. Cada device_id produz uma fase
+ * e um ruído diferentes.
+ *
+ * @param path Arquivo de saída
+ * @param device_id Identificador gravado no cabeçalho (também semente)
+ * @param samples Número de amostras
+ */
+void series_synth_write(const std::string &path, uint64_t device_id, uint64_t samples);
+
+#endif // SERIES_SYNTH_H
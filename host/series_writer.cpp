@@ -0,0 +1,127 @@
+/**
+ * @file series_writer.cpp
+ * @brief Implementação da escrita de arquivos de série
+ */
+#include "series_writer.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+SeriesWriter::SeriesWriter(const std::string &path, uint64_t device_id)
+    : file_(std::fopen(path.c_str(), "wb")) {
+    if (!file_) {
+        throw std::runtime_error("não foi possível criar " + path);
+    }
+    pending_.reserve(SERIES_CHUNK_MAX_SAMPLES);
+
+    series_file_header_t header = {};
+    std::memcpy(header.magic, SERIES_MAGIC, sizeof(header.magic));
+    header.version = SERIES_VERSION;
+    header.channel_count = SERIES_CH_COUNT;
+    header.device_id = device_id;
+    write(&header, sizeof(header));
+}
+
+SeriesWriter::~SeriesWriter() {
+    if (file_) {
+        try {
+            close();
+        } catch (...) {
+            // Destrutor não propaga exceções; quem precisa do erro chama close()
+        }
+    }
+}
+
+void SeriesWriter::write(const void *data, size_t size) {
+    if (std::fwrite(data, 1, size, file_) != size) {
+        throw std::runtime_error("falha de escrita no arquivo de série");
+    }
+    offset_ += size;
+}
+
+void SeriesWriter::append(const series_sample_t &sample) {
+    if (sample_count_ && sample.t_us < last_t_us_) {
+        throw std::invalid_argument("amostra fora de ordem: t=" + std::to_string(sample.t_us) + " us depois de t=" +
+                                    std::to_string(last_t_us_) + " us");
+    }
+    last_t_us_ = sample.t_us;
+    pending_.push_back(sample);
+    sample_count_++;
+    if (pending_.size() == SERIES_CHUNK_MAX_SAMPLES) {
+        flush_chunk();
+    }
+}
+
+void SeriesWriter::flush_chunk() {
+    if (pending_.empty()) return;
+
+    const size_t n = pending_.size();
+    series_chunk_index_t entry = {};
+    entry.offset = offset_;
+    entry.count = (uint32_t)n;
+    entry.t_min = pending_.front().t_us;
+    entry.t_max = pending_.back().t_us;
+
+    // Pior caso: 10 bytes por varint em cada coluna
+    scratch_.resize(n * 10 * (SERIES_CH_COUNT + 1));
+    uint8_t *out = scratch_.data();
+    size_t pos = 0;
+
+    // Coluna de tempo: delta-of-delta
+    entry.time_column.offset = 0;
+    int64_t prev = 0, prev_delta = 0;
+    for (size_t i = 0; i < n; i++) {
+        int64_t delta = pending_[i].t_us - prev;
+        pos += series_put_varint(out + pos, series_zigzag(delta - prev_delta));
+        prev = pending_[i].t_us;
+        prev_delta = delta;
+    }
+    entry.time_column.size = (uint32_t)pos;
+
+    // Colunas de valores: delta + zone map
+    for (int ch = 0; ch < SERIES_CH_COUNT; ch++) {
+        size_t start = pos;
+        int32_t vmin = pending_[0].value[ch], vmax = vmin;
+        int64_t last = 0;
+        for (size_t i = 0; i < n; i++) {
+            int32_t v = pending_[i].value[ch];
+            if (v < vmin) vmin = v;
+            if (v > vmax) vmax = v;
+            pos += series_put_varint(out + pos, series_zigzag((int64_t)v - last));
+            last = v;
+        }
+        entry.column[ch].offset = (uint32_t)start;
+        entry.column[ch].size = (uint32_t)(pos - start);
+        entry.v_min[ch] = vmin;
+        entry.v_max[ch] = vmax;
+    }
+
+    entry.size = (uint32_t)pos;
+    write(out, pos);
+    index_.push_back(entry);
+    pending_.clear();
+}
+
+void SeriesWriter::close() {
+    if (!file_) return;
+
+    flush_chunk();
+
+    series_file_footer_t footer = {};
+    footer.index_offset = offset_;
+    footer.chunk_count = index_.size();
+    footer.sample_count = sample_count_;
+    std::memcpy(footer.magic, SERIES_FOOTER_MAGIC, sizeof(footer.magic));
+
+    if (!index_.empty()) {
+        write(index_.data(), index_.size() * sizeof(series_chunk_index_t));
+    }
+    write(&footer, sizeof(footer));
+
+    std::FILE *f = file_;
+    file_ = nullptr;
+    if (std::fclose(f) != 0) {
+        throw std::runtime_error("falha ao fechar o arquivo de série");
+    }
+}
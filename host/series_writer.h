@@ -0,0 +1,53 @@
+/**
+ * @file series_writer.h
+ * @brief Escrita de arquivos de série no formato colunar (lado do coletor)
+ */
+#ifndef SERIES_WRITER_H
+#define SERIES_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "series_format.h"
+
+/**
+ * @brief Acumula amostras em memória e grava um chunk a cada
+ *        SERIES_CHUNK_MAX_SAMPLES amostras
+ *
+ * As amostras devem ser entregues em ordem crescente de tempo (instantes
+ * iguais são aceitos): o índice de chunks e as buscas do leitor dependem
+ * disso. O índice e o rodapé só são gravados em close(); um arquivo não
+ * fechado é rejeitado pelo leitor.
+ *
+ * Erros de E/S são reportados com std::runtime_error; uma amostra fora de
+ * ordem, com std::invalid_argument, sem entrar no arquivo.
+ */
+class SeriesWriter {
+public:
+    SeriesWriter(const std::string &path, uint64_t device_id);
+    ~SeriesWriter();
+
+    SeriesWriter(const SeriesWriter &) = delete;
+    SeriesWriter &operator=(const SeriesWriter &) = delete;
+
+    void append(const series_sample_t &sample);
+    void close();
+
+    uint64_t sample_count() const { return sample_count_; }
+    uint64_t bytes_written() const { return offset_; }
+
+private:
+    void flush_chunk();
+    void write(const void *data, size_t size);
+
+    std::FILE *file_;
+    uint64_t offset_ = 0;
+    uint64_t sample_count_ = 0;
+    int64_t last_t_us_ = 0;         // Instante da última amostra aceita
+    std::vector<series_sample_t> pending_;
+    std::vector<series_chunk_index_t> index_;
+    std::vector<uint8_t> scratch_;
+};
+
+#endif // SERIES_WRITER_H
@@ -0,0 +1,269 @@
+/**
+ * @file sim_main.c
+ * @brief Executa o firmware em tempo virtual sob um roteiro de cenário
+ *
+ * O main() de environment-monitoring.c é compilado como firmware_main()
+ * e roda sem alterações sobre o SDK substituto (pico_shim). Ao fim da
+ * duração do roteiro, um relatório é impresso em stderr, incluindo a
+ * razão entre segundos simulados e segundos de relógio de parede.
+ *
+ * Uso:
+ * @code
+ * firmware_sim <roteiro> [--echo] [--vcd arquivo.vcd]
+ * @endcode
+ *
+ * Com --echo, a saída serial do firmware é copiada para stdout (exceto
+ * durante quedas do enlace). Com --vcd, toda a atividade de GPIO e PWM,
+ * incluindo as respostas do DHT22, é registrada no arquivo (ver vcd.h).
+ *
+ * Se o roteiro declara sondas ("probe"), o relatório inclui a latência
+ * de cada evento até a resposta do atuador e o processo termina com
+ * código 1 se o percentil de alguma sonda exceder o orçamento ou faltar
+ * resposta. O relatório também traz os histogramas que o próprio firmware
+ * mantém (latency_trace.h), da aquisição da amostra ao comando, e os
+ * contadores da fila de reenvio (store_forward.h), a taxa média de cada
+ * canal amostrado de forma adaptativa (adaptive_sampler.h), o tempo com
+ * o aquecedor do MQ2 ligado (mq2_heater.h) e as últimas condições vistas
+ * pela compensação do ADC (adc_compensation.h).
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "adaptive_sampler.h"
+#include "adc_compensation.h"
+#include "board.h"
+#include "exec_trace.h"
+#include "gas_alarm.h"
+#include "latency_trace.h"
+#include "mq2_heater.h"
+#include "scenario.h"
+#include "sensor_registry.h"
+#include "sim.h"
+#include "store_forward.h"
+
+int firmware_main(void);
+
+// Folga do limiar do alarme de gás para a DNL do ADC e a sua correção (códigos)
+#define GAS_IDLE_MARGIN 64
+
+// Amostradores do laço principal (globais de environment-monitoring.c)
+extern adaptive_sampler_t ldr_sampler, mq2_sampler;
+
+static scenario_t scenario;
+static FILE *vcd_file;
+static struct timespec wall_start;
+
+// Bordas de subida dos GPIOs observados pelas sondas
+static uint64_t *rising_edges[SIM_GPIO_COUNT];
+static size_t rising_count[SIM_GPIO_COUNT];
+static size_t rising_capacity[SIM_GPIO_COUNT];
+
+#if !EXEC_TRACE_ENABLED
+/**
+ * @brief Blocos do ADC sem efeito no firmware: relé desligado e o MQ2 abaixo do limiar com folga
+ *
+ * O resto do bloco só chega ao laço principal pelos últimos valores,
+ * que a simulação sempre entrega (sim_set_adc_fast_forward()).
+ */
+static bool adc_idle(const uint16_t *lo, const uint16_t *hi) {
+    (void)lo;
+    return !gas_alarm_is_active() && hi[BOARD_MQ2_ADC_CHANNEL] + GAS_IDLE_MARGIN < GAS_ALARM_DEFAULT_THRESHOLD;
+}
+#endif
+
+static void record_edge(unsigned int gpio, bool level, uint64_t t_us) {
+    if (!level || gpio >= SIM_GPIO_COUNT) return;
+    for (int p = 0; p < scenario.probe_count; p++) {
+        if (scenario.probe[p].gpio != gpio) continue;
+        if (rising_count[gpio] == rising_capacity[gpio]) {
+            rising_capacity[gpio] = rising_capacity[gpio] ? rising_capacity[gpio] * 2 : 64;
+            rising_edges[gpio] = realloc(rising_edges[gpio], rising_capacity[gpio] * sizeof(uint64_t));
+        }
+        rising_edges[gpio][rising_count[gpio]++] = t_us;
+        return;
+    }
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Percentil pelo método do posto mais próximo sobre valores ordenados
+ */
+static uint64_t percentile_of(const uint64_t *sorted, int n, double percentile) {
+    int rank = (int)ceil(percentile / 100.0 * n);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+/**
+ * @brief Avalia as sondas do roteiro
+ *
+ * @return Número de sondas com eventos sem resposta ou percentil acima do orçamento
+ */
+static int report_probes(void) {
+    static const char *const names[SCENARIO_CH_COUNT] = {"temperature", "humidity", "ldr", "mq2", "chip", "vsys"};
+    uint64_t latency[SCENARIO_MAX_EVENTS];
+    int violations = 0;
+
+    for (int p = 0; p < scenario.probe_count; p++) {
+        const scenario_probe_t *probe = &scenario.probe[p];
+        int measured = 0, missing = 0;
+
+        for (int i = 0; i < scenario.event_count; i++) {
+            const scenario_event_t *e = &scenario.event[i];
+            if (e->kind > SCENARIO_EVENT_RAMP || e->channel != probe->channel) continue;
+
+            // As entradas são discretizadas em 1 ms: o evento fica visível
+            // no primeiro milissegundo inteiro a partir do seu início
+            uint64_t start = (scenario.start_us + e->start_us + 999) / 1000 * 1000;
+            uint64_t end = start + e->duration_us;
+            size_t k = 0;
+            while (k < rising_count[probe->gpio] && rising_edges[probe->gpio][k] < start) k++;
+            if (k == rising_count[probe->gpio] || rising_edges[probe->gpio][k] >= end) {
+                missing++;
+                continue;
+            }
+            latency[measured++] = rising_edges[probe->gpio][k] - start;
+        }
+
+        fprintf(stderr, "sonda %s -> GPIO %u: %d eventos", names[probe->channel], probe->gpio, measured);
+        bool over = false;
+        if (measured) {
+            qsort(latency, (size_t)measured, sizeof(latency[0]), compare_u64);
+            uint64_t at = percentile_of(latency, measured, probe->percentile);
+            over = at > probe->budget_us;
+            fprintf(stderr, ", latência mín %llu us, p50 %llu us, máx %llu us; p%g %llu us",
+                    (unsigned long long)latency[0], (unsigned long long)percentile_of(latency, measured, 50.0),
+                    (unsigned long long)latency[measured - 1], probe->percentile, (unsigned long long)at);
+        }
+        fprintf(stderr, " (orçamento %llu us): %s, %d sem resposta\n", (unsigned long long)probe->budget_us,
+                over ? "EXCEDIDO" : "ok", missing);
+        if (over || missing) violations++;
+    }
+    return violations;
+}
+
+/**
+ * @brief Imprime os histogramas de latência mantidos pelo próprio firmware
+ */
+static void report_latency_trace(void) {
+    for (int r = 0; r < LATENCY_RULE_COUNT; r++) {
+        latency_histogram_t h;
+        latency_trace_get((latency_rule_t)r, &h);
+        if (h.count == 0 && h.rejected == 0) continue;
+        fprintf(stderr, "firmware %s: %u comandos", latency_trace_rule_name((latency_rule_t)r), h.count);
+        if (h.count) {
+            fprintf(stderr, ", amostra -> comando p50 %u us, p90 %u us, p99 %u us, máx %u us",
+                    latency_trace_percentile(&h, 50.0f), latency_trace_percentile(&h, 90.0f),
+                    latency_trace_percentile(&h, 99.0f), h.max_us);
+        }
+        fprintf(stderr, ", %u rejeitados\n", h.rejected);
+    }
+}
+
+static void report(void) {
+    struct timespec wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall = (double)(wall_end.tv_sec - wall_start.tv_sec) +
+                  (double)(wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+    double simulated = (double)scenario.duration_us / 1e6;
+    const sim_stats_t *st = sim_stats();
+
+    fflush(stdout);
+    if (vcd_file) {
+        sim_set_vcd(NULL);
+        fclose(vcd_file);
+    }
+    fprintf(stderr, "simulado: %.0f s (%.2f dias) em %.3f s de relógio: %.0f s simulados/s\n",
+            simulated, simulated / 86400.0, wall, simulated / wall);
+    fprintf(stderr, "leituras do DHT22: %llu\n", (unsigned long long)st->dht22_transactions);
+    fprintf(stderr, "blocos do ADC pulados sem interrupção: %llu\n", (unsigned long long)st->adc_blocks_skipped);
+    for (int g = 0; g < SIM_GPIO_COUNT; g++) {
+        if (st->gpio_edges[g]) {
+            fprintf(stderr, "GPIO %d: %llu transições\n", g, (unsigned long long)st->gpio_edges[g]);
+        }
+        if (st->pwm_changes[g]) {
+            fprintf(stderr, "PWM GPIO %d: %llu mudanças de nível\n", g, (unsigned long long)st->pwm_changes[g]);
+        }
+    }
+    fprintf(stderr, "saída serial: %llu bytes entregues, %llu bytes perdidos com o enlace inativo\n",
+            (unsigned long long)st->stdout_bytes, (unsigned long long)st->stdout_dropped);
+    store_forward_stats_t sf;
+    store_forward_get_stats(&sf);
+    fprintf(stderr, "fila de reenvio: %u registros aceitos, %u enviados, %u bytes pendentes (máx %u); "
+            "flash: %llu páginas, %llu setores apagados, %u compactações; %u dizimados, %u descartados\n",
+            sf.pushed, sf.sent, store_forward_backlog(), sf.max_backlog, (unsigned long long)st->flash_pages, (unsigned long long)st->flash_erases,
+            sf.compactions, sf.decimated, sf.dropped);
+    fprintf(stderr, "amostragem adaptativa: LDR %u amostras (%.3f/s, %u disparos), MQ2 %u amostras (%.3f/s, "
+            "%u disparos e reforços)\n",
+            ldr_sampler.samples, ldr_sampler.samples / simulated, ldr_sampler.triggers, mq2_sampler.samples,
+            mq2_sampler.samples / simulated, mq2_sampler.triggers);
+    mq2_heater_stats_t heater;
+    mq2_heater_get_stats((uint32_t)(sim_now_us() / 1000), &heater);
+    fprintf(stderr, "aquecedor do MQ2: ligado %.1f%% do tempo, %u aquecimentos (%u pelo tempo máximo), "
+            "último em %.1f s\n",
+            100.0 * heater.on_ms / ((double)heater.on_ms + heater.off_ms), heater.warmups, heater.forced,
+            heater.last_warmup_ms / 1000.0);
+    sensor_reading_t aux;
+    sensor_registry_read(SENSOR_REGISTRY_ADC_AUX, &aux);
+    adc_compensation_t comp;
+    adc_compensation_update(&comp, (uint32_t)aux.value[0], (uint32_t)aux.value[1]);
+    fprintf(stderr, "compensação do ADC: chip %.2f °C, VSYS %.3f V; ganho LDR %.4f, MQ2 %.4f\n",
+            comp.die_mc / 1000.0, comp.vsys_mv / 1000.0, comp.gain_q16[ADC_COMPENSATION_LDR] / 65536.0,
+            comp.gain_q16[ADC_COMPENSATION_MQ2] / 65536.0);
+    report_latency_trace();
+    _Exit(report_probes() ? 1 : 0);
+}
+
+int main(int argc, char **argv) {
+    bool echo = false, bad_args = argc < 2;
+    const char *vcd_path = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "--echo")) {
+            echo = true;
+        } else if (!strcmp(argv[i], "--vcd") && i + 1 < argc) {
+            vcd_path = argv[++i];
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args) {
+        fprintf(stderr, "uso: %s <roteiro> [--echo] [--vcd arquivo.vcd]\n", argv[0]);
+        return 2;
+    }
+
+    char error[256];
+    if (!scenario_load(argv[1], &scenario, error, sizeof(error))) {
+        fprintf(stderr, "erro: %s\n", error);
+        return 1;
+    }
+
+    sim_init(scenario.start_us, scenario.start_us + scenario.duration_us, report);
+    sim_set_input_source(scenario_inputs, &scenario);
+    sim_set_echo(echo);
+    sim_set_link_rate(scenario.link_bytes_per_s);
+    sim_set_adc_dnl(scenario.adc_spike_lsb);
+    sim_set_gpio_observer(record_edge);
+#if !EXEC_TRACE_ENABLED
+    // A linha do tempo de execução registra cada interrupção de DMA
+    sim_set_adc_fast_forward(scenario_input_bounds, adc_idle);
+#endif
+    if (vcd_path) {
+        vcd_file = fopen(vcd_path, "w");
+        if (!vcd_file) {
+            fprintf(stderr, "erro: %s: não foi possível criar\n", vcd_path);
+            return 1;
+        }
+        sim_set_vcd(vcd_file);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    return firmware_main();
+}
@@ -0,0 +1,288 @@
+/**
+ * @file sntp_check.c
+ * @brief Cliente SNTP e relógio UTC (sntp_client.h, wall_clock.h) contra um servidor NTP local
+ *
+ * Uma thread faz o papel do servidor NTP em 127.0.0.1, com latência
+ * injetada: cada sentido do caminho atrasa a base mais um jitter
+ * uniforme, o caminho de ida pode ter uma assimetria fixa e uma fração
+ * das consultas se perde. O tempo do servidor é a referência (o relógio
+ * de parede no início, avançando pelo relógio monotônico); o relógio
+ * local do cliente é o monotônico com um desvio de frequência, como um
+ * cristal fora do nominal, e começa perto do zero, como no boot.
+ *
+ * O cliente roda o mesmo código do firmware sobre host/net_socket.c.
+ * A cada atualização do relógio, imprime a medida, a frequência estimada
+ * e o erro do relógio contra a referência. Ao fim, compara o erro
+ * máximo do relógio, medido a cada 10 ms depois da primeira metade da
+ * execução, e a frequência estimada com o esperado (-desvio); sai com 1
+ * se algum passar da tolerância. A assimetria é indistinguível de uma
+ * diferença de relógio e entra na tolerância por metade.
+ *
+ * O alvo é compilado com consultas e intervalos curtos para que a
+ * verificação caiba em um minuto e meio; o ruído da frequência cai com o
+ * intervalo coberto pelo histórico, que no firmware é bem mais longo.
+ *
+ * Com --serve, roda só o servidor, com o tempo do relógio de parede,
+ * para a placa na rede local (opção SNTP_SERVER do CMake do firmware).
+ *
+ * Uso:
+ * @code
+ * sntp_check [--seconds s] [--latency-ms ms] [--jitter-ms ms] [--asym-ms ms]
+ *            [--loss fração] [--drift-ppm ppm] [--offset-s s] [--seed n]
+ * sntp_check --serve porta [--latency-ms ms] [--jitter-ms ms] [--asym-ms ms] [--loss fração]
+ * @endcode
+ */
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "net.h"
+#include "sntp_client.h"
+#include "wall_clock.h"
+
+#define CHECK_PHASE_TOLERANCE_US 1000
+#define CHECK_FREQ_TOLERANCE_PPB 20000
+#define CHECK_SAMPLE_EVERY_US 10000
+#define CHECK_READ_MAX_US 50                // Leitura do erro mais longa que isto é descartada
+#define CHECK_LOCAL_START_US 5000000        // Relógio local no início: 5 s depois do boot
+#define NTP_UNIX_OFFSET_S 2208988800u
+
+typedef struct {
+    double latency_us;
+    double jitter_us;
+    double asym_us;
+    double loss;
+    int64_t offset_us;
+    unsigned int seed;
+} server_config_t;
+
+static int64_t mono0_us, utc0_us;
+static double drift_ppm = 150;
+static volatile bool stop;
+
+static int64_t clock_us(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief Tempo de referência (us desde 1970)
+ */
+static int64_t reference_utc_us(const server_config_t *config) {
+    return utc0_us + (clock_us(CLOCK_MONOTONIC) - mono0_us) + config->offset_us;
+}
+
+/**
+ * @brief Relógio local do cliente, com o desvio de frequência
+ */
+static uint64_t local_us(void) {
+    double elapsed = (double)(clock_us(CLOCK_MONOTONIC) - mono0_us);
+    return CHECK_LOCAL_START_US + (uint64_t)(elapsed * (1.0 + drift_ppm * 1e-6));
+}
+
+static uint32_t local_ms(void) {
+    return (uint32_t)(local_us() / 1000);
+}
+
+static void sleep_us(double us) {
+    struct timespec ts = {(time_t)(us / 1e6), (long)(fmod(us, 1e6) * 1000)};
+    nanosleep(&ts, NULL);
+}
+
+static void put_ntp(uint8_t *p, int64_t utc_us) {
+    uint32_t seconds = (uint32_t)(utc_us / 1000000 + NTP_UNIX_OFFSET_S);
+    uint32_t fraction = (uint32_t)(((uint64_t)(utc_us % 1000000) << 32) / 1000000);
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(seconds >> (24 - 8 * i));
+        p[4 + i] = (uint8_t)(fraction >> (24 - 8 * i));
+    }
+}
+
+/**
+ * @brief Atraso de um sentido: base, assimetria (só na ida) e jitter uniforme
+ */
+static double path_delay_us(server_config_t *config, bool uplink) {
+    double jitter = config->jitter_us * rand_r(&config->seed) / RAND_MAX;
+    return config->latency_us + jitter + (uplink ? config->asym_us : 0);
+}
+
+/**
+ * @brief Servidor NTP de estrato 1: atende uma consulta por vez até stop
+ */
+static void serve(int fd, server_config_t *config) {
+    struct timeval timeout = {0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    while (!stop) {
+        uint8_t request[48];
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t len = recvfrom(fd, request, sizeof(request), 0, (struct sockaddr *)&from, &from_len);
+        if (len < (ssize_t)sizeof(request) || (request[0] & 7) != 3) continue;
+        if ((double)rand_r(&config->seed) / RAND_MAX < config->loss) continue;
+
+        // O pacote "chega" depois do atraso de ida e a resposta "sai" antes do de volta
+        sleep_us(path_delay_us(config, true));
+        uint8_t reply[48] = {4 << 3 | 4, 1, request[2], (uint8_t)-20};
+        memcpy(reply + 12, "LOCL", 4);
+        put_ntp(reply + 16, reference_utc_us(config));
+        memcpy(reply + 24, request + 40, 8);
+        put_ntp(reply + 32, reference_utc_us(config));
+        put_ntp(reply + 40, reference_utc_us(config));
+        sleep_us(path_delay_us(config, false));
+        sendto(fd, reply, sizeof(reply), 0, (struct sockaddr *)&from, from_len);
+    }
+}
+
+static int open_server(uint32_t addr, uint16_t port, uint16_t *bound_port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in sa = {.sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(addr)};
+    if (fd < 0 || bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+        perror("bind");
+        return -1;
+    }
+    socklen_t sa_len = sizeof(sa);
+    getsockname(fd, (struct sockaddr *)&sa, &sa_len);
+    *bound_port = ntohs(sa.sin_port);
+    return fd;
+}
+
+static int server_fd;
+static server_config_t server_config;
+
+static void *server_main(void *arg) {
+    (void)arg;
+    serve(server_fd, &server_config);
+    return NULL;
+}
+
+static int usage(const char *argv0) {
+    fprintf(stderr,
+            "uso: %s [--seconds s] [--latency-ms ms] [--jitter-ms ms] [--asym-ms ms]\n"
+            "          [--loss fração] [--drift-ppm ppm] [--offset-s s] [--seed n]\n"
+            "     %s --serve porta [--latency-ms ms] [--jitter-ms ms] [--asym-ms ms] [--loss fração]\n",
+            argv0, argv0);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    server_config_t *config = &server_config;
+    *config = (server_config_t){.latency_us = 2000, .jitter_us = 4000, .loss = 0.05, .seed = 1};
+    double seconds = 90;
+    int serve_port = -1;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i];
+        const char *value = argv[i + 1];
+        if (!strcmp(arg, "--seconds")) {
+            seconds = strtod(value, NULL);
+        } else if (!strcmp(arg, "--latency-ms")) {
+            config->latency_us = strtod(value, NULL) * 1000;
+        } else if (!strcmp(arg, "--jitter-ms")) {
+            config->jitter_us = strtod(value, NULL) * 1000;
+        } else if (!strcmp(arg, "--asym-ms")) {
+            config->asym_us = strtod(value, NULL) * 1000;
+        } else if (!strcmp(arg, "--loss")) {
+            config->loss = strtod(value, NULL);
+        } else if (!strcmp(arg, "--drift-ppm")) {
+            drift_ppm = strtod(value, NULL);
+        } else if (!strcmp(arg, "--offset-s")) {
+            config->offset_us = (int64_t)(strtod(value, NULL) * 1e6);
+        } else if (!strcmp(arg, "--seed")) {
+            config->seed = (unsigned int)strtoul(value, NULL, 10);
+        } else if (!strcmp(arg, "--serve")) {
+            serve_port = atoi(value);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (argc % 2 == 0 || seconds <= 0) return usage(argv[0]);
+
+    mono0_us = clock_us(CLOCK_MONOTONIC);
+    utc0_us = clock_us(CLOCK_REALTIME);
+
+    uint16_t port;
+    if (serve_port >= 0) {
+        server_fd = open_server(INADDR_ANY, (uint16_t)serve_port, &port);
+        if (server_fd < 0) return 1;
+        printf("servidor NTP na porta UDP %u\n", port);
+        serve(server_fd, config);
+        return 0;
+    }
+
+    server_fd = open_server(INADDR_LOOPBACK, 0, &port);
+    if (server_fd < 0) return 1;
+    pthread_t server;
+    pthread_create(&server, NULL, server_main, NULL);
+
+    printf("latência %.1f ms + jitter %.1f ms por sentido, assimetria %.1f ms, perda %.0f%%, desvio %+.1f ppm\n",
+           config->latency_us / 1000, config->jitter_us / 1000, config->asym_us / 1000, config->loss * 100,
+           drift_ppm);
+    printf("%8s %10s %12s %5s %12s %10s\n", "t s", "fase us", "freq ppb", "usa", "atraso us", "erro us");
+
+    net_init();
+    wall_clock_init();
+    sntp_client_init("127.0.0.1", port, local_us, local_ms());
+
+    int64_t start_us = clock_us(CLOCK_MONOTONIC);
+    int64_t end_us = start_us + (int64_t)(seconds * 1e6);
+    int64_t settle_us = start_us + (int64_t)(seconds * 0.5e6);
+    int64_t next_sample_us = start_us;
+    uint32_t updates = 0;
+    int64_t max_error_us = 0;
+    long checked = 0;
+    while (clock_us(CLOCK_MONOTONIC) < end_us) {
+        net_poll();
+        sntp_client_poll(local_ms());
+
+        wall_clock_stats_t stats;
+        wall_clock_get_stats(&stats);
+        int64_t utc, now = clock_us(CLOCK_MONOTONIC);
+        // Uma preempção entre as leituras viraria erro do relógio: a leitura é descartada
+        int64_t before = reference_utc_us(config);
+        bool valid = wall_clock_utc_us(local_us(), &utc);
+        int64_t after = reference_utc_us(config);
+        int64_t error = utc - (before + after) / 2;
+        valid = valid && after - before < CHECK_READ_MAX_US;
+        if (stats.updates != updates) {
+            updates = stats.updates;
+            printf("%8.2f %10lld %12d %5u %12u %10lld\n", (now - start_us) / 1e6, (long long)stats.offset_us,
+                   stats.freq_ppb, stats.used, stats.min_delay_us, (long long)error);
+        }
+        if (valid && now >= settle_us && now >= next_sample_us) {
+            int64_t abs_error = error < 0 ? -error : error;
+            if (abs_error > max_error_us) max_error_us = abs_error;
+            checked++;
+            next_sample_us = now + CHECK_SAMPLE_EVERY_US;
+        }
+        sleep_us(100);
+    }
+    stop = true;
+    pthread_join(server, NULL);
+
+    sntp_client_stats_t client;
+    wall_clock_stats_t stats;
+    sntp_client_get_stats(&client);
+    wall_clock_get_stats(&stats);
+    double expected_ppb = (1.0 / (1.0 + drift_ppm * 1e-6) - 1.0) * 1e9;
+    double freq_error = fabs(stats.freq_ppb - expected_ppb);
+    double phase_tolerance = CHECK_PHASE_TOLERANCE_US + config->asym_us / 2;
+    bool ok = checked > 0 && max_error_us <= phase_tolerance && freq_error <= CHECK_FREQ_TOLERANCE_PPB;
+
+    printf("consultas %u, respostas %u, sem resposta %u, descartadas %u, kod %u, saltos %u\n", client.requests,
+           client.responses, client.timeouts, client.rejected, client.kod, stats.steps);
+    printf("frequência: %d ppb, esperado %.0f, erro %.0f ppb (tolerância %d)\n", stats.freq_ppb, expected_ppb,
+           freq_error, CHECK_FREQ_TOLERANCE_PPB);
+    printf("erro máximo do relógio na segunda metade: %lld us em %ld leituras (tolerância %.0f): %s\n",
+           (long long)max_error_us, checked, phase_tolerance, ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
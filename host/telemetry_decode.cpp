@@ -0,0 +1,335 @@
+/**
+ * @file telemetry_decode.cpp
+ * @brief Decodifica e valida a telemetria CBOR do firmware
+ *
+ * Lê um fluxo de registros CBOR (arquivo ou stdin), confere cada um
+ * contra os esquemas de telemetry_cbor.h e imprime um registro por
+ * linha. Bytes que não iniciam um mapa CBOR com tipo de registro conhecido
+ * (p.ex. mensagens de texto da inicialização do firmware na mesma serial)
+ * são ignorados até o próximo registro.
+ *
+ * Uso:
+ * @code
+ * telemetry_decode [-q] [arquivo|-]
+ * firmware_sim_cbor scenarios/actuator-latency.txt --echo | telemetry_decode -q
+ * @endcode
+ *
+ * Com -q, imprime apenas o resumo. Termina com código 1 se algum
+ * registro violar o esquema, estiver truncado ou tiver instante anterior
+ * ao do registro válido precedente (a fila de reenvio, store_forward.h,
+ * deve preservar a ordem mesmo após quedas do enlace).
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "telemetry_cbor.h"
+}
+
+/**
+ * @brief Item CBOR decodificado (subconjunto usado pela telemetria)
+ */
+struct Item {
+    enum Kind { Uint, Negint, Bytes, Text, Array, Map, Bool, Null, Other } kind = Other;
+    uint64_t value = 0;             // Argumento (Uint, Negint, Bool)
+    std::vector<Item> items;        // Array: elementos; Map: chave, valor, chave, ...
+
+    int64_t as_int() const { return kind == Negint ? -1 - (int64_t)value : (int64_t)value; }
+    bool is_int() const { return kind == Uint || kind == Negint; }
+    size_t pairs() const { return items.size() / 2; }
+
+    const Item *get(uint64_t key) const {
+        for (size_t i = 0; i + 1 < items.size(); i += 2) {
+            if (items[i].kind == Uint && items[i].value == key) return &items[i + 1];
+        }
+        return nullptr;
+    }
+};
+
+struct Truncated {};
+struct Malformed {
+    const char *what;
+};
+
+/**
+ * @brief Decodificador recursivo sobre um buffer
+ */
+class Parser {
+public:
+    Parser(const uint8_t *p, const uint8_t *end) : p_(p), end_(end) {}
+
+    const uint8_t *pos() const { return p_; }
+
+    Item parse(int depth = 0) {
+        if (depth > 8) throw Malformed{"aninhamento profundo demais"};
+        uint8_t ib = byte();
+        unsigned major = ib >> 5, ai = ib & 31;
+        Item it;
+
+        if (major == 7) {
+            if (ai == 20 || ai == 21) {
+                it.kind = Item::Bool;
+                it.value = ai == 21;
+            } else if (ai == 22) {
+                it.kind = Item::Null;
+            } else if (ai == 31) {
+                throw Malformed{"break fora de item indefinido"};
+            } else {
+                throw Malformed{"valor simples não usado pela telemetria"};
+            }
+            return it;
+        }
+
+        if (ai == 31) {
+            if (major != 4 && major != 5) throw Malformed{"tamanho indefinido não suportado"};
+            it.kind = major == 4 ? Item::Array : Item::Map;
+            while (peek() != 0xFF) it.items.push_back(parse(depth + 1));
+            byte();
+            if (it.kind == Item::Map && it.items.size() % 2) throw Malformed{"mapa com chave sem valor"};
+            return it;
+        }
+
+        uint64_t arg = argument(ai);
+        switch (major) {
+        case 0:
+            it.kind = Item::Uint;
+            it.value = arg;
+            break;
+        case 1:
+            it.kind = Item::Negint;
+            it.value = arg;
+            break;
+        case 2:
+        case 3:
+            it.kind = major == 2 ? Item::Bytes : Item::Text;
+            if ((uint64_t)(end_ - p_) < arg) throw Truncated{};
+            p_ += arg;
+            break;
+        case 4:
+        case 5: {
+            it.kind = major == 4 ? Item::Array : Item::Map;
+            uint64_t n = major == 5 ? arg * 2 : arg;
+            if (n > (uint64_t)(end_ - p_)) throw Truncated{};
+            for (uint64_t i = 0; i < n; i++) it.items.push_back(parse(depth + 1));
+            break;
+        }
+        default:
+            throw Malformed{"tag não usada pela telemetria"};
+        }
+        return it;
+    }
+
+private:
+    uint8_t byte() {
+        if (p_ == end_) throw Truncated{};
+        return *p_++;
+    }
+
+    uint8_t peek() const {
+        if (p_ == end_) throw Truncated{};
+        return *p_;
+    }
+
+    uint64_t argument(unsigned ai) {
+        if (ai < 24) return ai;
+        int n = ai == 24 ? 1 : ai == 25 ? 2 : ai == 26 ? 4 : ai == 27 ? 8 : 0;
+        if (!n) throw Malformed{"argumento reservado"};
+        uint64_t v = 0;
+        for (int i = 0; i < n; i++) v = (v << 8) | byte();
+        if (v < 24 || (n > 1 && v < (1ull << (4 * n)))) throw Malformed{"inteiro fora da forma mais curta"};
+        return v;
+    }
+
+    const uint8_t *p_;
+    const uint8_t *end_;
+};
+
+static bool all_uints(const Item *it, size_t n) {
+    if (!it || it->kind != Item::Array || it->items.size() != n) return false;
+    for (const Item &x : it->items) {
+        if (x.kind != Item::Uint) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Instante do registro: ms desde o boot e, se houver, UTC (chave 9) em ISO 8601
+ */
+static void print_time(const Item *t, const Item *utc) {
+    std::printf("t=%llu ms", (unsigned long long)t->value);
+    if (!utc) return;
+    time_t seconds = (time_t)(utc->value / 1000);
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    char text[32];
+    std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &tm);
+    std::printf(" (%s.%03lluZ)", text, (unsigned long long)(utc->value % 1000));
+}
+
+/**
+ * @brief Confere um registro contra o esquema do seu tipo
+ *
+ * @return nullptr se válido, ou a descrição da violação
+ */
+static const char *validate(const Item &rec, bool quiet) {
+    if (rec.kind != Item::Map) return "registro não é um mapa";
+    const Item *type = rec.get(0), *t = rec.get(1);
+    if (!type || type->kind != Item::Uint) return "tipo (chave 0) ausente";
+    if (!t || t->kind != Item::Uint || t->value > UINT32_MAX) return "instante (chave 1) ausente";
+    // UTC opcional: um par a mais em qualquer tipo
+    const Item *utc = rec.get(9);
+    if (utc && utc->kind != Item::Uint) return "UTC (chave 9) não é inteiro";
+    size_t common = utc ? 3 : 2;
+
+    switch (type->value) {
+    case TELEMETRY_CBOR_SAMPLE_BATCH: {
+        const Item *samples = rec.get(2);
+        if (rec.pairs() != common + 1 || !samples || samples->kind != Item::Array) return "lote sem array de amostras";
+        for (const Item &s : samples->items) {
+            if (s.kind != Item::Array || s.items.size() != 7) return "amostra sem 7 itens";
+            const std::vector<Item> &f = s.items;
+            if (f[0].kind != Item::Uint || !f[1].is_int() || !f[2].is_int() || !f[3].is_int())
+                return "amostra com tipo inválido";
+            if (f[4].kind != Item::Uint || f[4].value > 4095 || f[5].kind != Item::Uint || f[5].value > 4095)
+                return "amostra do ADC fora de 0-4095";
+            if (f[6].kind != Item::Bool) return "alarme não é booleano";
+            if (f[1].as_int() == 0 && (f[3].as_int() < 0 || f[3].as_int() > 1000)) return "umidade fora de 0-100%";
+        }
+        if (!quiet) {
+            std::printf("lote ");
+            print_time(t, utc);
+            std::printf(": %zu amostras", samples->items.size());
+            if (!samples->items.empty()) {
+                const std::vector<Item> &last = samples->items.back().items;
+                std::printf(", última dt=%llu ms temp=%.1f umid=%.1f ldr=%llu mq2=%llu alarme=%d",
+                            (unsigned long long)last[0].value, last[2].as_int() / 10.0, last[3].as_int() / 10.0,
+                            (unsigned long long)last[4].value, (unsigned long long)last[5].value,
+                            (int)last[6].value);
+            }
+            std::printf("\n");
+        }
+        return nullptr;
+    }
+    case TELEMETRY_CBOR_ACTUATOR_EVENT: {
+        static const char *const names[] = {"relé", "servo", "LED"};
+        const Item *act = rec.get(2), *value = rec.get(3);
+        if (rec.pairs() != common + 2 || !act || act->kind != Item::Uint || act->value > TELEMETRY_ACTUATOR_LED)
+            return "atuador inválido";
+        uint64_t max = act->value == TELEMETRY_ACTUATOR_SERVO ? 180 : 1;
+        if (!value || value->kind != Item::Uint || value->value > max) return "valor do atuador inválido";
+        if (!quiet) {
+            std::printf("evento ");
+            print_time(t, utc);
+            std::printf(": %s = %llu\n", names[act->value], (unsigned long long)value->value);
+        }
+        return nullptr;
+    }
+    case TELEMETRY_CBOR_STATS: {
+        const Item *rules = rec.get(4);
+        if (rec.pairs() != common + 3 || !all_uints(rec.get(2), 2) || !all_uints(rec.get(3), 3)) {
+            return "estatísticas com formato inválido";
+        }
+        if (!rules || rules->kind != Item::Array || rules->items.size() != TELEMETRY_CBOR_STATS_RULES)
+            return "estatísticas sem regras";
+        for (const Item &r : rules->items) {
+            if (!all_uints(&r, 5)) return "regra com formato inválido";
+        }
+        if (!quiet) {
+            const Item *gas = rec.get(3);
+            std::printf("estatísticas ");
+            print_time(t, utc);
+            std::printf(": %llu blocos do ADC, %llu descartes, alarme %llu acionamentos (máx %llu us)\n",
+                        (unsigned long long)rec.get(2)->items[0].value,
+                        (unsigned long long)rec.get(2)->items[1].value, (unsigned long long)gas->items[0].value,
+                        (unsigned long long)gas->items[1].value);
+        }
+        return nullptr;
+    }
+    default:
+        return "tipo de registro desconhecido";
+    }
+}
+
+int main(int argc, char **argv) {
+    bool quiet = false;
+    const char *path = "-";
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-q")) quiet = true;
+        else path = argv[i];
+    }
+
+    FILE *f = std::strcmp(path, "-") ? std::fopen(path, "rb") : stdin;
+    if (!f) {
+        std::perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    if (f != stdin) std::fclose(f);
+
+    uint64_t records[4] = {}, samples = 0, invalid = 0, skipped = 0, out_of_order = 0;
+    bool truncated = false, have_last = false;
+    uint32_t last_ms = 0;
+    const uint8_t *p = data.data(), *end = data.data() + data.size();
+
+    while (p < end) {
+        // Registros começam com um mapa definido (0xa0-0xb7)
+        if ((*p >> 5) != 5 || (*p & 31) >= 24) {
+            p++;
+            skipped++;
+            continue;
+        }
+        Parser parser(p, end);
+        try {
+            Item rec = parser.parse();
+            const Item *type = rec.get(0);
+            if (!type || type->kind != Item::Uint || type->value < TELEMETRY_CBOR_SAMPLE_BATCH ||
+                type->value > TELEMETRY_CBOR_STATS) {
+                p++;
+                skipped++;
+                continue;
+            }
+            const char *error = validate(rec, quiet);
+            if (error) {
+                std::printf("registro inválido no byte %zu: %s\n", (size_t)(p - data.data()), error);
+                invalid++;
+            } else {
+                uint64_t type = rec.get(0)->value;
+                uint32_t t_ms = (uint32_t)rec.get(1)->value;
+                // Diferença em 32 bits tolera o wrap de 49,7 dias
+                if (have_last && (int32_t)(t_ms - last_ms) < 0) {
+                    std::printf("registro fora de ordem no byte %zu: t=%u ms após t=%u ms\n",
+                                (size_t)(p - data.data()), t_ms, last_ms);
+                    out_of_order++;
+                }
+                have_last = true;
+                last_ms = t_ms;
+                records[type]++;
+                if (type == TELEMETRY_CBOR_SAMPLE_BATCH) samples += rec.get(2)->items.size();
+            }
+            p = parser.pos();
+        } catch (const Truncated &) {
+            std::printf("registro truncado no byte %zu\n", (size_t)(p - data.data()));
+            truncated = true;
+            break;
+        } catch (const Malformed &) {
+            // Não era um registro: segue procurando a partir do próximo byte
+            p++;
+            skipped++;
+        }
+    }
+
+    std::printf("%zu bytes: %llu lotes (%llu amostras), %llu eventos, %llu estatísticas, %llu inválidos, "
+                "%llu fora de ordem, %llu bytes ignorados\n",
+                data.size(), (unsigned long long)records[TELEMETRY_CBOR_SAMPLE_BATCH], (unsigned long long)samples,
+                (unsigned long long)records[TELEMETRY_CBOR_ACTUATOR_EVENT],
+                (unsigned long long)records[TELEMETRY_CBOR_STATS], (unsigned long long)invalid,
+                (unsigned long long)out_of_order, (unsigned long long)skipped);
+    return invalid || truncated || out_of_order ? 1 : 0;
+}
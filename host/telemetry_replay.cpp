@@ -0,0 +1,177 @@
+/**
+ * @file telemetry_replay.cpp
+ * @brief Reproduz séries gravadas pela política de relato por mudança
+ *
+ * Cada amostra de um arquivo de série é codificada duas vezes com o
+ * mesmo telemetry.c do firmware: uma com todas as linhas (comportamento
+ * sem deadband) e outra apenas com as linhas escolhidas por
+ * telemetry_deadband_select(). O relatório mostra bytes por hora para
+ * dois destinos:
+ * - serial: apenas o texto da telemetria;
+ * - rede: cada amostra com ao menos uma linha vira uma mensagem MQTT
+ *   PUBLISH (QoS 0, tópico como o de fleet_loadgen) em um segmento TCP
+ *   próprio sobre IPv4 (40 bytes de cabeçalhos).
+ *
+ * Também confere os limites de reconstrução documentados em telemetry.h:
+ * o maior erro entre o valor real e o último valor emitido de cada canal
+ * e o maior silêncio de cada linha.
+ *
+ * Uso:
+ * @code
+ * telemetry_replay [--synth amostras] <arquivo.ems>...
+ * @endcode
+ *
+ * Com --synth, cada arquivo é antes gerado por series_synth_write().
+ * O estado do alarme é reconstruído pelo limiar do MQ2, já que as séries
+ * não o gravam.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "series_reader.h"
+#include "series_synth.h"
+
+extern "C" {
+#include "gas_alarm.h"
+#include "telemetry.h"
+}
+
+#define MQTT_TOPIC_PREFIX "environment-monitoring/"
+#define TCP_IP_HEADER_BYTES 40
+
+/**
+ * @brief Bytes acumulados por um destino
+ */
+struct SinkBytes {
+    uint64_t serial = 0;
+    uint64_t network = 0;
+    uint64_t messages = 0;
+
+    void add(int text_len, size_t topic_len) {
+        if (text_len <= 0) return;
+        size_t body = 2 + topic_len + (size_t)text_len;
+        size_t length_bytes = body < 128 ? 1 : body < 16384 ? 2 : 3;
+        serial += (uint64_t)text_len;
+        network += TCP_IP_HEADER_BYTES + 1 + length_bytes + body;
+        messages++;
+    }
+};
+
+/**
+ * @brief Erro de reconstrução e silêncio observados durante a reprodução
+ */
+struct Reconstruction {
+    double temperature = 0, humidity = 0;
+    int ldr = 0, mq2 = 0;
+    uint64_t alarm_mismatches = 0;
+    int64_t max_silence_us[TELEMETRY_LINE_COUNT] = {};
+};
+
+static void replay(const std::string &path, const telemetry_deadband_t &policy) {
+    SeriesReader reader(path);
+    std::string topic = MQTT_TOPIC_PREFIX + std::to_string(reader.device_id()) + "/telemetry";
+
+    SinkBytes full, deadband;
+    Reconstruction rec;
+    telemetry_deadband_state_t state = {};
+    int64_t last_emit[TELEMETRY_LINE_COUNT] = {};
+    int64_t t_first = 0, t_last = 0;
+    char text[256];
+
+    std::vector<int64_t> t;
+    std::vector<int32_t> v[SERIES_CH_COUNT];
+    for (size_t c = 0; c < reader.chunk_count(); c++) {
+        size_t n = reader.chunk(c).count;
+        t.resize(n);
+        reader.decode_time(c, t.data());
+        for (int ch = 0; ch < SERIES_CH_COUNT; ch++) {
+            v[ch].resize(n);
+            reader.decode_channel(c, (series_channel_t)ch, v[ch].data());
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            telemetry_sample_t s = {};
+            s.temperature = (float)v[SERIES_CH_TEMPERATURE][i] / 10.0f;
+            s.humidity = (float)v[SERIES_CH_HUMIDITY][i] / 10.0f;
+            s.ldr_raw = (uint16_t)v[SERIES_CH_LDR][i];
+            s.mq2_raw = (uint16_t)v[SERIES_CH_MQ2][i];
+            s.gas_alarm = s.mq2_raw > GAS_ALARM_DEFAULT_THRESHOLD;
+
+            if (c == 0 && i == 0) t_first = t[i];
+            t_last = t[i];
+
+            full.add(telemetry_format_sample(text, sizeof(text), &s), topic.size());
+            unsigned int lines = telemetry_deadband_select(&policy, &state, &s, (uint32_t)(t[i] / 1000));
+            deadband.add(telemetry_format_lines(text, sizeof(text), &s, lines), topic.size());
+
+            for (int l = 0; l < TELEMETRY_LINE_COUNT; l++) {
+                if (!(lines & (1u << l))) {
+                    rec.max_silence_us[l] = std::max(rec.max_silence_us[l], t[i] - last_emit[l]);
+                } else {
+                    last_emit[l] = t[i];
+                }
+            }
+            const telemetry_sample_t &held = state.reported;
+            rec.temperature = std::max(rec.temperature, (double)std::fabs(s.temperature - held.temperature));
+            rec.humidity = std::max(rec.humidity, (double)std::fabs(s.humidity - held.humidity));
+            rec.ldr = std::max(rec.ldr, std::abs((int)s.ldr_raw - (int)held.ldr_raw));
+            rec.mq2 = std::max(rec.mq2, std::abs((int)s.mq2_raw - (int)held.mq2_raw));
+            if (s.gas_alarm != held.gas_alarm) rec.alarm_mismatches++;
+        }
+    }
+
+    double hours = (double)(t_last - t_first) / 3.6e9;
+    if (hours <= 0) hours = 1.0 / 3600.0;
+    auto per_hour = [&](uint64_t bytes) { return (double)bytes / hours; };
+    auto saved = [](uint64_t before, uint64_t after) {
+        return before ? 100.0 * (1.0 - (double)after / (double)before) : 0.0;
+    };
+
+    std::printf("%s: %llu amostras em %.1f h\n", path.c_str(), (unsigned long long)reader.sample_count(), hours);
+    std::printf("  serial: %.0f -> %.0f bytes/h (%.1f%% a menos)\n", per_hour(full.serial),
+                per_hour(deadband.serial), saved(full.serial, deadband.serial));
+    std::printf("  rede:   %.0f -> %.0f bytes/h (%.1f%% a menos), %.0f -> %.0f mensagens/h\n",
+                per_hour(full.network), per_hour(deadband.network), saved(full.network, deadband.network),
+                per_hour(full.messages), per_hour(deadband.messages));
+    std::printf("  erro máximo de reconstrução: temperatura %.2f °C, umidade %.2f %%, LDR %d, MQ2 %d, "
+                "alarme %llu amostras\n",
+                rec.temperature, rec.humidity, rec.ldr, rec.mq2, (unsigned long long)rec.alarm_mismatches);
+    std::printf("  maior silêncio (s): DHT22 %.0f, LDR %.0f, MQ2 %.0f, alarme %.0f\n",
+                rec.max_silence_us[0] / 1e6, rec.max_silence_us[1] / 1e6, rec.max_silence_us[2] / 1e6,
+                rec.max_silence_us[3] / 1e6);
+}
+
+int main(int argc, char **argv) {
+    uint64_t synth = 0;
+    int first = 1;
+    if (argc > 2 && !std::strcmp(argv[1], "--synth")) {
+        synth = std::strtoull(argv[2], nullptr, 10);
+        first = 3;
+    }
+    if (first >= argc) {
+        std::fprintf(stderr, "uso: %s [--synth amostras] <arquivo.ems>...\n", argv[0]);
+        return 2;
+    }
+
+    const telemetry_deadband_t policy = TELEMETRY_DEADBAND_DEFAULT;
+    std::printf("política: temperatura %.1f °C, umidade %.1f %%, LDR %u, MQ2 %u, heartbeat %u s\n",
+                policy.temperature_delta, policy.humidity_delta, policy.ldr_delta, policy.mq2_delta,
+                policy.max_silence_ms / 1000);
+
+    try {
+        for (int i = first; i < argc; i++) {
+            if (synth) series_synth_write(argv[i], (uint64_t)(i - first + 1), synth);
+            replay(argv[i], policy);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "erro: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file work_pool.cpp
+ * @brief Implementação do pool de threads com roubo de tarefas
+ */
+#include "work_pool.h"
+
+WorkPool::WorkPool(unsigned threads) {
+    if (threads == 0) threads = 1;
+    for (unsigned i = 0; i < threads; i++) {
+        workers_.emplace_back(new Worker);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers_[i]->thread = std::thread(&WorkPool::run, this, i);
+    }
+}
+
+WorkPool::~WorkPool() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto &w : workers_) {
+        w->thread.join();
+    }
+}
+
+void WorkPool::submit(Task task) {
+    unsigned target = next_.fetch_add(1, std::memory_order_relaxed) % size();
+    unfinished_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->queue.push_back(std::move(task));
+    }
+    {
+        // Publica sob idle_mutex_ para não perder a notificação de um worker adormecendo
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        queued_.fetch_add(1, std::memory_order_release);
+    }
+    work_cv_.notify_one();
+}
+
+void WorkPool::wait() {
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    done_cv_.wait(lock, [this] { return unfinished_.load(std::memory_order_acquire) == 0; });
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool WorkPool::pop_local(unsigned self, Task &task) {
+    Worker &w = *workers_[self];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.queue.empty()) return false;
+    task = std::move(w.queue.back());
+    w.queue.pop_back();
+    return true;
+}
+
+bool WorkPool::steal(unsigned self, Task &task) {
+    const unsigned n = size();
+    for (unsigned k = 1; k < n; k++) {
+        Worker &victim = *workers_[(self + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty()) {
+            task = std::move(victim.queue.front());
+            victim.queue.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkPool::run(unsigned self) {
+    Task task;
+    for (;;) {
+        if (pop_local(self, task) || steal(self, task)) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(idle_mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            task = nullptr;
+            if (unfinished_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(idle_mutex_);
+                done_cv_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        work_cv_.wait(lock, [this] {
+            return stop_ || queued_.load(std::memory_order_acquire) > 0;
+        });
+        if (stop_ && queued_.load(std::memory_order_acquire) == 0) return;
+    }
+}
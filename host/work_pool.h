@@ -0,0 +1,88 @@
+/**
+ * @file work_pool.h
+ * @brief Pool de threads com roubo de tarefas (work stealing)
+ */
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Pool de threads com uma fila por worker
+ *
+ * Cada worker consome a própria fila pelo fim (LIFO, boa localidade) e,
+ * quando ela esvazia, rouba tarefas do início da fila de outro worker
+ * (FIFO, pega as tarefas mais antigas e normalmente maiores). As
+ * tarefas enviadas por submit() são distribuídas em rodízio.
+ *
+ * Uma exceção que escapa de uma tarefa não derruba o worker: a primeira
+ * é guardada e relançada por wait(), depois que todas as tarefas
+ * terminarem; as seguintes são descartadas.
+ *
+ * Exemplo de uso:
+ * @code
+ * WorkPool pool(4);
+ * for (auto &file : files) pool.submit([&] { process(file); });
+ * pool.wait();
+ * @endcode
+ */
+class WorkPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkPool(unsigned threads = std::thread::hardware_concurrency());
+    ~WorkPool();
+
+    WorkPool(const WorkPool &) = delete;
+    WorkPool &operator=(const WorkPool &) = delete;
+
+    unsigned size() const { return (unsigned)workers_.size(); }
+
+    void submit(Task task);
+
+    /**
+     * @brief Bloqueia até que todas as tarefas enviadas terminem
+     *
+     * Relança a primeira exceção lançada por uma tarefa desde o último
+     * wait().
+     */
+    void wait();
+
+    /**
+     * @brief Número de tarefas executadas por um worker diferente do
+     *        que as recebeu
+     */
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> queue;
+        std::thread thread;
+    };
+
+    void run(unsigned self);
+    bool pop_local(unsigned self, Task &task);
+    bool steal(unsigned self, Task &task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex idle_mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> unfinished_{0};
+    std::atomic<uint64_t> steals_{0};
+    std::atomic<unsigned> next_{0};
+    bool stop_ = false;
+    std::exception_ptr error_;          // Primeira exceção de uma tarefa, sob idle_mutex_
+};
+
+#endif // WORK_POOL_H
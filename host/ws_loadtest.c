@@ -0,0 +1,503 @@
+/**
+ * @file ws_loadtest.c
+ * @brief Servidor WebSocket (ws_server.h) e telemetria ao vivo sob muitos clientes
+ *
+ * A thread principal faz o papel do laço do firmware: chama
+ * ws_server_poll() a cada passagem e publica amostras a --rate-hz por
+ * telemetry_live_sample(), com um evento de atuador a cada
+ * --event-every amostras, sobre host/net_socket.c. Cada registro leva um
+ * número de sequência (LDR e MQ2 da amostra, valor do evento).
+ *
+ * Outra thread conduz todos os clientes em 127.0.0.1 com poll():
+ * - rápidos (--clients): leem tudo, conferem a sequência e mandam um ping;
+ * - lentos (--slow): leem 256 bytes a cada 100 ms, menos que o fluxo;
+ * - mortos (--dead): completam o handshake e nunca mais leem;
+ * - um com requisição inválida e um calado, que não completam o handshake.
+ * Lentos e mortos têm um buffer de recepção pequeno, para encher logo.
+ *
+ * A publicação começa quando todos os lentos, mortos e rápidos estão
+ * conectados. Ao fim, a verificação falha (saída 1) se:
+ * - algum rápido perdeu, repetiu ou recebeu fora de ordem uma mensagem,
+ *   não recebeu o pong ou foi derrubado;
+ * - algum lento ou morto não foi derrubado;
+ * - os dois handshakes ruins não foram recusados;
+ * - o p99 das passagens do laço (poll e publicação), no relógio, ou a
+ *   maior delas em tempo de CPU da thread passou de --budget-us: um
+ *   cliente ruim nunca pode segurar a aquisição. O máximo no relógio só
+ *   é mostrado: num host com poucos núcleos ele inclui as vezes em que o
+ *   escalonador tirou a thread para rodar os clientes, o que não existe
+ *   no firmware;
+ * - faltou quadro no pool ou algum quadro não voltou a ele.
+ *
+ * Uso:
+ * @code
+ * ws_loadtest [--clients n] [--slow n] [--dead n] [--seconds s] [--rate-hz n]
+ *             [--event-every n] [--budget-us us]
+ * @endcode
+ */
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "message_pools.h"
+#include "telemetry_live.h"
+#include "ws_server.h"
+
+#define LOAD_SLOW_READ_BYTES 256
+#define LOAD_SLOW_READ_MS 100
+#define LOAD_SMALL_RCVBUF 2048
+#define LOAD_CONNECT_TIMEOUT_MS 5000
+#define LOAD_DRAIN_MS 1000
+#define LOAD_RX_BYTES 8192
+
+// Exemplo da RFC 6455, seção 1.3
+#define LOAD_KEY "dGhlIHNhbXBsZSBub25jZQ=="
+#define LOAD_ACCEPT "s3pPLMBiTxaQ9kYGzzhZRbK+xOo="
+
+typedef enum {
+    CLIENT_FAST,
+    CLIENT_SLOW,
+    CLIENT_DEAD,
+    CLIENT_BAD_REQUEST,
+    CLIENT_SILENT,
+} client_kind_t;
+
+typedef struct {
+    client_kind_t kind;
+    int fd;
+    bool upgraded;
+    bool closed;                // Fim do fluxo ou erro visto pelo cliente
+    bool rejected;              // Recebeu 400 ou foi fechado sem upgrade
+    bool pong;
+    bool order_error;
+    uint32_t next_seq;
+    uint32_t messages;
+    int64_t last_read_ms;
+    size_t rx_len;
+    uint8_t rx[LOAD_RX_BYTES];
+} client_t;
+
+static client_t *clients;
+static int client_count;
+static int64_t mono0_ns;
+static atomic_bool clients_ready;          // Os que completam o handshake estão conectados
+static atomic_bool producing_done;
+static atomic_uint published;              // Mensagens publicadas
+static atomic_bool clients_done;
+static uint16_t server_port;
+
+// Latências dos rápidos: da publicação (chave 1 do registro) à leitura, em ms
+static uint32_t latency_hist[1001];
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec - mono0_ns) / 1000000;
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Tempo de CPU da thread que chama, sem as preempções
+static int64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void sleep_us(long us) {
+    struct timespec ts = {.tv_sec = us / 1000000, .tv_nsec = us % 1000000 * 1000};
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief Cabeça de um item CBOR: tipo maior e argumento (31 marca indefinido ou break)
+ */
+static bool cbor_head(const uint8_t **p, const uint8_t *end, int *major, uint64_t *value) {
+    if (*p >= end) return false;
+    uint8_t b = *(*p)++;
+    *major = b >> 5;
+    uint8_t info = b & 31;
+    if (info < 24 || info == 31) {
+        *value = info;
+        return true;
+    }
+    if (info > 27) return false;
+    int bytes = 1 << (info - 24);
+    if (end - *p < bytes) return false;
+    *value = 0;
+    for (int i = 0; i < bytes; i++) *value = *value << 8 | *(*p)++;
+    return true;
+}
+
+/**
+ * @brief Sequência e instante de um registro ao vivo (lote de uma amostra ou evento)
+ */
+static bool decode_record(const uint8_t *p, size_t len, uint32_t *seq, uint32_t *t_ms) {
+    const uint8_t *end = p + len;
+    int major;
+    uint64_t pairs, key, value, type = 0;
+    if (!cbor_head(&p, end, &major, &pairs) || major != 5) return false;
+    bool found = false;
+    for (uint64_t i = 0; i < pairs; i++) {
+        if (!cbor_head(&p, end, &major, &key) || major != 0) return false;
+        if (key == 2 && type == TELEMETRY_CBOR_SAMPLE_BATCH) {
+            // Array indefinido com um array de 7: [dt, código, temp, umid, LDR, MQ2, alarme]
+            uint64_t items[7];
+            if (!cbor_head(&p, end, &major, &value) || major != 4 || value != 31) return false;
+            if (!cbor_head(&p, end, &major, &value) || major != 4 || value != 7) return false;
+            for (int k = 0; k < 7; k++) {
+                if (!cbor_head(&p, end, &major, &items[k])) return false;
+            }
+            if (!cbor_head(&p, end, &major, &value) || major != 7 || value != 31) return false;
+            *seq = (uint32_t)(items[5] << 16 | items[4]);
+            found = true;
+            continue;
+        }
+        if (!cbor_head(&p, end, &major, &value)) return false;
+        if (key == 0) type = value;
+        if (key == 1) *t_ms = (uint32_t)value;
+        if (key == 3 && type == TELEMETRY_CBOR_ACTUATOR_EVENT) {
+            *seq = (uint32_t)value;
+            found = true;
+        }
+    }
+    return found && p == end;
+}
+
+static int connect_client(client_kind_t kind) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (kind == CLIENT_SLOW || kind == CLIENT_DEAD) {
+        int size = LOAD_SMALL_RCVBUF;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    struct sockaddr_in to = {.sin_family = AF_INET, .sin_port = htons(server_port),
+                             .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    if (connect(fd, (const struct sockaddr *)&to, sizeof(to)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void send_all(int fd, const void *data, size_t len) {
+    const uint8_t *p = data;
+    while (len) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+static void send_ping(int fd) {
+    // Quadro do cliente: mascarado, carga "seq"
+    uint8_t frame[2 + 4 + 3] = {0x80 | 0x9, 0x80 | 3, 0x12, 0x34, 0x56, 0x78};
+    const char payload[3] = {'s', 'e', 'q'};
+    for (int i = 0; i < 3; i++) frame[6 + i] = (uint8_t)payload[i] ^ frame[2 + i % 4];
+    send_all(fd, frame, sizeof(frame));
+}
+
+/**
+ * @brief Consome o que chegou: resposta do handshake, depois mensagens do servidor
+ */
+static void parse_input(client_t *c) {
+    size_t pos = 0;
+    if (!c->upgraded) {
+        c->rx[c->rx_len < sizeof(c->rx) ? c->rx_len : sizeof(c->rx) - 1] = '\0';
+        char *end = strstr((char *)c->rx, "\r\n\r\n");
+        if (!end) return;
+        if (strncmp((char *)c->rx, "HTTP/1.1 101", 12) != 0 || !strstr((char *)c->rx, LOAD_ACCEPT)) {
+            c->rejected = true;
+            c->rx_len = 0;
+            return;
+        }
+        c->upgraded = true;
+        pos = (size_t)(end + 4 - (char *)c->rx);
+        if (c->kind == CLIENT_FAST) send_ping(c->fd);
+    }
+
+    while (c->kind == CLIENT_FAST && c->rx_len - pos >= 2) {
+        const uint8_t *p = c->rx + pos;
+        size_t header = 2, len = p[1] & 0x7F;
+        if (p[1] & 0x80) c->order_error = true;     // Servidor nunca mascara
+        if (len == 126) {
+            if (c->rx_len - pos < 4) break;
+            len = (size_t)p[2] << 8 | p[3];
+            header = 4;
+        }
+        if (c->rx_len - pos < header + len) break;
+        if (p[0] == (0x80 | 0xA)) {
+            c->pong = len == 3 && !memcmp(p + header, "seq", 3);
+        } else if (p[0] == (0x80 | 0x2)) {
+            uint32_t seq = 0, t_ms = 0;
+            if (!decode_record(p + header, len, &seq, &t_ms) || seq != c->next_seq) c->order_error = true;
+            c->next_seq = seq + 1;
+            c->messages++;
+            int64_t latency = now_ms() - t_ms;
+            latency_hist[latency < 0 ? 0 : latency > 1000 ? 1000 : latency]++;
+        } else {
+            c->order_error = true;
+        }
+        pos += header + len;
+    }
+    if (c->kind != CLIENT_FAST) pos = c->upgraded ? c->rx_len : pos;
+    memmove(c->rx, c->rx + pos, c->rx_len - pos);
+    c->rx_len -= pos;
+}
+
+static void *clients_main(void *arg) {
+    (void)arg;
+    static const char request[] = "GET /live HTTP/1.1\r\nHost: pico\r\nUpgrade: websocket\r\n"
+                                  "Connection: Upgrade\r\nSec-WebSocket-Key: " LOAD_KEY "\r\n"
+                                  "Sec-WebSocket-Version: 13\r\n\r\n";
+    static const char bad_request[] = "GET / HTTP/1.1\r\nHost: pico\r\n\r\n";
+    for (int i = 0; i < client_count; i++) {
+        client_t *c = &clients[i];
+        c->fd = connect_client(c->kind);
+        if (c->fd < 0) {
+            c->closed = true;
+            continue;
+        }
+        if (c->kind == CLIENT_BAD_REQUEST) send_all(c->fd, bad_request, sizeof(bad_request) - 1);
+        else if (c->kind != CLIENT_SILENT) send_all(c->fd, request, sizeof(request) - 1);
+    }
+
+    struct pollfd *fds = calloc((size_t)client_count, sizeof(*fds));
+    int64_t done_ms = -1;
+    for (;;) {
+        int64_t now = now_ms();
+        bool ready = true, fast_done = atomic_load(&producing_done);
+        unsigned int total = atomic_load(&published);
+        for (int i = 0; i < client_count; i++) {
+            client_t *c = &clients[i];
+            if (c->kind <= CLIENT_DEAD && !c->upgraded && !c->closed) ready = false;
+            if (c->kind == CLIENT_FAST && !c->closed && c->messages < total) fast_done = false;
+            bool reads = !c->closed && (c->kind != CLIENT_DEAD || !c->upgraded);
+            if (c->kind == CLIENT_SLOW && c->upgraded && now - c->last_read_ms < LOAD_SLOW_READ_MS) reads = false;
+            fds[i] = (struct pollfd){.fd = reads ? c->fd : -1, .events = POLLIN};
+        }
+        if (ready) atomic_store(&clients_ready, true);
+        if (atomic_load(&producing_done)) {
+            if (done_ms < 0) done_ms = now;
+            if (fast_done || now - done_ms > LOAD_DRAIN_MS) break;
+        }
+
+        poll(fds, (nfds_t)client_count, 5);
+        for (int i = 0; i < client_count; i++) {
+            client_t *c = &clients[i];
+            if (fds[i].fd < 0 || !fds[i].revents) continue;
+            size_t max = sizeof(c->rx) - 1 - c->rx_len;
+            if (c->kind == CLIENT_SLOW && c->upgraded && max > LOAD_SLOW_READ_BYTES) max = LOAD_SLOW_READ_BYTES;
+            ssize_t n = recv(c->fd, c->rx + c->rx_len, max, MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+            if (n <= 0) {
+                c->closed = true;
+                if (!c->upgraded) c->rejected = true;
+                continue;
+            }
+            c->rx_len += (size_t)n;
+            c->last_read_ms = now;
+            parse_input(c);
+        }
+    }
+    free(fds);
+
+    for (int i = 0; i < client_count; i++) {
+        if (clients[i].fd >= 0) close(clients[i].fd);
+    }
+    atomic_store(&clients_done, true);
+    return NULL;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint32_t latency_percentile(double p) {
+    uint64_t total = 0, seen = 0;
+    for (int i = 0; i <= 1000; i++) total += latency_hist[i];
+    for (int i = 0; i <= 1000; i++) {
+        seen += latency_hist[i];
+        if (seen > 0 && seen >= total * p / 100) return (uint32_t)i;
+    }
+    return 0;
+}
+
+static int usage(const char *argv0) {
+    fprintf(stderr,
+            "uso: %s [--clients n] [--slow n] [--dead n] [--seconds s] [--rate-hz n]\n"
+            "          [--event-every n] [--budget-us us]\n",
+            argv0);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    int fast = 48, slow = 6, dead = 6, event_every = 50;
+    double seconds = 10, rate_hz = 200, budget_us = 10000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i];
+        const char *value = argv[i + 1];
+        if (!strcmp(arg, "--clients")) {
+            fast = atoi(value);
+        } else if (!strcmp(arg, "--slow")) {
+            slow = atoi(value);
+        } else if (!strcmp(arg, "--dead")) {
+            dead = atoi(value);
+        } else if (!strcmp(arg, "--seconds")) {
+            seconds = strtod(value, NULL);
+        } else if (!strcmp(arg, "--rate-hz")) {
+            rate_hz = strtod(value, NULL);
+        } else if (!strcmp(arg, "--event-every")) {
+            event_every = atoi(value);
+        } else if (!strcmp(arg, "--budget-us")) {
+            budget_us = strtod(value, NULL);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    client_count = fast + slow + dead + 2;
+    if (argc % 2 == 0 || seconds <= 0 || rate_hz <= 0 || event_every <= 0 || fast < 0 || slow < 0 || dead < 0 ||
+        client_count - 2 > WS_SERVER_CLIENTS) {
+        if (client_count - 2 > WS_SERVER_CLIENTS) fprintf(stderr, "no máximo %d clientes\n", WS_SERVER_CLIENTS);
+        return usage(argv[0]);
+    }
+
+    mono0_ns = now_ns();
+    message_pools_init();
+    if (!ws_server_init(0)) {
+        fprintf(stderr, "falha ao abrir a porta do servidor\n");
+        return 1;
+    }
+    server_port = ws_server_port();
+
+    clients = calloc((size_t)client_count, sizeof(*clients));
+    for (int i = 0; i < client_count; i++) {
+        client_t *c = &clients[i];
+        c->kind = i < fast ? CLIENT_FAST : i < fast + slow ? CLIENT_SLOW : i < fast + slow + dead ? CLIENT_DEAD
+                : i == client_count - 2 ? CLIENT_BAD_REQUEST : CLIENT_SILENT;
+        c->fd = -1;
+    }
+    printf("porta %u: %d rápidos, %d lentos, %d mortos e 2 handshakes ruins; %.0f amostras/s por %.0f s\n",
+           server_port, fast, slow, dead, rate_hz, seconds);
+
+    pthread_t client_thread;
+    pthread_create(&client_thread, NULL, clients_main, NULL);
+
+    // Conexões e handshakes antes da primeira amostra
+    int64_t connect_deadline = now_ms() + LOAD_CONNECT_TIMEOUT_MS;
+    while (!atomic_load(&clients_ready) && now_ms() < connect_deadline) {
+        ws_server_poll((uint32_t)now_ms());
+        sleep_us(200);
+    }
+    ws_server_stats_t stats;
+    ws_server_get_stats(&stats);
+    printf("conectados: %u clientes abertos\n", stats.clients);
+
+    // Laço da aquisição: cada passagem é medida, como um tick do firmware
+    size_t max_passes = (size_t)(seconds * 2000) + 16;
+    uint32_t *passes = malloc(max_passes * sizeof(*passes));
+    uint32_t cpu_max = 0;       // Maior passagem em tempo de CPU da thread, em us
+    size_t pass_count = 0;
+    int64_t period_ns = (int64_t)(1e9 / rate_hz);
+    int64_t start_ns = now_ns(), next_ns = start_ns, end_ns = start_ns + (int64_t)(seconds * 1e9);
+    uint32_t seq = 0;
+    while (now_ns() < end_ns) {
+        int64_t t0 = now_ns(), cpu0 = thread_cpu_ns();
+        uint32_t now = (uint32_t)now_ms();
+        ws_server_poll(now);
+        while (t0 >= next_ns) {
+            if (seq % (uint32_t)event_every == (uint32_t)event_every - 1) {
+                telemetry_live_actuator(now, TELEMETRY_ACTUATOR_RELAY, seq);
+            } else {
+                telemetry_sample_t sample = {
+                    .temperature = 24.5f,
+                    .humidity = 60.0f,
+                    .ldr_raw = (uint16_t)seq,
+                    .mq2_raw = (uint16_t)(seq >> 16),
+                };
+                telemetry_live_sample(now, &sample);
+            }
+            seq++;
+            atomic_store(&published, seq);
+            next_ns += period_ns;
+        }
+        int64_t t1 = now_ns();
+        uint32_t cpu_us = (uint32_t)((thread_cpu_ns() - cpu0) / 1000);
+        if (cpu_us > cpu_max) cpu_max = cpu_us;
+        if (pass_count < max_passes) passes[pass_count++] = (uint32_t)((t1 - t0) / 1000);
+        int64_t wait_ns = next_ns - t1;
+        sleep_us(wait_ns > 500000 ? 500 : wait_ns > 0 ? (long)(wait_ns / 1000) : 0);
+    }
+    atomic_store(&producing_done, true);
+
+    // Escoa os rápidos até saírem, depois os fechamentos
+    while (!atomic_load(&clients_done)) {
+        ws_server_poll((uint32_t)now_ms());
+        sleep_us(200);
+    }
+    for (int64_t until = now_ms() + WS_SERVER_POLL_MS * 10; now_ms() < until;) {
+        ws_server_poll((uint32_t)now_ms());
+        ws_server_get_stats(&stats);
+        if (stats.clients == 0) break;
+        sleep_us(200);
+    }
+    pthread_join(client_thread, NULL);
+    ws_server_get_stats(&stats);
+
+    // Rápidos
+    int fast_bad = 0;
+    uint32_t fewest = UINT32_MAX;
+    for (int i = 0; i < fast; i++) {
+        const client_t *c = &clients[i];
+        if (c->messages < fewest) fewest = c->messages;
+        if (!c->upgraded || c->messages != seq || c->order_error || !c->pong) fast_bad++;
+    }
+    // Lentos, mortos e handshakes ruins
+    int rejected = 0;
+    for (int i = fast + slow + dead; i < client_count; i++) rejected += clients[i].rejected || clients[i].closed;
+    uint32_t dropped = stats.dropped_slow + stats.dropped_stalled;
+
+    qsort(passes, pass_count, sizeof(*passes), compare_u32);
+    uint32_t pass_p99 = pass_count ? passes[pass_count * 99 / 100] : 0;
+    uint32_t pass_max = pass_count ? passes[pass_count - 1] : 0;
+
+    block_pool_stats_t pool;
+    message_pools_stats(MESSAGE_POOL_TELEMETRY_FRAME, &pool);
+
+    printf("publicadas %u mensagens; servidor: %u quadros, %u mensagens entregues, %u bytes\n", seq, stats.frames,
+           stats.messages, stats.bytes);
+    printf("rápidos: %d de %d com falha (menor contagem %u); latência p50 %u ms, p99 %u ms, máx %u ms\n", fast_bad,
+           fast, fewest == UINT32_MAX ? 0 : fewest, latency_percentile(50), latency_percentile(99),
+           latency_percentile(100));
+    printf("derrubados: %u lentos (fila cheia) + %u parados, esperados %d; handshakes recusados %u/2, fechados %u\n",
+           stats.dropped_slow, stats.dropped_stalled, slow + dead, stats.handshake_failed, stats.closed);
+    printf("passagens do laço: %zu, p99 %u us, máx %u us no relógio; máx %u us de CPU (limite %.0f us no p99 e "
+           "na CPU)\n",
+           pass_count, pass_p99, pass_max, cpu_max, budget_us);
+    printf("pool de quadros: em uso %u, pico %u de %u, negadas %u; quadros perdidos %u\n", pool.in_use,
+           pool.high_water, pool.count, pool.exhausted, stats.frames_lost);
+
+    bool ok = fast_bad == 0 && dropped == (uint32_t)(slow + dead) && stats.handshake_failed == 2 && rejected == 2 &&
+              pass_p99 <= budget_us && cpu_max <= budget_us && pool.in_use == 0 && stats.frames_lost == 0 &&
+              pool.high_water <= WS_SERVER_CLIENT_QUEUE + 1;
+    printf("%s\n", ok ? "ok" : "FALHOU");
+    free(passes);
+    free(clients);
+    return ok ? 0 : 1;
+}
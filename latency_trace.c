@@ -0,0 +1,107 @@
+/**
+ * @file latency_trace.c
+ * @brief Implementação do rastreamento de latência sensor -> atuador
+ */
+#include "latency_trace.h"
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+static latency_histogram_t latency_histogram[LATENCY_RULE_COUNT];
+static uint32_t latency_seq;
+
+static const char *const latency_rule_names[LATENCY_RULE_COUNT] = {
+    [LATENCY_RULE_GAS_RELAY] = "mq2->rele",
+    [LATENCY_RULE_TEMP_SERVO] = "temperatura->servo",
+    [LATENCY_RULE_LDR_LED] = "ldr->led",
+};
+
+/**
+ * @brief Índice da sub-faixa de uma latência
+ *
+ * Valores de 0 a 7 têm faixa própria; acima disso, cada oitava
+ * [2^m, 2^(m+1)) é dividida em LATENCY_TRACE_SUB_BUCKETS partes iguais.
+ * Esta função, stamp e issue ficam em RAM: a interrupção do DMA as chama
+ * também durante gravações na flash (ver store_forward.h). Por isso o
+ * bit mais alto sai de uma busca binária, não de __builtin_clz(), que no
+ * M0+ chama __clzsi2 na flash.
+ */
+static int __not_in_flash_func(latency_bucket_index)(uint32_t us) {
+    if (us < LATENCY_TRACE_SUB_BUCKETS) return (int)us;
+    int msb = 0;
+    for (int step = 16; step; step >>= 1) {
+        if (us >> (msb + step)) msb += step;
+    }
+    int sub = (int)(us >> (msb - 2)) & (LATENCY_TRACE_SUB_BUCKETS - 1);
+    return (msb - 1) * LATENCY_TRACE_SUB_BUCKETS + sub;
+}
+
+/**
+ * @brief Maior latência que cai na sub-faixa index
+ */
+static uint32_t latency_bucket_upper(int index) {
+    if (index < 2 * LATENCY_TRACE_SUB_BUCKETS) return (uint32_t)index;
+    int msb = index / LATENCY_TRACE_SUB_BUCKETS + 1;
+    uint32_t sub = (uint32_t)(index % LATENCY_TRACE_SUB_BUCKETS);
+    uint64_t lower = (uint64_t)(LATENCY_TRACE_SUB_BUCKETS + sub) << (msb - 2);
+    return (uint32_t)(lower + (1ull << (msb - 2)) - 1);
+}
+
+latency_stamp_t __not_in_flash_func(latency_trace_stamp)(uint32_t acquired_us) {
+    // O laço principal e a interrupção do DMA carimbam amostras
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t seq = ++latency_seq;
+    if (seq == 0) seq = ++latency_seq;
+    restore_interrupts(irq);
+
+    latency_stamp_t stamp = {.seq = seq, .acquired_us = acquired_us};
+    return stamp;
+}
+
+void __not_in_flash_func(latency_trace_issue)(latency_rule_t rule, const latency_stamp_t *cause) {
+    uint32_t issued_us = time_us_32();
+    latency_histogram_t *h = &latency_histogram[rule];
+
+    // Diferença em 32 bits tolera o wrap de time_us_32(); um carimbo do
+    // futuro aparece como latência acima de 2^31 us
+    uint32_t latency = issued_us - cause->acquired_us;
+    if (cause->seq == 0 || latency > INT32_MAX) {
+        h->rejected++;
+        return;
+    }
+
+    if (h->count == 0 || latency < h->min_us) h->min_us = latency;
+    if (latency > h->max_us) h->max_us = latency;
+    h->sum_us += latency;
+    h->bucket[latency_bucket_index(latency)]++;
+    h->count++;
+}
+
+void latency_trace_get(latency_rule_t rule, latency_histogram_t *histogram) {
+    uint32_t irq = save_and_disable_interrupts();
+    *histogram = latency_histogram[rule];
+    restore_interrupts(irq);
+}
+
+uint32_t latency_trace_percentile(const latency_histogram_t *histogram, float percentile) {
+    if (histogram->count == 0) return 0;
+
+    // Posto do percentil (método do posto mais próximo)
+    uint32_t rank = (uint32_t)(percentile / 100.0f * (float)histogram->count + 0.999f);
+    if (rank < 1) rank = 1;
+    if (rank > histogram->count) rank = histogram->count;
+
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_TRACE_BUCKETS; i++) {
+        seen += histogram->bucket[i];
+        if (seen >= rank) {
+            uint32_t upper = latency_bucket_upper(i);
+            return upper < histogram->max_us ? upper : histogram->max_us;
+        }
+    }
+    return histogram->max_us;
+}
+
+const char *latency_trace_rule_name(latency_rule_t rule) {
+    return rule < LATENCY_RULE_COUNT ? latency_rule_names[rule] : "?";
+}
@@ -0,0 +1,96 @@
+/**
+ * @file latency_trace.h
+ * @brief Rastreamento de latência sensor -> atuador por regra de decisão
+ *
+ * Cada amostra que alimenta uma decisão recebe um carimbo no momento da
+ * aquisição (latency_stamp_t); cada comando de atuador é registrado no
+ * momento em que é emitido, junto com o carimbo da amostra que o causou.
+ * A ligação é explícita: um comando só é casado com a amostra que o
+ * provocou, e um carimbo posterior ao comando é rejeitado como não causal.
+ *
+ * Para cada regra é mantido um histograma logarítmico das latências
+ * (4 sub-faixas por oitava, erro relativo abaixo de 25%), além de
+ * contagem, mínimo, máximo e soma. Cada regra tem um único escritor (a
+ * interrupção do DMA ou o laço principal), então o registro não bloqueia
+ * interrupções; apenas a cópia com latency_trace_get() o faz.
+ *
+ * Exemplo:
+ * @code
+ * latency_stamp_t stamp = latency_trace_stamp(time_us_32());
+ * if (leitura acima do limiar) {
+ *     gpio_put(RELE_PIN, 1);
+ *     latency_trace_issue(LATENCY_RULE_GAS_RELAY, &stamp);
+ * }
+ * @endcode
+ */
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LATENCY_TRACE_SUB_BUCKETS 4     // Sub-faixas por oitava
+#define LATENCY_TRACE_BUCKETS (32 * LATENCY_TRACE_SUB_BUCKETS)
+
+/**
+ * @brief Regras de decisão que comandam atuadores
+ */
+typedef enum {
+    LATENCY_RULE_GAS_RELAY,     // MQ2 acima do limiar -> relé (interrupção do DMA)
+    LATENCY_RULE_TEMP_SERVO,    // Temperatura alta/normal -> servo
+    LATENCY_RULE_LDR_LED,       // Luminosidade alta/baixa -> LED vermelho
+    LATENCY_RULE_COUNT
+} latency_rule_t;
+
+/**
+ * @brief Carimbo de aquisição de uma amostra
+ */
+typedef struct {
+    uint32_t seq;               // Número de sequência (0 = carimbo inválido)
+    uint32_t acquired_us;       // time_us_32() da aquisição
+} latency_stamp_t;
+
+/**
+ * @brief Histograma de latências de uma regra, em microssegundos
+ */
+typedef struct {
+    uint32_t count;             // Comandos casados com sua amostra
+    uint32_t rejected;          // Comandos sem carimbo válido ou não causais
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t bucket[LATENCY_TRACE_BUCKETS];
+} latency_histogram_t;
+
+/**
+ * @brief Carimba uma amostra adquirida no instante acquired_us
+ */
+latency_stamp_t latency_trace_stamp(uint32_t acquired_us);
+
+/**
+ * @brief Registra um comando de atuador emitido agora, causado pela amostra cause
+ *
+ * Deve ser chamada logo após o comando (gpio_put, pwm_set_gpio_level).
+ * Pode ser chamada de interrupção.
+ */
+void latency_trace_issue(latency_rule_t rule, const latency_stamp_t *cause);
+
+/**
+ * @brief Copia o histograma de uma regra
+ */
+void latency_trace_get(latency_rule_t rule, latency_histogram_t *histogram);
+
+/**
+ * @brief Estima um percentil (0-100) a partir do histograma
+ *
+ * @return Limite superior da sub-faixa que contém o percentil, limitado ao
+ *         máximo observado; 0 se o histograma está vazio
+ */
+uint32_t latency_trace_percentile(const latency_histogram_t *histogram, float percentile);
+
+/**
+ * @brief Nome curto da regra, para relatórios
+ */
+const char *latency_trace_rule_name(latency_rule_t rule);
+
+#endif // LATENCY_TRACE_H
@@ -0,0 +1,22 @@
+/**
+ * @file message_pools.c
+ * @brief Armazenamento e preparação dos pools tipados do firmware
+ */
+#include "message_pools.h"
+
+BLOCK_POOL_STORAGE(telemetry_frame_pool, telemetry_frame_t, TELEMETRY_FRAME_BLOCKS);
+
+block_pool_t telemetry_frame_pool;
+
+static block_pool_t *const message_pools[MESSAGE_POOL_COUNT] = {
+    [MESSAGE_POOL_TELEMETRY_FRAME] = &telemetry_frame_pool,
+};
+
+void message_pools_init(void) {
+    BLOCK_POOL_SETUP(telemetry_frame_pool);
+}
+
+const char *message_pools_stats(message_pool_id_t id, block_pool_stats_t *stats) {
+    block_pool_stats(message_pools[id], stats);
+    return message_pools[id]->name;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file message_pools.h
+ * @brief Pools de blocos tipados do firmware: quadros de telemetria
+ *
+ * Buffers que passam de um contexto a outro (de uma interrupção ou do
+ * core 1 para o laço principal, do laço para a rede) saem destes pools,
+ * e não do heap: cada tipo tem um número fixo de blocos, reservado em
+ * tempo de compilação, e alocar ou liberar custa sempre o mesmo
+ * (block_pool.h). Quem recebe um bloco é responsável por devolvê-lo ao
+ * mesmo pool. Um tipo só ganha pool quando tem quem o aloque: cada
+ * pool reserva RAM e um spinlock de hardware mesmo sem uso.
+ *
+ * O dimensionamento parte do uso esperado; message_pools_stats() mostra
+ * o pico de uso (high-water) e as alocações negadas de cada pool, para
+ * ajustar as contagens abaixo.
+ */
+#ifndef MESSAGE_POOLS_H
+#define MESSAGE_POOLS_H
+
+#include <stdint.h>
+
+#include "block_pool.h"
+#include "store_forward.h"
+
+#define TELEMETRY_FRAME_BLOCKS 8        // Quadros prontos esperando o enlace (fluxo ao vivo)
+
+/**
+ * @brief Um registro de telemetria codificado, do tamanho máximo da fila de reenvio
+ */
+typedef struct {
+    uint16_t len;
+    uint8_t refs;               // Donos do quadro (ws_server.c: clientes com ele na fila)
+    uint8_t data[STORE_FORWARD_RECORD_MAX];
+} telemetry_frame_t;
+
+typedef enum {
+    MESSAGE_POOL_TELEMETRY_FRAME,
+    MESSAGE_POOL_COUNT,
+} message_pool_id_t;
+
+extern block_pool_t telemetry_frame_pool;
+
+/**
+ * @brief Prepara os pools (uma vez, antes de qualquer alocação)
+ */
+void message_pools_init(void);
+
+static inline telemetry_frame_t *telemetry_frame_alloc(void) {
+    return (telemetry_frame_t *)block_pool_alloc(&telemetry_frame_pool);
+}
+
+static inline void telemetry_frame_free(telemetry_frame_t *frame) {
+    block_pool_free(&telemetry_frame_pool, frame);
+}
+
+/**
+ * @brief Contadores de um pool e o seu nome
+ *
+ * @return Nome do pool ("telemetry_frame_pool", ...)
+ */
+const char *message_pools_stats(message_pool_id_t id, block_pool_stats_t *stats);
+
+#endif // MESSAGE_POOLS_H
@@ -0,0 +1,144 @@
+/**
+ * @file mq2_heater.c
+ * @brief Implementação da máquina de estados do aquecedor do MQ2
+ */
+#include "mq2_heater.h"
+
+#include "pico/stdlib.h"
+#include "exec_trace.h"
+
+typedef struct {
+    uint32_t pin;
+    mq2_heater_ready_fn on_ready;
+    mq2_heater_state_t state;
+    uint32_t state_ms;              // Entrada no estado atual
+    uint32_t next_ms;
+    bool cold;                      // Aquecimento atual é a partida a frio
+
+    // Janela da detecção de estabilidade
+    uint32_t window_ms;
+    bool window_empty;
+    uint16_t window_min;
+    uint16_t window_max;
+
+    mq2_heater_stats_t stats;
+} mq2_heater_t;
+
+static mq2_heater_t heater;
+
+static void set_ready(bool ready) {
+    if (heater.on_ready) heater.on_ready(ready);
+}
+
+// Soma o tempo do estado que termina ao contador do aquecedor ligado ou desligado
+static void enter(mq2_heater_state_t state, uint32_t now_ms) {
+    uint32_t spent = now_ms - heater.state_ms;
+    if (heater.state == MQ2_HEATER_SLEEP) heater.stats.off_ms += spent;
+    else heater.stats.on_ms += spent;
+    heater.state = state;
+    heater.state_ms = now_ms;
+}
+
+static void start_warmup(uint32_t now_ms, bool cold) {
+    heater.cold = cold;
+    heater.window_ms = now_ms;
+    heater.window_empty = true;
+    heater.next_ms = now_ms + MQ2_HEATER_POLL_MS;
+}
+
+void mq2_heater_init(uint32_t heater_pin, mq2_heater_ready_fn on_ready, uint32_t now_ms) {
+    heater.pin = heater_pin;
+    heater.on_ready = on_ready;
+    heater.state = MQ2_HEATER_WARMUP;
+    heater.state_ms = now_ms;
+    heater.stats = (mq2_heater_stats_t){0};
+    set_ready(false);
+
+    gpio_init(heater_pin);
+    gpio_set_dir(heater_pin, GPIO_OUT);
+    gpio_put(heater_pin, 1);
+    EXEC_TRACE_INSTANT(EXEC_TRACE_MQ2_HEATER, 1);
+    start_warmup(now_ms, true);
+}
+
+/**
+ * @brief Aquecimento: estabilidade depois do mínimo, ou o máximo
+ */
+static void poll_warmup(uint32_t now_ms, uint16_t mq2_value) {
+    uint32_t min_ms = heater.cold ? MQ2_HEATER_WARMUP_MIN_MS : MQ2_HEATER_REWARM_MIN_MS;
+    uint32_t max_ms = heater.cold ? MQ2_HEATER_WARMUP_MAX_MS : MQ2_HEATER_REWARM_MAX_MS;
+    uint32_t elapsed = now_ms - heater.state_ms;
+
+    if (heater.window_empty) {
+        heater.window_min = heater.window_max = mq2_value;
+        heater.window_empty = false;
+    }
+    if (mq2_value < heater.window_min) heater.window_min = mq2_value;
+    if (mq2_value > heater.window_max) heater.window_max = mq2_value;
+
+    bool stable = false;
+    if (now_ms - heater.window_ms >= MQ2_HEATER_STABLE_MS) {
+        stable = heater.window_max - heater.window_min <= MQ2_HEATER_STABLE_DELTA;
+        heater.window_ms = now_ms;
+        heater.window_min = heater.window_max = mq2_value;
+    }
+
+    if ((stable && elapsed >= min_ms) || elapsed >= max_ms) {
+        if (!stable) heater.stats.forced++;
+        heater.stats.warmups++;
+        heater.stats.last_warmup_ms = elapsed;
+        enter(MQ2_HEATER_READY, now_ms);
+        set_ready(true);
+        heater.next_ms = now_ms + MQ2_HEATER_WINDOW_MS;
+    } else {
+        heater.next_ms = now_ms + MQ2_HEATER_POLL_MS;
+    }
+}
+
+void mq2_heater_poll(uint32_t now_ms, uint16_t mq2_value, bool alarm_active) {
+    if ((int32_t)(now_ms - heater.next_ms) < 0) return;
+
+    switch (heater.state) {
+    case MQ2_HEATER_WARMUP:
+        poll_warmup(now_ms, mq2_value);
+        break;
+    case MQ2_HEATER_READY:
+        if (MQ2_HEATER_OFF_MS == 0 || alarm_active) {
+            // Sem ciclo, ou com gás presente: a janela se estende
+            heater.next_ms = now_ms + MQ2_HEATER_WINDOW_MS;
+            break;
+        }
+        // Desarma antes de desligar: a leitura deriva assim que o elemento esfria
+        set_ready(false);
+        gpio_put(heater.pin, 0);
+        EXEC_TRACE_INSTANT(EXEC_TRACE_MQ2_HEATER, 0);
+        enter(MQ2_HEATER_SLEEP, now_ms);
+        heater.next_ms = now_ms + MQ2_HEATER_OFF_MS;
+        break;
+    case MQ2_HEATER_SLEEP:
+        gpio_put(heater.pin, 1);
+        EXEC_TRACE_INSTANT(EXEC_TRACE_MQ2_HEATER, 1);
+        enter(MQ2_HEATER_WARMUP, now_ms);
+        start_warmup(now_ms, false);
+        break;
+    }
+}
+
+uint32_t mq2_heater_next_ms(void) {
+    return heater.next_ms;
+}
+
+bool mq2_heater_is_ready(void) {
+    return heater.state == MQ2_HEATER_READY;
+}
+
+mq2_heater_state_t mq2_heater_state(void) {
+    return heater.state;
+}
+
+void mq2_heater_get_stats(uint32_t now_ms, mq2_heater_stats_t *stats) {
+    *stats = heater.stats;
+    uint32_t spent = now_ms - heater.state_ms;
+    if (heater.state == MQ2_HEATER_SLEEP) stats->off_ms += spent;
+    else stats->on_ms += spent;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file mq2_heater.h
+ * @brief Aquecedor do MQ2: detecção do aquecimento, ciclos de medição e prontidão
+ *
+ * O MQ2 só mede gás com o elemento aquecido. Logo depois de ligado, a
+ * saída passa minutos longe do valor real (em geral alta, acima do
+ * limiar do alarme), então as leituras desse período não valem nada.
+ * O aquecedor é alimentado por um GPIO (BOARD_MQ2_HEATER_PIN, por um
+ * transistor ou relé) e este módulo decide quando ligá-lo e quando as
+ * leituras do MQ2 são confiáveis:
+ *
+ * - WARMUP: aquecedor ligado, sensor não pronto. Termina quando a
+ *   leitura se estabiliza (variação de no máximo MQ2_HEATER_STABLE_DELTA
+ *   numa janela de MQ2_HEATER_STABLE_MS) depois de um tempo mínimo, ou
+ *   no tempo máximo, mesmo sem estabilizar (contado em forced).
+ * - READY: sensor pronto; é a janela de medição.
+ * - SLEEP: aquecedor desligado por MQ2_HEATER_OFF_MS; depois, volta a
+ *   WARMUP com os tempos do reaquecimento, mais curtos que os da partida
+ *   a frio.
+ *
+ * Com MQ2_HEATER_OFF_MS em 0 (padrão), o aquecedor fica ligado depois
+ * do primeiro aquecimento e o alarme mantém a latência de 1 ms de
+ * gas_alarm.h. Com o ciclo ativo, cada janela de medição dura
+ * MQ2_HEATER_WINDOW_MS e o aquecedor só desliga com o alarme inativo;
+ * um vazamento que comece logo depois do desligamento é detectado em até
+ * MQ2_HEATER_OFF_MS + MQ2_HEATER_REWARM_MAX_MS, que a compilação
+ * confere contra MQ2_HEATER_DETECTION_BOUND_MS.
+ *
+ * A prontidão é entregue ao callback de mq2_heater_init() sempre que
+ * muda, e antes de desligar o aquecedor: o alarme de gás deve ser
+ * desarmado antes que a leitura comece a derivar.
+ */
+#ifndef MQ2_HEATER_H
+#define MQ2_HEATER_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MQ2_HEATER_OK 0                     // Leitura do MQ2 válida (status no registro de sensores)
+#define MQ2_HEATER_NOT_READY -1             // Aquecedor desligado ou ainda aquecendo
+
+#ifndef MQ2_HEATER_OFF_MS
+#define MQ2_HEATER_OFF_MS 0                 // Aquecedor desligado por ciclo (0: sempre ligado)
+#endif
+#ifndef MQ2_HEATER_WINDOW_MS
+#define MQ2_HEATER_WINDOW_MS 10000          // Janela de medição com o sensor pronto, por ciclo
+#endif
+#ifndef MQ2_HEATER_DETECTION_BOUND_MS
+#define MQ2_HEATER_DETECTION_BOUND_MS 60000 // Maior atraso aceitável na detecção de um vazamento
+#endif
+
+#define MQ2_HEATER_WARMUP_MIN_MS 20000      // Partida a frio: tempo mínimo de aquecimento
+#define MQ2_HEATER_WARMUP_MAX_MS 180000     // Partida a frio: pronto mesmo sem estabilizar
+#define MQ2_HEATER_REWARM_MIN_MS 5000       // Reaquecimento depois de SLEEP
+#define MQ2_HEATER_REWARM_MAX_MS 20000
+#define MQ2_HEATER_STABLE_MS 2000           // Janela da detecção de estabilidade
+#define MQ2_HEATER_STABLE_DELTA 60          // Variação máxima na janela (código do ADC)
+#define MQ2_HEATER_POLL_MS 250              // Período de leitura durante o aquecimento
+
+static_assert(MQ2_HEATER_OFF_MS == 0 || MQ2_HEATER_OFF_MS + MQ2_HEATER_REWARM_MAX_MS <= MQ2_HEATER_DETECTION_BOUND_MS,
+              "o aquecedor desligado mais o reaquecimento excedem o atraso de detecção aceitável");
+
+typedef enum {
+    MQ2_HEATER_WARMUP,
+    MQ2_HEATER_READY,
+    MQ2_HEATER_SLEEP,
+} mq2_heater_state_t;
+
+/**
+ * @brief Recebe a prontidão do sensor (p.ex. gas_alarm_set_armed)
+ */
+typedef void (*mq2_heater_ready_fn)(bool ready);
+
+/**
+ * @brief Contadores do aquecedor
+ */
+typedef struct {
+    uint32_t on_ms;                 // Tempo total com o aquecedor ligado
+    uint32_t off_ms;                // Tempo total com o aquecedor desligado
+    uint32_t warmups;               // Aquecimentos concluídos (partida e reaquecimentos)
+    uint32_t forced;                // Aquecimentos encerrados pelo tempo máximo
+    uint32_t last_warmup_ms;        // Duração do último aquecimento concluído
+} mq2_heater_stats_t;
+
+/**
+ * @brief Configura o GPIO do aquecedor, liga-o e começa o aquecimento a frio
+ *
+ * on_ready é chamado em seguida com false.
+ */
+void mq2_heater_init(uint32_t heater_pin, mq2_heater_ready_fn on_ready, uint32_t now_ms);
+
+/**
+ * @brief Avança a máquina de estados
+ *
+ * Deve ser chamada a partir de mq2_heater_next_ms(); chamadas extras são
+ * inofensivas.
+ *
+ * @param mq2_value Leitura mais recente do MQ2 (código do ADC)
+ * @param alarm_active Estado do alarme de gás: o aquecedor não desliga com ele ativo
+ */
+void mq2_heater_poll(uint32_t now_ms, uint16_t mq2_value, bool alarm_active);
+
+/**
+ * @brief Instante da próxima chamada de mq2_heater_poll()
+ */
+uint32_t mq2_heater_next_ms(void);
+
+bool mq2_heater_is_ready(void);
+
+mq2_heater_state_t mq2_heater_state(void);
+
+/**
+ * @brief Contadores, com o tempo do estado atual somado até now_ms
+ */
+void mq2_heater_get_stats(uint32_t now_ms, mq2_heater_stats_t *stats);
+
+#endif // MQ2_HEATER_H
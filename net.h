@@ -0,0 +1,157 @@
+/**
+ * @file net.h
+ * @brief Rede mínima do firmware: Wi-Fi, resolução de nomes, UDP e servidor TCP
+ *
+ * Interface comum a duas implementações:
+ * - net_lwip.c, no dispositivo: rádio CYW43 da Pico W e lwIP em modo
+ *   "threadsafe background", em que o lwIP roda numa interrupção de
+ *   baixa prioridade. Os callbacks de recepção rodam nessa interrupção:
+ *   devem só copiar o pacote e sair.
+ * - host/net_socket.c, no host: sockets POSIX, com os callbacks
+ *   chamados de dentro de net_poll().
+ *
+ * Só IPv4. Os "sockets" UDP vêm de um conjunto fixo de NET_UDP_SOCKETS,
+ * sem heap.
+ *
+ * O TCP é só de servidor e por consulta, sem callbacks: uma porta em
+ * escuta, até NET_TCP_CONNECTIONS conexões, e leituras e escritas que
+ * nunca bloqueiam. net_tcp_send() aceita só o que cabe no buffer de envio
+ * da conexão e diz quanto aceitou; quem chama guarda o resto. No
+ * dispositivo, cada conexão tem um buffer de recepção de NET_TCP_RX_BYTES
+ * preenchido na interrupção do lwIP; cheio, o lwIP segura os dados e a
+ * janela do cliente fecha. Os dados enviados e ainda não confirmados
+ * ficam limitados a NET_TCP_TX_BYTES por conexão: o heap do lwIP é
+ * comum a todas, e um cliente que não lê não pode prendê-lo inteiro.
+ *
+ * Na Pico W, o rádio usa o GPIO 25 e o GPIO 29: com a rede, a captura do
+ * ADC não mede VSYS (ADC_CAPTURE_SAMPLE_VSYS em adc_capture.h).
+ */
+#ifndef NET_H
+#define NET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Códigos de retorno das operações de rede
+ */
+#define NET_OK 0                            // Operação realizada com sucesso
+#define NET_PENDING 1                       // Em andamento: repita a chamada mais tarde
+#define NET_ERROR_INIT -1                   // Falha ao iniciar o rádio ou a pilha
+#define NET_ERROR_DOWN -2                   // Sem enlace
+#define NET_ERROR_RESOLVE -3                // Nome não encontrado
+#define NET_ERROR_SEND -4                   // Pacote não enviado
+#define NET_ERROR_NO_SOCKET -5              // Todos os sockets em uso
+#define NET_ERROR_CLOSED -6                 // Conexão TCP fechada pelo outro lado ou perdida
+
+#define NET_UDP_SOCKETS 2                   // Sockets UDP simultâneos
+#define NET_UDP_MAX_PAYLOAD 512             // Maior pacote UDP recebido
+#ifndef NET_TCP_CONNECTIONS
+#define NET_TCP_CONNECTIONS 4               // Conexões TCP simultâneas
+#endif
+#ifndef NET_TCP_RX_BYTES
+#define NET_TCP_RX_BYTES 256                // Buffer de recepção de cada conexão (dispositivo)
+#endif
+#ifndef NET_TCP_TX_BYTES
+#define NET_TCP_TX_BYTES 1024               // Dados em voo por conexão
+#endif
+
+/**
+ * @brief Endereço IPv4, na ordem da rede
+ */
+typedef struct {
+    uint8_t bytes[4];
+} net_addr_t;
+
+/**
+ * @brief Recebe um pacote UDP (no dispositivo, dentro da interrupção do lwIP)
+ */
+typedef void (*net_udp_recv_fn)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct net_udp net_udp_t;
+typedef struct net_tcp_listener net_tcp_listener_t;
+typedef struct net_tcp net_tcp_t;
+
+/**
+ * @brief Inicia a rede e, no dispositivo, a conexão ao Wi-Fi (WIFI_SSID, WIFI_PASSWORD)
+ *
+ * Não espera a conexão: net_is_up() diz quando o enlace está pronto.
+ *
+ * @return NET_OK ou NET_ERROR_INIT
+ */
+int net_init(void);
+
+/**
+ * @brief Enlace pronto, com endereço IP
+ */
+bool net_is_up(void);
+
+/**
+ * @brief Trata os eventos pendentes (no host; no dispositivo, o lwIP roda sozinho)
+ */
+void net_poll(void);
+
+/**
+ * @brief Resolve um nome ou um endereço em texto
+ *
+ * @return NET_OK com addr preenchido, NET_PENDING enquanto a consulta
+ *         está em andamento ou um código de erro
+ */
+int net_resolve(const char *host, net_addr_t *addr);
+
+/**
+ * @brief Abre um socket UDP numa porta local livre
+ *
+ * @return O socket, ou NULL sem sockets livres ou sem enlace
+ */
+net_udp_t *net_udp_open(net_udp_recv_fn on_recv, void *ctx);
+
+/**
+ * @brief Envia um pacote
+ *
+ * @return NET_OK ou um código de erro
+ */
+int net_udp_sendto(net_udp_t *udp, const net_addr_t *addr, uint16_t port, const void *data, size_t len);
+
+void net_udp_close(net_udp_t *udp);
+
+/**
+ * @brief Abre a porta TCP de escuta (uma por vez)
+ *
+ * @param port Porta local; 0 escolhe uma livre (net_tcp_local_port())
+ * @return A porta em escuta, ou NULL
+ */
+net_tcp_listener_t *net_tcp_listen(uint16_t port);
+
+uint16_t net_tcp_local_port(const net_tcp_listener_t *listener);
+
+/**
+ * @brief Entrega a próxima conexão recebida
+ *
+ * Com as NET_TCP_CONNECTIONS em uso, novas conexões são recusadas.
+ *
+ * @return A conexão, ou NULL se não há nenhuma nova
+ */
+net_tcp_t *net_tcp_accept(net_tcp_listener_t *listener);
+
+/**
+ * @brief Lê o que já chegou, sem esperar
+ *
+ * @return Bytes lidos (0 se nada chegou) ou NET_ERROR_CLOSED
+ */
+int net_tcp_recv(net_tcp_t *conn, void *buf, size_t max);
+
+/**
+ * @brief Enfileira para envio o que couber no buffer da conexão, sem esperar
+ *
+ * @return Bytes aceitos (0 com o buffer cheio) ou NET_ERROR_CLOSED
+ */
+int net_tcp_send(net_tcp_t *conn, const void *data, size_t len);
+
+/**
+ * @brief Fecha a conexão e libera a vaga (também depois de NET_ERROR_CLOSED)
+ */
+void net_tcp_close(net_tcp_t *conn);
+
+#endif // NET_H
@@ -0,0 +1,276 @@
+/**
+ * @file net_lwip.c
+ * @brief Implementação de net.h com o rádio da Pico W e o lwIP
+ *
+ * O lwIP roda em modo "threadsafe background": os callbacks vêm de uma
+ * interrupção de baixa prioridade, e as chamadas a partir do laço
+ * principal ficam entre cyw43_arch_lwip_begin() e cyw43_arch_lwip_end().
+ *
+ * Cada conexão TCP ocupa uma vaga de tcp_conns do aceite até
+ * net_tcp_close(), mesmo depois que o lwIP libera o pcb (erro ou reset):
+ * a vaga só volta a aceitar quando o laço principal solta a conexão.
+ */
+#include "net.h"
+
+#include <string.h>
+
+#include "pico/cyw43_arch.h"
+#include "lwip/dns.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+
+#ifndef WIFI_SSID
+#error "defina WIFI_SSID e WIFI_PASSWORD (opções do CMake) para compilar com a rede"
+#endif
+
+struct net_udp {
+    struct udp_pcb *pcb;
+    net_udp_recv_fn on_recv;
+    void *ctx;
+};
+
+struct net_tcp_listener {
+    struct tcp_pcb *pcb;
+};
+
+struct net_tcp {
+    struct tcp_pcb *pcb;            // NULL depois de um erro: o lwIP já liberou
+    bool in_use;                    // Vaga ocupada até net_tcp_close()
+    bool accepted;                  // Já entregue por net_tcp_accept()
+    volatile bool closed;           // Fim de fluxo ou erro, da interrupção do lwIP
+    uint16_t rx_len;
+    uint8_t rx[NET_TCP_RX_BYTES];
+};
+
+static net_udp_t udp_sockets[NET_UDP_SOCKETS];
+static net_tcp_listener_t tcp_listener;
+static net_tcp_t tcp_conns[NET_TCP_CONNECTIONS];
+
+// Uma consulta de DNS por vez; o resultado fica até a próxima
+static struct {
+    const char *host;
+    volatile int status;
+    ip_addr_t addr;
+} lookup;
+
+int net_init(void) {
+    if (cyw43_arch_init()) return NET_ERROR_INIT;
+    cyw43_arch_enable_sta_mode();
+    if (cyw43_arch_wifi_connect_async(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK)) return NET_ERROR_INIT;
+    return NET_OK;
+}
+
+bool net_is_up(void) {
+    return cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA) == CYW43_LINK_UP;
+}
+
+void net_poll(void) {}
+
+static void addr_from_lwip(const ip_addr_t *ip, net_addr_t *addr) {
+    uint32_t a = ip4_addr_get_u32(ip_2_ip4(ip));   // Já na ordem da rede
+    memcpy(addr->bytes, &a, 4);
+}
+
+static void dns_found(const char *name, const ip_addr_t *ip, void *arg) {
+    (void)name;
+    (void)arg;
+    if (ip) lookup.addr = *ip;
+    lookup.status = ip ? NET_OK : NET_ERROR_RESOLVE;
+}
+
+int net_resolve(const char *host, net_addr_t *addr) {
+    if (!net_is_up()) return NET_ERROR_DOWN;
+    if (lookup.host == host && lookup.status != NET_PENDING) {
+        int status = lookup.status;
+        if (status == NET_OK) addr_from_lwip(&lookup.addr, addr);
+        lookup.host = NULL;
+        return status;
+    }
+    if (lookup.host == host) return NET_PENDING;
+
+    ip_addr_t ip;
+    lookup.host = host;
+    lookup.status = NET_PENDING;
+    cyw43_arch_lwip_begin();
+    err_t err = dns_gethostbyname(host, &ip, dns_found, NULL);
+    cyw43_arch_lwip_end();
+    if (err == ERR_INPROGRESS) return NET_PENDING;
+    lookup.host = NULL;
+    if (err != ERR_OK) return NET_ERROR_RESOLVE;
+    addr_from_lwip(&ip, addr);
+    return NET_OK;
+}
+
+static void udp_received(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port) {
+    (void)pcb;
+    (void)addr;
+    (void)port;
+    net_udp_t *udp = arg;
+    uint8_t data[NET_UDP_MAX_PAYLOAD];
+    size_t len = pbuf_copy_partial(p, data, sizeof(data), 0);
+    pbuf_free(p);
+    udp->on_recv(udp->ctx, data, len);
+}
+
+net_udp_t *net_udp_open(net_udp_recv_fn on_recv, void *ctx) {
+    for (int i = 0; i < NET_UDP_SOCKETS; i++) {
+        net_udp_t *udp = &udp_sockets[i];
+        if (udp->pcb) continue;
+        cyw43_arch_lwip_begin();
+        udp->pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+        if (udp->pcb) {
+            udp->on_recv = on_recv;
+            udp->ctx = ctx;
+            udp_recv(udp->pcb, udp_received, udp);
+        }
+        cyw43_arch_lwip_end();
+        return udp->pcb ? udp : NULL;
+    }
+    return NULL;
+}
+
+int net_udp_sendto(net_udp_t *udp, const net_addr_t *addr, uint16_t port, const void *data, size_t len) {
+    ip_addr_t ip;
+    IP_ADDR4(&ip, addr->bytes[0], addr->bytes[1], addr->bytes[2], addr->bytes[3]);
+    cyw43_arch_lwip_begin();
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)len, PBUF_RAM);
+    err_t err = ERR_MEM;
+    if (p) {
+        memcpy(p->payload, data, len);
+        err = udp_sendto(udp->pcb, p, &ip, port);
+        pbuf_free(p);
+    }
+    cyw43_arch_lwip_end();
+    return err == ERR_OK ? NET_OK : NET_ERROR_SEND;
+}
+
+void net_udp_close(net_udp_t *udp) {
+    cyw43_arch_lwip_begin();
+    udp_remove(udp->pcb);
+    cyw43_arch_lwip_end();
+    udp->pcb = NULL;
+}
+
+static err_t tcp_received(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    (void)err;
+    net_tcp_t *conn = arg;
+    if (!p) {
+        conn->closed = true;
+        return ERR_OK;
+    }
+    // Sem espaço, o lwIP guarda o pbuf e entrega de novo mais tarde
+    if (p->tot_len > sizeof(conn->rx) - conn->rx_len) return ERR_MEM;
+    conn->rx_len += pbuf_copy_partial(p, conn->rx + conn->rx_len, p->tot_len, 0);
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static void tcp_failed(void *arg, err_t err) {
+    (void)err;
+    net_tcp_t *conn = arg;
+    conn->pcb = NULL;
+    conn->closed = true;
+}
+
+static err_t tcp_accepted(void *arg, struct tcp_pcb *pcb, err_t err) {
+    (void)arg;
+    if (err != ERR_OK || !pcb) return ERR_VAL;
+    for (int i = 0; i < NET_TCP_CONNECTIONS; i++) {
+        net_tcp_t *conn = &tcp_conns[i];
+        if (conn->in_use) continue;
+        conn->pcb = pcb;
+        conn->in_use = true;
+        conn->accepted = false;
+        conn->closed = false;
+        conn->rx_len = 0;
+        tcp_arg(pcb, conn);
+        tcp_recv(pcb, tcp_received);
+        tcp_err(pcb, tcp_failed);
+        tcp_nagle_disable(pcb);
+        return ERR_OK;
+    }
+    tcp_abort(pcb);
+    return ERR_ABRT;
+}
+
+net_tcp_listener_t *net_tcp_listen(uint16_t port) {
+    if (tcp_listener.pcb) return NULL;
+    cyw43_arch_lwip_begin();
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+    if (pcb && tcp_bind(pcb, IP_ADDR_ANY, port) == ERR_OK) {
+        tcp_listener.pcb = tcp_listen_with_backlog(pcb, NET_TCP_CONNECTIONS);
+        if (tcp_listener.pcb) tcp_accept(tcp_listener.pcb, tcp_accepted);
+        else tcp_close(pcb);
+    } else if (pcb) {
+        tcp_close(pcb);
+    }
+    cyw43_arch_lwip_end();
+    return tcp_listener.pcb ? &tcp_listener : NULL;
+}
+
+uint16_t net_tcp_local_port(const net_tcp_listener_t *listener) {
+    return listener->pcb->local_port;
+}
+
+net_tcp_t *net_tcp_accept(net_tcp_listener_t *listener) {
+    (void)listener;
+    net_tcp_t *found = NULL;
+    cyw43_arch_lwip_begin();
+    for (int i = 0; i < NET_TCP_CONNECTIONS && !found; i++) {
+        net_tcp_t *conn = &tcp_conns[i];
+        if (conn->in_use && !conn->accepted) {
+            conn->accepted = true;
+            found = conn;
+        }
+    }
+    cyw43_arch_lwip_end();
+    return found;
+}
+
+int net_tcp_recv(net_tcp_t *conn, void *buf, size_t max) {
+    cyw43_arch_lwip_begin();
+    size_t n = conn->rx_len < max ? conn->rx_len : max;
+    memcpy(buf, conn->rx, n);
+    memmove(conn->rx, conn->rx + n, conn->rx_len - n);
+    conn->rx_len -= (uint16_t)n;
+    bool closed = conn->closed;
+    cyw43_arch_lwip_end();
+    return n || !closed ? (int)n : NET_ERROR_CLOSED;
+}
+
+int net_tcp_send(net_tcp_t *conn, const void *data, size_t len) {
+    int result = NET_ERROR_CLOSED;
+    cyw43_arch_lwip_begin();
+    if (conn->pcb && !conn->closed) {
+        // Em voo: o que saiu do buffer de envio e ainda não foi confirmado
+        size_t in_flight = TCP_SND_BUF - tcp_sndbuf(conn->pcb);
+        size_t n = in_flight < NET_TCP_TX_BYTES ? NET_TCP_TX_BYTES - in_flight : 0;
+        if (n > tcp_sndbuf(conn->pcb)) n = tcp_sndbuf(conn->pcb);
+        if (n > len) n = len;
+        if (tcp_sndqueuelen(conn->pcb) >= TCP_SND_QUEUELEN) n = 0;
+        err_t err = n ? tcp_write(conn->pcb, data, (u16_t)n, TCP_WRITE_FLAG_COPY) : ERR_OK;
+        if (err == ERR_OK) {
+            if (n) tcp_output(conn->pcb);
+            result = (int)n;
+        } else if (err == ERR_MEM) {
+            result = 0;
+        }
+    }
+    cyw43_arch_lwip_end();
+    return result;
+}
+
+void net_tcp_close(net_tcp_t *conn) {
+    cyw43_arch_lwip_begin();
+    if (conn->pcb) {
+        tcp_arg(conn->pcb, NULL);
+        tcp_recv(conn->pcb, NULL);
+        tcp_err(conn->pcb, NULL);
+        if (tcp_close(conn->pcb) != ERR_OK) tcp_abort(conn->pcb);
+        conn->pcb = NULL;
+    }
+    conn->in_use = false;
+    cyw43_arch_lwip_end();
+}
@@ -1,17 +1,12 @@
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h"
+#include "board.h"
 #include "dht22.h"
 #include <stdio.h>
 #include <string.h>
 
-// GPIOs
-#define DHT_PIN 2
-#define LDR_PIN 26
-#define MQ2_PIN 27
-#define SERVO_PIN 3
-#define LED_PIN 4
-#define RELE_PIN 5
+// GPIOs: board.h, gerado de diagram.json
 
 
 // Converte valor ADC para tensão (0 - 3.3V)
@@ -39,21 +34,21 @@ int main() {
     stdio_init_all();
 
     // GPIOs
-    gpio_init(LED_PIN);
-    gpio_set_dir(LED_PIN, GPIO_OUT);
-    gpio_put(LED_PIN, 0);
+    gpio_init(BOARD_RED_LED_PIN);
+    gpio_set_dir(BOARD_RED_LED_PIN, GPIO_OUT);
+    gpio_put(BOARD_RED_LED_PIN, 0);
 
-    gpio_init(RELE_PIN);
-    gpio_set_dir(RELE_PIN, GPIO_OUT);
-    gpio_put(RELE_PIN, 0);
+    gpio_init(BOARD_RELE_PIN);
+    gpio_set_dir(BOARD_RELE_PIN, GPIO_OUT);
+    gpio_put(BOARD_RELE_PIN, 0);
 
-    dht22_init(DHT_PIN);
-    init_pwm_servo(SERVO_PIN);
+    dht22_init(BOARD_DHT22_PIN);
+    init_pwm_servo(BOARD_SERVO_PIN);
 
     // Inicializa ADC
     adc_init();
-    adc_gpio_init(LDR_PIN);
-    adc_gpio_init(MQ2_PIN);
+    adc_gpio_init(BOARD_LDR_PIN);
+    adc_gpio_init(BOARD_MQ2_PIN);
 
     while (1) {
         // --- Temperatura ---        
@@ -64,32 +59,32 @@ int main() {
         int resultado = dht22_read(&temp, &umid);
         
         if (temp > 30.0) {
-            set_servo_angle(SERVO_PIN, 180.0f); // Alerta físico
+            set_servo_angle(BOARD_SERVO_PIN, 180.0f); // Alerta físico
             strcpy(motor, "\t --- MOTOR ACIONADO!");
         } else {
-            set_servo_angle(SERVO_PIN, 0.0f);
+            set_servo_angle(BOARD_SERVO_PIN, 0.0f);
         }
 
         // --- LDR ---
-        adc_select_input(0); // GPIO 26
+        adc_select_input(BOARD_LDR_ADC_CHANNEL);
         uint16_t ldr_raw = adc_read();
         float ldr_v = adc_to_voltage(ldr_raw);
         if (ldr_v < 1.5) { // Limiar de luminosidade baixa
-            gpio_put(LED_PIN, 1);
+            gpio_put(BOARD_RED_LED_PIN, 1);
             strcpy(ilum, "\t --- LED ACIONADO!");
         } else {
-            gpio_put(LED_PIN, 0);
+            gpio_put(BOARD_RED_LED_PIN, 0);
         }
 
         // --- MQ-2 ---
-        adc_select_input(1); // GPIO 27
+        adc_select_input(BOARD_MQ2_ADC_CHANNEL);
         uint16_t mq2_raw = adc_read();
         float mq2_percent = (mq2_raw/4095.0f)*100.0f;
         if (mq2_percent > 50.0) { // Limiar de gás detectado
-            gpio_put(RELE_PIN, 1);
+            gpio_put(BOARD_RELE_PIN, 1);
             strcpy(alarm, "\t --- ALARME ACIONADO!");
         } else {
-            gpio_put(RELE_PIN, 0);
+            gpio_put(BOARD_RELE_PIN, 0);
         }
         printf("Temperatura: %.2f °C %s\n", temp, motor);
         printf("Luminosidade: %.2f \n", ldr_v);
@@ -0,0 +1,113 @@
+/**
+ * @file running_median.c
+ * @brief Implementação da mediana móvel com heap duplo indexável
+ */
+#include "running_median.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#if PICO_ON_DEVICE
+#include "pico.h"
+#define RUNNING_MEDIAN_FUNC(f) __not_in_flash_func(f)
+#else
+#define RUNNING_MEDIAN_FUNC(f) f
+#endif
+
+// Índice da janela na posição i do heap duplo (i < 0: máximo, i > 0: mínimo)
+#define HEAP(m, i) ((m)->heap[(m)->half + (i)])
+
+static inline bool RUNNING_MEDIAN_FUNC(heap_less)(const running_median_t *m, int i, int j) {
+    return m->value[HEAP(m, i)] < m->value[HEAP(m, j)];
+}
+
+// Troca as posições i e j se o valor em i for menor; devolve se trocou
+static inline bool RUNNING_MEDIAN_FUNC(heap_order)(running_median_t *m, int i, int j) {
+    if (!heap_less(m, i, j)) return false;
+    uint8_t t = HEAP(m, i);
+    HEAP(m, i) = HEAP(m, j);
+    HEAP(m, j) = t;
+    m->pos[HEAP(m, i)] = (int8_t)i;
+    m->pos[HEAP(m, j)] = (int8_t)j;
+    return true;
+}
+
+static inline int RUNNING_MEDIAN_FUNC(min_count)(const running_median_t *m) {
+    return (m->count - 1) / 2;
+}
+
+static inline int RUNNING_MEDIAN_FUNC(max_count)(const running_median_t *m) {
+    return m->count / 2;
+}
+
+// Desce pelo heap de mínimo a partir do filho i
+static void RUNNING_MEDIAN_FUNC(min_sort_down)(running_median_t *m, int i) {
+    int n = min_count(m);
+    for (; i <= n; i *= 2) {
+        if (i > 1 && i < n && heap_less(m, i + 1, i)) i++;
+        if (!heap_order(m, i, i / 2)) break;
+    }
+}
+
+// Desce pelo heap de máximo a partir do filho i (negativo)
+static void RUNNING_MEDIAN_FUNC(max_sort_down)(running_median_t *m, int i) {
+    int n = max_count(m);
+    for (; i >= -n; i *= 2) {
+        if (i < -1 && i > -n && heap_less(m, i, i - 1)) i--;
+        if (!heap_order(m, i / 2, i)) break;
+    }
+}
+
+// Sobe pelo heap de mínimo; devolve se chegou à mediana
+static bool RUNNING_MEDIAN_FUNC(min_sort_up)(running_median_t *m, int i) {
+    while (i > 0 && heap_order(m, i, i / 2)) i /= 2;
+    return i == 0;
+}
+
+static bool RUNNING_MEDIAN_FUNC(max_sort_up)(running_median_t *m, int i) {
+    while (i < 0 && heap_order(m, i / 2, i)) i /= 2;
+    return i == 0;
+}
+
+void running_median_init(running_median_t *m, uint8_t window) {
+    memset(m, 0, sizeof(*m));
+    m->window = window ? window : 1;
+    m->half = m->window / 2;
+
+    // Posições 0, -1, 1, -2, 2...: os heaps crescem alternados enquanto a janela enche
+    for (int k = 0; k < m->window; k++) {
+        int p = ((k + 1) / 2) * ((k & 1) ? -1 : 1);
+        m->pos[k] = (int8_t)p;
+        HEAP(m, p) = (uint8_t)k;
+    }
+}
+
+int32_t RUNNING_MEDIAN_FUNC(running_median_push)(running_median_t *m, int32_t value) {
+    bool filling = m->count < m->window;
+    int p = m->pos[m->next];
+    int32_t old = m->value[m->next];
+
+    m->value[m->next] = value;
+    m->next = m->next + 1 == m->window ? 0 : m->next + 1;
+    m->count += filling;
+
+    if (p > 0) {
+        // Heap de mínimo: desce se cresceu, senão sobe e talvez troque a mediana
+        if (!filling && old < value) {
+            min_sort_down(m, p * 2);
+        } else if (min_sort_up(m, p)) {
+            max_sort_down(m, -1);
+        }
+    } else if (p < 0) {
+        if (!filling && value < old) {
+            max_sort_down(m, p * 2);
+        } else if (max_sort_up(m, p)) {
+            min_sort_down(m, 1);
+        }
+    } else {
+        // A própria mediana foi substituída: confere os dois lados
+        if (max_count(m)) max_sort_down(m, -1);
+        if (min_count(m)) min_sort_down(m, 1);
+    }
+    return m->value[HEAP(m, 0)];
+}
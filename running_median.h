@@ -0,0 +1,60 @@
+/**
+ * @file running_median.h
+ * @brief Mediana móvel em O(log n) por amostra, em memória estática
+ *
+ * Rejeita picos de uma amostra (ruído do ADC, decodificações erradas do
+ * DHT22) antes da avaliação dos limiares: com janela w, um pico isolado
+ * só passa se durar (w + 1) / 2 amostras; em troca, um degrau chega à
+ * saída (w - 1) / 2 amostras depois.
+ *
+ * A estrutura é um heap duplo indexável sobre a janela circular: as
+ * posições negativas formam um heap de máximo com os valores abaixo da
+ * mediana, as positivas um heap de mínimo com os de cima, e a posição 0
+ * é a mediana. Cada valor da janela sabe sua posição no heap, então o
+ * valor mais antigo é substituído no lugar pelo novo e só precisa
+ * descer ou subir pelo seu heap: O(log w) trocas por amostra.
+ *
+ * Todo o armazenamento está na própria estrutura, para janelas de até
+ * RUNNING_MEDIAN_MAX_WINDOW. Janelas ímpares dão a mediana exata; com
+ * janela par, sai um dos dois valores centrais. No dispositivo, o código
+ * fica em RAM, pois roda na interrupção do DMA (adc_capture.h), que segue
+ * ativa durante escritas na flash.
+ */
+#ifndef RUNNING_MEDIAN_H
+#define RUNNING_MEDIAN_H
+
+#include <stdint.h>
+
+#define RUNNING_MEDIAN_MAX_WINDOW 255
+
+typedef struct {
+    int32_t value[RUNNING_MEDIAN_MAX_WINDOW];   // Janela circular
+    int8_t pos[RUNNING_MEDIAN_MAX_WINDOW];      // Posição de cada valor no heap duplo
+    uint8_t heap[RUNNING_MEDIAN_MAX_WINDOW];    // Valor da janela em cada posição, deslocada de half
+    uint8_t window;
+    uint8_t half;                               // Deslocamento da posição 0 (a mediana)
+    uint8_t count;                              // Valores na janela (até window)
+    uint8_t next;                               // Próximo valor a substituir
+} running_median_t;
+
+/**
+ * @brief Prepara o filtro com a janela dada (1 a RUNNING_MEDIAN_MAX_WINDOW)
+ */
+void running_median_init(running_median_t *m, uint8_t window);
+
+/**
+ * @brief Acrescenta um valor, descartando o mais antigo com a janela cheia
+ *
+ * @return A mediana dos valores na janela (enquanto ela não enche, dos
+ *         valores recebidos até aqui)
+ */
+int32_t running_median_push(running_median_t *m, int32_t value);
+
+/**
+ * @brief Mediana atual (sem valores: 0)
+ */
+static inline int32_t running_median_value(const running_median_t *m) {
+    return m->count ? m->value[m->heap[m->half]] : 0;
+}
+
+#endif // RUNNING_MEDIAN_H
@@ -0,0 +1,87 @@
+/**
+ * @file running_median_bench.c
+ * @brief Benchmark no RP2040 da mediana móvel por tamanho de janela
+ *
+ * Firmware à parte (alvo running_median_bench): alimenta um filtro de
+ * running_median.h com amostras de 12 bits com picos, como as do ADC,
+ * para janelas de 5 a 255, e conta com o SysTick os ciclos médios por
+ * amostra, descontando o custo da própria medição. O resultado sai na
+ * serial a cada 5 s.
+ *
+ * No dispositivo, running_median_push roda da RAM (como na interrupção
+ * do DMA); a primeira passada enche a janela e não entra na conta. O
+ * equivalente no host é host/running_median_bench.cpp.
+ */
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#include "running_median.h"
+
+#define BENCH_SAMPLES 1024
+#define BENCH_PASSES 8
+#define SYSTICK_MAX 0x00FFFFFFu     // Contador decrescente de 24 bits
+
+static const uint8_t windows[] = {5, 9, 15, 31, 63, 127, 255};
+
+static int32_t samples[BENCH_SAMPLES];
+static running_median_t median;
+static uint32_t rng = 12345;
+
+static uint32_t next_random(void) {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// Sinal lento com ruído e 1/32 de picos até o fundo de escala
+static void build_samples(void) {
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        int32_t v = 2048 + (i % 256) * 4 + (int32_t)(next_random() % 31) - 15;
+        if (next_random() % 32 == 0) v = (next_random() & 1) ? 4095 : 0;
+        samples[i] = v;
+    }
+}
+
+static int32_t null_push(running_median_t *m, int32_t value) {
+    (void)m;
+    return value;
+}
+
+/**
+ * @brief Ciclos médios por amostra com a janela dada
+ */
+static uint32_t measure(uint8_t window, int32_t (*push)(running_median_t *, int32_t)) {
+    uint64_t total = 0;
+    running_median_init(&median, window);
+    for (int pass = 0; pass <= BENCH_PASSES; pass++) {
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            uint32_t c0 = systick_hw->cvr;
+            push(&median, samples[i]);
+            uint32_t c1 = systick_hw->cvr;
+            if (pass) total += (c0 - c1) & SYSTICK_MAX;
+        }
+    }
+    return (uint32_t)(total / (BENCH_PASSES * BENCH_SAMPLES));
+}
+
+int main() {
+    stdio_init_all();
+    build_samples();
+
+    systick_hw->rvr = SYSTICK_MAX;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    while (true) {
+        uint32_t mhz = clock_get_hz(clk_sys) / 1000000u;
+        uint32_t overhead = measure(1, null_push);
+        for (size_t w = 0; w < sizeof(windows); w++) {
+            uint32_t cycles = measure(windows[w], running_median_push) - overhead;
+            printf("mediana, janela %3u: %lu ciclos/amostra (%lu ns a %lu MHz)\n", windows[w],
+                   (unsigned long)cycles, (unsigned long)(cycles * 1000u / mhz), (unsigned long)mhz);
+        }
+        sleep_ms(5000);
+    }
+}
@@ -0,0 +1,306 @@
+/**
+ * @file sensor_pipeline.h
+ * @brief Cadeias de processamento de canais do ADC compostas como tipos (C++17, só cabeçalho)
+ *
+ * Uma cadeia é a lista de etapas de um canal, da fonte ao atuador:
+ * @code
+ * using Mq2 = sensor_pipeline::Pipeline<sensor_pipeline::Channel<ADC_CAPTURE_CHANNELS, ADC_CAPTURE_MQ2>,
+ *                                       sensor_pipeline::Median<3>,
+ *                                       sensor_pipeline::LatchAbove<GAS_ALARM_DEFAULT_THRESHOLD>,
+ *                                       sensor_pipeline::Actuator<Relay>>;
+ * @endcode
+ * Cada etapa é uma struct com o próprio estado e um operator() que
+ * transforma a amostra no lugar; os parâmetros (janelas, limiares,
+ * deslocamentos) são argumentos do template. Pipeline guarda as etapas
+ * numa std::tuple e as encadeia por uma expressão de dobra, então
+ * run() vira um único laço por canal, com todas as etapas expandidas
+ * dentro dele: sem funções virtuais, ponteiros de função nem heap, e o
+ * estado inteiro cabe num objeto estático.
+ *
+ * Protocolo das etapas:
+ * - bool operator()(int32_t &v): transforma v; devolve false para
+ *   absorver a amostra (decimação), e as etapas seguintes não a veem;
+ * - bool end_block(int32_t &v), opcional: chamada por
+ *   Pipeline::end_block() depois de cada bloco; devolve true se produziu
+ *   um valor em v, que segue pelas etapas seguintes como uma amostra.
+ *
+ * Os filtros reproduzem os módulos em C do firmware: Median<W> dá a
+ * mesma saída de running_median_push() (inclusive enquanto a janela
+ * enche), Hysteresis<L, L> é o limiar do LDR em ldr_monitoring() e
+ * LatchAbove<L> é a regra por bloco de gas_alarm_on_block(). A
+ * comparação de ciclos com esse código em C está em
+ * sensor_pipeline_bench.cpp (RP2040) e host/sensor_pipeline_bench.cpp.
+ *
+ * Não depende do SDK do Pico; os atuadores recebem o estado por um
+ * objeto chamável (por exemplo, um que chame gpio_put()).
+ */
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace sensor_pipeline {
+
+/**
+ * @brief Fonte: amostras Offset, Offset + Stride, ... de um bloco intercalado
+ *
+ * Com Stride igual ao número de entradas do round-robin, seleciona um
+ * canal dos blocos de adc_capture.h.
+ */
+template <std::size_t Stride, std::size_t Offset>
+struct Channel {
+    static_assert(Stride > 0 && Offset < Stride, "canal fora do bloco");
+    static constexpr std::size_t stride = Stride;
+    static constexpr std::size_t offset = Offset;
+};
+
+/**
+ * @brief Média de N amostras consecutivas: uma saída a cada N entradas
+ */
+template <unsigned N>
+struct Oversample {
+    static_assert(N > 0, "sobreamostragem de zero amostras");
+    int32_t sum = 0;
+    unsigned count = 0;
+
+    bool operator()(int32_t &v) {
+        sum += v;
+        if (++count < N) return false;
+        v = sum / (int32_t)N;
+        sum = 0;
+        count = 0;
+        return true;
+    }
+};
+
+/**
+ * @brief Deixa passar só a última de cada N amostras
+ *
+ * Equivale a ler o valor mais recente a cada N amostras, como o laço
+ * principal faz com o registro de sensores.
+ */
+template <unsigned N>
+struct Decimate {
+    static_assert(N > 0, "decimação por zero");
+    unsigned count = 0;
+
+    bool operator()(int32_t &) {
+        if (++count < N) return false;
+        count = 0;
+        return true;
+    }
+};
+
+/**
+ * @brief Mediana móvel de W amostras, com a janela mantida ordenada
+ *
+ * Para as janelas curtas do ADC, deslocar alguns valores custa menos
+ * que os heaps de running_median.h, que ganham a partir de dezenas de
+ * amostras. A saída é a mesma: enquanto a janela enche, o valor de
+ * índice count / 2 dos recebidos, em ordem.
+ */
+template <unsigned W>
+struct Median {
+    static_assert(W > 0 && W <= 255, "janela de 1 a 255 amostras");
+    int32_t ring[W] = {};
+    int32_t sorted[W] = {};
+    unsigned count = 0;
+    unsigned next = 0;
+
+    bool operator()(int32_t &v) {
+        unsigned n = count;
+        if (n == W) {
+            // Retira o valor mais antigo, fechando o espaço dele
+            int32_t old = ring[next];
+            unsigned i = 0;
+            while (sorted[i] != old) i++;
+            for (; i + 1 < W; i++) sorted[i] = sorted[i + 1];
+            n = W - 1;
+        } else {
+            count++;
+        }
+        ring[next] = v;
+        next = next + 1 == W ? 0 : next + 1;
+
+        unsigned i = n;
+        for (; i > 0 && sorted[i - 1] > v; i--) sorted[i] = sorted[i - 1];
+        sorted[i] = v;
+        v = sorted[count / 2];
+        return true;
+    }
+};
+
+/**
+ * @brief Média móvel exponencial com peso 2^-Shift para a amostra nova
+ *
+ * O acumulador guarda a média com Shift bits de fração; a primeira
+ * amostra o inicializa, para não partir de zero.
+ */
+template <unsigned Shift>
+struct Ewma {
+    static_assert(Shift < 16, "peso menor que 2^-15 estoura o acumulador de códigos de 12 bits");
+    int32_t acc = 0;
+    bool primed = false;
+
+    bool operator()(int32_t &v) {
+        if (!primed) {
+            acc = v * (1 << Shift);
+            primed = true;
+        } else {
+            acc += v - (acc >> Shift);
+        }
+        v = (acc + (1 << Shift >> 1)) >> Shift;
+        return true;
+    }
+};
+
+/**
+ * @brief Histerese: liga acima de On, desliga em Off ou abaixo; a saída é 0 ou 1
+ *
+ * Com On == Off é um limiar simples, como o do LDR.
+ */
+template <int32_t On, int32_t Off>
+struct Hysteresis {
+    static_assert(Off <= On, "o limiar de desligar deve ser o menor");
+    bool on = false;
+
+    bool operator()(int32_t &v) {
+        on = on ? v > Off : v > On;
+        v = on;
+        return true;
+    }
+};
+
+/**
+ * @brief Regra do alarme de gás: liga na primeira amostra acima de Threshold,
+ *        desliga no fim de um bloco sem nenhuma acima
+ */
+template <int32_t Threshold>
+struct LatchAbove {
+    bool on = false;
+    bool seen = false;      // Alguma amostra do bloco atual acima do limiar
+
+    bool operator()(int32_t &v) {
+        if (v > Threshold) {
+            seen = true;
+            on = true;
+        }
+        v = on;
+        return true;
+    }
+
+    bool end_block(int32_t &v) {
+        bool release = on && !seen;
+        seen = false;
+        if (release) {
+            on = false;
+            v = 0;
+        }
+        return release;
+    }
+};
+
+/**
+ * @brief Atuador: chama set(bool) só nas mudanças da entrada (0 ou não)
+ *
+ * Set é um tipo chamável, construído por padrão; como é um tipo, a
+ * chamada é direta e expandida no laço.
+ */
+template <typename Set>
+struct Actuator {
+    Set set;
+    bool on = false;
+
+    bool operator()(int32_t &v) {
+        if ((v != 0) != on) {
+            on = !on;
+            set(on);
+        }
+        return true;
+    }
+};
+
+namespace detail {
+
+template <typename Stage, typename = void>
+struct has_end_block : std::false_type {};
+
+template <typename Stage>
+struct has_end_block<Stage, std::void_t<decltype(std::declval<Stage &>().end_block(std::declval<int32_t &>()))>>
+        : std::true_type {};
+
+} // namespace detail
+
+/**
+ * @brief Cadeia de um canal: Source (Channel) seguida das etapas
+ */
+template <typename Source, typename... Stages>
+class Pipeline {
+public:
+    static_assert(sizeof...(Stages) > 0, "cadeia sem etapas");
+
+    /**
+     * @brief Passa uma amostra por todas as etapas
+     *
+     * @return false se alguma etapa a absorveu
+     */
+    bool push(int32_t v) { return push(v, std::index_sequence_for<Stages...>{}); }
+
+    /**
+     * @brief Processa as amostras do canal num bloco intercalado de n amostras
+     *
+     * Não chama end_block(), para que blocos possam ser divididos.
+     */
+    void run(const uint16_t *block, std::size_t n) {
+        for (std::size_t i = Source::offset; i < n; i += Source::stride) push(block[i]);
+    }
+
+    /**
+     * @brief Fecha um bloco nas etapas que têm end_block()
+     */
+    void end_block() { end_block(std::index_sequence_for<Stages...>{}); }
+
+    /**
+     * @brief run() seguido de end_block()
+     */
+    void run_block(const uint16_t *block, std::size_t n) {
+        run(block, n);
+        end_block();
+    }
+
+    template <std::size_t I>
+    auto &stage() { return std::get<I>(stages_); }
+
+private:
+    std::tuple<Stages...> stages_;
+
+    template <std::size_t... I>
+    bool push(int32_t v, std::index_sequence<I...>) {
+        // && para na primeira etapa que absorve a amostra
+        return (std::get<I>(stages_)(v) && ...);
+    }
+
+    template <typename Stage>
+    static bool close(Stage &stage, int32_t &v, bool flowing) {
+        if (flowing) flowing = stage(v);
+        if constexpr (detail::has_end_block<Stage>::value) {
+            if (stage.end_block(v)) flowing = true;
+        }
+        return flowing;
+    }
+
+    template <std::size_t... I>
+    void end_block(std::index_sequence<I...>) {
+        int32_t v = 0;
+        bool flowing = false;
+        ((flowing = close(std::get<I>(stages_), v, flowing)), ...);
+    }
+};
+
+} // namespace sensor_pipeline
+
+#endif // SENSOR_PIPELINE_H
@@ -0,0 +1,169 @@
+/**
+ * @file sensor_pipeline_bench.cpp
+ * @brief Benchmark no RP2040 das cadeias de sensor_pipeline.h contra o C escrito à mão
+ *
+ * Firmware à parte (alvo sensor_pipeline_bench): processa blocos de
+ * adc_capture.h (LDR e MQ2 intercalados) pelas duas versões da lógica
+ * de cada canal e conta com o SysTick os ciclos médios por bloco,
+ * descontando o custo da própria medição:
+ * - LDR: mediana de 3 e limiar de ldr_monitoring() na última amostra;
+ * - MQ2: mediana de 3 e a regra por bloco de gas_alarm_on_block().
+ * A versão em C usa running_median_push(), como a interrupção do DMA.
+ * As duas versões ficam em RAM, como no firmware, e as mudanças dos
+ * atuadores são conferidas a cada rodada. O resultado sai na serial a
+ * cada 5 s. O equivalente no host é host/sensor_pipeline_bench.cpp.
+ */
+#include <cstdio>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#include "sensor_pipeline.h"
+
+extern "C" {
+#include "adc_capture.h"
+#include "gas_alarm.h"
+#include "running_median.h"
+}
+
+#define BENCH_BLOCKS 64
+#define BENCH_PASSES 8
+#define BENCH_PER_CHANNEL (ADC_CAPTURE_BLOCK_SAMPLES / ADC_CAPTURE_CHANNELS)
+#define BENCH_LDR_THRESHOLD 1500    // LDR_THRESHOLD de environment-monitoring.c
+#define SYSTICK_MAX 0x00FFFFFFu     // Contador decrescente de 24 bits
+
+namespace sp = sensor_pipeline;
+
+static uint16_t blocks[BENCH_BLOCKS][ADC_CAPTURE_BLOCK_SAMPLES];
+static uint32_t rng = 12345;
+
+// Mudanças de cada atuador: 0 pela versão em C, 1 pelo template
+static uint32_t changes[2];
+
+template <int Version>
+struct Count {
+    void operator()(bool) const { changes[Version]++; }
+};
+
+struct CChannel {
+    running_median_t median;
+    bool on;
+};
+
+static CChannel c_ldr, c_mq2;
+
+static sp::Pipeline<sp::Channel<ADC_CAPTURE_CHANNELS, ADC_CAPTURE_LDR>, sp::Median<3>, sp::Decimate<BENCH_PER_CHANNEL>,
+                    sp::Hysteresis<BENCH_LDR_THRESHOLD, BENCH_LDR_THRESHOLD>, sp::Actuator<Count<1>>>
+        ldr_pipeline;
+
+static sp::Pipeline<sp::Channel<ADC_CAPTURE_CHANNELS, ADC_CAPTURE_MQ2>, sp::Median<3>,
+                    sp::LatchAbove<GAS_ALARM_DEFAULT_THRESHOLD>, sp::Actuator<Count<1>>>
+        mq2_pipeline;
+
+static uint32_t next_random() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// LDR em rampa que cruza o limiar, MQ2 com um vazamento perto do limiar, picos isolados
+static void build_blocks() {
+    for (int i = 0; i < BENCH_BLOCKS * BENCH_PER_CHANNEL; i++) {
+        int32_t noise = (int32_t)(next_random() % 61) - 30;
+        int32_t ldr = 1000 + i * 2 + noise;
+        int32_t mq2 = 400 + noise;
+        if (i / 64 % 4 == 3) mq2 += 1650 + (int32_t)(next_random() % 101) - 50;
+        if (next_random() % 64 == 0) ldr = mq2 = 4095;
+        blocks[0][i * ADC_CAPTURE_CHANNELS + ADC_CAPTURE_LDR] = (uint16_t)ldr;
+        blocks[0][i * ADC_CAPTURE_CHANNELS + ADC_CAPTURE_MQ2] = (uint16_t)mq2;
+    }
+}
+
+static void __not_in_flash_func(null_block)(const uint16_t *) {
+}
+
+static void __not_in_flash_func(c_ldr_block)(const uint16_t *block) {
+    int32_t latest = 0;
+    for (int i = ADC_CAPTURE_LDR; i < ADC_CAPTURE_BLOCK_SAMPLES; i += ADC_CAPTURE_CHANNELS) {
+        latest = running_median_push(&c_ldr.median, block[i]);
+    }
+    if ((latest > BENCH_LDR_THRESHOLD) != c_ldr.on) {
+        c_ldr.on = !c_ldr.on;
+        changes[0]++;
+    }
+}
+
+static void __not_in_flash_func(c_mq2_block)(const uint16_t *block) {
+    int32_t filtered[BENCH_PER_CHANNEL];
+    for (int i = 0; i < BENCH_PER_CHANNEL; i++) {
+        filtered[i] = running_median_push(&c_mq2.median, block[i * ADC_CAPTURE_CHANNELS + ADC_CAPTURE_MQ2]);
+    }
+    int first_above = -1;
+    for (int i = 0; i < BENCH_PER_CHANNEL; i++) {
+        if (filtered[i] > GAS_ALARM_DEFAULT_THRESHOLD) {
+            first_above = i;
+            break;
+        }
+    }
+    if ((first_above >= 0) != c_mq2.on) {
+        c_mq2.on = !c_mq2.on;
+        changes[0]++;
+    }
+}
+
+static void __not_in_flash_func(template_ldr_block)(const uint16_t *block) {
+    ldr_pipeline.run_block(block, ADC_CAPTURE_BLOCK_SAMPLES);
+}
+
+static void __not_in_flash_func(template_mq2_block)(const uint16_t *block) {
+    mq2_pipeline.run_block(block, ADC_CAPTURE_BLOCK_SAMPLES);
+}
+
+/**
+ * @brief Ciclos médios por bloco; os filtros recomeçam do zero
+ */
+static uint32_t measure(void (*process)(const uint16_t *)) {
+    uint64_t total = 0;
+    running_median_init(&c_ldr.median, 3);
+    running_median_init(&c_mq2.median, 3);
+    c_ldr.on = c_mq2.on = false;
+    ldr_pipeline = decltype(ldr_pipeline)();
+    mq2_pipeline = decltype(mq2_pipeline)();
+    for (int pass = 0; pass <= BENCH_PASSES; pass++) {
+        for (int b = 0; b < BENCH_BLOCKS; b++) {
+            uint32_t c0 = systick_hw->cvr;
+            process(blocks[b]);
+            uint32_t c1 = systick_hw->cvr;
+            if (pass) total += (c0 - c1) & SYSTICK_MAX;
+        }
+    }
+    return (uint32_t)(total / (BENCH_PASSES * BENCH_BLOCKS));
+}
+
+int main() {
+    stdio_init_all();
+    build_blocks();
+
+    systick_hw->rvr = SYSTICK_MAX;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    static const struct {
+        const char *name;
+        void (*c)(const uint16_t *);
+        void (*pipeline)(const uint16_t *);
+    } channels[] = {{"LDR", c_ldr_block, template_ldr_block}, {"MQ2", c_mq2_block, template_mq2_block}};
+
+    while (true) {
+        uint32_t mhz = clock_get_hz(clk_sys) / 1000000u;
+        uint32_t overhead = measure(null_block);
+        for (const auto &ch : channels) {
+            changes[0] = changes[1] = 0;
+            uint32_t c = measure(ch.c) - overhead;
+            uint32_t t = measure(ch.pipeline) - overhead;
+            printf("%s: C %lu ciclos/bloco, template %lu ciclos/bloco (%lu MHz)%s\n", ch.name, (unsigned long)c,
+                   (unsigned long)t, (unsigned long)mhz, changes[0] == changes[1] ? "" : " ATUADOR DIVERGE");
+        }
+        sleep_ms(5000);
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * @file sensor_registry.c
+ * @brief Implementação do registro de últimos valores com seqlock
+ */
+#include "sensor_registry.h"
+
+#include <stdatomic.h>
+
+#if PICO_ON_DEVICE
+#include "pico.h"
+#define SENSOR_REGISTRY_FUNC(f) __not_in_flash_func(f)
+#else
+#define SENSOR_REGISTRY_FUNC(f) f
+#endif
+
+/**
+ * @brief Um canal: contador de sequência e campos da última publicação
+ *
+ * O contador é ímpar durante uma publicação e conta duas por publicação.
+ */
+typedef struct {
+    _Atomic uint32_t seq;
+    _Atomic int32_t status;
+    _Atomic int32_t value[2];
+    _Atomic uint32_t time_us;
+} sensor_registry_entry_t;
+
+static sensor_registry_entry_t sensor_registry[SENSOR_REGISTRY_CHANNELS];
+
+void SENSOR_REGISTRY_FUNC(sensor_registry_publish)(sensor_registry_channel_t channel,
+                                                    const sensor_reading_t *reading) {
+    sensor_registry_entry_t *e = &sensor_registry[channel];
+    uint32_t seq = atomic_load_explicit(&e->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&e->seq, seq + 1, memory_order_relaxed);
+    // Os campos não podem ficar visíveis antes do contador ímpar
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&e->status, reading->status, memory_order_relaxed);
+    atomic_store_explicit(&e->value[0], reading->value[0], memory_order_relaxed);
+    atomic_store_explicit(&e->value[1], reading->value[1], memory_order_relaxed);
+    atomic_store_explicit(&e->time_us, reading->time_us, memory_order_relaxed);
+
+    atomic_store_explicit(&e->seq, seq + 2, memory_order_release);
+}
+
+bool SENSOR_REGISTRY_FUNC(sensor_registry_try_read)(sensor_registry_channel_t channel, sensor_reading_t *reading) {
+    sensor_registry_entry_t *e = &sensor_registry[channel];
+    uint32_t begin = atomic_load_explicit(&e->seq, memory_order_acquire);
+    if (begin & 1) return false;
+
+    reading->status = atomic_load_explicit(&e->status, memory_order_relaxed);
+    reading->value[0] = atomic_load_explicit(&e->value[0], memory_order_relaxed);
+    reading->value[1] = atomic_load_explicit(&e->value[1], memory_order_relaxed);
+    reading->time_us = atomic_load_explicit(&e->time_us, memory_order_relaxed);
+
+    // Os campos não podem ser lidos depois da segunda leitura do contador
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&e->seq, memory_order_relaxed) != begin) return false;
+
+    reading->sequence = begin / 2;
+    return true;
+}
+
+void SENSOR_REGISTRY_FUNC(sensor_registry_read)(sensor_registry_channel_t channel, sensor_reading_t *reading) {
+    while (!sensor_registry_try_read(channel, reading)) {
+    }
+}
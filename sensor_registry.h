@@ -0,0 +1,76 @@
+/**
+ * @file sensor_registry.h
+ * @brief Registro dos últimos valores de cada sensor, protegido por seqlock
+ *
+ * Cada canal guarda a última leitura publicada do seu sensor (estado,
+ * dois valores e instante) atrás de um contador de sequência próprio. O
+ * escritor leva o contador a ímpar, grava os campos e o leva ao par
+ * seguinte; o leitor copia os campos entre duas leituras do contador e
+ * repete a cópia se ele mudou ou estava ímpar. Assim o leitor sempre
+ * recebe os campos de uma mesma publicação, mesmo com o escritor em
+ * outro core ou numa interrupção.
+ *
+ * Regras de uso:
+ * - cada canal tem um único escritor (laço principal, core 1 ou uma
+ *   interrupção), que nunca espera. Dois contextos que publicam no mesmo
+ *   canal precisariam de um spinlock de hardware em volta da publicação;
+ * - leitores nunca atrasam o escritor e podem estar em qualquer core;
+ * - uma interrupção não deve chamar sensor_registry_read() num canal cujo
+ *   escritor ela pode interromper no mesmo core, pois o escritor não
+ *   avança enquanto ela repete: nesse caso, sensor_registry_try_read().
+ *
+ * Os campos são palavras atômicas de 32 bits (C11), que no Cortex-M0+
+ * são ldr/str comuns, e as barreiras viram dmb. No dispositivo,
+ * publicação e leitura ficam em RAM, pois a interrupção do DMA
+ * (adc_capture.h) publica durante escritas na flash.
+ */
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Canais do registro e o significado dos campos de cada um
+ */
+typedef enum {
+    SENSOR_REGISTRY_ADC,        // Interrupção do DMA: value = {LDR, MQ2} filtrados, time_us do bloco
+    SENSOR_REGISTRY_ADC_AUX,    // Interrupção do DMA: value = {temperatura, VSYS / 3}, médias do bloco em Q4
+    SENSOR_REGISTRY_DHT22,      // status = dht22_read(); value = {temperatura, umidade} em décimos
+    SENSOR_REGISTRY_LDR,        // Última amostra do LDR no laço principal: value[0]
+    SENSOR_REGISTRY_MQ2,        // Última amostra do MQ2 no laço principal: value[0]
+    SENSOR_REGISTRY_CHANNELS,
+} sensor_registry_channel_t;
+
+/**
+ * @brief Uma leitura publicada
+ *
+ * Campos sem significado no canal ficam em zero.
+ */
+typedef struct {
+    int32_t status;             // Código de erro do sensor (0: leitura válida)
+    int32_t value[2];
+    uint32_t time_us;           // Instante da leitura (time_us_32)
+    uint32_t sequence;          // Publicações no canal até esta (0: nunca publicado)
+} sensor_reading_t;
+
+/**
+ * @brief Publica uma leitura no canal (sequence é ignorado)
+ *
+ * Wait-free; só pode ser chamada pelo escritor do canal.
+ */
+void sensor_registry_publish(sensor_registry_channel_t channel, const sensor_reading_t *reading);
+
+/**
+ * @brief Copia a última leitura do canal, repetindo até obter uma consistente
+ */
+void sensor_registry_read(sensor_registry_channel_t channel, sensor_reading_t *reading);
+
+/**
+ * @brief Tenta copiar a última leitura do canal uma única vez
+ *
+ * @return false se a cópia cruzou uma publicação; reading fica indefinido
+ */
+bool sensor_registry_try_read(sensor_registry_channel_t channel, sensor_reading_t *reading);
+
+#endif // SENSOR_REGISTRY_H
@@ -0,0 +1,210 @@
+/**
+ * @file sntp_client.c
+ * @brief Implementação do cliente SNTP
+ */
+#include "sntp_client.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "net.h"
+#include "wall_clock.h"
+
+#define NTP_PACKET_SIZE 48
+#define NTP_MODE_CLIENT 3
+#define NTP_MODE_SERVER 4
+#define NTP_VERSION 4
+#define NTP_LEAP_UNSYNCED 3
+#define NTP_UNIX_OFFSET_S 2208988800u       // 1900-01-01 a 1970-01-01
+
+// Posição dos campos no pacote
+#define NTP_ORIGINATE 24
+#define NTP_RECEIVE 32
+#define NTP_TRANSMIT 40
+
+typedef enum {
+    SNTP_IDLE,                  // Esperando next_ms para consultar
+    SNTP_RESOLVING,             // Nome do servidor em resolução
+    SNTP_WAITING,               // Consulta enviada, esperando a resposta até next_ms
+} sntp_state_t;
+
+static struct {
+    const char *server;
+    uint16_t port;
+    uint64_t (*now_us)(void);
+    sntp_state_t state;
+    uint32_t next_ms;
+    bool resolved;
+    net_addr_t addr;
+    net_udp_t *udp;
+    uint8_t cookie[8];          // Campo de transmissão da consulta em andamento
+    uint64_t t1_us;
+    uint32_t samples;
+
+    // Caixa de um pacote, preenchida pelo callback de recepção (no dispositivo, em interrupção)
+    volatile bool rx_full;
+    uint8_t rx_data[NTP_PACKET_SIZE];
+    size_t rx_len;
+    uint64_t rx_t4_us;
+
+    sntp_client_stats_t stats;
+} sntp;
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+/**
+ * @brief Carimbo NTP (segundos e fração de 32 bits) em us desde 1970
+ *
+ * Os segundos dão a volta em 2036: com o bit mais alto em 0, o carimbo é
+ * da era seguinte (RFC 4330, seção 3).
+ */
+static int64_t ntp_to_unix_us(const uint8_t *p) {
+    uint32_t seconds = get_u32(p);
+    uint32_t fraction = get_u32(p + 4);
+    int64_t unix_s = (int64_t)seconds - NTP_UNIX_OFFSET_S;
+    if (!(seconds & 0x80000000u)) unix_s += (int64_t)1 << 32;
+    return unix_s * 1000000 + (int64_t)(((uint64_t)fraction * 1000000) >> 32);
+}
+
+static void on_receive(void *ctx, const uint8_t *data, size_t len) {
+    (void)ctx;
+    uint64_t t4 = sntp.now_us();
+    if (sntp.rx_full) return;
+    sntp.rx_len = len < NTP_PACKET_SIZE ? len : NTP_PACKET_SIZE;
+    memcpy(sntp.rx_data, data, sntp.rx_len);
+    sntp.rx_t4_us = t4;
+    sntp.rx_full = true;
+}
+
+void sntp_client_init(const char *server, uint16_t port, uint64_t (*now_us)(void), uint32_t now_ms) {
+    memset(&sntp, 0, sizeof(sntp));
+    sntp.server = server;
+    sntp.port = port;
+    sntp.now_us = now_us;
+    sntp.state = SNTP_IDLE;
+    sntp.next_ms = now_ms;
+}
+
+static void schedule(uint32_t now_ms, uint32_t delay_ms) {
+    sntp.state = SNTP_IDLE;
+    sntp.next_ms = now_ms + delay_ms;
+}
+
+static void send_request(uint32_t now_ms) {
+    if (!sntp.udp) sntp.udp = net_udp_open(on_receive, NULL);
+    if (!sntp.udp) {
+        schedule(now_ms, SNTP_CLIENT_RETRY_MS);
+        return;
+    }
+
+    // O relógio local no campo de transmissão serve de identificador da consulta
+    uint8_t packet[NTP_PACKET_SIZE] = {NTP_VERSION << 3 | NTP_MODE_CLIENT};
+    uint64_t t1 = sntp.now_us();
+    put_u32(packet + NTP_TRANSMIT, (uint32_t)(t1 / 1000000));
+    put_u32(packet + NTP_TRANSMIT + 4, (uint32_t)(((t1 % 1000000) << 32) / 1000000));
+    memcpy(sntp.cookie, packet + NTP_TRANSMIT, sizeof(sntp.cookie));
+
+    sntp.rx_full = false;
+    sntp.t1_us = t1;
+    if (net_udp_sendto(sntp.udp, &sntp.addr, sntp.port, packet, sizeof(packet)) != NET_OK) {
+        schedule(now_ms, SNTP_CLIENT_RETRY_MS);
+        return;
+    }
+    sntp.stats.requests++;
+    sntp.state = SNTP_WAITING;
+    sntp.next_ms = now_ms + SNTP_CLIENT_TIMEOUT_MS;
+}
+
+/**
+ * @brief Confere a resposta na caixa e entrega a medida ao relógio
+ *
+ * @return false se a resposta não é desta consulta: a espera continua
+ */
+static bool handle_response(uint32_t now_ms) {
+    const uint8_t *p = sntp.rx_data;
+    if (sntp.rx_len < NTP_PACKET_SIZE || (p[0] & 7) != NTP_MODE_SERVER ||
+        memcmp(p + NTP_ORIGINATE, sntp.cookie, sizeof(sntp.cookie)) != 0) {
+        sntp.stats.rejected++;
+        return false;
+    }
+
+    uint8_t stratum = p[1];
+    if (stratum == 0) {
+        sntp.stats.kod++;
+        schedule(now_ms, SNTP_CLIENT_KOD_BACKOFF_MS);
+        return true;
+    }
+    if (p[0] >> 6 == NTP_LEAP_UNSYNCED || stratum > 15 || get_u32(p + NTP_TRANSMIT) == 0) {
+        sntp.stats.rejected++;
+        schedule(now_ms, SNTP_CLIENT_RETRY_MS);
+        return true;
+    }
+
+    int64_t t1 = (int64_t)sntp.t1_us;
+    int64_t t4 = (int64_t)sntp.rx_t4_us;
+    int64_t t2 = ntp_to_unix_us(p + NTP_RECEIVE);
+    int64_t t3 = ntp_to_unix_us(p + NTP_TRANSMIT);
+    int64_t offset = ((t2 - t1) + (t3 - t4)) / 2;
+    int64_t delay = (t4 - t1) - (t3 - t2);
+    if (delay < 0) delay = 0;
+    wall_clock_update((uint64_t)(t1 + (t4 - t1) / 2), offset, (uint32_t)delay);
+
+    sntp.stats.responses++;
+    sntp.samples++;
+    schedule(now_ms, sntp.samples < SNTP_CLIENT_FAST_SAMPLES ? SNTP_CLIENT_FAST_POLL_MS : SNTP_CLIENT_POLL_MS);
+    return true;
+}
+
+void sntp_client_poll(uint32_t now_ms) {
+    if (sntp.state == SNTP_WAITING) {
+        if (sntp.rx_full) {
+            bool done = handle_response(now_ms);
+            sntp.rx_full = false;
+            if (done) return;
+        }
+        if ((int32_t)(now_ms - sntp.next_ms) >= 0) {
+            // O servidor pode ter mudado de endereço (pool): resolve de novo na próxima
+            sntp.stats.timeouts++;
+            sntp.resolved = false;
+            schedule(now_ms, SNTP_CLIENT_RETRY_MS);
+        }
+        return;
+    }
+    if ((int32_t)(now_ms - sntp.next_ms) < 0) return;
+
+    if (!net_is_up()) {
+        schedule(now_ms, SNTP_CLIENT_RETRY_MS);
+        return;
+    }
+    if (!sntp.resolved) {
+        int status = net_resolve(sntp.server, &sntp.addr);
+        if (status == NET_PENDING) {
+            sntp.state = SNTP_RESOLVING;
+            sntp.next_ms = now_ms + SNTP_CLIENT_RESOLVE_POLL_MS;
+            return;
+        }
+        if (status != NET_OK) {
+            schedule(now_ms, SNTP_CLIENT_RETRY_MS);
+            return;
+        }
+        sntp.resolved = true;
+    }
+    send_request(now_ms);
+}
+
+uint32_t sntp_client_next_ms(void) {
+    return sntp.next_ms;
+}
+
+void sntp_client_get_stats(sntp_client_stats_t *stats) {
+    *stats = sntp.stats;
+}
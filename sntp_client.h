@@ -0,0 +1,92 @@
+/**
+ * @file sntp_client.h
+ * @brief Cliente SNTP (RFC 4330) que alimenta o relógio UTC (wall_clock.h)
+ *
+ * Cada consulta é um pacote de 48 bytes ao servidor (modo 3, versão 4).
+ * O campo de transmissão leva o instante local do envio (T1), que o
+ * servidor devolve como origem: a resposta só é aceita se a origem
+ * confere, o que descarta respostas atrasadas de consultas anteriores e
+ * pacotes forjados. Com T2 e T3 do servidor (recepção e envio, UTC) e
+ * T4, o instante local da chegada:
+ * @code
+ * diferença = ((T2 - T1) + (T3 - T4)) / 2
+ * atraso    = (T4 - T1) - (T3 - T2)
+ * @endcode
+ * entregues a wall_clock_update() no meio da troca. T1 e T4 vêm do
+ * relógio de microssegundos passado a sntp_client_init(); T4 é tomado no
+ * callback de recepção, antes de qualquer fila do laço principal.
+ *
+ * As primeiras SNTP_CLIENT_FAST_SAMPLES consultas saem a cada
+ * SNTP_CLIENT_FAST_POLL_MS, para sincronizar logo depois do boot; as
+ * seguintes, a cada SNTP_CLIENT_POLL_MS. Sem resposta em
+ * SNTP_CLIENT_TIMEOUT_MS, a consulta é repetida em SNTP_CLIENT_RETRY_MS.
+ * Respostas com estrato 0 ("kiss-o'-death", o servidor pede para parar)
+ * adiam a próxima consulta por SNTP_CLIENT_KOD_BACKOFF_MS; respostas de
+ * servidor sem sincronia (indicador de salto 3) são descartadas.
+ *
+ * O cliente roda no laço principal: sntp_client_poll() quando
+ * sntp_client_next_ms() chegar, como mq2_heater_poll(). Depende só de
+ * net.h: no host, o mesmo código conversa com o servidor de teste de
+ * host/sntp_check.c.
+ */
+#ifndef SNTP_CLIENT_H
+#define SNTP_CLIENT_H
+
+#include <stdint.h>
+
+#ifndef SNTP_CLIENT_SERVER
+#define SNTP_CLIENT_SERVER "pool.ntp.org"   // Servidor padrão
+#endif
+#ifndef SNTP_CLIENT_PORT
+#define SNTP_CLIENT_PORT 123
+#endif
+#ifndef SNTP_CLIENT_POLL_MS
+#define SNTP_CLIENT_POLL_MS 64000           // Período das consultas depois da partida
+#endif
+#ifndef SNTP_CLIENT_FAST_POLL_MS
+#define SNTP_CLIENT_FAST_POLL_MS 2000       // Período das primeiras consultas
+#endif
+#ifndef SNTP_CLIENT_TIMEOUT_MS
+#define SNTP_CLIENT_TIMEOUT_MS 2000         // Espera pela resposta
+#endif
+#ifndef SNTP_CLIENT_RETRY_MS
+#define SNTP_CLIENT_RETRY_MS 8000           // Nova tentativa depois de uma falha
+#endif
+#define SNTP_CLIENT_FAST_SAMPLES 8          // Consultas no período curto
+#define SNTP_CLIENT_KOD_BACKOFF_MS 600000   // Espera depois de um "kiss-o'-death"
+#define SNTP_CLIENT_RESOLVE_POLL_MS 100     // Período de consulta da resolução do nome
+
+/**
+ * @brief Contadores do cliente
+ */
+typedef struct {
+    uint32_t requests;          // Consultas enviadas
+    uint32_t responses;         // Respostas entregues ao relógio
+    uint32_t timeouts;          // Consultas sem resposta
+    uint32_t rejected;          // Respostas descartadas (origem, modo ou servidor sem sincronia)
+    uint32_t kod;               // "Kiss-o'-death" recebidos
+} sntp_client_stats_t;
+
+/**
+ * @brief Configura o cliente; a primeira consulta sai no primeiro poll com a rede pronta
+ *
+ * @param server Nome ou endereço do servidor (a string deve continuar válida)
+ * @param port Porta UDP do servidor
+ * @param now_us Relógio local de microssegundos que o relógio UTC disciplina
+ * @param now_ms Instante atual em ms desde o boot
+ */
+void sntp_client_init(const char *server, uint16_t port, uint64_t (*now_us)(void), uint32_t now_ms);
+
+/**
+ * @brief Avança o cliente: resolve o nome, envia a consulta ou trata a resposta
+ */
+void sntp_client_poll(uint32_t now_ms);
+
+/**
+ * @brief Próximo instante (ms desde o boot) em que sntp_client_poll() tem algo a fazer
+ */
+uint32_t sntp_client_next_ms(void);
+
+void sntp_client_get_stats(sntp_client_stats_t *stats);
+
+#endif // SNTP_CLIENT_H
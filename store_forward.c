@@ -0,0 +1,330 @@
+/**
+ * @file store_forward.c
+ * @brief Implementação do armazenamento e reenvio da telemetria
+ */
+#include "store_forward.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/flash.h"
+#include "hardware/irq.h"
+#include "exec_trace.h"
+#include "telemetry_ring.h"
+
+#define SF_LOG_BYTES (STORE_FORWARD_FLASH_SECTORS * FLASH_SECTOR_SIZE)
+#define SF_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - SF_LOG_BYTES)
+#define SF_RAM_HIGH (STORE_FORWARD_RAM_BYTES * 3 / 4)   // Começa a gravar na flash
+#define SF_RAM_LOW (STORE_FORWARD_RAM_BYTES / 2)        // Para de gravar na flash
+#define SF_IRQ_COUNT 32                                 // IRQs do RP2040
+#define SF_BLANK 0xFFFFu                                // Tamanho lido de flash apagada
+
+/**
+ * @brief Estado da fila
+ *
+ * As posições na flash são deslocamentos absolutos dentro do registro
+ * circular, que só crescem; o endereço é a posição módulo SF_LOG_BYTES.
+ * A gravação avança de página em página; a leitura, de registro em
+ * registro.
+ */
+typedef struct {
+    telemetry_ring_t ram;
+    uint32_t flash_read;
+    uint32_t flash_write;
+    store_forward_stats_t stats;
+} store_forward_state_t;
+
+static store_forward_state_t sf;
+static uint8_t sf_ram_storage[STORE_FORWARD_RAM_BYTES];
+
+// Dois setores compactados em um
+static uint8_t sf_scratch[FLASH_SECTOR_SIZE];
+
+static_assert(SF_LOG_BYTES % FLASH_SECTOR_SIZE == 0 && (SF_LOG_BYTES & (SF_LOG_BYTES - 1)) == 0,
+              "o registro na flash deve ter tamanho potência de dois");
+
+static const uint8_t *sf_flash_at(uint32_t pos) {
+    return (const uint8_t *)(XIP_BASE + SF_FLASH_OFFSET + (pos & (SF_LOG_BYTES - 1)));
+}
+
+static uint32_t sf_record_len(const uint8_t *header) {
+    return (uint32_t)header[0] | (uint32_t)header[1] << 8;
+}
+
+// ---------------------------------------------------------------------------
+// Flash
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Suspende as interrupções habilitadas, exceto a DMA_IRQ_0
+ *
+ * @return Máscara das interrupções suspensas
+ */
+static uint32_t sf_pause_irqs(void) {
+    uint32_t paused = 0;
+    for (unsigned int irq = 0; irq < SF_IRQ_COUNT; irq++) {
+        if (irq == DMA_IRQ_0 || !irq_is_enabled(irq)) continue;
+        irq_set_enabled(irq, false);
+        paused |= 1u << irq;
+    }
+    return paused;
+}
+
+static void sf_resume_irqs(uint32_t paused) {
+    for (unsigned int irq = 0; irq < SF_IRQ_COUNT; irq++) {
+        if (paused & (1u << irq)) irq_set_enabled(irq, true);
+    }
+}
+
+static void sf_flash_erase(uint32_t pos) {
+    EXEC_TRACE_BEGIN(EXEC_TRACE_FLASH_ERASE);
+    uint32_t paused = sf_pause_irqs();
+    flash_range_erase(SF_FLASH_OFFSET + (pos & (SF_LOG_BYTES - 1)), FLASH_SECTOR_SIZE);
+    sf_resume_irqs(paused);
+    EXEC_TRACE_END(EXEC_TRACE_FLASH_ERASE);
+}
+
+static void sf_flash_program(uint32_t pos, const uint8_t *data, size_t len) {
+    EXEC_TRACE_BEGIN(EXEC_TRACE_FLASH_PROGRAM);
+    uint32_t paused = sf_pause_irqs();
+    flash_range_program(SF_FLASH_OFFSET + (pos & (SF_LOG_BYTES - 1)), data, len);
+    sf_resume_irqs(paused);
+    EXEC_TRACE_END(EXEC_TRACE_FLASH_PROGRAM);
+}
+
+/**
+ * @brief Próximo registro na flash a partir de *pos, sem passar de end
+ *
+ * Pula o resto de páginas sem registro (fim de página ou página apagada).
+ *
+ * @return Cabeçalho do registro, ou NULL se não há registro antes de end
+ */
+static const uint8_t *sf_flash_seek(uint32_t *pos, uint32_t end) {
+    while (*pos != end) {
+        uint32_t room = FLASH_PAGE_SIZE - (*pos & (FLASH_PAGE_SIZE - 1));
+        const uint8_t *header = sf_flash_at(*pos);
+        if (room >= STORE_FORWARD_HEADER_BYTES && sf_record_len(header) != SF_BLANK) return header;
+        *pos += room;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Copia para sf_scratch os registros sobreviventes de [from, to)
+ *
+ * @param data_stride Mantém um a cada data_stride registros DATA (0: nenhum)
+ * @param keep_skip Registros KEEP mais antigos a descartar
+ * @param used Recebe os bytes usados em sf_scratch
+ *
+ * @return false se os sobreviventes não couberam em um setor
+ */
+static bool sf_pack(uint32_t from, uint32_t to, uint32_t data_stride, uint32_t keep_skip, uint32_t *used,
+                    uint32_t *decimated, uint32_t *dropped) {
+    uint32_t data_index = 0;
+    *used = 0;
+    *decimated = 0;
+    *dropped = 0;
+    memset(sf_scratch, 0xFF, sizeof(sf_scratch));
+
+    const uint8_t *header;
+    while ((header = sf_flash_seek(&from, to)) != NULL) {
+        uint32_t size = STORE_FORWARD_HEADER_BYTES + sf_record_len(header);
+        from += size;
+
+        bool keep = header[2] == STORE_FORWARD_KEEP;
+        if (keep && keep_skip) {
+            keep_skip--;
+            (*dropped)++;
+            continue;
+        }
+        if (!keep && (data_stride == 0 || data_index++ % data_stride != 0)) {
+            (*decimated)++;
+            continue;
+        }
+
+        // Registros não atravessam páginas
+        uint32_t room = FLASH_PAGE_SIZE - (*used & (FLASH_PAGE_SIZE - 1));
+        if (size > room) *used += room;
+        if (*used + size > sizeof(sf_scratch)) return false;
+        memcpy(sf_scratch + *used, header, size);
+        *used += size;
+    }
+    return true;
+}
+
+/**
+ * @brief Compacta os dois setores mais antigos no segundo deles
+ *
+ * O primeiro setor fica livre para a próxima gravação; a ordem dos
+ * registros é preservada.
+ */
+static void sf_compact(void) {
+    uint32_t oldest = sf.flash_read & ~(FLASH_SECTOR_SIZE - 1);
+    uint32_t target = oldest + FLASH_SECTOR_SIZE;
+    uint32_t end = target + FLASH_SECTOR_SIZE;
+    uint32_t used, decimated, dropped;
+    bool fits = false;
+
+    // Dizima cada vez mais os dados; depois, descarta os alarmes mais antigos
+    for (uint32_t stride = 2; stride <= 16 && !fits; stride *= 2) {
+        fits = sf_pack(sf.flash_read, end, stride, 0, &used, &decimated, &dropped);
+    }
+    for (uint32_t skip = 0; !fits; skip += 16) {
+        fits = sf_pack(sf.flash_read, end, 0, skip, &used, &decimated, &dropped);
+    }
+
+    sf_flash_erase(target);
+    uint32_t pages = (used + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    if (pages) sf_flash_program(target, sf_scratch, pages * FLASH_PAGE_SIZE);
+
+    sf.flash_read = target;
+    sf.stats.compactions++;
+    sf.stats.decimated += decimated;
+    sf.stats.dropped += dropped;
+}
+
+/**
+ * @brief Grava uma página no fim do registro, abrindo espaço se preciso
+ */
+static void sf_flash_append(const uint8_t *page) {
+    if ((sf.flash_write & (FLASH_SECTOR_SIZE - 1)) == 0) {
+        if (sf.flash_write - (sf.flash_read & ~(FLASH_SECTOR_SIZE - 1)) >= SF_LOG_BYTES) sf_compact();
+        sf_flash_erase(sf.flash_write);
+    }
+    sf_flash_program(sf.flash_write, page, FLASH_PAGE_SIZE);
+    sf.flash_write += FLASH_PAGE_SIZE;
+    sf.stats.spilled_pages++;
+}
+
+// ---------------------------------------------------------------------------
+// RAM
+// ---------------------------------------------------------------------------
+
+static void sf_ram_copy(uint32_t pos, uint8_t *dst, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) dst[i] = sf.ram.data[(pos + i) & sf.ram.mask];
+}
+
+/**
+ * @brief Trecho contíguo da RAM a partir de pos, com no máximo n bytes
+ */
+static uint32_t sf_ram_span(uint32_t pos, uint32_t n, uint8_t **data) {
+    uint32_t offset = pos & sf.ram.mask;
+    uint32_t contiguous = sf.ram.mask + 1 - offset;
+    *data = sf.ram.data + offset;
+    return n < contiguous ? n : contiguous;
+}
+
+static void sf_ram_write(uint32_t pos, const uint8_t *src, uint32_t n) {
+    if (n == 0) return;
+    uint8_t *dst;
+    uint32_t first = sf_ram_span(pos, n, &dst);
+    memcpy(dst, src, first);
+    memcpy(sf.ram.data, src + first, n - first);
+}
+
+/**
+ * @brief Tamanho, com cabeçalho, do registro mais antigo da RAM (0 se vazia)
+ */
+static uint32_t sf_ram_front(void) {
+    if (telemetry_ring_used(&sf.ram) == 0) return 0;
+    uint8_t header[2];
+    sf_ram_copy(sf.ram.tail, header, sizeof(header));
+    return STORE_FORWARD_HEADER_BYTES + sf_record_len(header);
+}
+
+/**
+ * @brief Move os registros mais antigos da RAM para uma página da flash
+ */
+static void sf_spill_page(void) {
+    uint8_t page[FLASH_PAGE_SIZE];
+    uint32_t used = 0, size;
+    memset(page, 0xFF, sizeof(page));
+
+    while ((size = sf_ram_front()) != 0 && used + size <= sizeof(page)) {
+        sf_ram_copy(sf.ram.tail, page + used, size);
+        telemetry_ring_consume(&sf.ram, size);
+        used += size;
+    }
+    if (used) sf_flash_append(page);
+}
+
+// ---------------------------------------------------------------------------
+// Interface
+// ---------------------------------------------------------------------------
+
+void store_forward_init(void) {
+    memset(&sf, 0, sizeof(sf));
+    telemetry_ring_init(&sf.ram, sf_ram_storage, sizeof(sf_ram_storage));
+}
+
+bool store_forward_push(const uint8_t *data, size_t len, store_forward_class_t cls) {
+    const uint8_t *const span[2] = {data, NULL};
+    const size_t span_len[2] = {len, 0};
+    return store_forward_push_spans(span, span_len, cls);
+}
+
+bool store_forward_push_spans(const uint8_t *const span[2], const size_t span_len[2], store_forward_class_t cls) {
+    size_t len = span_len[0] + span_len[1];
+    if (len == 0 || len > STORE_FORWARD_RECORD_MAX) {
+        sf.stats.dropped++;
+        return false;
+    }
+
+    uint32_t size = STORE_FORWARD_HEADER_BYTES + (uint32_t)len;
+    if (telemetry_ring_used(&sf.ram) + size > SF_RAM_HIGH) {
+        while (telemetry_ring_used(&sf.ram) > SF_RAM_LOW) sf_spill_page();
+    }
+
+    uint8_t header[STORE_FORWARD_HEADER_BYTES] = {(uint8_t)len, (uint8_t)(len >> 8), (uint8_t)cls};
+    uint32_t head = sf.ram.head;
+    sf_ram_write(head, header, sizeof(header));
+    sf_ram_write(head + sizeof(header), span[0], (uint32_t)span_len[0]);
+    sf_ram_write(head + sizeof(header) + (uint32_t)span_len[0], span[1], (uint32_t)span_len[1]);
+    telemetry_ring_publish(&sf.ram, head + size);
+    sf.stats.pushed++;
+
+    uint32_t backlog = store_forward_backlog();
+    if (backlog > sf.stats.max_backlog) sf.stats.max_backlog = backlog;
+    return true;
+}
+
+uint32_t store_forward_pump(uint32_t budget_us) {
+    uint32_t start = time_us_32();
+    uint32_t sent = 0;
+
+    while (stdio_usb_connected() && time_us_32() - start < budget_us) {
+        // A flash guarda sempre registros mais antigos que os da RAM
+        const uint8_t *header = sf_flash_seek(&sf.flash_read, sf.flash_write);
+        uint32_t len;
+        if (header) {
+            len = sf_record_len(header);
+            fwrite(header + STORE_FORWARD_HEADER_BYTES, 1, len, stdout);
+            sf.flash_read += STORE_FORWARD_HEADER_BYTES + len;
+        } else if (sf_ram_front()) {
+            // Direto da RAM, em até dois trechos
+            len = sf_ram_front() - STORE_FORWARD_HEADER_BYTES;
+            uint8_t *data;
+            uint32_t first = sf_ram_span(sf.ram.tail + STORE_FORWARD_HEADER_BYTES, len, &data);
+            fwrite(data, 1, first, stdout);
+            if (first < len) fwrite(sf.ram.data, 1, len - first, stdout);
+            telemetry_ring_consume(&sf.ram, STORE_FORWARD_HEADER_BYTES + len);
+        } else {
+            break;
+        }
+        fflush(stdout);
+        sent++;
+    }
+    sf.stats.sent += sent;
+    return sent;
+}
+
+uint32_t store_forward_backlog(void) {
+    return telemetry_ring_used(&sf.ram) + (sf.flash_write - sf.flash_read);
+}
+
+void store_forward_get_stats(store_forward_stats_t *stats) {
+    *stats = sf.stats;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file store_forward.h
+ * @brief Armazenamento e reenvio da telemetria durante quedas do enlace
+ *
+ * Cada registro de telemetria (um bloco de linhas de texto ou um registro
+ * CBOR) entra em uma fila em RAM e só sai dela quando é transmitido por
+ * store_forward_pump() com o enlace USB conectado. Os registros passam
+ * por três níveis, sempre transmitidos na ordem em que entraram:
+ *
+ * 1. Fila em RAM (STORE_FORWARD_RAM_BYTES): absorve quedas curtas sem
+ *    tocar na flash.
+ * 2. Quando a fila passa de 3/4, os registros mais antigos são copiados
+ *    em páginas de 256 bytes para um registro circular no fim da flash
+ *    (STORE_FORWARD_FLASH_SECTORS setores de 4 kB), até a fila voltar à
+ *    metade. Um registro nunca atravessa uma página.
+ * 3. Com a flash cheia, os dois setores mais antigos são compactados em
+ *    um só: registros STORE_FORWARD_KEEP (mudanças do alarme de gás)
+ *    são mantidos e os STORE_FORWARD_DATA são dizimados (um a cada dois,
+ *    mais se ainda não couber). Como o setor compactado continua sendo o
+ *    mais antigo, dados mais velhos são dizimados repetidamente e o
+ *    histórico recente fica completo. Só se os alarmes sozinhos não
+ *    couberem os mais antigos são descartados.
+ *
+ * Enquanto a flash é apagada ou programada, o XIP fica indisponível: as
+ * interrupções habilitadas são suspensas, exceto a DMA_IRQ_0, cujo
+ * tratador (captura do ADC e alarme de gás) roda da RAM e só faz contas
+ * inteiras, sem as rotinas de ponto flutuante nem as auxiliares do
+ * compilador (__clzsi2), que ficam na flash. O relé continua respondendo
+ * ao MQ2 durante a gravação.
+ *
+ * O registro na flash não sobrevive a um reset; ele só estende a
+ * capacidade da fila.
+ */
+#ifndef STORE_FORWARD_H
+#define STORE_FORWARD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define STORE_FORWARD_RAM_BYTES 8192        // Fila em RAM (potência de dois)
+#define STORE_FORWARD_FLASH_SECTORS 64      // Setores de 4 kB no fim da flash (256 kB)
+#define STORE_FORWARD_HEADER_BYTES 3        // Tamanho (2 bytes) e classe de cada registro
+#define STORE_FORWARD_RECORD_MAX (256 - STORE_FORWARD_HEADER_BYTES)  // Cabe em uma página
+
+/**
+ * @brief Classe do registro, usada quando é preciso descartar
+ */
+typedef enum {
+    STORE_FORWARD_DATA = 0,     // Amostras periódicas: podem ser dizimadas
+    STORE_FORWARD_KEEP = 1,     // Alarmes e eventos: mantidos enquanto houver espaço
+} store_forward_class_t;
+
+/**
+ * @brief Contadores acumulados desde a inicialização
+ */
+typedef struct {
+    uint32_t pushed;            // Registros aceitos
+    uint32_t sent;              // Registros transmitidos
+    uint32_t spilled_pages;     // Páginas gravadas na flash
+    uint32_t compactions;       // Compactações de setores
+    uint32_t decimated;         // Registros DATA descartados na compactação
+    uint32_t dropped;           // Registros KEEP descartados ou grandes demais
+    uint32_t max_backlog;       // Maior pendência observada, em bytes
+} store_forward_stats_t;
+
+/**
+ * @brief Inicializa a fila (vazia; o conteúdo anterior da flash é ignorado)
+ */
+void store_forward_init(void);
+
+/**
+ * @brief Enfileira um registro
+ *
+ * Pode gravar páginas na flash (e compactar setores) para abrir espaço;
+ * deve ser chamada apenas do laço principal.
+ *
+ * @return false se o registro é vazio ou maior que STORE_FORWARD_RECORD_MAX
+ */
+bool store_forward_push(const uint8_t *data, size_t len, store_forward_class_t cls);
+
+/**
+ * @brief Enfileira um registro dado em dois trechos, como os de telemetry_ring_peek_all()
+ *
+ * Igual a store_forward_push(), mas o registro não precisa ser contíguo:
+ * os trechos são copiados direto para a fila.
+ */
+bool store_forward_push_spans(const uint8_t *const span[2], const size_t span_len[2], store_forward_class_t cls);
+
+/**
+ * @brief Transmite registros pendentes, em ordem, enquanto o enlace estiver conectado
+ *
+ * Escreve um registro por vez na saída padrão, na vazão do enlace, até a
+ * fila esvaziar, o enlace cair ou o orçamento de tempo acabar.
+ *
+ * @param budget_us Tempo máximo gasto na chamada
+ *
+ * @return Registros transmitidos
+ */
+uint32_t store_forward_pump(uint32_t budget_us);
+
+/**
+ * @brief Bytes pendentes (RAM e flash, incluindo cabeçalhos)
+ */
+uint32_t store_forward_backlog(void);
+
+/**
+ * @brief Copia os contadores
+ */
+void store_forward_get_stats(store_forward_stats_t *stats);
+
+#endif // STORE_FORWARD_H
@@ -0,0 +1,90 @@
+/**
+ * @file telemetry.c
+ * @brief Implementação da codificação em texto das amostras
+ */
+#include "telemetry.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int telemetry_format_sample(char *buf, size_t size, const telemetry_sample_t *sample) {
+    return telemetry_format_lines(buf, size, sample, TELEMETRY_LINE_ALL);
+}
+
+int telemetry_format_lines(char *buf, size_t size, const telemetry_sample_t *sample, unsigned int lines) {
+    int len = 0;
+    int n;
+
+    // Acumula o comprimento total mesmo quando o buffer já estiver cheio
+#define TELEMETRY_APPEND(...)                                                       \
+    do {                                                                            \
+        n = snprintf(buf + ((size_t)len < size ? (size_t)len : size),               \
+                     (size_t)len < size ? size - (size_t)len : 0, __VA_ARGS__);     \
+        if (n < 0) return n;                                                        \
+        len += n;                                                                   \
+    } while (0)
+
+    if (size > 0) buf[0] = '\0';
+
+    if (lines & TELEMETRY_LINE_DHT22) {
+        if (sample->dht22_result == 0) {
+            TELEMETRY_APPEND("Temperatura: %.1f °C | Umidade: %.1f %%\n",
+                             sample->temperature, sample->humidity);
+        } else {
+            TELEMETRY_APPEND("Erro na leitura do DHT22: código %d\n", sample->dht22_result);
+        }
+    }
+    if (lines & TELEMETRY_LINE_LDR) {
+        TELEMETRY_APPEND("LDR: %.2f V (Raw: %d)\n",
+                         telemetry_adc_to_voltage(sample->ldr_raw), sample->ldr_raw);
+    }
+    if (lines & TELEMETRY_LINE_MQ2) {
+        TELEMETRY_APPEND("MQ2: %.2f V (Raw: %d)\n",
+                         telemetry_adc_to_voltage(sample->mq2_raw), sample->mq2_raw);
+    }
+    if (lines & TELEMETRY_LINE_ALARM) {
+        TELEMETRY_APPEND("%s", sample->gas_alarm ? "Alarme ativado!\n" : "Alarme desativado.\n");
+    }
+
+#undef TELEMETRY_APPEND
+    return len;
+}
+
+unsigned int telemetry_deadband_select(const telemetry_deadband_t *policy, telemetry_deadband_state_t *state,
+                                       const telemetry_sample_t *sample, uint32_t now_ms) {
+    const telemetry_sample_t *last = &state->reported;
+    unsigned int lines = 0;
+
+    bool dht22_changed = sample->dht22_result != last->dht22_result;
+    if (!dht22_changed && sample->dht22_result == 0) {
+        dht22_changed = fabsf(sample->temperature - last->temperature) > policy->temperature_delta ||
+                        fabsf(sample->humidity - last->humidity) > policy->humidity_delta;
+    }
+    if (dht22_changed) lines |= TELEMETRY_LINE_DHT22;
+    if (abs((int)sample->ldr_raw - (int)last->ldr_raw) > policy->ldr_delta) lines |= TELEMETRY_LINE_LDR;
+    if (abs((int)sample->mq2_raw - (int)last->mq2_raw) > policy->mq2_delta) lines |= TELEMETRY_LINE_MQ2;
+    if (sample->gas_alarm != last->gas_alarm) lines |= TELEMETRY_LINE_ALARM;
+
+    // Linhas nunca emitidas ou em silêncio há tempo demais
+    for (int i = 0; i < TELEMETRY_LINE_COUNT; i++) {
+        unsigned int line = 1u << i;
+        if (!(state->valid & line) || now_ms - state->reported_ms[i] >= policy->max_silence_ms) {
+            lines |= line;
+        }
+    }
+
+    for (int i = 0; i < TELEMETRY_LINE_COUNT; i++) {
+        if (lines & (1u << i)) state->reported_ms[i] = now_ms;
+    }
+    if (lines & TELEMETRY_LINE_DHT22) {
+        state->reported.dht22_result = sample->dht22_result;
+        state->reported.temperature = sample->temperature;
+        state->reported.humidity = sample->humidity;
+    }
+    if (lines & TELEMETRY_LINE_LDR) state->reported.ldr_raw = sample->ldr_raw;
+    if (lines & TELEMETRY_LINE_MQ2) state->reported.mq2_raw = sample->mq2_raw;
+    if (lines & TELEMETRY_LINE_ALARM) state->reported.gas_alarm = sample->gas_alarm;
+    state->valid |= lines;
+    return lines;
+}
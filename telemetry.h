@@ -0,0 +1,138 @@
+/**
+ * @file telemetry.h
+ * @brief Registro de uma amostra do laço principal e sua codificação em texto
+ *
+ * Este módulo não depende do SDK do Pico: é compilado tanto no firmware
+ * quanto nas ferramentas de host (gerador de carga da frota), garantindo
+ * que ambos produzam exatamente o mesmo formato de telemetria.
+ *
+ * Relato por mudança (deadband): cada linha da telemetria só é emitida
+ * quando seu valor se afasta do último valor emitido por mais que um
+ * delta configurável, ou quando a linha fica em silêncio por mais que
+ * max_silence_ms (heartbeat). Limites de reconstrução para um receptor
+ * que mantém o último valor recebido de cada linha:
+ * - em todo instante de amostragem, |valor real - valor mantido| <= delta
+ *   do canal (mais o arredondamento do texto: 0,05 para temperatura e
+ *   umidade, 0,005 V para a tensão, exato para o código bruto);
+ * - o código de erro do DHT22 e o estado do alarme são exatos: qualquer
+ *   mudança é emitida na mesma amostra;
+ * - nenhuma linha fica sem ser emitida por mais que max_silence_ms mais
+ *   um período do laço.
+ * A comparação é sempre contra o último valor emitido, não contra a
+ * amostra anterior, então variações lentas não acumulam erro.
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Uma amostra completa de todos os sensores
+ */
+typedef struct {
+    int dht22_result;       // Código retornado por dht22_read() (DHT22_OK = 0)
+    float temperature;      // Temperatura em °C (válida se dht22_result == 0)
+    float humidity;         // Umidade em % (válida se dht22_result == 0)
+    uint16_t ldr_raw;       // Código do ADC0 (0-4095), compensado no firmware (adc_compensation.h)
+    uint16_t mq2_raw;       // Código do ADC1 (0-4095), compensado no firmware
+    bool gas_alarm;         // Estado do relé do alarme de gás
+} telemetry_sample_t;
+
+/**
+ * @brief Linhas da telemetria, usadas como máscara de bits
+ */
+typedef enum {
+    TELEMETRY_LINE_DHT22 = 1 << 0,  // Temperatura e umidade (ou erro do DHT22)
+    TELEMETRY_LINE_LDR = 1 << 1,
+    TELEMETRY_LINE_MQ2 = 1 << 2,
+    TELEMETRY_LINE_ALARM = 1 << 3,
+    TELEMETRY_LINE_ALL = 0x0F,
+} telemetry_line_t;
+
+#define TELEMETRY_LINE_COUNT 4
+
+/**
+ * @brief Política de relato por mudança
+ *
+ * Deltas em zero emitem qualquer mudança; max_silence_ms em zero emite
+ * todas as linhas a cada amostra (comportamento sem deadband).
+ */
+typedef struct {
+    float temperature_delta;    // °C
+    float humidity_delta;       // %
+    uint16_t ldr_delta;         // Código bruto do ADC
+    uint16_t mq2_delta;         // Código bruto do ADC
+    uint32_t max_silence_ms;    // Intervalo máximo sem emitir uma linha
+} telemetry_deadband_t;
+
+/**
+ * @brief Política padrão, compartilhada pelo firmware e pelas ferramentas de host
+ */
+#define TELEMETRY_DEADBAND_DEFAULT {0.2f, 0.5f, 40, 40, 60000}
+
+/**
+ * @brief Últimos valores emitidos de cada linha
+ *
+ * Deve começar zerado: a primeira amostra emite todas as linhas.
+ */
+typedef struct {
+    telemetry_sample_t reported;                    // Valores da última emissão
+    uint32_t reported_ms[TELEMETRY_LINE_COUNT];     // Instante da última emissão
+    unsigned int valid;                             // Linhas já emitidas (máscara)
+} telemetry_deadband_state_t;
+
+/**
+ * @brief Converte um código do ADC de 12 bits em tensão (0 - 3.3V)
+ */
+static inline float telemetry_adc_to_voltage(uint16_t raw) {
+    return (raw * 3.3f) / 4095.0f;
+}
+
+/**
+ * @brief Formata uma amostra como as linhas de texto enviadas pela serial
+ *
+ * Formato (uma linha por sensor):
+ * @code
+ * Temperatura: 24.5 °C | Umidade: 60.1 %      (ou: Erro na leitura do DHT22: código -2)
+ * LDR: 1.00 V (Raw: 1241)
+ * MQ2: 0.32 V (Raw: 400)
+ * Alarme desativado.                          (ou: Alarme ativado!)
+ * @endcode
+ *
+ * @param buf Buffer de saída
+ * @param size Tamanho do buffer em bytes
+ * @param sample Amostra a ser formatada
+ *
+ * @return Número de caracteres que o texto completo ocupa (como snprintf);
+ *         se for maior ou igual a size, a saída foi truncada
+ */
+int telemetry_format_sample(char *buf, size_t size, const telemetry_sample_t *sample);
+
+/**
+ * @brief Formata apenas as linhas selecionadas, na ordem de telemetry_format_sample()
+ *
+ * @param lines Máscara de telemetry_line_t
+ *
+ * @return Como telemetry_format_sample(); 0 se nenhuma linha foi selecionada
+ */
+int telemetry_format_lines(char *buf, size_t size, const telemetry_sample_t *sample, unsigned int lines);
+
+/**
+ * @brief Decide quais linhas de uma amostra devem ser emitidas
+ *
+ * Atualiza o estado das linhas selecionadas como se tivessem sido
+ * emitidas no instante now_ms.
+ *
+ * @param policy Política de relato
+ * @param state Estado da política (um por destino da telemetria)
+ * @param sample Amostra atual
+ * @param now_ms Instante da amostra em ms (pode dar a volta em 32 bits)
+ *
+ * @return Máscara de telemetry_line_t para telemetry_format_lines()
+ */
+unsigned int telemetry_deadband_select(const telemetry_deadband_t *policy, telemetry_deadband_state_t *state,
+                                       const telemetry_sample_t *sample, uint32_t now_ms);
+
+#endif // TELEMETRY_H
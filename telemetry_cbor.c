@@ -0,0 +1,213 @@
+/**
+ * @file telemetry_cbor.c
+ * @brief Implementação do codificador CBOR sobre a fila da telemetria
+ */
+#include "telemetry_cbor.h"
+
+#include <math.h>
+
+// Tipos maiores do CBOR (3 bits mais altos do byte inicial)
+#define CBOR_UINT (0u << 5)
+#define CBOR_NEGINT (1u << 5)
+#define CBOR_TEXT (3u << 5)
+#define CBOR_ARRAY (4u << 5)
+#define CBOR_MAP (5u << 5)
+#define CBOR_SIMPLE (7u << 5)
+
+#define CBOR_FALSE (CBOR_SIMPLE | 20)
+#define CBOR_TRUE (CBOR_SIMPLE | 21)
+#define CBOR_INDEFINITE 31
+#define CBOR_BREAK (CBOR_SIMPLE | 31)
+
+static inline void cbor_byte(telemetry_cbor_t *enc, uint8_t b) {
+    if (enc->head == enc->limit) {
+        enc->overflow = true;
+        return;
+    }
+    enc->ring->data[enc->head & enc->ring->mask] = b;
+    enc->head++;
+}
+
+/**
+ * @brief Byte inicial com o argumento na forma mais curta
+ */
+static void cbor_head(telemetry_cbor_t *enc, uint8_t major, uint32_t value) {
+    if (value < 24) {
+        cbor_byte(enc, (uint8_t)(major | value));
+    } else if (value <= 0xFF) {
+        cbor_byte(enc, major | 24);
+        cbor_byte(enc, (uint8_t)value);
+    } else if (value <= 0xFFFF) {
+        cbor_byte(enc, major | 25);
+        cbor_byte(enc, (uint8_t)(value >> 8));
+        cbor_byte(enc, (uint8_t)value);
+    } else {
+        cbor_byte(enc, major | 26);
+        cbor_byte(enc, (uint8_t)(value >> 24));
+        cbor_byte(enc, (uint8_t)(value >> 16));
+        cbor_byte(enc, (uint8_t)(value >> 8));
+        cbor_byte(enc, (uint8_t)value);
+    }
+}
+
+void telemetry_cbor_uint(telemetry_cbor_t *enc, uint32_t value) {
+    cbor_head(enc, CBOR_UINT, value);
+}
+
+void telemetry_cbor_uint64(telemetry_cbor_t *enc, uint64_t value) {
+    if (value <= UINT32_MAX) {
+        cbor_head(enc, CBOR_UINT, (uint32_t)value);
+        return;
+    }
+    cbor_byte(enc, CBOR_UINT | 27);
+    for (int shift = 56; shift >= 0; shift -= 8) cbor_byte(enc, (uint8_t)(value >> shift));
+}
+
+void telemetry_cbor_int(telemetry_cbor_t *enc, int32_t value) {
+    if (value >= 0) {
+        cbor_head(enc, CBOR_UINT, (uint32_t)value);
+    } else {
+        // -1 - n, sem estouro para INT32_MIN
+        cbor_head(enc, CBOR_NEGINT, (uint32_t)(-(value + 1)));
+    }
+}
+
+void telemetry_cbor_bool(telemetry_cbor_t *enc, bool value) {
+    cbor_byte(enc, value ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void telemetry_cbor_text(telemetry_cbor_t *enc, const char *text, size_t len) {
+    cbor_head(enc, CBOR_TEXT, (uint32_t)len);
+    for (size_t i = 0; i < len; i++) cbor_byte(enc, (uint8_t)text[i]);
+}
+
+void telemetry_cbor_array(telemetry_cbor_t *enc, uint32_t count) {
+    cbor_head(enc, CBOR_ARRAY, count);
+}
+
+void telemetry_cbor_map(telemetry_cbor_t *enc, uint32_t pairs) {
+    cbor_head(enc, CBOR_MAP, pairs);
+}
+
+void telemetry_cbor_array_indefinite(telemetry_cbor_t *enc) {
+    cbor_byte(enc, CBOR_ARRAY | CBOR_INDEFINITE);
+}
+
+void telemetry_cbor_break(telemetry_cbor_t *enc) {
+    cbor_byte(enc, CBOR_BREAK);
+}
+
+void telemetry_cbor_begin(telemetry_cbor_t *enc, telemetry_ring_t *ring) {
+    enc->ring = ring;
+    enc->head = ring->head;
+    enc->limit = ring->tail + ring->mask + 1;
+    enc->overflow = false;
+}
+
+bool telemetry_cbor_commit(telemetry_cbor_t *enc) {
+    if (enc->overflow) {
+        enc->ring->dropped++;
+        return false;
+    }
+    telemetry_ring_publish(enc->ring, enc->head);
+    return true;
+}
+
+static telemetry_cbor_utc_fn utc_source;
+
+void telemetry_cbor_set_utc_source(telemetry_cbor_utc_fn source) {
+    utc_source = source;
+}
+
+/**
+ * @brief Cabeçalho comum: mapa, tipo, instante e, com o relógio sincronizado, UTC
+ *
+ * A conversão para UTC é feita uma vez por registro: as amostras de um
+ * lote seguem só com o dt relativo à chave 1.
+ */
+static void cbor_record_header(telemetry_cbor_t *enc, uint32_t pairs, telemetry_cbor_record_t type, uint32_t t_ms) {
+    uint64_t utc_ms;
+    bool utc = utc_source && utc_source(t_ms, &utc_ms);
+    telemetry_cbor_map(enc, pairs + utc);
+    telemetry_cbor_uint(enc, 0);
+    telemetry_cbor_uint(enc, type);
+    telemetry_cbor_uint(enc, 1);
+    telemetry_cbor_uint(enc, t_ms);
+    if (utc) {
+        telemetry_cbor_uint(enc, 9);
+        telemetry_cbor_uint64(enc, utc_ms);
+    }
+}
+
+/**
+ * @brief Converte para décimos arredondando, como o "%.1f" do texto
+ */
+static int32_t cbor_tenths(float value) {
+    return (int32_t)lroundf(value * 10.0f);
+}
+
+void telemetry_cbor_batch_begin(telemetry_cbor_t *enc, telemetry_ring_t *ring, uint32_t t_ms) {
+    telemetry_cbor_begin(enc, ring);
+    cbor_record_header(enc, 3, TELEMETRY_CBOR_SAMPLE_BATCH, t_ms);
+    telemetry_cbor_uint(enc, 2);
+    telemetry_cbor_array_indefinite(enc);
+}
+
+void telemetry_cbor_batch_sample(telemetry_cbor_t *enc, uint32_t dt_ms, const telemetry_sample_t *sample) {
+    bool valid = sample->dht22_result == 0;
+    telemetry_cbor_array(enc, 7);
+    telemetry_cbor_uint(enc, dt_ms);
+    telemetry_cbor_int(enc, sample->dht22_result);
+    telemetry_cbor_int(enc, valid ? cbor_tenths(sample->temperature) : 0);
+    telemetry_cbor_int(enc, valid ? cbor_tenths(sample->humidity) : 0);
+    telemetry_cbor_uint(enc, sample->ldr_raw);
+    telemetry_cbor_uint(enc, sample->mq2_raw);
+    telemetry_cbor_bool(enc, sample->gas_alarm);
+}
+
+bool telemetry_cbor_batch_end(telemetry_cbor_t *enc) {
+    telemetry_cbor_break(enc);
+    return telemetry_cbor_commit(enc);
+}
+
+bool telemetry_cbor_actuator_event(telemetry_ring_t *ring, uint32_t t_ms, telemetry_actuator_t actuator,
+                                   uint32_t value) {
+    telemetry_cbor_t enc;
+    telemetry_cbor_begin(&enc, ring);
+    cbor_record_header(&enc, 4, TELEMETRY_CBOR_ACTUATOR_EVENT, t_ms);
+    telemetry_cbor_uint(&enc, 2);
+    telemetry_cbor_uint(&enc, actuator);
+    telemetry_cbor_uint(&enc, 3);
+    telemetry_cbor_uint(&enc, value);
+    return telemetry_cbor_commit(&enc);
+}
+
+bool telemetry_cbor_stats(telemetry_ring_t *ring, uint32_t t_ms, const telemetry_stats_t *stats) {
+    telemetry_cbor_t enc;
+    telemetry_cbor_begin(&enc, ring);
+    cbor_record_header(&enc, 5, TELEMETRY_CBOR_STATS, t_ms);
+
+    telemetry_cbor_uint(&enc, 2);
+    telemetry_cbor_array(&enc, 2);
+    telemetry_cbor_uint(&enc, stats->adc_blocks);
+    telemetry_cbor_uint(&enc, stats->ring_dropped);
+
+    telemetry_cbor_uint(&enc, 3);
+    telemetry_cbor_array(&enc, 3);
+    telemetry_cbor_uint(&enc, stats->gas_activations);
+    telemetry_cbor_uint(&enc, stats->gas_max_latency_us);
+    telemetry_cbor_uint(&enc, stats->gas_max_isr_us);
+
+    telemetry_cbor_uint(&enc, 4);
+    telemetry_cbor_array(&enc, TELEMETRY_CBOR_STATS_RULES);
+    for (int i = 0; i < TELEMETRY_CBOR_STATS_RULES; i++) {
+        const telemetry_rule_stats_t *r = &stats->rule[i];
+        telemetry_cbor_array(&enc, 5);
+        telemetry_cbor_uint(&enc, r->count);
+        telemetry_cbor_uint(&enc, r->rejected);
+        telemetry_cbor_uint(&enc, r->p50_us);
+        telemetry_cbor_uint(&enc, r->p99_us);
+        telemetry_cbor_uint(&enc, r->max_us);
+    }
+    return telemetry_cbor_commit(&enc);
+}
@@ -0,0 +1,167 @@
+/**
+ * @file telemetry_cbor.h
+ * @brief Codificação CBOR (RFC 8949) dos registros da telemetria
+ *
+ * O codificador escreve cada item diretamente na fila da telemetria
+ * (telemetry_ring.h), sem buffer intermediário e sem heap. Um registro é
+ * aberto com telemetry_cbor_begin(), preenchido com as funções de
+ * registro ou com as primitivas e publicado com telemetry_cbor_commit();
+ * se faltar espaço em qualquer ponto, o registro inteiro é descartado.
+ *
+ * Cada registro é um mapa CBOR com chaves inteiras pequenas:
+ * @code
+ * Comum a todos:   0: tipo do registro, 1: instante em ms desde o boot,
+ *                  9 (opcional): instante da chave 1 em ms UTC desde 1970,
+ *                  presente com o relógio sincronizado (wall_clock.h) e
+ *                  contado como um par a mais nos totais abaixo
+ *
+ * Lote de amostras (TELEMETRY_CBOR_SAMPLE_BATCH), 3 pares:
+ *   2: array indefinido de amostras, cada uma um array de 7 itens
+ *      [dt_ms desde a chave 1, código do DHT22, temperatura em décimos
+ *       de °C, umidade em décimos de %, LDR bruto, MQ2 bruto, alarme]
+ *
+ * Evento de atuador (TELEMETRY_CBOR_ACTUATOR_EVENT), 4 pares:
+ *   2: atuador (telemetry_actuator_t), 3: valor (relé/LED 0 ou 1,
+ *      servo em graus)
+ *
+ * Retrato das estatísticas (TELEMETRY_CBOR_STATS), 5 pares:
+ *   2: [blocos do ADC, registros descartados pela fila]
+ *   3: [acionamentos do alarme, maior latência us, maior ISR us]
+ *   4: array de regras, cada uma [comandos, rejeitados, p50 us, p99 us, máx us]
+ * @endcode
+ *
+ * Um lote fica aberto enquanto amostras são acrescentadas; ele é a única
+ * estrutura de tamanho indefinido, o que permite transmitir cada amostra
+ * sem conhecer antes o tamanho do lote. Enquanto um registro está aberto,
+ * nenhum outro pode ser aberto na mesma fila: feche o lote antes de
+ * escrever um evento.
+ */
+#ifndef TELEMETRY_CBOR_H
+#define TELEMETRY_CBOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+#include "telemetry_ring.h"
+
+#define TELEMETRY_CBOR_STATS_RULES 3    // Regras de latência no retrato
+
+/**
+ * @brief Tipos de registro (chave 0)
+ */
+typedef enum {
+    TELEMETRY_CBOR_SAMPLE_BATCH = 1,
+    TELEMETRY_CBOR_ACTUATOR_EVENT = 2,
+    TELEMETRY_CBOR_STATS = 3,
+} telemetry_cbor_record_t;
+
+/**
+ * @brief Atuadores dos eventos
+ */
+typedef enum {
+    TELEMETRY_ACTUATOR_RELAY = 0,
+    TELEMETRY_ACTUATOR_SERVO = 1,
+    TELEMETRY_ACTUATOR_LED = 2,
+} telemetry_actuator_t;
+
+/**
+ * @brief Resumo de uma regra de latência no retrato das estatísticas
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t rejected;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} telemetry_rule_stats_t;
+
+/**
+ * @brief Retrato das estatísticas do firmware
+ */
+typedef struct {
+    uint32_t adc_blocks;
+    uint32_t ring_dropped;
+    uint32_t gas_activations;
+    uint32_t gas_max_latency_us;
+    uint32_t gas_max_isr_us;
+    telemetry_rule_stats_t rule[TELEMETRY_CBOR_STATS_RULES];
+} telemetry_stats_t;
+
+/**
+ * @brief Registro em construção
+ */
+typedef struct {
+    telemetry_ring_t *ring;
+    uint32_t head;              // Cabeça privada (ainda não publicada)
+    uint32_t limit;             // Primeira posição que não pode ser escrita
+    bool overflow;              // Algum byte não coube
+} telemetry_cbor_t;
+
+/**
+ * @brief Converte um instante em ms desde o boot para ms UTC desde 1970
+ *
+ * @return false enquanto não há sincronia: o registro sai sem a chave 9
+ */
+typedef bool (*telemetry_cbor_utc_fn)(uint32_t t_ms, uint64_t *utc_ms);
+
+// Primitivas: escrevem um item CBOR na posição atual
+void telemetry_cbor_uint(telemetry_cbor_t *enc, uint32_t value);
+void telemetry_cbor_uint64(telemetry_cbor_t *enc, uint64_t value);
+void telemetry_cbor_int(telemetry_cbor_t *enc, int32_t value);
+void telemetry_cbor_bool(telemetry_cbor_t *enc, bool value);
+void telemetry_cbor_text(telemetry_cbor_t *enc, const char *text, size_t len);
+void telemetry_cbor_array(telemetry_cbor_t *enc, uint32_t count);
+void telemetry_cbor_map(telemetry_cbor_t *enc, uint32_t pairs);
+void telemetry_cbor_array_indefinite(telemetry_cbor_t *enc);
+void telemetry_cbor_break(telemetry_cbor_t *enc);
+
+/**
+ * @brief Passa a marcar os registros com UTC (chave 9); NULL desliga
+ *
+ * Com a rede, o firmware usa wall_clock_utc_ms_at().
+ */
+void telemetry_cbor_set_utc_source(telemetry_cbor_utc_fn source);
+
+/**
+ * @brief Abre um registro na fila
+ */
+void telemetry_cbor_begin(telemetry_cbor_t *enc, telemetry_ring_t *ring);
+
+/**
+ * @brief Publica o registro; se ele não coube, descarta e conta em ring->dropped
+ *
+ * @return true se o registro foi publicado
+ */
+bool telemetry_cbor_commit(telemetry_cbor_t *enc);
+
+/**
+ * @brief Abre um lote de amostras: begin + cabeçalho do lote
+ */
+void telemetry_cbor_batch_begin(telemetry_cbor_t *enc, telemetry_ring_t *ring, uint32_t t_ms);
+
+/**
+ * @brief Acrescenta uma amostra ao lote aberto
+ *
+ * @param dt_ms Instante da amostra relativo ao início do lote
+ */
+void telemetry_cbor_batch_sample(telemetry_cbor_t *enc, uint32_t dt_ms, const telemetry_sample_t *sample);
+
+/**
+ * @brief Fecha e publica o lote
+ */
+bool telemetry_cbor_batch_end(telemetry_cbor_t *enc);
+
+/**
+ * @brief Escreve e publica um evento de atuador
+ */
+bool telemetry_cbor_actuator_event(telemetry_ring_t *ring, uint32_t t_ms, telemetry_actuator_t actuator,
+                                   uint32_t value);
+
+/**
+ * @brief Escreve e publica um retrato das estatísticas
+ */
+bool telemetry_cbor_stats(telemetry_ring_t *ring, uint32_t t_ms, const telemetry_stats_t *stats);
+
+#endif // TELEMETRY_CBOR_H
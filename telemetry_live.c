@@ -0,0 +1,58 @@
+/**
+ * @file telemetry_live.c
+ * @brief Implementação da telemetria ao vivo
+ */
+#include "telemetry_live.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "store_forward.h"
+#include "ws_server.h"
+
+static telemetry_ring_t live_ring;
+static uint8_t live_storage[TELEMETRY_LIVE_RING_BYTES];
+static bool live_ready;
+
+static void live_begin(void) {
+    if (!live_ready) {
+        telemetry_ring_init(&live_ring, live_storage, sizeof(live_storage));
+        live_ready = true;
+    }
+}
+
+/**
+ * @brief Publica o registro que acabou de entrar na fila (em até dois trechos)
+ */
+static void live_publish(uint32_t t_ms) {
+    uint8_t record[STORE_FORWARD_RECORD_MAX];
+    size_t len = 0, n;
+    const uint8_t *data;
+    while ((n = telemetry_ring_peek(&live_ring, &data)) > 0) {
+        if (len + n <= sizeof(record)) memcpy(record + len, data, n);
+        len += n;
+        telemetry_ring_consume(&live_ring, n);
+    }
+    if (len > sizeof(record)) {
+        live_ring.dropped++;
+    } else if (len) {
+        ws_server_publish(record, (uint16_t)len, t_ms);
+    }
+}
+
+void telemetry_live_sample(uint32_t t_ms, const telemetry_sample_t *sample) {
+    if (!ws_server_has_clients()) return;
+    live_begin();
+    telemetry_cbor_t batch;
+    telemetry_cbor_batch_begin(&batch, &live_ring, t_ms);
+    telemetry_cbor_batch_sample(&batch, 0, sample);
+    telemetry_cbor_batch_end(&batch);
+    live_publish(t_ms);
+}
+
+void telemetry_live_actuator(uint32_t t_ms, telemetry_actuator_t actuator, uint32_t value) {
+    if (!ws_server_has_clients()) return;
+    live_begin();
+    telemetry_cbor_actuator_event(&live_ring, t_ms, actuator, value);
+    live_publish(t_ms);
+}
@@ -0,0 +1,30 @@
+/**
+ * @file telemetry_live.h
+ * @brief Telemetria ao vivo para painéis, pelo servidor WebSocket (ws_server.h)
+ *
+ * Independente do formato da serial: cada amostra do laço sai na hora
+ * como um lote CBOR de uma amostra, e cada evento de atuador como o
+ * registro de evento, nos esquemas de telemetry_cbor.h (com o UTC,
+ * quando o relógio está sincronizado). Sem clientes conectados, nada é
+ * codificado.
+ */
+#ifndef TELEMETRY_LIVE_H
+#define TELEMETRY_LIVE_H
+
+#include <stdint.h>
+
+#include "telemetry_cbor.h"
+
+#define TELEMETRY_LIVE_RING_BYTES 512       // Potência de dois, maior que um registro
+
+/**
+ * @brief Publica uma amostra
+ */
+void telemetry_live_sample(uint32_t t_ms, const telemetry_sample_t *sample);
+
+/**
+ * @brief Publica um evento de atuador
+ */
+void telemetry_live_actuator(uint32_t t_ms, telemetry_actuator_t actuator, uint32_t value);
+
+#endif // TELEMETRY_LIVE_H
@@ -0,0 +1,53 @@
+/**
+ * @file telemetry_ring.c
+ * @brief Implementação da fila circular de bytes da telemetria
+ */
+#include "telemetry_ring.h"
+
+bool telemetry_ring_init(telemetry_ring_t *ring, uint8_t *storage, uint32_t size) {
+    if (size == 0 || (size & (size - 1)) != 0) return false;
+    ring->data = storage;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    return true;
+}
+
+void telemetry_ring_publish(telemetry_ring_t *ring, uint32_t new_head) {
+    // Os bytes do registro devem estar visíveis antes da nova cabeça
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    ring->head = new_head;
+}
+
+size_t telemetry_ring_peek(const telemetry_ring_t *ring, const uint8_t **data) {
+    uint32_t head = ring->head;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t tail = ring->tail;
+    uint32_t offset = tail & ring->mask;
+    uint32_t used = head - tail;
+    uint32_t contiguous = ring->mask + 1 - offset;
+
+    *data = ring->data + offset;
+    return used < contiguous ? used : contiguous;
+}
+
+size_t telemetry_ring_peek_all(const telemetry_ring_t *ring, const uint8_t *span[2], size_t span_len[2]) {
+    uint32_t head = ring->head;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t tail = ring->tail;
+    uint32_t offset = tail & ring->mask;
+    uint32_t used = head - tail;
+    uint32_t contiguous = ring->mask + 1 - offset;
+
+    span[0] = ring->data + offset;
+    span_len[0] = used < contiguous ? used : contiguous;
+    span[1] = ring->data;
+    span_len[1] = used - span_len[0];
+    return used;
+}
+
+void telemetry_ring_consume(telemetry_ring_t *ring, size_t n) {
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    ring->tail += (uint32_t)n;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file telemetry_ring.h
+ * @brief Fila circular de bytes da telemetria (um produtor, um consumidor)
+ *
+ * O produtor escreve direto no armazenamento da fila a partir de uma
+ * cabeça privada e publica o registro inteiro de uma vez; um registro
+ * que não cabe é descartado por completo, nunca fica pela metade. O
+ * consumidor lê trechos contíguos sem cópia (peek/consume).
+ */
+#ifndef TELEMETRY_RING_H
+#define TELEMETRY_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Fila circular; o tamanho é potência de dois
+ */
+typedef struct {
+    uint8_t *data;
+    uint32_t mask;              // Tamanho - 1
+    volatile uint32_t head;     // Próximo byte a publicar (produtor)
+    volatile uint32_t tail;     // Próximo byte a ler (consumidor)
+    uint32_t dropped;           // Registros descartados por falta de espaço
+} telemetry_ring_t;
+
+/**
+ * @brief Inicializa a fila sobre um armazenamento do chamador
+ *
+ * @param size Tamanho do armazenamento em bytes (potência de dois)
+ *
+ * @return false se size não é potência de dois
+ */
+bool telemetry_ring_init(telemetry_ring_t *ring, uint8_t *storage, uint32_t size);
+
+/**
+ * @brief Bytes publicados e ainda não consumidos
+ */
+static inline uint32_t telemetry_ring_used(const telemetry_ring_t *ring) {
+    return ring->head - ring->tail;
+}
+
+/**
+ * @brief Publica os bytes escritos até new_head (uso do produtor)
+ */
+void telemetry_ring_publish(telemetry_ring_t *ring, uint32_t new_head);
+
+/**
+ * @brief Trecho contíguo mais longo disponível para leitura
+ *
+ * @param data Recebe o início do trecho
+ *
+ * @return Tamanho do trecho (0 se a fila está vazia)
+ */
+size_t telemetry_ring_peek(const telemetry_ring_t *ring, const uint8_t **data);
+
+/**
+ * @brief Todos os bytes disponíveis para leitura, em até dois trechos contíguos
+ *
+ * O segundo trecho, no início do armazenamento, só existe quando os
+ * bytes dão a volta.
+ *
+ * @param span Recebe o início de cada trecho
+ * @param span_len Recebe o tamanho de cada trecho (o segundo pode ser 0)
+ *
+ * @return Total de bytes (0 se a fila está vazia)
+ */
+size_t telemetry_ring_peek_all(const telemetry_ring_t *ring, const uint8_t *span[2], size_t span_len[2]);
+
+/**
+ * @brief Libera n bytes já lidos com telemetry_ring_peek()
+ */
+void telemetry_ring_consume(telemetry_ring_t *ring, size_t n);
+
+#endif // TELEMETRY_RING_H
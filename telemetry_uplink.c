@@ -0,0 +1,122 @@
+/**
+ * @file telemetry_uplink.c
+ * @brief Implementação da telemetria binária CBOR
+ */
+#include "telemetry_uplink.h"
+
+#include <stdbool.h>
+
+#include "pico/stdlib.h"
+#include "adc_capture.h"
+#include "gas_alarm.h"
+#include "latency_trace.h"
+#include "store_forward.h"
+
+/**
+ * @brief Estado do envio
+ */
+typedef struct {
+    telemetry_ring_t ring;
+    telemetry_cbor_t batch;         // Lote aberto na fila
+    bool batch_open;
+    uint32_t batch_start_ms;
+    uint32_t batch_samples;
+    uint32_t last_stats_ms;
+    bool ready;
+} telemetry_uplink_state_t;
+
+static telemetry_uplink_state_t uplink;
+static uint8_t uplink_storage[TELEMETRY_UPLINK_RING_BYTES];
+
+static uint32_t uplink_now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static void uplink_init(void) {
+    telemetry_ring_init(&uplink.ring, uplink_storage, sizeof(uplink_storage));
+    uplink.last_stats_ms = uplink_now_ms();
+    uplink.ready = true;
+}
+
+/**
+ * @brief Entrega o registro publicado à fila de reenvio
+ *
+ * Chamada após cada registro publicado, então a fila contém exatamente
+ * um registro (em até dois trechos, se der a volta). Os trechos vão
+ * direto da fila para a de reenvio, sem cópia intermediária.
+ */
+static void uplink_drain(store_forward_class_t cls) {
+    const uint8_t *span[2];
+    size_t span_len[2];
+    size_t len = telemetry_ring_peek_all(&uplink.ring, span, span_len);
+    if (len > STORE_FORWARD_RECORD_MAX) {
+        uplink.ring.dropped++;
+    } else if (len) {
+        store_forward_push_spans(span, span_len, cls);
+    }
+    telemetry_ring_consume(&uplink.ring, len);
+}
+
+static void uplink_close_batch(void) {
+    if (!uplink.batch_open) return;
+    telemetry_cbor_batch_end(&uplink.batch);
+    uplink.batch_open = false;
+    uplink_drain(STORE_FORWARD_DATA);
+}
+
+static void uplink_stats(uint32_t now_ms) {
+    telemetry_stats_t stats = {
+        .adc_blocks = adc_capture_block_count(),
+        .ring_dropped = uplink.ring.dropped,
+    };
+
+    gas_alarm_stats_t gas;
+    gas_alarm_get_stats(&gas);
+    stats.gas_activations = gas.activations;
+    stats.gas_max_latency_us = gas.max_latency_us;
+    stats.gas_max_isr_us = gas.max_isr_us;
+
+    for (int r = 0; r < TELEMETRY_CBOR_STATS_RULES && r < LATENCY_RULE_COUNT; r++) {
+        latency_histogram_t h;
+        latency_trace_get((latency_rule_t)r, &h);
+        stats.rule[r] = (telemetry_rule_stats_t){
+            .count = h.count,
+            .rejected = h.rejected,
+            .p50_us = latency_trace_percentile(&h, 50.0f),
+            .p99_us = latency_trace_percentile(&h, 99.0f),
+            .max_us = h.max_us,
+        };
+    }
+
+    telemetry_cbor_stats(&uplink.ring, now_ms, &stats);
+    uplink_drain(STORE_FORWARD_DATA);
+}
+
+void telemetry_uplink_sample(const telemetry_sample_t *sample) {
+    if (!uplink.ready) uplink_init();
+    uint32_t now = uplink_now_ms();
+
+    if (!uplink.batch_open) {
+        telemetry_cbor_batch_begin(&uplink.batch, &uplink.ring, now);
+        uplink.batch_open = true;
+        uplink.batch_start_ms = now;
+        uplink.batch_samples = 0;
+    }
+    telemetry_cbor_batch_sample(&uplink.batch, now - uplink.batch_start_ms, sample);
+    if (++uplink.batch_samples == TELEMETRY_UPLINK_BATCH_SAMPLES) {
+        uplink_close_batch();
+    }
+
+    if (now - uplink.last_stats_ms >= TELEMETRY_UPLINK_STATS_MS) {
+        uplink_close_batch();
+        uplink_stats(now);
+        uplink.last_stats_ms = now;
+    }
+}
+
+void telemetry_uplink_actuator(telemetry_actuator_t actuator, uint32_t value) {
+    if (!uplink.ready) uplink_init();
+    uplink_close_batch();
+    telemetry_cbor_actuator_event(&uplink.ring, uplink_now_ms(), actuator, value);
+    uplink_drain(actuator == TELEMETRY_ACTUATOR_RELAY ? STORE_FORWARD_KEEP : STORE_FORWARD_DATA);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file telemetry_uplink.h
+ * @brief Telemetria binária CBOR para o backend, pela fila da telemetria
+ *
+ * Alternativa ao texto de telemetry_format_lines(), habilitada com
+ * TELEMETRY_FORMAT_CBOR=1 em environment-monitoring.c. As amostras do
+ * laço são acumuladas em um lote aberto na fila (até
+ * TELEMETRY_UPLINK_BATCH_SAMPLES); eventos de atuador fecham o lote e
+ * são enviados na hora; um retrato das estatísticas sai a cada
+ * TELEMETRY_UPLINK_STATS_MS. Cada registro publicado segue para a fila
+ * de reenvio (store_forward.h): os eventos do relé (alarme de gás) são
+ * mantidos em quedas longas do enlace; os demais podem ser dizimados.
+ *
+ * Os registros seguem os esquemas de telemetry_cbor.h e podem ser
+ * conferidos no host com telemetry_decode.
+ */
+#ifndef TELEMETRY_UPLINK_H
+#define TELEMETRY_UPLINK_H
+
+#include <stdint.h>
+
+#include "telemetry.h"
+#include "telemetry_cbor.h"
+
+#define TELEMETRY_UPLINK_RING_BYTES 2048    // Potência de dois
+#define TELEMETRY_UPLINK_BATCH_SAMPLES 8    // Amostras por lote
+#define TELEMETRY_UPLINK_STATS_MS 60000     // Intervalo entre retratos das estatísticas
+
+/**
+ * @brief Acrescenta uma amostra ao lote atual
+ */
+void telemetry_uplink_sample(const telemetry_sample_t *sample);
+
+/**
+ * @brief Envia um evento de atuador (fecha o lote aberto antes)
+ */
+void telemetry_uplink_actuator(telemetry_actuator_t actuator, uint32_t value);
+
+#endif // TELEMETRY_UPLINK_H
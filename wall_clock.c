@@ -0,0 +1,161 @@
+/**
+ * @file wall_clock.c
+ * @brief Implementação do relógio UTC disciplinado
+ */
+#include "wall_clock.h"
+
+#define NS_PER_S 1000000000
+#define WALL_CLOCK_FREQ_GAIN 4              // Peso da nova reta na frequência: 1 / 4
+
+typedef struct {
+    uint64_t local_us;
+    int64_t offset_us;
+    uint32_t delay_us;
+} wall_clock_sample_t;
+
+static struct {
+    wall_clock_sample_t history[WALL_CLOCK_HISTORY];
+    uint8_t count;
+    uint8_t next;
+
+    // UTC(local) = base_utc + dt + dt * freq + corr * min(dt, slew) / slew, com dt = local - base_local
+    uint64_t base_local_us;
+    int64_t base_utc_us;
+    int32_t freq_ppb;
+    bool freq_known;                // freq_ppb já veio de uma reta
+    int64_t corr_us;                // Erro de fase em correção gradual
+    int64_t slew_us;                // Duração da correção (0: nenhuma)
+
+    wall_clock_stats_t stats;
+} wall;
+
+/**
+ * @brief UTC pelo mapeamento atual
+ *
+ * dt * freq cabe em 64 bits até 200 dias da atualização com o desvio no
+ * limite; com |freq| e a taxa de correção até WALL_CLOCK_MAX_PPM, a
+ * derivada fica positiva e o relógio nunca volta atrás.
+ */
+static int64_t utc_at(uint64_t local_us) {
+    int64_t dt = (int64_t)(local_us - wall.base_local_us);
+    int64_t utc = wall.base_utc_us + dt + dt * wall.freq_ppb / NS_PER_S;
+    if (wall.slew_us) {
+        int64_t s = dt < 0 ? 0 : dt > wall.slew_us ? wall.slew_us : dt;
+        utc += wall.corr_us * s / wall.slew_us;
+    }
+    return utc;
+}
+
+void wall_clock_init(void) {
+    wall.count = 0;
+    wall.next = 0;
+    wall.freq_ppb = 0;
+    wall.freq_known = false;
+    wall.corr_us = 0;
+    wall.slew_us = 0;
+    wall.stats = (wall_clock_stats_t){0};
+}
+
+/**
+ * @brief Diferença UTC - local esperada em local_us, pelas medidas filtradas
+ *
+ * Só entram as WALL_CLOCK_FIT_SAMPLES medidas de menor atraso. Com
+ * intervalo suficiente entre elas, ajusta a reta e atualiza a
+ * frequência; senão, usa a média delas com a frequência atual.
+ */
+static int64_t estimate_offset(uint64_t local_us) {
+    // Índices do histórico em ordem de atraso (inserção: no máximo WALL_CLOCK_HISTORY)
+    uint8_t order[WALL_CLOCK_HISTORY];
+    for (int i = 0; i < wall.count; i++) {
+        int j = i;
+        while (j > 0 && wall.history[order[j - 1]].delay_us > wall.history[i].delay_us) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint8_t)i;
+    }
+    int n = wall.count < WALL_CLOCK_FIT_SAMPLES ? wall.count : WALL_CLOCK_FIT_SAMPLES;
+    wall.stats.min_delay_us = wall.history[order[0]].delay_us;
+    wall.stats.used = (uint8_t)n;
+
+    // Tempos em segundos relativos a local_us e diferenças em us relativas à
+    // de menor atraso (a absoluta, ~10^15 us, perderia a precisão nas somas):
+    // a inclinação sai em ppm
+    int64_t ref = wall.history[order[0]].offset_us;
+    double st = 0, so = 0, stt = 0, sto = 0, extrapolated = 0;
+    double t_min = 0, t_max = 0;
+    for (int i = 0; i < n; i++) {
+        const wall_clock_sample_t *s = &wall.history[order[i]];
+        double t = (double)(int64_t)(s->local_us - local_us) / 1e6;
+        double o = (double)(s->offset_us - ref);
+        st += t;
+        so += o;
+        stt += t * t;
+        sto += t * o;
+        extrapolated += o - t * wall.freq_ppb / 1000.0;
+        if (!i || t < t_min) t_min = t;
+        if (!i || t > t_max) t_max = t;
+    }
+
+    double den = n * stt - st * st;
+    if (n >= 3 && (t_max - t_min) * 1e6 >= WALL_CLOCK_FREQ_MIN_SPAN_US && den > 0) {
+        double ppm = (n * sto - st * so) / den;
+        if (ppm > WALL_CLOCK_MAX_PPM) ppm = WALL_CLOCK_MAX_PPM;
+        if (ppm < -WALL_CLOCK_MAX_PPM) ppm = -WALL_CLOCK_MAX_PPM;
+        // Retas seguidas dividem quase todas as medidas: a média amortece o ruído da inclinação
+        if (wall.freq_known) ppm = wall.freq_ppb / 1000.0 + (ppm - wall.freq_ppb / 1000.0) / WALL_CLOCK_FREQ_GAIN;
+        wall.freq_known = true;
+        wall.freq_ppb = (int32_t)(ppm * 1000.0);
+        return ref + (int64_t)((so - ppm * st) / n);
+    }
+    return ref + (int64_t)(extrapolated / n);
+}
+
+void wall_clock_update(uint64_t local_us, int64_t offset_us, uint32_t delay_us) {
+    wall.history[wall.next] = (wall_clock_sample_t){local_us, offset_us, delay_us};
+    wall.next = (uint8_t)((wall.next + 1) % WALL_CLOCK_HISTORY);
+    if (wall.count < WALL_CLOCK_HISTORY) wall.count++;
+    wall.stats.updates++;
+
+    // A nova frequência vale a partir daqui: o mapeamento é refeito com base em local_us
+    int64_t current = wall.stats.synced ? utc_at(local_us) : 0;
+    int64_t target = (int64_t)local_us + estimate_offset(local_us);
+    int64_t err = target - current;
+    int64_t abs_err = err < 0 ? -err : err;
+
+    wall.base_local_us = local_us;
+    if (!wall.stats.synced || abs_err > WALL_CLOCK_STEP_US) {
+        wall.base_utc_us = target;
+        wall.corr_us = 0;
+        wall.slew_us = 0;
+        wall.stats.offset_us = wall.stats.synced ? err : 0;
+        wall.stats.synced = true;
+        wall.stats.steps++;
+        return;
+    }
+    int64_t min_slew = abs_err * (1000000 / WALL_CLOCK_MAX_PPM);
+    wall.base_utc_us = current;
+    wall.corr_us = err;
+    wall.slew_us = min_slew > WALL_CLOCK_SLEW_US ? min_slew : WALL_CLOCK_SLEW_US;
+    wall.stats.offset_us = err;
+}
+
+bool wall_clock_utc_us(uint64_t local_us, int64_t *utc_us) {
+    if (!wall.stats.synced) return false;
+    *utc_us = utc_at(local_us);
+    return true;
+}
+
+bool wall_clock_utc_ms_at(uint32_t boot_ms, uint64_t *utc_ms) {
+    if (!wall.stats.synced) return false;
+    uint64_t base_ms = wall.base_local_us / 1000;
+    int64_t local_ms = (int64_t)base_ms + (int32_t)(boot_ms - (uint32_t)base_ms);
+    if (local_ms < 0) return false;
+    *utc_ms = (uint64_t)(utc_at((uint64_t)local_ms * 1000) / 1000);
+    return true;
+}
+
+void wall_clock_get_stats(wall_clock_stats_t *stats) {
+    *stats = wall.stats;
+    stats->freq_ppb = wall.freq_ppb;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file wall_clock.h
+ * @brief Relógio UTC de 64 bits disciplinado a partir do temporizador de microssegundos
+ *
+ * O firmware marca o tempo em ms desde o boot; para correlacionar
+ * leituras de várias placas, os registros da telemetria também levam o
+ * instante UTC (telemetry_cbor.h). Este módulo mantém a relação entre o
+ * relógio local (time_us_64(), o cristal da placa) e UTC a partir das
+ * medidas do cliente SNTP (sntp_client.h): em cada troca, a diferença
+ * UTC - local no meio da troca e o atraso de ida e volta.
+ *
+ * - Filtro: das últimas WALL_CLOCK_HISTORY medidas, só entram as
+ *   WALL_CLOCK_FIT_SAMPLES de menor atraso, as que menos sofreram com
+ *   filas e assimetria do caminho.
+ * - Frequência: com as medidas filtradas cobrindo ao menos
+ *   WALL_CLOCK_FREQ_MIN_SPAN_US, a reta de mínimos quadrados da diferença
+ *   contra o tempo local dá o desvio do cristal (ppb, limitado a
+ *   ±WALL_CLOCK_MAX_PPM), que entra na estimativa com peso 1/4, e a
+ *   diferença esperada agora.
+ * - Fase: a primeira medida, ou um erro acima de WALL_CLOCK_STEP_US,
+ *   ajusta o relógio num salto; erros menores são corrigidos aos poucos
+ *   (em WALL_CLOCK_SLEW_US, ou mais devagar para não passar de
+ *   WALL_CLOCK_MAX_PPM), sem que o relógio volte atrás.
+ *
+ * A conversão (wall_clock_utc_us) é inteira, sem float: duas
+ * multiplicações e duas divisões de 64 bits (a do desvio e a da correção
+ * gradual), que no Cortex-M0+ são rotinas de software de algumas
+ * centenas de ciclos; a atualização usa double, uma vez por consulta ao
+ * servidor. Tudo roda no laço principal, sem travas.
+ */
+#ifndef WALL_CLOCK_H
+#define WALL_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef WALL_CLOCK_HISTORY
+#define WALL_CLOCK_HISTORY 16                   // Medidas guardadas para o filtro e a reta
+#endif
+#define WALL_CLOCK_FIT_SAMPLES ((WALL_CLOCK_HISTORY + 1) / 2) // Medidas de menor atraso na reta
+#ifndef WALL_CLOCK_FREQ_MIN_SPAN_US
+#define WALL_CLOCK_FREQ_MIN_SPAN_US 60000000    // Intervalo mínimo das medidas para estimar a frequência
+#endif
+#ifndef WALL_CLOCK_STEP_US
+#define WALL_CLOCK_STEP_US 128000               // Erro de fase corrigido num salto
+#endif
+#ifndef WALL_CLOCK_SLEW_US
+#define WALL_CLOCK_SLEW_US 16000000             // Duração da correção gradual da fase
+#endif
+#define WALL_CLOCK_MAX_PPM 500                  // Maior desvio de frequência e taxa de correção
+
+/**
+ * @brief Estado da disciplina do relógio
+ */
+typedef struct {
+    bool synced;                // Já houve uma medida: a conversão é válida
+    int64_t offset_us;          // Erro de fase na última atualização
+    int32_t freq_ppb;           // Desvio estimado: UTC avança (1 + freq) por unidade local
+    uint32_t min_delay_us;      // Menor atraso do histórico
+    uint8_t used;               // Medidas que passaram pelo filtro na última atualização
+    uint32_t updates;           // Medidas recebidas
+    uint32_t steps;             // Ajustes por salto
+} wall_clock_stats_t;
+
+/**
+ * @brief Descarta o histórico; o relógio fica sem sincronia
+ */
+void wall_clock_init(void);
+
+/**
+ * @brief Entrega uma medida do SNTP
+ *
+ * @param local_us Relógio local no meio da troca
+ * @param offset_us UTC - relógio local nesse instante (us)
+ * @param delay_us Atraso de ida e volta da troca
+ */
+void wall_clock_update(uint64_t local_us, int64_t offset_us, uint32_t delay_us);
+
+/**
+ * @brief UTC (us desde 1970) num instante do relógio local
+ *
+ * @return false sem sincronia; utc_us não é alterado
+ */
+bool wall_clock_utc_us(uint64_t local_us, int64_t *utc_us);
+
+/**
+ * @brief UTC (ms desde 1970) de um instante em ms desde o boot de 32 bits
+ *
+ * O instante é tomado como o mais próximo da última atualização, o que
+ * vale para instantes a até 24 dias dela.
+ */
+bool wall_clock_utc_ms_at(uint32_t boot_ms, uint64_t *utc_ms);
+
+void wall_clock_get_stats(wall_clock_stats_t *stats);
+
+#endif // WALL_CLOCK_H
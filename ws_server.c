@@ -0,0 +1,464 @@
+/**
+ * @file ws_server.c
+ * @brief Implementação do servidor WebSocket
+ */
+#include "ws_server.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+static_assert(WS_SERVER_CLIENT_QUEUE < TELEMETRY_FRAME_BLOCKS,
+              "as filas dos clientes prendem até WS_SERVER_CLIENT_QUEUE + 1 quadros do pool");
+static_assert(WS_SERVER_CLIENTS < 255, "refs do quadro tem 8 bits: um por cliente mais o do próprio publish");
+static_assert(STORE_FORWARD_RECORD_MAX <= 0xFFFF, "o cabeçalho usa o tamanho estendido de 16 bits");
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+// Quadros de RFC 6455, seção 5.2
+#define WS_FIN 0x80
+#define WS_OP_BINARY 0x2
+#define WS_OP_CLOSE 0x8
+#define WS_OP_PING 0x9
+#define WS_OP_PONG 0xA
+#define WS_MASKED 0x80
+#define WS_CONTROL_MAX 125
+
+typedef enum {
+    WS_CLIENT_FREE,
+    WS_CLIENT_HANDSHAKE,        // Conexão aceita, esperando a requisição de upgrade
+    WS_CLIENT_OPEN,             // Recebendo quadros
+} ws_client_state_t;
+
+typedef struct {
+    ws_client_state_t state;
+    net_tcp_t *conn;
+    uint32_t since_ms;          // Handshake: aceite; aberto: último avanço da fila
+    telemetry_frame_t *queue[WS_SERVER_CLIENT_QUEUE];
+    uint8_t head, count;
+    uint16_t sent;              // Bytes já aceitos da mensagem em envio (cabeçalho incluído)
+    bool sending_control;       // A mensagem em envio é control, não a frente da fila
+    uint8_t control_len;        // Pong pendente (cabeçalho e carga), 0 se nenhum
+    uint8_t control[2 + WS_CONTROL_MAX];
+    uint32_t skip;              // Carga de quadro de dados do cliente ainda a descartar
+    uint16_t rx_len;
+    uint8_t rx[WS_SERVER_REQUEST_BYTES];
+} ws_client_t;
+
+static struct {
+    net_tcp_listener_t *listener;
+    ws_client_t clients[WS_SERVER_CLIENTS];
+    uint32_t last_poll_ms;
+    ws_server_stats_t stats;
+} ws;
+
+// Mensagem em envio: cabeçalho e carga juntos, para uma escrita só no TCP
+static uint8_t wire[4 + STORE_FORWARD_RECORD_MAX];
+
+/**
+ * @brief SHA-1 de uma mensagem curta (RFC 3174), só para Sec-WebSocket-Accept
+ */
+static void sha1(const uint8_t *data, size_t len, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    uint64_t bits = (uint64_t)len * 8;
+    size_t blocks = (len + 8) / 64 + 1;
+
+    for (size_t b = 0; b < blocks; b++) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            uint32_t word = 0;
+            for (int j = 0; j < 4; j++) {
+                size_t pos = b * 64 + (size_t)i * 4 + (size_t)j;
+                uint8_t byte;
+                if (pos < len) byte = data[pos];
+                else if (pos == len) byte = 0x80;
+                else if (pos >= blocks * 64 - 8) byte = (uint8_t)(bits >> (8 * (blocks * 64 - 1 - pos)));
+                else byte = 0;
+                word = word << 8 | byte;
+            }
+            w[i] = word;
+        }
+        for (int i = 16; i < 80; i++) {
+            uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = x << 1 | x >> 31;
+        }
+
+        uint32_t a = h[0], bb = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (bb & c) | (~bb & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = bb ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (bb & c) | (bb & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = bb ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t t = (a << 5 | a >> 27) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = bb << 30 | bb >> 2;
+            bb = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += bb;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    for (int i = 0; i < 20; i++) digest[i] = (uint8_t)(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+static size_t base64(const uint8_t *data, size_t len, char *out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        out[n++] = alphabet[v >> 18 & 63];
+        out[n++] = alphabet[v >> 12 & 63];
+        out[n++] = i + 1 < len ? alphabet[v >> 6 & 63] : '=';
+        out[n++] = i + 2 < len ? alphabet[v & 63] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Valor de um cabeçalho HTTP (nome sem diferença de caixa), sem os espaços das pontas
+ *
+ * @return Início do valor, ou NULL se o cabeçalho não está na requisição
+ */
+static const char *header_value(const char *request, const char *name, size_t *len) {
+    size_t name_len = strlen(name);
+    for (const char *line = strstr(request, "\r\n"); line; line = strstr(line, "\r\n")) {
+        line += 2;
+        size_t i = 0;
+        while (i < name_len && line[i] && tolower((unsigned char)line[i]) == name[i]) i++;
+        if (i < name_len || line[i] != ':') continue;
+        const char *value = line + i + 1;
+        while (*value == ' ' || *value == '\t') value++;
+        const char *end = strstr(value, "\r\n");
+        while (end > value && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        *len = (size_t)(end - value);
+        return value;
+    }
+    return NULL;
+}
+
+static bool contains_token(const char *value, size_t len, const char *token) {
+    size_t token_len = strlen(token);
+    for (size_t i = 0; i + token_len <= len; i++) {
+        size_t j = 0;
+        while (j < token_len && tolower((unsigned char)value[i + j]) == token[j]) j++;
+        if (j == token_len) return true;
+    }
+    return false;
+}
+
+static void release(telemetry_frame_t *frame) {
+    if (--frame->refs == 0) telemetry_frame_free(frame);
+}
+
+static void drop(ws_client_t *c) {
+    for (; c->count; c->count--) {
+        release(c->queue[c->head]);
+        c->head = (uint8_t)((c->head + 1) % WS_SERVER_CLIENT_QUEUE);
+    }
+    net_tcp_close(c->conn);
+    if (c->state == WS_CLIENT_OPEN) ws.stats.clients--;
+    c->state = WS_CLIENT_FREE;
+}
+
+/**
+ * @brief Responde à requisição de upgrade, se já chegou inteira
+ *
+ * @return false se o cliente foi derrubado
+ */
+static bool handshake(ws_client_t *c, uint32_t now_ms) {
+    int n = net_tcp_recv(c->conn, c->rx + c->rx_len, sizeof(c->rx) - 1 - c->rx_len);
+    if (n > 0) c->rx_len += (uint16_t)n;
+    c->rx[c->rx_len] = '\0';
+    char *end = strstr((char *)c->rx, "\r\n\r\n");
+    if (!end) {
+        if (n >= 0 && c->rx_len < sizeof(c->rx) - 1 && now_ms - c->since_ms < WS_SERVER_HANDSHAKE_MS) return true;
+        ws.stats.handshake_failed++;
+        drop(c);
+        return false;
+    }
+    end[2] = '\0';      // A requisição termina na última linha de cabeçalho
+
+    size_t key_len = 0, upgrade_len = 0;
+    const char *key = header_value((const char *)c->rx, "sec-websocket-key", &key_len);
+    const char *upgrade = header_value((const char *)c->rx, "upgrade", &upgrade_len);
+    char response[160];
+    int response_len;
+    if (strncmp((const char *)c->rx, "GET ", 4) != 0 || !key || key_len == 0 || key_len > 64 || !upgrade ||
+        !contains_token(upgrade, upgrade_len, "websocket")) {
+        response_len = snprintf(response, sizeof(response), "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        net_tcp_send(c->conn, response, (size_t)response_len);
+        ws.stats.handshake_failed++;
+        drop(c);
+        return false;
+    }
+
+    uint8_t material[64 + sizeof(WS_GUID) - 1];
+    memcpy(material, key, key_len);
+    memcpy(material + key_len, WS_GUID, sizeof(WS_GUID) - 1);
+    uint8_t digest[20];
+    sha1(material, key_len + sizeof(WS_GUID) - 1, digest);
+    char accept[29];
+    base64(digest, sizeof(digest), accept);
+    response_len = snprintf(response, sizeof(response),
+                            "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                            "Sec-WebSocket-Accept: %s\r\n\r\n",
+                            accept);
+    // A conexão é nova e o buffer de envio está vazio: a resposta cabe inteira
+    if (net_tcp_send(c->conn, response, (size_t)response_len) != response_len) {
+        ws.stats.handshake_failed++;
+        drop(c);
+        return false;
+    }
+
+    // Quadros que o cliente já enviou depois da requisição ficam para process_input()
+    size_t used = (size_t)(end + 4 - (char *)c->rx);
+    memmove(c->rx, c->rx + used, c->rx_len - used);
+    c->rx_len = (uint16_t)(c->rx_len - used);
+    c->state = WS_CLIENT_OPEN;
+    c->since_ms = now_ms;
+    ws.stats.clients++;
+    return true;
+}
+
+/**
+ * @brief Trata os quadros do cliente: descarta dados, responde ping e close
+ *
+ * @return false se o cliente foi derrubado
+ */
+static bool process_input(ws_client_t *c) {
+    int n = net_tcp_recv(c->conn, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len);
+    if (n < 0) {
+        ws.stats.closed++;
+        drop(c);
+        return false;
+    }
+    c->rx_len += (uint16_t)n;
+
+    size_t pos = 0;
+    for (;;) {
+        if (c->skip) {
+            size_t k = c->rx_len - pos < c->skip ? c->rx_len - pos : c->skip;
+            pos += k;
+            c->skip -= (uint32_t)k;
+            if (c->skip) break;
+        }
+        if (c->rx_len - pos < 2) break;
+        const uint8_t *p = c->rx + pos;
+        uint8_t opcode = p[0] & 0x0F;
+        uint64_t len = p[1] & 0x7F;
+        size_t header = 2;
+        if (len == 126) header += 2;
+        else if (len == 127) header += 8;
+        header += 4;    // Máscara: todo quadro do cliente é mascarado
+        if (!(p[1] & WS_MASKED)) {
+            drop(c);    // Erro de protocolo (RFC 6455, seção 5.1)
+            return false;
+        }
+        if (c->rx_len - pos < header) break;
+        if (header == 8) len = (uint64_t)p[2] << 8 | p[3];
+        if (header == 14) {
+            len = 0;
+            for (int i = 0; i < 8; i++) len = len << 8 | p[2 + i];
+        }
+
+        if (!(opcode & 0x8)) {
+            // Dados do cliente: sem uso aqui, descartados à medida que chegam
+            if (len > UINT32_MAX) {
+                drop(c);
+                return false;
+            }
+            pos += header;
+            c->skip = (uint32_t)len;
+            continue;
+        }
+        if (len > WS_CONTROL_MAX) {
+            drop(c);
+            return false;
+        }
+        if (c->rx_len - pos < header + len) break;
+        const uint8_t *mask = p + header - 4;
+        uint8_t payload[WS_CONTROL_MAX];
+        for (size_t i = 0; i < len; i++) payload[i] = p[header + i] ^ mask[i % 4];
+        pos += header + (size_t)len;
+
+        if (opcode == WS_OP_CLOSE) {
+            // Responde o close se nenhuma mensagem está pela metade, e fecha
+            static const uint8_t close_frame[2] = {WS_FIN | WS_OP_CLOSE, 0};
+            if (c->sent == 0) net_tcp_send(c->conn, close_frame, sizeof(close_frame));
+            ws.stats.closed++;
+            drop(c);
+            return false;
+        }
+        if (opcode == WS_OP_PING && !c->sending_control) {
+            // Só o último ping pendente é respondido (RFC 6455, seção 5.5.3)
+            c->control[0] = WS_FIN | WS_OP_PONG;
+            c->control[1] = (uint8_t)len;
+            memcpy(c->control + 2, payload, (size_t)len);
+            c->control_len = (uint8_t)(2 + len);
+        }
+    }
+    memmove(c->rx, c->rx + pos, c->rx_len - pos);
+    c->rx_len = (uint16_t)(c->rx_len - pos);
+    return true;
+}
+
+/**
+ * @brief Envia o que couber: o pong pendente entre mensagens, depois a fila
+ *
+ * @return false se o cliente foi derrubado
+ */
+static bool flush(ws_client_t *c, uint32_t now_ms) {
+    for (;;) {
+        const uint8_t *data;
+        size_t len;
+        if (c->sending_control || (c->sent == 0 && c->control_len)) {
+            c->sending_control = true;
+            data = c->control;
+            len = c->control_len;
+        } else if (c->count) {
+            const telemetry_frame_t *frame = c->queue[c->head];
+            size_t header = 2;
+            wire[0] = WS_FIN | WS_OP_BINARY;
+            if (frame->len < 126) {
+                wire[1] = (uint8_t)frame->len;
+            } else {
+                wire[1] = 126;
+                wire[2] = (uint8_t)(frame->len >> 8);
+                wire[3] = (uint8_t)frame->len;
+                header = 4;
+            }
+            memcpy(wire + header, frame->data, frame->len);
+            data = wire;
+            len = header + frame->len;
+        } else {
+            c->since_ms = now_ms;
+            return true;
+        }
+
+        while (c->sent < len) {
+            int n = net_tcp_send(c->conn, data + c->sent, len - c->sent);
+            if (n < 0) {
+                ws.stats.closed++;
+                drop(c);
+                return false;
+            }
+            if (n == 0) return true;
+            c->sent += (uint16_t)n;
+            c->since_ms = now_ms;
+            ws.stats.bytes += (uint32_t)n;
+        }
+        c->sent = 0;
+        if (c->sending_control) {
+            c->sending_control = false;
+            c->control_len = 0;
+        } else {
+            release(c->queue[c->head]);
+            c->head = (uint8_t)((c->head + 1) % WS_SERVER_CLIENT_QUEUE);
+            c->count--;
+            ws.stats.messages++;
+        }
+    }
+}
+
+bool ws_server_init(uint16_t port) {
+    memset(&ws, 0, sizeof(ws));
+    ws.listener = net_tcp_listen(port);
+    return ws.listener != NULL;
+}
+
+uint16_t ws_server_port(void) {
+    return ws.listener ? net_tcp_local_port(ws.listener) : 0;
+}
+
+void ws_server_poll(uint32_t now_ms) {
+    ws.last_poll_ms = now_ms;
+    if (!ws.listener) return;
+
+    net_tcp_t *conn;
+    while ((conn = net_tcp_accept(ws.listener)) != NULL) {
+        ws_client_t *c = NULL;
+        for (int i = 0; i < WS_SERVER_CLIENTS && !c; i++) {
+            if (ws.clients[i].state == WS_CLIENT_FREE) c = &ws.clients[i];
+        }
+        if (!c) {
+            net_tcp_close(conn);
+            continue;
+        }
+        memset(c, 0, sizeof(*c));
+        c->state = WS_CLIENT_HANDSHAKE;
+        c->conn = conn;
+        c->since_ms = now_ms;
+        ws.stats.accepted++;
+    }
+
+    for (int i = 0; i < WS_SERVER_CLIENTS; i++) {
+        ws_client_t *c = &ws.clients[i];
+        if (c->state == WS_CLIENT_HANDSHAKE && !handshake(c, now_ms)) continue;
+        if (c->state != WS_CLIENT_OPEN) continue;
+        if (!process_input(c) || !flush(c, now_ms)) continue;
+        if ((c->count || c->control_len) && now_ms - c->since_ms >= WS_SERVER_STALL_MS) {
+            ws.stats.dropped_stalled++;
+            drop(c);
+        }
+    }
+}
+
+uint32_t ws_server_next_ms(void) {
+    return ws.last_poll_ms + WS_SERVER_POLL_MS;
+}
+
+bool ws_server_has_clients(void) {
+    return ws.stats.clients > 0;
+}
+
+bool ws_server_publish(const uint8_t *data, uint16_t len, uint32_t now_ms) {
+    if (!ws.stats.clients || len > STORE_FORWARD_RECORD_MAX) return false;
+    telemetry_frame_t *frame = telemetry_frame_alloc();
+    if (!frame) {
+        ws.stats.frames_lost++;
+        return false;
+    }
+    frame->len = len;
+    frame->refs = 1;    // Do próprio publish, até o fim do laço abaixo
+    memcpy(frame->data, data, len);
+    ws.stats.frames++;
+
+    for (int i = 0; i < WS_SERVER_CLIENTS; i++) {
+        ws_client_t *c = &ws.clients[i];
+        if (c->state != WS_CLIENT_OPEN) continue;
+        if (c->count == WS_SERVER_CLIENT_QUEUE) {
+            ws.stats.dropped_slow++;
+            drop(c);
+            continue;
+        }
+        if (!c->count) c->since_ms = now_ms;
+        c->queue[(c->head + c->count) % WS_SERVER_CLIENT_QUEUE] = frame;
+        c->count++;
+        frame->refs++;
+        flush(c, now_ms);
+    }
+    release(frame);
+    return true;
+}
+
+void ws_server_get_stats(ws_server_stats_t *stats) {
+    *stats = ws.stats;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file ws_server.h
+ * @brief Servidor WebSocket (RFC 6455) que empurra a telemetria ao vivo para painéis
+ *
+ * Cada cliente abre ws://<pico>:WS_SERVER_PORT/ (qualquer caminho) e
+ * recebe, em mensagens binárias, os registros CBOR de telemetry_cbor.h
+ * assim que são produzidos: um registro por mensagem. O que o cliente
+ * envia é lido e descartado, menos os quadros de controle: ping recebe
+ * pong e close fecha a conexão.
+ *
+ * Os quadros vêm do pool telemetry_frame_pool (message_pools.h) e são
+ * compartilhados: ws_server_publish() põe o mesmo quadro na fila de
+ * cada cliente aberto e conta os donos em refs; o último cliente a
+ * enviá-lo devolve o bloco. Cada cliente tem uma fila de
+ * WS_SERVER_CLIENT_QUEUE quadros e o envio nunca bloqueia
+ * (net_tcp_send() aceita só o que cabe). Um cliente que não acompanha é
+ * derrubado, em vez de segurar a aquisição ou os outros clientes:
+ * - fila cheia quando chega um quadro novo (lento);
+ * - quadro da frente sem nenhum byte aceito por WS_SERVER_STALL_MS
+ *   (parado, por exemplo fora do alcance do Wi-Fi sem fechar o TCP).
+ * Como um quadro só fica retido enquanto algum cliente o tem na fila,
+ * nunca há mais de WS_SERVER_CLIENT_QUEUE + 1 quadros em uso.
+ *
+ * O servidor roda no laço principal: ws_server_poll() aceita conexões,
+ * conduz o handshake HTTP e escoa as filas; ws_server_next_ms() diz
+ * quando chamá-lo de novo. Depende só de net.h: no host, o mesmo código
+ * roda sobre sockets em host/ws_loadtest.c.
+ */
+#ifndef WS_SERVER_H
+#define WS_SERVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "message_pools.h"
+#include "net.h"
+
+#ifndef WS_SERVER_PORT
+#define WS_SERVER_PORT 8080                 // Porta TCP de escuta
+#endif
+#ifndef WS_SERVER_CLIENTS
+#define WS_SERVER_CLIENTS NET_TCP_CONNECTIONS
+#endif
+#ifndef WS_SERVER_CLIENT_QUEUE
+#define WS_SERVER_CLIENT_QUEUE 4            // Quadros na fila de cada cliente
+#endif
+#ifndef WS_SERVER_STALL_MS
+#define WS_SERVER_STALL_MS 3000             // Fila parada por mais que isso derruba o cliente
+#endif
+#ifndef WS_SERVER_HANDSHAKE_MS
+#define WS_SERVER_HANDSHAKE_MS 2000         // Prazo para a requisição HTTP de upgrade
+#endif
+#define WS_SERVER_REQUEST_BYTES 512         // Maior requisição de upgrade aceita
+#define WS_SERVER_POLL_MS 20                // Período de ws_server_poll() sem eventos
+
+/**
+ * @brief Contadores do servidor
+ */
+typedef struct {
+    uint32_t accepted;          // Conexões aceitas
+    uint32_t handshake_failed;  // Requisições inválidas ou fora do prazo
+    uint32_t closed;            // Conexões fechadas pelo cliente
+    uint32_t dropped_slow;      // Clientes derrubados com a fila cheia
+    uint32_t dropped_stalled;   // Clientes derrubados com a fila parada
+    uint32_t frames;            // Quadros publicados com ao menos um cliente
+    uint32_t frames_lost;       // Quadros não publicados (pool vazio)
+    uint32_t messages;          // Mensagens enviadas por inteiro, somando os clientes
+    uint32_t bytes;             // Bytes aceitos pelo TCP, somando os clientes
+    uint8_t clients;            // Clientes com o handshake concluído, agora
+} ws_server_stats_t;
+
+/**
+ * @brief Abre a porta de escuta
+ *
+ * @param port Porta TCP; 0 escolhe uma livre (ws_server_port())
+ * @return false se a porta não pôde ser aberta
+ */
+bool ws_server_init(uint16_t port);
+
+uint16_t ws_server_port(void);
+
+/**
+ * @brief Aceita conexões, avança os handshakes, trata o que os clientes enviaram e escoa as filas
+ */
+void ws_server_poll(uint32_t now_ms);
+
+/**
+ * @brief Próximo instante (ms desde o boot) em que ws_server_poll() deve ser chamado
+ */
+uint32_t ws_server_next_ms(void);
+
+/**
+ * @brief Há clientes para receber quadros (evita codificar para ninguém)
+ */
+bool ws_server_has_clients(void);
+
+/**
+ * @brief Copia um registro num quadro do pool e o publica para todos os clientes
+ *
+ * Não bloqueia: enfileira em cada cliente, tenta enviar na hora e
+ * derruba os clientes de fila cheia.
+ *
+ * @return false se não havia clientes ou quadro livre
+ */
+bool ws_server_publish(const uint8_t *data, uint16_t len, uint32_t now_ms);
+
+void ws_server_get_stats(ws_server_stats_t *stats);
+
+#endif // WS_SERVER_H